@@ -0,0 +1,276 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef BVH_HPP_INCLUDED
+#define BVH_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ares/glutils/BoundingVolume.hpp"
+#include "ares/glutils/Frustum.hpp"
+#include "ares/glutils/LinearAlgebra.hpp"
+
+namespace ares
+{
+
+namespace core
+{
+    class Bvh;
+    using BvhPtr = std::shared_ptr<Bvh>;
+
+    /*!
+     * @brief Bounding volume hierarchy over a set of boxes
+     * 
+     * This class implements a binary BVH with one item per leaf, stored
+     * in a flat array of nodes. Items are identified by caller-provided
+     * dense indices (e.g. an index into an array of scene nodes).
+     * The tree can be built from scratch with the surface area heuristic
+     * (SAH), and then updated incrementally: items can be inserted and
+     * removed, and moved items are refitted by updating the boxes of
+     * their ancestors. Items with empty bounds are tracked but not stored
+     * in the tree, while items with infinite bounds are kept in a separate
+     * list and reported by all frustum queries.
+     */
+    class Bvh
+    {
+    public:
+        /*!
+         * @brief Class constructor, creates an empty hierarchy
+         */
+        Bvh();
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~Bvh() = default;
+
+        Bvh(const Bvh&) = delete;
+        Bvh& operator=(const Bvh&) = delete;
+
+        /*!
+         * @brief Removes all items
+         */
+        void clear();
+
+        /*!
+         * @brief Builds the hierarchy from scratch with the SAH
+         * 
+         * @param[in] boxes - Item bounds, the item index is the position in the vector
+         */
+        void build(const std::vector<glutils::BoundingBox>& boxes);
+
+        /*!
+         * @brief Rebuilds the hierarchy from scratch with the SAH using the current item bounds
+         */
+        void rebuild();
+
+        /*!
+         * @brief Inserts or updates an item
+         * 
+         * New items are inserted in the tree choosing the sibling with the
+         * lowest SAH cost, existing items are refitted to the new bounds.
+         * 
+         * @param[in] item - Item index
+         * @param[in] box - Item bounds
+         */
+        void update(uint32_t item, const glutils::BoundingBox& box);
+
+        /*!
+         * @brief Removes an item
+         * 
+         * @param[in] item - Item index
+         */
+        void remove(uint32_t item);
+
+        /*!
+         * @brief Number of incremental updates since last build getter
+         * 
+         * This value can be used to decide when to rebuild the tree,
+         * as incremental updates degrade its quality over time.
+         * 
+         * @return Number of updates since last build
+         */
+        size_t updatesSinceBuild() const { return m_updatesSinceBuild; }
+
+        /*!
+         * @brief Number of items getter
+         * 
+         * @return Number of items with non-empty bounds
+         */
+        size_t itemCount() const { return m_itemCount; }
+
+        /*!
+         * @brief Collects the items intersecting a frustum
+         * 
+         * @param[in] frustum - Frustum to test
+         * @param[out] items - Vector where the items are appended
+         */
+        void queryFrustum(const glutils::Frustum& frustum, std::vector<uint32_t>& items) const;
+
+        /*!
+         * @brief Finds the closest item whose bounds are hit by a ray
+         * 
+         * @param[in] origin - Ray origin
+         * @param[in] direction - Ray direction
+         * @param[in,out] distance - Maximum distance as input, distance of the hit along the ray as output
+         * @return Item index, -1 if nothing is hit
+         */
+        int32_t queryRay(const glutils::Vec3& origin, const glutils::Vec3& direction, float& distance) const;
+
+        /*!
+         * @brief Collects the items closest to a point
+         * 
+         * @param[in] point - Query point
+         * @param[in] count - Maximum number of items to collect
+         * @param[out] items - Vector where the items are appended, sorted by distance
+         */
+        void queryNearest(const glutils::Vec3& point, size_t count, std::vector<uint32_t>& items) const;
+
+    private:
+        /*!
+         * @brief Tree node
+         */
+        struct TreeNode
+        {
+            /*! Node bounds */
+            glutils::BoundingBox box;
+
+            /*! Parent node index, -1 for the root */
+            int32_t parent;
+
+            /*! Left child index, -1 for leaves */
+            int32_t left;
+
+            /*! Right child index, -1 for leaves */
+            int32_t right;
+
+            /*! Item index for leaves, -1 for inner nodes */
+            int32_t item;
+        };
+
+        /*!
+         * @brief Item data
+         */
+        struct ItemData
+        {
+            /*! Item bounds */
+            glutils::BoundingBox box;
+
+            /*! Leaf node index, -1 if the item is not in the tree */
+            int32_t leaf;
+
+            /*! Index in the unbounded list, -1 if the item is not unbounded */
+            int32_t unbounded;
+        };
+
+        /*! Tree nodes */
+        std::vector<TreeNode> m_nodes;
+
+        /*! Indices of free tree nodes */
+        std::vector<int32_t> m_freeNodes;
+
+        /*! Root node index, -1 if the tree is empty */
+        int32_t m_root;
+
+        /*! Item data, indexed by item */
+        std::vector<ItemData> m_items;
+
+        /*! Items with infinite bounds */
+        std::vector<uint32_t> m_unboundedItems;
+
+        /*! Number of items with non-empty bounds */
+        size_t m_itemCount;
+
+        /*! Number of incremental updates since last build */
+        size_t m_updatesSinceBuild;
+
+        /*!
+         * @brief Helper method to allocate a tree node
+         * 
+         * @return Node index
+         */
+        int32_t allocateNode();
+
+        /*!
+         * @brief Helper method to release a tree node
+         * 
+         * @param[in] index - Node index
+         */
+        void releaseNode(int32_t index);
+
+        /*!
+         * @brief Recursive helper method to build a subtree with the SAH
+         * 
+         * @param[in,out] items - Item indices to partition
+         * @param[in] centroids - Item box centroids, indexed by item
+         * @param[in] begin - First item of the subtree
+         * @param[in] end - Past-the-end item of the subtree
+         * @param[in] parent - Parent node index
+         * @return Subtree root index
+         */
+        int32_t buildRecursive(std::vector<uint32_t>& items, const std::vector<glutils::Vec3>& centroids, size_t begin, size_t end, int32_t parent);
+
+        /*!
+         * @brief Helper method to insert a leaf in the tree
+         * 
+         * @param[in] leaf - Leaf node index
+         */
+        void insertLeaf(int32_t leaf);
+
+        /*!
+         * @brief Helper method to remove a leaf from the tree
+         * 
+         * @param[in] leaf - Leaf node index
+         */
+        void removeLeaf(int32_t leaf);
+
+        /*!
+         * @brief Helper method to refit the ancestors of a node
+         * 
+         * @param[in] index - First node to refit
+         */
+        void refitFrom(int32_t index);
+
+        /*!
+         * @brief Helper method to add or remove an item from the unbounded list
+         * 
+         * @param[in] item - Item index
+         * @param[in] unbounded - true to add the item, false to remove it
+         */
+        void setUnbounded(uint32_t item, bool unbounded);
+    };
+}
+
+}
+
+#endif
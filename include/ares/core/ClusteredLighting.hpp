@@ -0,0 +1,379 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef CLUSTEREDLIGHTING_HPP_INCLUDED
+#define CLUSTEREDLIGHTING_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ares/core/LightNode.hpp"
+#include "ares/core/TaskPool.hpp"
+#include "ares/glutils/LinearAlgebra.hpp"
+#include "ares/glutils/Shader.hpp"
+#include "ares/glutils/Texture.hpp"
+
+namespace ares
+{
+
+namespace core
+{
+    class ClusteredLighting;
+    using ClusteredLightingPtr = std::shared_ptr<ClusteredLighting>;
+
+    /*!
+     * @brief Clustered forward lighting engine
+     * 
+     * This class assigns the lights of a frame to the clusters of a
+     * view space grid: the screen is split in tiles and the view depth
+     * in exponentially distributed slices. Point and spot lights are
+     * tested against the bounds of the clusters with the sphere of their
+     * range, directional lights affect all clusters.
+     * The grid, the light index lists of the clusters and the light data
+     * are uploaded to textures, which the shaders including FRAG_SHADER_HEADER
+     * index with the fragment position, so that each fragment only iterates
+     * the lights affecting its cluster.
+     * The light data is stored in float textures, or in half float textures
+     * when float textures are not supported. When neither is supported,
+     * the shaders get no light.
+     */
+    class ClusteredLighting
+    {
+    public:
+        /*! Number of screen tiles along X */
+        static constexpr uint32_t TILES_X = 16U;
+
+        /*! Number of screen tiles along Y */
+        static constexpr uint32_t TILES_Y = 8U;
+
+        /*! Number of depth slices */
+        static constexpr uint32_t SLICES = 24U;
+
+        /*! Maximum number of directional lights, further ones are ignored */
+        static constexpr uint32_t MAX_DIRECTIONAL_LIGHTS = 4U;
+
+        /*! Maximum number of lights per cluster, further ones are ignored */
+        static constexpr uint32_t MAX_CLUSTER_LIGHTS = 64U;
+
+        /*! Maximum number of lights, further ones are ignored */
+        static constexpr uint32_t MAX_LIGHTS = 8192U;
+
+        /*! Texture unit of the cluster grid texture */
+        static constexpr int32_t GRID_TEX_UNIT = 5;
+
+        /*! Texture unit of the light index texture */
+        static constexpr int32_t INDEX_TEX_UNIT = 6;
+
+        /*! Texture unit of the light data texture */
+        static constexpr int32_t LIGHT_TEX_UNIT = 7;
+
+        /*!
+         * @brief Fragment shader header with the clustered lighting functions
+         * 
+         * The header is meant to be passed to Material::setShaderSources.
+         * It defines ARES_MAX_LIGHTS and two functions:
+         * - float aresLightCount(vec3 viewPos, out float listOffset), returning
+         *   the number of lights affecting a fragment at the view position;
+         * - void aresLight(float i, float listOffset, vec3 viewPos, out vec3 L, out vec3 radiance),
+         *   returning the normalized direction towards the i-th light and its
+         *   attenuated radiance at the view position.
+         */
+        static const char FRAG_SHADER_HEADER[];
+
+        /*!
+         * @brief Lighting statistics of a frame
+         */
+        struct Stats
+        {
+            /*! Number of lights uploaded */
+            uint32_t lights;
+
+            /*! Number of directional lights uploaded */
+            uint32_t directionalLights;
+
+            /*! Number of light indices in the cluster lists */
+            uint32_t lightIndices;
+
+            /*! Maximum number of lights in a cluster */
+            uint32_t maxClusterLights;
+
+            /*! Number of lights or light indices ignored because of the limits */
+            uint32_t droppedLights;
+        };
+
+        /*!
+         * @brief Handles of the clustered lighting uniforms of a shader
+         */
+        struct UniformHandles
+        {
+            /*! Tile and slice scale factors */
+            glutils::UniformHandle<glutils::Uniform4f> clusterScale;
+
+            /*! Light counts and texture scale factors */
+            glutils::UniformHandle<glutils::Uniform4f> clusterParams;
+        };
+
+        /*!
+         * @brief Class constructor
+         */
+        ClusteredLighting();
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~ClusteredLighting() = default;
+
+        ClusteredLighting(const ClusteredLighting&) = delete;
+        ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+        /*!
+         * @brief Checks if clustered lighting is supported by the current context
+         * 
+         * @return true if float or half float textures are supported, false otherwise
+         */
+        static bool isSupported();
+
+        /*!
+         * @brief Maximum clustered depth setter
+         * 
+         * The depth slices are distributed between the near plane and the
+         * closest of the far plane and this depth; fragments and lights
+         * beyond it share the last slice.
+         * 
+         * @param[in] maxDepth - Maximum clustered depth (default 1000)
+         */
+        void setMaxDepth(float maxDepth);
+
+        /*!
+         * @brief Maximum clustered depth getter
+         * 
+         * @return Maximum clustered depth
+         */
+        float maxDepth() const { return m_maxDepth; }
+
+        /*!
+         * @brief Statistics getter
+         * 
+         * @return Lighting statistics of the last update
+         */
+        const Stats& stats() const { return m_stats; }
+
+        /*!
+         * @brief Assigns the lights to the clusters and uploads the lighting textures
+         * 
+         * The light positions and directions in the view coordinate system
+         * must be up to date. A context must be current.
+         * 
+         * @param[in] lightVec - Lights of the frame
+         * @param[in] projectionMatrix - Projection matrix of the frame
+         * @param[in] viewportWidth - Viewport width in pixels
+         * @param[in] viewportHeight - Viewport height in pixels
+         * @param[in] taskPool - Optional task pool to bin the depth slices in parallel
+         */
+        void update(const std::vector<LightNodePtr>& lightVec, const glutils::Mat4& projectionMatrix, int32_t viewportWidth, int32_t viewportHeight, TaskPool* taskPool = nullptr);
+
+        /*!
+         * @brief Binds the lighting textures and makes the lighting current
+         * 
+         * The materials set the uniforms of the current lighting in their setup.
+         */
+        void bind();
+
+        /*!
+         * @brief Releases the current lighting
+         * 
+         * The materials set up afterwards get no light.
+         */
+        void unbind();
+
+        /*!
+         * @brief Resolves the clustered lighting uniforms of a shader and sets its samplers
+         * 
+         * @param[in] shader - Shader including FRAG_SHADER_HEADER
+         * @param[out] handles - Uniform handles of the shader
+         */
+        static void resolveUniforms(glutils::Shader& shader, UniformHandles& handles);
+
+        /*!
+         * @brief Sets the uniforms of the current lighting, if any
+         * 
+         * The lighting textures are bound again, as the light pre-pass
+         * shares their texture units.
+         * 
+         * @param[in] shader - Shader in use
+         * @param[in] handles - Uniform handles of the shader
+         */
+        static void setUniforms(glutils::Shader& shader, const UniformHandles& handles);
+
+    private:
+        /*!
+         * @brief Bounds of a point or spot light in the cluster grid
+         */
+        struct LightBounds
+        {
+            /*! Light position in the view coordinate system */
+            float position[3];
+
+            /*! Light range */
+            float radius;
+
+            /*! Index of the light in the light data */
+            uint16_t index;
+
+            /*! First depth slice */
+            uint8_t slice0;
+
+            /*! Last depth slice */
+            uint8_t slice1;
+
+            /*! First tile along X */
+            uint8_t tileX0;
+
+            /*! Last tile along X */
+            uint8_t tileX1;
+
+            /*! First tile along Y */
+            uint8_t tileY0;
+
+            /*! Last tile along Y */
+            uint8_t tileY1;
+        };
+
+        /*! Maximum clustered depth */
+        float m_maxDepth;
+
+        /*! Type of the light data texture, 0 until checked or if unsupported */
+        GLenum m_lightDataType;
+
+        /*! Projection matrix of the cluster bounds */
+        glutils::Mat4 m_projectionMatrix;
+
+        /*! Flag set if the cluster bounds must be recomputed */
+        bool m_boundsDirty;
+
+        /*! Near plane distance */
+        float m_near;
+
+        /*! Far plane distance of the projection, may be infinite */
+        float m_far;
+
+        /*! Tile and slice scale factors for the shaders */
+        glutils::Vec4 m_clusterScale;
+
+        /*! Light counts and texture scale factors for the shaders */
+        glutils::Vec4 m_clusterParams;
+
+        /*! View depth of the slice boundaries, the last one is the maximum clustered depth */
+        std::vector<float> m_sliceDepths;
+
+        /*! Minimum X of the cluster bounds in the view coordinate system, indexed by slice and tile column */
+        std::vector<float> m_clusterMinX;
+
+        /*! Maximum X of the cluster bounds in the view coordinate system, indexed by slice and tile column */
+        std::vector<float> m_clusterMaxX;
+
+        /*! Minimum Y of the cluster bounds in the view coordinate system, indexed by slice and tile row */
+        std::vector<float> m_clusterMinY;
+
+        /*! Maximum Y of the cluster bounds in the view coordinate system, indexed by slice and tile row */
+        std::vector<float> m_clusterMaxY;
+
+        /*! Bounds of the point and spot lights of the frame, kept to reuse its memory */
+        std::vector<LightBounds> m_lightBounds;
+
+        /*! Light indices of the clusters, kept to reuse their memory */
+        std::vector<std::vector<uint16_t>> m_clusterLights;
+
+        /*! Number of light indices ignored per depth slice */
+        std::vector<uint32_t> m_sliceDropped;
+
+        /*! Cluster grid texture data */
+        std::vector<uint8_t> m_gridData;
+
+        /*! Light index texture data */
+        std::vector<uint8_t> m_indexData;
+
+        /*! Light data, 3 RGBA texels per light */
+        std::vector<float> m_lightData;
+
+        /*! Light data converted to half floats */
+        std::vector<uint16_t> m_halfLightData;
+
+        /*! Cluster grid texture */
+        glutils::TexturePtr m_gridTex;
+
+        /*! Light index texture */
+        glutils::TexturePtr m_indexTex;
+
+        /*! Light data texture */
+        glutils::TexturePtr m_lightTex;
+
+        /*! Lighting statistics */
+        Stats m_stats;
+
+        /*!
+         * @brief Helper method to compute the cluster bounds of a projection
+         * 
+         * @param[in] projectionMatrix - Projection matrix
+         */
+        void updateClusterBounds(const glutils::Mat4& projectionMatrix);
+
+        /*!
+         * @brief Helper method to compute the bounds of a light in the grid
+         * 
+         * @param[in] position - Light position in the view coordinate system
+         * @param[in] radius - Light range
+         * @param[out] bounds - Light bounds
+         * @return false if the light cannot affect any cluster, true otherwise
+         */
+        bool computeLightBounds(const glutils::Vec3& position, float radius, LightBounds& bounds) const;
+
+        /*!
+         * @brief Helper method to assign the lights to the clusters of a depth slice
+         * 
+         * Slices are independent, so this method can run concurrently on different slices.
+         * 
+         * @param[in] slice - Depth slice index
+         */
+        void binSlice(uint32_t slice);
+
+        /*!
+         * @brief Helper method to pack and upload the lighting textures
+         * 
+         * @param[in] lightCount - Number of lights in the light data
+         */
+        void uploadTextures(uint32_t lightCount);
+    };
+}
+
+}
+
+#endif
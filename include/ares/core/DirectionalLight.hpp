@@ -0,0 +1,73 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef DIRECTIONALLIGHT_HPP_INCLUDED
+#define DIRECTIONALLIGHT_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+
+#include "ares/core/Light.hpp"
+
+namespace ares
+{
+
+namespace core
+{
+    class DirectionalLight;
+    using DirectionalLightPtr = std::shared_ptr<DirectionalLight>;
+
+    /*!
+     * @brief Directional light specialization of the generic Light class
+     * 
+     * Implements a light infinitely far away, emitted along the -Z
+     * axis of the light node, e.g. the sun.
+     */
+    class DirectionalLight : public Light
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         */
+        DirectionalLight();
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~DirectionalLight() = default;
+
+        DirectionalLight(const DirectionalLight&) = delete;
+        DirectionalLight& operator=(const DirectionalLight&) = delete;
+    };
+}
+
+}
+
+#endif
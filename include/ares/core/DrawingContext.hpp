@@ -33,8 +33,10 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include <EGL/egl.h>
 
+#include "ares/glutils/GlState.hpp"
 #include "ares/port/DisplayDevice.hpp"
 
 namespace ares
@@ -56,6 +58,9 @@ namespace core
      * any initializations needed to create the EGL window, render surface and
      * context. The activate/deactivate methods select the EGL context.
      * The draw method performs a buffer swap operation.
+     * Devices without a native window (e.g. port::HeadlessDisplay) are drawn
+     * in an offscreen pbuffer surface, whose content can be read back with
+     * the readPixels method.
      */
     class DrawingContext
     {
@@ -107,7 +112,8 @@ namespace core
         /*!
          * @brief Method to activate the context
          * 
-         * This method activates the drawing context, if not already active
+         * This method activates the drawing context, if not already active,
+         * and makes its OpenGL state tracker current
          */
         void activate();
 
@@ -125,6 +131,24 @@ namespace core
          */
         void draw() const;
 
+        /*!
+         * @brief Method to read back the drawn pixels
+         * 
+         * This method reads the pixels of the context surface, e.g. to save
+         * the frame rendered in an offscreen surface. It must be called
+         * while the context is active.
+         * 
+         * @param[out] pixels - RGBA pixels with 8 bits per channel, bottom row first
+         */
+        void readPixels(std::vector<uint8_t>& pixels) const;
+
+        /*!
+         * @brief OpenGL state tracker getter
+         * 
+         * @return OpenGL state tracker of the context
+         */
+        glutils::GlState& glState() { return m_glState; }
+
     private:
         /*! Native device associated to the drawing context */
         port::DisplayDevicePtr m_device;
@@ -144,11 +168,15 @@ namespace core
         /*! Flag indicating if context is active */
         bool m_active;
 
+        /*! OpenGL state tracker of the context */
+        glutils::GlState m_glState;
+
         /*!
          * @brief Helper method to create an EGL Display
          * 
          * This method creates an EGL display with the provided
-         * native device object. Throws a runtime error in case of errors
+         * native device object, using the device EGL platform if it has
+         * one and it is supported. Throws a runtime error in case of errors
          */
         void createEGLDisplay();
 
@@ -163,8 +191,9 @@ namespace core
         /*!
          * @brief Helper method to create an EGL Surface
          * 
-         * This method creates an EGL surface with the provided
-         * native device object. Throws a runtime error in case of errors
+         * This method creates an EGL window surface with the provided
+         * native device object, or a pbuffer surface with the device size
+         * for offscreen devices. Throws a runtime error in case of errors
          */
         void createEGLSurface();
 
@@ -70,6 +70,13 @@ namespace core
         FlatColorMaterial(const FlatColorMaterial&) = delete;
         FlatColorMaterial& operator=(const FlatColorMaterial&) = delete;
 
+        /*!
+         * @brief Material class name getter
+         * 
+         * @return "FlatColorMaterial"
+         */
+        const char* className() const override { return "FlatColorMaterial"; }
+
         /*!
          * @brief Material color setter
          * 
@@ -96,7 +103,31 @@ namespace core
          * @param[in] normalMatrix - Normal matrix for drawing
          * @param[in] lightVec - Vector of lights for drawing
          */
-        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+
+        /*!
+         * @brief Method to resolve the material uniforms of a shader variant
+         * 
+         * @param[in] shader - Shader variant to configure
+         * @param[in] variant - Shader variant type
+         */
+        void resolveUniforms(glutils::Shader& shader, ShaderVariant variant) override;
+
+    private:
+        /*!
+         * @brief Uniform handles of a shader variant
+         */
+        struct UniformHandles
+        {
+            /*! Model-view-projection matrix */
+            glutils::UniformHandle<glutils::UniformMat4> mvp;
+
+            /*! Material color */
+            glutils::UniformHandle<glutils::Uniform4f> color;
+        };
+
+        /*! Uniform handles of each shader variant */
+        UniformHandles m_uniforms[SHADER_VARIANT_COUNT];
     };
 }
 
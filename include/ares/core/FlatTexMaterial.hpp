@@ -70,6 +70,13 @@ namespace core
         FlatTexMaterial(const FlatTexMaterial&) = delete;
         FlatTexMaterial& operator=(const FlatTexMaterial&) = delete;
 
+        /*!
+         * @brief Material class name getter
+         * 
+         * @return "FlatTexMaterial"
+         */
+        const char* className() const override { return "FlatTexMaterial"; }
+
         /*!
          * @brief Texture setter
          * 
@@ -84,6 +91,13 @@ namespace core
          */
         glutils::TexturePtr texture() const { return m_texture; }
 
+        /*!
+         * @brief Texture key getter
+         * 
+         * @return OpenGL ID of the material texture, 0 if not set
+         */
+        uint32_t textureKey() const override { return (nullptr != m_texture) ? (m_texture->tex()) : (0U); }
+
     protected:
         /*! Texture */
         glutils::TexturePtr m_texture;
@@ -96,7 +110,28 @@ namespace core
          * @param[in] normalMatrix - Normal matrix for drawing
          * @param[in] lightVec - Vector of lights for drawing
          */
-        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+
+        /*!
+         * @brief Method to resolve the material uniforms of a shader variant
+         * 
+         * @param[in] shader - Shader variant to configure
+         * @param[in] variant - Shader variant type
+         */
+        void resolveUniforms(glutils::Shader& shader, ShaderVariant variant) override;
+
+    private:
+        /*!
+         * @brief Uniform handles of a shader variant
+         */
+        struct UniformHandles
+        {
+            /*! Model-view-projection matrix */
+            glutils::UniformHandle<glutils::UniformMat4> mvp;
+        };
+
+        /*! Uniform handles of each shader variant */
+        UniformHandles m_uniforms[SHADER_VARIANT_COUNT];
     };
 }
 
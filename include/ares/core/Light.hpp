@@ -34,6 +34,8 @@
 #include <cstdint>
 #include <memory>
 
+#include "ares/glutils/LinearAlgebra.hpp"
+
 namespace ares
 {
 
@@ -46,7 +48,11 @@ namespace core
      * @brief Light classto implement a generic light
      * 
      * This class serves as a base class for all specialized
-     * light classes. It cannot be directly instantiated
+     * light classes. It cannot be directly instantiated.
+     * Lights follow the KHR_lights_punctual conventions: the
+     * intensity is in candela for point and spot lights and in lux
+     * for directional lights, the light is emitted along the -Z axis
+     * of the light node and the range is infinite when set to zero.
      */
     class Light
     {
@@ -77,10 +83,74 @@ namespace core
          */
         Type type() const { return m_type; }
 
+        /*!
+         * @brief Color setter
+         * 
+         * @param[in] color - Linear RGB light color (default white)
+         */
+        void setColor(const glutils::Vec3& color) { m_color = color; }
+
+        /*!
+         * @brief Color getter
+         * 
+         * @return Linear RGB light color
+         */
+        const glutils::Vec3& color() const { return m_color; }
+
+        /*!
+         * @brief Intensity setter
+         * 
+         * @param[in] intensity - Light intensity (default 1)
+         */
+        void setIntensity(float intensity) { m_intensity = intensity; }
+
+        /*!
+         * @brief Intensity getter
+         * 
+         * @return Light intensity
+         */
+        float intensity() const { return m_intensity; }
+
+        /*!
+         * @brief Range setter
+         * 
+         * The range is ignored by directional lights.
+         * 
+         * @param[in] range - Distance where the light intensity reaches zero, 0 for infinite range (default)
+         */
+        void setRange(float range) { m_range = range; }
+
+        /*!
+         * @brief Range getter
+         * 
+         * @return Distance where the light intensity reaches zero, 0 for infinite range
+         */
+        float range() const { return m_range; }
+
+        /*!
+         * @brief Effective range getter
+         * 
+         * Lights with infinite range are limited to the distance
+         * where their inverse-square attenuated intensity becomes
+         * negligible, so that they can be culled.
+         * 
+         * @return Distance where the light contribution can be ignored
+         */
+        float effectiveRange() const;
+
     protected:
         /*! Light type */
         Type m_type;
 
+        /*! Linear RGB light color */
+        glutils::Vec3 m_color;
+
+        /*! Light intensity */
+        float m_intensity;
+
+        /*! Light range, 0 for infinite */
+        float m_range;
+
         /*!
          * @brief Class constructor
          */
@@ -78,6 +78,16 @@ namespace core
          */
         void setLightPosition(const glutils::Vec3& lightPosition) { m_lightPosition = lightPosition; }
 
+        /*!
+         * @brief Sets the direction of the light node in view coordinates system
+         * 
+         * This method is called with setLightPosition to set the direction
+         * of the light (i.e. the -Z axis of the node) in the view coordinate system.
+         *
+         * @param[in] lightDirection - Normalized direction of the light node in view coordinates system
+         */
+        void setLightDirection(const glutils::Vec3& lightDirection) { m_lightDirection = lightDirection; }
+
         /*!
          * @brief Light getter
          * 
@@ -95,6 +105,32 @@ namespace core
          */
         const glutils::Vec3& lightPosition() const { return m_lightPosition; }
 
+        /*!
+         * @brief Light direction getter in the view coordinate system
+         * 
+         * @return Normalized light direction in the view coordinate system
+         */
+        const glutils::Vec3& lightDirection() const { return m_lightDirection; }
+
+        /*!
+         * @brief Light position getter in the world coordinate system
+         * 
+         * The position is cached by the scene update, and it is
+         * only recomputed when the node transform changes.
+         * 
+         * @return Light position in the world coordinate system
+         */
+        const glutils::Vec3& worldPosition() const { return m_worldPosition; }
+
+        /*!
+         * @brief Light direction getter in the world coordinate system
+         * 
+         * The direction is cached with the world position.
+         * 
+         * @return Normalized light direction in the world coordinate system
+         */
+        const glutils::Vec3& worldDirection() const { return m_worldDirection; }
+
     private:
         /*! Light object */
         LightPtr m_light;
@@ -102,6 +138,18 @@ namespace core
         /*! Light node position in the view coordinate system  */
         glutils::Vec3 m_lightPosition;
 
+        /*! Light node direction in the view coordinate system  */
+        glutils::Vec3 m_lightDirection;
+
+        /*! Cached light node position in the world coordinate system */
+        glutils::Vec3 m_worldPosition;
+
+        /*! Cached light node direction in the world coordinate system */
+        glutils::Vec3 m_worldDirection;
+
+        /*! Flag set if the world position or direction changed since the last view update */
+        bool m_lightPositionDirty;
+
         /*!
          * @brief Class constructor
          */
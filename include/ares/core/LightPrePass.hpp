@@ -0,0 +1,315 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef LIGHTPREPASS_HPP_INCLUDED
+#define LIGHTPREPASS_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ares/core/LightNode.hpp"
+#include "ares/glutils/Framebuffer.hpp"
+#include "ares/glutils/LinearAlgebra.hpp"
+#include "ares/glutils/Renderbuffer.hpp"
+#include "ares/glutils/Shader.hpp"
+#include "ares/glutils/Texture.hpp"
+#include "ares/glutils/VertexLayout.hpp"
+
+namespace ares
+{
+
+namespace core
+{
+    class LightPrePass;
+    using LightPrePassPtr = std::shared_ptr<LightPrePass>;
+
+    /*!
+     * @brief Light pre-pass (deferred lighting) engine
+     * 
+     * This class implements the passes of the light pre-pass rendering
+     * within the GLES2 limits, i.e. a single color attachment per framebuffer:
+     * - the normals and depths of the opaque primitives are rendered to an
+     *   offscreen RGBA8 target, the normal is octahedral encoded in RG and
+     *   the depth is read from a depth texture when OES_depth_texture is
+     *   supported, otherwise the inverse view depth is packed in BA;
+     * - each light is drawn as proxy geometry covering its volume (a sphere
+     *   for point lights, a cone for spot lights, a fullscreen quad for
+     *   directional lights), which reconstructs the view position of the
+     *   pixels and accumulates their diffuse radiance (RGB) and specular
+     *   luminance (A) in the light buffer with additive blending;
+     * - the materials are drawn again with their LightBuffer shader variant,
+     *   which reads the light buffer of the pixel through FRAG_SHADER_HEADER.
+     * The light buffer is an RGBA8 texture storing the lighting scaled down
+     * by LIGHT_BUFFER_SCALE, so that it saturates at that value.
+     */
+    class LightPrePass
+    {
+    public:
+        /*! Texture unit of the light buffer, shared with the ClusteredLighting grid texture */
+        static constexpr int32_t LIGHT_BUFFER_TEX_UNIT = 5;
+
+        /*! Scale of the lighting stored in the light buffer */
+        static constexpr float LIGHT_BUFFER_SCALE = 4.F;
+
+        /*!
+         * @brief Fragment shader header with the light buffer function
+         * 
+         * The header is meant to be passed to Material::setShaderSources as
+         * light buffer header. It defines ARES_LIGHT_PREPASS and the function
+         * vec4 aresLightBuffer(), returning the diffuse radiance (RGB) and the
+         * specular luminance (A) accumulated at the fragment.
+         */
+        static const char FRAG_SHADER_HEADER[];
+
+        /*!
+         * @brief Fragment shader writing the normal and depth of the fragments
+         * 
+         * The shader reads the v_norm and v_pos (view position) varyings of
+         * the material vertex shader.
+         */
+        static const char NORMAL_DEPTH_FRAG_SHADER[];
+
+        /*!
+         * @brief Fragment shader header of NORMAL_DEPTH_FRAG_SHADER getter
+         * 
+         * The header defines ARES_PACKED_DEPTH if depth textures are not supported
+         * by the current context.
+         * 
+         * @return Fragment shader header, a static string
+         */
+        static const char* normalDepthFragHeader();
+
+        /*!
+         * @brief Handles of the light pre-pass uniforms of a shader
+         */
+        struct UniformHandles
+        {
+            /*! Light buffer texture coordinate and lighting scale factors */
+            glutils::UniformHandle<glutils::Uniform4f> lightBufferParams;
+        };
+
+        /*!
+         * @brief Class constructor
+         */
+        LightPrePass();
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~LightPrePass() = default;
+
+        LightPrePass(const LightPrePass&) = delete;
+        LightPrePass& operator=(const LightPrePass&) = delete;
+
+        /*!
+         * @brief Checks if the current context renders depth to textures
+         * 
+         * Without depth textures the depth is packed in the normal target.
+         * 
+         * @return true if OES_depth_texture is supported, false otherwise
+         */
+        static bool hasDepthTexture();
+
+        /*!
+         * @brief Begins the normal and depth pass
+         * 
+         * The offscreen targets are created or resized to the viewport, the
+         * normal and depth target is bound and cleared. The caller then draws
+         * the opaque primitives with the NormalDepth shader variants.
+         * A context must be current.
+         * 
+         * @param[in] width - Viewport width in pixels
+         * @param[in] height - Viewport height in pixels
+         * @return true if the pass can be rendered, false if the offscreen targets are not supported
+         */
+        bool beginNormalDepthPass(int32_t width, int32_t height);
+
+        /*!
+         * @brief Accumulates the lights in the light buffer
+         * 
+         * This method ends the normal and depth pass, draws the light volumes
+         * in the light buffer and binds the default framebuffer back, with the
+         * renderer default state (depth test and writes enabled, back faces culled,
+         * blending disabled). The light positions and directions in the view
+         * coordinate system must be up to date.
+         * 
+         * @param[in] lightVec - Lights of the frame
+         * @param[in] projectionMatrix - Projection matrix of the frame
+         */
+        void accumulateLights(const std::vector<LightNodePtr>& lightVec, const glutils::Mat4& projectionMatrix);
+
+        /*!
+         * @brief Makes the light buffer current
+         * 
+         * The materials set the uniforms of the current light buffer in their setup.
+         */
+        void bind();
+
+        /*!
+         * @brief Releases the current light buffer
+         * 
+         * The materials set up afterwards get no light from the light buffer.
+         */
+        void unbind();
+
+        /*!
+         * @brief Resolves the light pre-pass uniforms of a shader and sets its sampler
+         * 
+         * @param[in] shader - Shader including FRAG_SHADER_HEADER
+         * @param[out] handles - Uniform handles of the shader
+         */
+        static void resolveUniforms(glutils::Shader& shader, UniformHandles& handles);
+
+        /*!
+         * @brief Sets the uniforms of the current light buffer, if any, and binds it
+         * 
+         * @param[in] shader - Shader in use
+         * @param[in] handles - Uniform handles of the shader
+         */
+        static void setUniforms(glutils::Shader& shader, const UniformHandles& handles);
+
+    private:
+        /*!
+         * @brief Handles of the uniforms of the light shader
+         */
+        struct LightShaderHandles
+        {
+            /*! Model-view-projection matrix of the light volume */
+            glutils::UniformHandle<glutils::UniformMat4> mvpMx;
+
+            /*! Inverse projection matrix */
+            glutils::UniformHandle<glutils::UniformMat4> invPMx;
+
+            /*! Inverse viewport size */
+            glutils::UniformHandle<glutils::Uniform2f> invViewport;
+
+            /*! Light position and inverse squared range, negative for directional lights */
+            glutils::UniformHandle<glutils::Uniform4f> lightPos;
+
+            /*! Light radiance and spot falloff scale */
+            glutils::UniformHandle<glutils::Uniform4f> lightColor;
+
+            /*! Light direction and spot falloff offset */
+            glutils::UniformHandle<glutils::Uniform4f> lightDir;
+        };
+
+        /*!
+         * @brief Proxy geometry of a light volume
+         */
+        struct Proxy
+        {
+            /*! Vertex layout for the light shader */
+            glutils::VertexLayoutPtr layout;
+
+            /*! Number of indices */
+            GLsizei indexCount;
+        };
+
+        /*! Depth texture flag, the depth is packed in the normal target otherwise */
+        bool m_depthTexture;
+
+        /*! Width of the offscreen targets */
+        int32_t m_width;
+
+        /*! Height of the offscreen targets */
+        int32_t m_height;
+
+        /*! Normal and packed depth target */
+        glutils::TexturePtr m_normalTex;
+
+        /*! Depth texture, if supported */
+        glutils::TexturePtr m_depthTex;
+
+        /*! Depth renderbuffer shared by the framebuffers, if depth textures are not supported */
+        glutils::RenderbufferPtr m_depthRb;
+
+        /*! Light buffer */
+        glutils::TexturePtr m_lightBufferTex;
+
+        /*! Normal and depth framebuffer */
+        glutils::FramebufferPtr m_normalFbo;
+
+        /*! Light buffer framebuffer */
+        glutils::FramebufferPtr m_lightBufferFbo;
+
+        /*! Light shader */
+        glutils::ShaderPtr m_lightShader;
+
+        /*! Light shader uniform handles */
+        LightShaderHandles m_lightHandles;
+
+        /*! Sphere proxy of point lights, and of spot lights with a wide cone */
+        Proxy m_sphere;
+
+        /*! Cone proxy of spot lights */
+        Proxy m_cone;
+
+        /*! Fullscreen quad proxy of directional lights */
+        Proxy m_quad;
+
+        /*! Light buffer texture coordinate and lighting scale factors for the shaders */
+        glutils::Vec4 m_lightBufferParams;
+
+        /*!
+         * @brief Helper method to create the offscreen targets
+         * 
+         * @param[in] width - Target width in pixels
+         * @param[in] height - Target height in pixels
+         */
+        void createTargets(int32_t width, int32_t height);
+
+        /*!
+         * @brief Helper method to create the light shader and the proxy geometries
+         */
+        void createLightResources();
+
+        /*!
+         * @brief Helper method to create a proxy geometry
+         * 
+         * @param[in] vertices - Vertex positions, 3 floats per vertex
+         * @param[in] indices - Triangle indices
+         * @param[out] proxy - Proxy geometry
+         */
+        void createProxy(const std::vector<float>& vertices, const std::vector<uint16_t>& indices, Proxy& proxy) const;
+
+        /*!
+         * @brief Helper method to draw a proxy geometry
+         * 
+         * @param[in] proxy - Proxy geometry
+         * @param[in] mvpMatrix - Model-view-projection matrix of the light volume
+         */
+        void drawProxy(const Proxy& proxy, const glutils::Mat4& mvpMatrix);
+    };
+}
+
+}
+
+#endif
@@ -33,6 +33,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 #include <GLES2/gl2.h>
 
@@ -51,6 +52,9 @@ namespace core
     class LightNode;
     using LightNodePtr = std::shared_ptr<LightNode>;
 
+    /*! Number of vec4 attributes holding the rows of an instance model matrix */
+    constexpr uint32_t INSTANCE_MATRIX_ROWS = 3U;
+
     /*!
      * @brief Abstract class to handle materials.
      * 
@@ -59,12 +63,41 @@ namespace core
      * This class must be derived by specializations that implement the actual
      * materials. The derived classes must assign a valid shader pointer in the
      * constructor, as well as implementing the onSetup method to setup the
-     * material, activate the provided vbo and configure the shader.
+     * material and configure the shader.
      * The onSetup method is called in the context of the Material::setup method
+     * Materials whose shaders are set with setShaderSources also get an
+     * instanced variant of their vertex shader, compiled on first use, where
+     * ARES_INSTANCING is defined and the instanceModelMatrix() function returns
+     * the model matrix of the current instance, read from per-instance
+     * attributes. In this variant the model-view and normal matrices passed
+     * to onSetup are the ones of the view, to be combined with the instance
+     * model matrix by the vertex shader.
+     * Materials whose shaders are set with a light buffer fragment header
+     * support the light pre-pass: their NormalDepth variants pair the vertex
+     * shader with the LightPrePass normal and depth fragment shader, and
+     * their LightBuffer variants replace the lighting header with the light
+     * buffer one, defining ARES_LIGHT_PREPASS. Each of them has an instanced
+     * counterpart.
      */
     class Material
     {
     public:
+        /*!
+         * @brief Shader variant enumeration
+         */
+        enum class ShaderVariant
+        {
+            Default = 0,              /*!< Forward shading                        */
+            Instanced = 1,            /*!< Instanced forward shading              */
+            NormalDepth = 2,          /*!< Light pre-pass normals and depth       */
+            NormalDepthInstanced = 3, /*!< Instanced light pre-pass normals/depth */
+            LightBuffer = 4,          /*!< Shading with the light buffer          */
+            LightBufferInstanced = 5  /*!< Instanced shading with the light buffer */
+        };
+
+        /*! Number of shader variants */
+        static constexpr size_t SHADER_VARIANT_COUNT = 6U;
+
         /*!
          * @brief Class constructor
          */
@@ -86,34 +119,163 @@ namespace core
         glutils::ShaderPtr shader() const { return m_shader; }
 
         /*!
-         * @brief Method to setup the material
+         * @brief Material ID getter
+         * 
+         * The ID is unique for each material instance and it is used
+         * to group draws by material.
+         * 
+         * @return Material ID
+         */
+        uint32_t id() const { return m_id; }
+
+        /*!
+         * @brief Material class name getter
+         * 
+         * This method must be implemented by derived classes to return
+         * their class name, e.g. to group the render statistics by class.
+         * 
+         * @return Name of the material class
+         */
+        virtual const char* className() const = 0;
+
+        /*!
+         * @brief Texture key getter
+         * 
+         * This method can be overridden by derived classes to return
+         * a value identifying the main texture bound by the material
+         * (e.g. the OpenGL texture ID), so that draws sharing the same
+         * textures can be grouped together.
+         * 
+         * @return Texture key, 0 if the material has no texture
+         */
+        virtual uint32_t textureKey() const { return 0U; }
+
+        /*!
+         * @brief Checks if the material can be drawn with instancing
+         * 
+         * @return true if the material has an instanced shader variant, false otherwise
+         */
+        bool supportsInstancing() const { return nullptr != m_vertShaderSource; }
+
+        /*!
+         * @brief Checks if the material can be drawn with the light pre-pass
+         * 
+         * @return true if the material has the NormalDepth and LightBuffer shader variants, false otherwise
+         */
+        bool supportsLightPrePass() const { return nullptr != m_lightBufferFragHeader; }
+
+        /*!
+         * @brief Instanced shader variant getter
+         * 
+         * The variant is compiled on first use, a context must be current.
+         * 
+         * @return Instanced shader object, nullptr if instancing is not supported
+         */
+        glutils::ShaderPtr instancedShader() { return shader(ShaderVariant::Instanced); }
+
+        /*!
+         * @brief Instance attribute locations getter
+         * 
+         * @param[in] variant - Instanced shader variant type
+         * @return Locations of the INSTANCE_MATRIX_ROWS instance attributes in the
+         *         instanced shader variant, -1 for unused attributes
+         */
+        const GLint* instanceAttributeLocations(ShaderVariant variant = ShaderVariant::Instanced) const { return m_instanceAttribLocations[static_cast<size_t>(variant)]; }
+
+        /*!
+         * @brief Shader variant getter
+         * 
+         * The variants other than the default one are compiled on first
+         * use, a context must be current.
+         * 
+         * @param[in] variant - Shader variant type
+         * @return Shader object of the variant, nullptr if not available
+         */
+        glutils::ShaderPtr shader(ShaderVariant variant);
+
+        /*!
+         * @brief Checks if a shader variant is instanced
+         * 
+         * @param[in] variant - Shader variant type
+         * @return true if the variant reads the instance model matrices, false otherwise
+         */
+        static bool isInstanced(ShaderVariant variant) { return 0U != (static_cast<uint32_t>(variant) & 1U); }
+
+        /*!
+         * @brief Instanced counterpart of a shader variant getter
+         * 
+         * @param[in] variant - Shader variant type
+         * @return Instanced shader variant of the same pass
+         */
+        static ShaderVariant instancedVariant(ShaderVariant variant) { return static_cast<ShaderVariant>(static_cast<uint32_t>(variant) | 1U); }
+
+        /*!
+         * @brief Checks if an attribute is an instance attribute of the instanced shader variant
+         * 
+         * @param[in] name - Attribute name
+         * @return true if the attribute is set by the instanced drawing, false otherwise
+         */
+        static bool isInstanceAttribute(const std::string& name);
+
+        /*!
+         * @brief Double sided flag setter
+         * 
+         * Back faces are culled unless the material is double sided. The flag
+         * is part of the pipeline state of the primitives using the material,
+         * so it must be set before the primitives are created.
+         * 
+         * @param[in] doubleSided - true to draw back faces, false otherwise (default)
+         */
+        void setDoubleSided(bool doubleSided) { m_doubleSided = doubleSided; }
+
+        /*!
+         * @brief Double sided flag getter
+         * 
+         * @return true if back faces are drawn, false otherwise
+         */
+        bool doubleSided() const { return m_doubleSided; }
+
+        /*!
+         * @brief Blending flag setter
+         * 
+         * Blended materials are alpha blended over the framebuffer and do
+         * not write depth. The flag is part of the pipeline state of the
+         * primitives using the material, so it must be set before the
+         * primitives are created.
+         * 
+         * @param[in] blending - true to enable alpha blending, false otherwise (default)
+         */
+        void setBlending(bool blending) { m_blending = blending; }
+
+        /*!
+         * @brief Blending flag getter
+         * 
+         * @return true if alpha blending is enabled, false otherwise
+         */
+        bool blending() const { return m_blending; }
+
+        /*!
+         * @brief Method to set the per-draw constants of the material
          * 
          * This method can be called by the material owner to configure the
-         * material for drawing. This method activates the shader and calls
-         * the virtual onSetup interface, that must be implemented by derived
-         * classes to perform any shader configuration.
+         * material for drawing, after binding the pipeline state of the shader
+         * variant. This method calls the virtual onSetup interface, that must
+         * be implemented by derived classes to set the shader uniforms.
+         * In the instanced variant the model-view and normal matrices are the
+         * view ones, combined with the instance model matrices by the shader.
          * 
-         * @param[in] attributeData - Vector of attribute data for the shader
+         * @param[in] variant - Shader variant bound for the drawing
          * @param[in] mvMatrix - Model-View matrix for the drawing
          * @param[in] projectionMatrix - Projection matrix for the drawing
          * @param[in] normalMatrix - Normal matrix for the drawing
          * @param[in] lightVec - Vector of light for the drawing
          */
-        void setup(const std::vector<glutils::AttributeDataPtr>& attributeData,
+        void setup(ShaderVariant variant,
                    const glutils::Mat4& mvMatrix,
                    const glutils::Mat4& projectionMatrix,
-                   const glutils::Mat4& normalMatrix,
+                   const glutils::Mat3& normalMatrix,
                    const std::vector<LightNodePtr>& lightVec);
 
-        /*!
-         * @brief Method to deactivate the material
-         * 
-         * This method deactivates the shader attached to the material.
-         * 
-         * @param[in] attributeData - Vector of attribute data for the shader 
-         */
-        void deactivate(const std::vector<glutils::AttributeDataPtr>& attributeData);
-
     protected:
         /*!
          * @brief Virtual interface to setup the material
@@ -126,10 +288,78 @@ namespace core
          * @param[in] normalMatrix - Normal matrix for the drawing
          * @param[in] lightVec - Vector of light for the drawing
          */
-        virtual void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec) = 0;
+        virtual void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec) = 0;
+
+        /*!
+         * @brief Virtual interface to resolve the material uniforms of a shader variant
+         * 
+         * This method is called for each shader variant of the material
+         * when the variant is created by setShaderSources or shader.
+         * Derived classes resolve here the handles of their uniforms, and
+         * use the ones of m_activeVariant in onSetup.
+         * 
+         * @param[in] shader - Shader variant to configure
+         * @param[in] variant - Shader variant type
+         */
+        virtual void resolveUniforms(glutils::Shader& shader, ShaderVariant variant) { (void)shader; (void)variant; }
+
+        /*!
+         * @brief Method to set the shader sources of the material
+         * 
+         * This method must be called by the constructor of derived classes.
+         * It compiles the default shader variant and resolves the material
+         * uniforms of it; the sources are kept to build the other variants, so
+         * they must be static strings.
+         * An optional fragment shader header, e.g. the ClusteredLighting
+         * shader code, is inserted after the first line of the fragment shader
+         * of the forward variants. The light buffer header, e.g. the LightPrePass
+         * shader code, replaces it in the LightBuffer variants; the vertex shader
+         * must then output the normal and the view position used by the light
+         * pre-pass as v_norm and v_pos.
+         * 
+         * @param[in] vertShaderSource - Vertex shader code
+         * @param[in] fragShaderSource - Fragment shader code
+         * @param[in] fragShaderHeader - Optional fragment shader header, must be a static string
+         * @param[in] lightBufferFragHeader - Optional light buffer fragment shader header, must be a static string
+         */
+        void setShaderSources(const char* vertShaderSource, const char* fragShaderSource, const char* fragShaderHeader = nullptr, const char* lightBufferFragHeader = nullptr);
 
         /*! Shader object */
         glutils::ShaderPtr m_shader;
+
+        /*! Shader variant being set up, to be used by onSetup */
+        glutils::Shader* m_activeShader;
+
+        /*! Type of the shader variant being set up, to be used by onSetup */
+        ShaderVariant m_activeVariant;
+
+    private:
+        /*! Material ID */
+        uint32_t m_id;
+
+        /*! Vertex shader code */
+        const char* m_vertShaderSource;
+
+        /*! Fragment shader code */
+        const char* m_fragShaderSource;
+
+        /*! Fragment shader header */
+        const char* m_fragShaderHeader;
+
+        /*! Light buffer fragment shader header */
+        const char* m_lightBufferFragHeader;
+
+        /*! Shader variants, the non-default ones are created on first use */
+        glutils::ShaderPtr m_variantShaders[SHADER_VARIANT_COUNT];
+
+        /*! Locations of the instance attributes in each shader variant */
+        GLint m_instanceAttribLocations[SHADER_VARIANT_COUNT][INSTANCE_MATRIX_ROWS];
+
+        /*! Double sided flag */
+        bool m_doubleSided;
+
+        /*! Blending flag */
+        bool m_blending;
     };
 }
 
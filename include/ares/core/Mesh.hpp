@@ -44,11 +44,14 @@ namespace core
 {
     class Mesh;
     using MeshPtr = std::shared_ptr<Mesh>;
+    class MeshNode;
 
     /*!
      * @brief Mesh class implementing a drawable surface.
      * 
-     * This class implements a drawable mesh as a collection of primitives
+     * This class implements a drawable mesh as a collection of primitives.
+     * The mesh bounds enclose the bounds of all its primitives, and the
+     * nodes holding the mesh are notified when they change.
      */
     class Mesh
     {
@@ -74,9 +77,12 @@ namespace core
         /*!
          * @brief Method to add a primitive to the mesh
          * 
+         * The bounds of the nodes holding the mesh are invalidated, so
+         * primitives can be added after the mesh has been set in a node.
+         * 
          * @param[in] primitive - Primitive to add
          */
-        void addPrimitive(PrimitivePtr primitive) { m_primitives.push_back(primitive); }
+        void addPrimitive(PrimitivePtr primitive);
 
         /*!
          * @brief Primitives getter
@@ -85,6 +91,55 @@ namespace core
          */
         const std::vector<PrimitivePtr>& primitives() const { return m_primitives; }
 
+        /*!
+         * @brief Bounding box getter
+         * 
+         * @return Bounding box in the mesh coordinate system
+         */
+        const glutils::BoundingBox& boundingBox() const { return m_boundingBox; }
+
+        /*!
+         * @brief Bounding sphere getter
+         * 
+         * @return Bounding sphere in the mesh coordinate system
+         */
+        const glutils::BoundingSphere& boundingSphere() const { return m_boundingSphere; }
+
+        /*!
+         * @brief Recomputes the mesh bounds from the primitive bounds
+         * 
+         * This method must be called if the bounds of a primitive change
+         * after the primitive has been added to the mesh.
+         */
+        void updateBounds();
+
+        /*!
+         * @brief Occluder geometry setter
+         * 
+         * The occluder geometry is a simplified, CPU-side version of the
+         * mesh surface, used to rasterize the mesh in the software depth
+         * buffer when its node is designated as occluder. It should be
+         * conservative, i.e. it should not exceed the actual mesh surface.
+         * 
+         * @param[in] vertices - Vertex positions in the mesh coordinate system
+         * @param[in] indices - Triangle list indices
+         */
+        void setOccluderGeometry(const std::vector<glutils::Vec3>& vertices, const std::vector<uint32_t>& indices);
+
+        /*!
+         * @brief Occluder vertices getter
+         * 
+         * @return Occluder vertex positions
+         */
+        const std::vector<glutils::Vec3>& occluderVertices() const { return m_occluderVertices; }
+
+        /*!
+         * @brief Occluder indices getter
+         * 
+         * @return Occluder triangle list indices
+         */
+        const std::vector<uint32_t>& occluderIndices() const { return m_occluderIndices; }
+
         /*!
          * @brief Method to draw the mesh
          *
@@ -93,7 +148,7 @@ namespace core
          * @param[in] normalMatrix - Normal matrix for the drawing
          * @param[in] lightVec - Vector of light for the drawing
          */
-        void draw(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec);
+        void draw(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec);
 
     protected:
         /*! Mesh name */
@@ -101,6 +156,43 @@ namespace core
 
         /*! Primitives vector */
         std::vector<PrimitivePtr> m_primitives;
+
+        /*! Bounding box */
+        glutils::BoundingBox m_boundingBox;
+
+        /*! Bounding sphere */
+        glutils::BoundingSphere m_boundingSphere;
+
+        /*! Occluder vertex positions */
+        std::vector<glutils::Vec3> m_occluderVertices;
+
+        /*! Occluder triangle list indices */
+        std::vector<uint32_t> m_occluderIndices;
+
+    private:
+        /*! Nodes holding the mesh, notified when the bounds change */
+        std::vector<MeshNode*> m_nodes;
+
+        /*!
+         * @brief Registers a node holding the mesh
+         * 
+         * @param[in] node - Node to register
+         */
+        void attachNode(MeshNode* node);
+
+        /*!
+         * @brief Unregisters a node no longer holding the mesh
+         * 
+         * @param[in] node - Node to unregister
+         */
+        void detachNode(MeshNode* node);
+
+        /*!
+         * @brief Invalidates the bounds of the nodes holding the mesh
+         */
+        void notifyBoundsChanged();
+
+        friend class MeshNode;
     };
 }
 
@@ -54,7 +54,7 @@ namespace core
         /*!
          * @brief Class destructor
          */
-        virtual ~MeshNode() = default;
+        virtual ~MeshNode();
 
         MeshNode(const MeshNode&) = delete;
         MeshNode& operator=(const MeshNode&) = delete;
@@ -64,7 +64,7 @@ namespace core
          * 
          * @param[in] mesh - Mesh to set in the node
          */
-        void setMesh(MeshPtr mesh) { m_mesh = mesh; }
+        void setMesh(MeshPtr mesh);
 
         /*!
          * @brief Mesh getter
@@ -73,15 +73,44 @@ namespace core
          */
         MeshPtr mesh() const { return m_mesh; }
 
+        /*!
+         * @brief Occluder flag setter
+         * 
+         * Occluder nodes are rasterized in the software depth buffer
+         * when occlusion culling is enabled, using the occluder geometry
+         * of their mesh.
+         * 
+         * @param[in] occluder - true to designate the node as occluder, false otherwise
+         */
+        void setOccluder(bool occluder) { m_occluder = occluder; }
+
+        /*!
+         * @brief Occluder flag getter
+         * 
+         * @return true if the node is an occluder, false otherwise
+         */
+        bool isOccluder() const { return m_occluder; }
+
+        /*!
+         * @brief Local bounding box getter
+         * 
+         * @return Bounding box of the mesh, empty if no mesh is set
+         */
+        glutils::BoundingBox localBoundingBox() const override;
+
     private:
         /*! Mesh object */
         MeshPtr m_mesh;
 
+        /*! Occluder flag */
+        bool m_occluder;
+
         /*!
          * @brief Class constructor
          */
         MeshNode(const std::string& name, NodePtr parent);
 
+        friend class Mesh;
         friend class Scene;
     };
 }
@@ -36,6 +36,7 @@
 #include <vector>
 #include <string>
 
+#include "ares/glutils/BoundingVolume.hpp"
 #include "ares/glutils/LinearAlgebra.hpp"
 
 namespace ares
@@ -55,6 +56,12 @@ namespace core
      * which allows to build the scene tree structure.
      * The Node class also provides facilities to handle transforms, in terms of
      * translations and rotations and providing the overall transform matrix.
+     * The overall (world) transform matrix is cached: changing the node transform
+     * marks the node and its subtree as dirty, and the dirty branches are
+     * recomputed either on demand or by the updateSubtree pass,
+     * which skips the clean branches of the tree.
+     * The update pass also refreshes the world bounds of the node and the
+     * hierarchical bounds enclosing the whole subtree.
      */
     class Node
     {
@@ -120,7 +127,24 @@ namespace core
          * 
          * @param[in] transformMatrix - Node transform matrix
          */
-        void setTransformMatrix(const glutils::Mat4& transformMatrix) { m_transformMatrix = transformMatrix; }
+        void setTransformMatrix(const glutils::Mat4& transformMatrix);
+
+        /*!
+         * @brief Static flag setter
+         * 
+         * Static nodes are expected to never move after loading, so that
+         * the loaders can merge their geometry in world space.
+         * 
+         * @param[in] isStatic - true if the node never moves, false otherwise (default)
+         */
+        void setStatic(bool isStatic) { m_static = isStatic; }
+
+        /*!
+         * @brief Static flag getter
+         * 
+         * @return true if the node never moves, false otherwise
+         */
+        bool isStatic() const { return m_static; }
 
         /*!
          * @brief Name getter
@@ -167,9 +191,51 @@ namespace core
         /*!
          * @brief Transform matrix getter from root node
          * 
+         * The matrix is cached and it is recomputed only if the
+         * transform of the node or of one of its ancestors changed.
+         * 
          * @return Node transform matrix from root node
          */
-        glutils::Mat4 totalTransformMatrix() const;
+        const glutils::Mat4& totalTransformMatrix() const;
+
+        /*!
+         * @brief Updates the cached transform matrices and bounds of the subtree
+         * 
+         * This method recomputes the transform matrix from root node and
+         * the bounds for all dirty nodes in the subtree starting from this
+         * node, skipping the branches that did not change.
+         * 
+         * @param[out] changedNodes - Optional vector where the nodes whose world bounds changed are appended
+         */
+        void updateSubtree(std::vector<Node*>* changedNodes = nullptr);
+
+        /*!
+         * @brief Local bounding box getter
+         * 
+         * This method can be overridden by derived classes with drawable
+         * content to provide their bounds in the node coordinate system.
+         * 
+         * @return Bounding box in the node coordinate system, empty by default
+         */
+        virtual glutils::BoundingBox localBoundingBox() const { return glutils::BoundingBox(); }
+
+        /*!
+         * @brief World bounding box getter
+         * 
+         * The box is refreshed by the updateSubtree pass.
+         * 
+         * @return Bounding box of the node content in world coordinates
+         */
+        const glutils::BoundingBox& worldBoundingBox() const { return m_worldBoundingBox; }
+
+        /*!
+         * @brief Subtree bounding box getter
+         * 
+         * The box is refreshed by the updateSubtree pass.
+         * 
+         * @return Bounding box of the node and all its descendants in world coordinates
+         */
+        const glutils::BoundingBox& subtreeBoundingBox() const { return m_subtreeBoundingBox; }
 
         /*!
          * @brief Parent node getter
@@ -204,12 +270,36 @@ namespace core
         /*! Transform matrix */
         glutils::Mat4 m_transformMatrix;
 
+        /*! Cached transform matrix from root node */
+        mutable glutils::Mat4 m_totalTransformMatrix;
+
+        /*! Flag set if the cached transform matrix from root node is outdated */
+        mutable bool m_totalTransformDirty;
+
+        /*! Flag set if any node in the subtree has an outdated transform matrix from root node or outdated bounds */
+        bool m_subtreeDirty;
+
+        /*! Flag set if the world bounds of the node are outdated */
+        bool m_boundsDirty;
+
+        /*! Bounding box of the node content in world coordinates */
+        glutils::BoundingBox m_worldBoundingBox;
+
+        /*! Bounding box of the subtree in world coordinates */
+        glutils::BoundingBox m_subtreeBoundingBox;
+
         /*! Node parent */
         std::weak_ptr<Node> m_parent;
 
         /*! Node children */
         std::vector<NodePtr> m_children;
 
+        /*! Index of the node in the scene registry of its type (also its spatial index item), -1 if not registered */
+        int32_t m_spatialId;
+
+        /*! Flag set if the node never moves */
+        bool m_static;
+
         /*!
          * @brief Class constructor
          * 
@@ -230,11 +320,57 @@ namespace core
          */
         void addChild(NodePtr child);
 
+        /*!
+         * @brief Helper method to remove a child from the node
+         * 
+         * @param[in] child - Child node to remove
+         */
+        void removeChild(NodePtr child);
+
         /*!
          * @brief Helper method to update transform matrix
          */
         void updateTransformMatrix();
 
+        /*!
+         * @brief Helper method to mark the transform of the subtree as dirty
+         * 
+         * This method marks the cached transform matrix from root node of
+         * this node and all its descendants as outdated, and flags the
+         * ancestors so that the update pass can reach the dirty nodes.
+         */
+        void invalidateTotalTransform();
+
+        /*!
+         * @brief Helper method to mark the bounds of the node as dirty
+         * 
+         * This method must be called by derived classes when the value
+         * returned by localBoundingBox changes.
+         */
+        void invalidateBounds();
+
+        /*!
+         * @brief Helper method to flag the ancestors of a dirty node
+         */
+        void propagateDirtyToAncestors();
+
+        /*!
+         * @brief Helper method to refresh the transform and bounds of the node only
+         * 
+         * The parent transform must already be up to date.
+         * 
+         * @param[out] changedNodes - Optional vector where the node is appended if its world bounds changed
+         */
+        void updateSelf(std::vector<Node*>* changedNodes);
+
+        /*!
+         * @brief Helper method to merge the children bounds into the subtree bounds
+         * 
+         * The children subtrees must already be up to date. This method
+         * marks the subtree as clean.
+         */
+        void updateSubtreeBounds();
+
         friend class Scene;
     };
 }
@@ -35,6 +35,8 @@
 #include <memory>
 #include <GLES2/gl2.h>
 
+#include "ares/core/ClusteredLighting.hpp"
+#include "ares/core/LightPrePass.hpp"
 #include "ares/core/Material.hpp"
 #include "ares/glutils/Texture.hpp"
 
@@ -68,6 +70,13 @@ namespace core
         NormalMapMaterial(const NormalMapMaterial&) = delete;
         NormalMapMaterial& operator=(const NormalMapMaterial&) = delete;
 
+        /*!
+         * @brief Material class name getter
+         * 
+         * @return "NormalMapMaterial"
+         */
+        const char* className() const override { return "NormalMapMaterial"; }
+
         /*!
          * @brief Diffuse texture setter
          * 
@@ -96,6 +105,13 @@ namespace core
          */
         glutils::TexturePtr normalTex() const { return m_normalTex; }
 
+        /*!
+         * @brief Texture key getter
+         * 
+         * @return OpenGL ID of the diffuse texture, 0 if not set
+         */
+        uint32_t textureKey() const override { return (nullptr != m_diffuseTex) ? (m_diffuseTex->tex()) : (0U); }
+
     protected:
         /*! Diffuse texture */
         glutils::TexturePtr m_diffuseTex;
@@ -111,7 +127,40 @@ namespace core
          * @param[in] normalMatrix - Normal matrix for drawing
          * @param[in] lightVec - Vector of lights for drawing
          */
-        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+
+        /*!
+         * @brief Method to resolve the material uniforms of a shader variant
+         * 
+         * @param[in] shader - Shader variant to configure
+         * @param[in] variant - Shader variant type
+         */
+        void resolveUniforms(glutils::Shader& shader, ShaderVariant variant) override;
+
+    private:
+        /*!
+         * @brief Uniform handles of a shader variant
+         */
+        struct UniformHandles
+        {
+            /*! Model-view matrix */
+            glutils::UniformHandle<glutils::UniformMat4> mvMx;
+
+            /*! Projection matrix */
+            glutils::UniformHandle<glutils::UniformMat4> pMx;
+
+            /*! Normal matrix */
+            glutils::UniformHandle<glutils::UniformMat3> normMx;
+
+            /*! Clustered lighting uniforms */
+            ClusteredLighting::UniformHandles lighting;
+
+            /*! Light pre-pass uniforms */
+            LightPrePass::UniformHandles lightBuffer;
+        };
+
+        /*! Uniform handles of each shader variant */
+        UniformHandles m_uniforms[SHADER_VARIANT_COUNT];
     };
 }
 
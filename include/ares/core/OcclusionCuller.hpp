@@ -0,0 +1,221 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef OCCLUSIONCULLER_HPP_INCLUDED
+#define OCCLUSIONCULLER_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ares/glutils/BoundingVolume.hpp"
+#include "ares/glutils/LinearAlgebra.hpp"
+
+namespace ares
+{
+
+namespace core
+{
+    class OcclusionCuller;
+    using OcclusionCullerPtr = std::shared_ptr<OcclusionCuller>;
+
+    /*!
+     * @brief Software depth buffer occlusion culler
+     * 
+     * This class rasterizes occluder triangles into a low resolution CPU
+     * depth buffer, four pixels at a time with SIMD instructions, and
+     * builds a hierarchical-Z pyramid (max depth per texel) from it.
+     * Candidate bounding boxes are then projected on screen and tested
+     * against the pyramid level matching their screen size: a candidate
+     * is occluded if its nearest depth is behind the farthest occluder
+     * depth of all the texels it covers.
+     * Depth values are normalized device depths mapped to [0, 1].
+     */
+    class OcclusionCuller
+    {
+    public:
+        /*!
+         * @brief Per-frame statistics
+         */
+        struct Stats
+        {
+            /*! Number of rasterized occluders */
+            uint32_t occluders;
+
+            /*! Number of rasterized occluder triangles */
+            uint32_t occluderTriangles;
+
+            /*! Number of tested candidates */
+            uint32_t tested;
+
+            /*! Number of candidates found occluded */
+            uint32_t culled;
+
+            /*! Time spent rasterizing occluders and building the hierarchical-Z (ms) */
+            float rasterTimeMs;
+        };
+
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] width - Depth buffer width, rounded up to a multiple of 4
+         * @param[in] height - Depth buffer height
+         */
+        OcclusionCuller(uint32_t width = 256U, uint32_t height = 128U);
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~OcclusionCuller() = default;
+
+        OcclusionCuller(const OcclusionCuller&) = delete;
+        OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+        /*!
+         * @brief Starts a new frame
+         * 
+         * This method clears the depth buffer and resets the statistics.
+         * 
+         * @param[in] viewProjectionMatrix - View-projection matrix of the frame
+         */
+        void beginFrame(const glutils::Mat4& viewProjectionMatrix);
+
+        /*!
+         * @brief Rasterizes an occluder in the depth buffer
+         * 
+         * Triangles crossing the near plane are skipped, which is conservative.
+         * 
+         * @param[in] vertices - Vertex positions in the occluder coordinate system
+         * @param[in] indices - Triangle list indices
+         * @param[in] modelMatrix - Occluder model (world) matrix
+         */
+        void rasterizeOccluder(const std::vector<glutils::Vec3>& vertices, const std::vector<uint32_t>& indices, const glutils::Mat4& modelMatrix);
+
+        /*!
+         * @brief Builds the hierarchical-Z pyramid from the depth buffer
+         * 
+         * This method must be called after all occluders have been
+         * rasterized and before testing candidates.
+         */
+        void buildHierarchy();
+
+        /*!
+         * @brief Tests a candidate against the occluders
+         * 
+         * This method does not modify the culler, so it can be called
+         * concurrently once the hierarchy is built. Test results are
+         * accounted in the statistics with addTestResults.
+         * 
+         * @param[in] box - Candidate bounds in world coordinates
+         * @return false if the candidate is occluded, true otherwise
+         */
+        bool isVisible(const glutils::BoundingBox& box) const;
+
+        /*!
+         * @brief Adds candidate test results to the statistics
+         * 
+         * @param[in] tested - Number of tested candidates
+         * @param[in] culled - Number of culled candidates
+         */
+        void addTestResults(uint32_t tested, uint32_t culled);
+
+        /*!
+         * @brief Statistics getter
+         * 
+         * @return Statistics of the current frame
+         */
+        const Stats& stats() const { return m_stats; }
+
+        /*!
+         * @brief Depth buffer width getter
+         * 
+         * @return Depth buffer width
+         */
+        uint32_t width() const { return m_width; }
+
+        /*!
+         * @brief Depth buffer height getter
+         * 
+         * @return Depth buffer height
+         */
+        uint32_t height() const { return m_height; }
+
+        /*!
+         * @brief Depth buffer getter
+         * 
+         * @return Depth buffer, row-major with bottom row first
+         */
+        const std::vector<float>& depthBuffer() const { return m_levels[0].depth; }
+
+    private:
+        /*!
+         * @brief Hierarchical-Z level
+         */
+        struct Level
+        {
+            /*! Level width */
+            uint32_t width;
+
+            /*! Level height */
+            uint32_t height;
+
+            /*! Max depth values, row-major */
+            std::vector<float> depth;
+        };
+
+        /*! Depth buffer width */
+        uint32_t m_width;
+
+        /*! Depth buffer height */
+        uint32_t m_height;
+
+        /*! Hierarchical-Z levels, level 0 is the depth buffer */
+        std::vector<Level> m_levels;
+
+        /*! View-projection matrix of the frame */
+        glutils::Mat4 m_viewProjectionMatrix;
+
+        /*! Statistics of the current frame */
+        Stats m_stats;
+
+        /*!
+         * @brief Helper method to rasterize a triangle in screen coordinates
+         * 
+         * @param[in] v0 - First vertex (x, y in pixels, z depth)
+         * @param[in] v1 - Second vertex (x, y in pixels, z depth)
+         * @param[in] v2 - Third vertex (x, y in pixels, z depth)
+         */
+        void rasterizeTriangle(const glutils::Vec3& v0, const glutils::Vec3& v1, const glutils::Vec3& v2);
+    };
+}
+
+}
+
+#endif
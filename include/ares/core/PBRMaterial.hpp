@@ -35,6 +35,8 @@
 #include <memory>
 #include <GLES2/gl2.h>
 
+#include "ares/core/ClusteredLighting.hpp"
+#include "ares/core/LightPrePass.hpp"
 #include "ares/core/Material.hpp"
 #include "ares/glutils/Texture.hpp"
 
@@ -88,6 +90,13 @@ namespace core
         PBRMaterial(const PBRMaterial&) = delete;
         PBRMaterial& operator=(const PBRMaterial&) = delete;
 
+        /*!
+         * @brief Material class name getter
+         * 
+         * @return "PBRMaterial"
+         */
+        const char* className() const override { return "PBRMaterial"; }
+
         /*!
          * @brief Base color factor getter
          *
@@ -151,6 +160,13 @@ namespace core
          */
         const glutils::TexturePtr& metallicRoughnessTex() const { return m_metallicRoughnessTex; }
 
+        /*!
+         * @brief Texture key getter
+         * 
+         * @return OpenGL ID of the base color texture, 0 if not set
+         */
+        uint32_t textureKey() const override { return (nullptr != m_baseColorTex) ? (m_baseColorTex->tex()) : (0U); }
+
     protected:
         /*! Base color factor */
         glutils::Vec3       m_baseColorFactor;
@@ -187,7 +203,67 @@ namespace core
          * @param[in] normalMatrix - Normal matrix for drawing
          * @param[in] lightVec - Vector of lights for drawing
          */
-        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+
+        /*!
+         * @brief Method to resolve the material uniforms of a shader variant
+         * 
+         * @param[in] shader - Shader variant to configure
+         * @param[in] variant - Shader variant type
+         */
+        void resolveUniforms(glutils::Shader& shader, ShaderVariant variant) override;
+
+    private:
+        /*!
+         * @brief Uniform handles of a shader variant
+         */
+        struct UniformHandles
+        {
+            /*! Model-view matrix */
+            glutils::UniformHandle<glutils::UniformMat4> mvMx;
+
+            /*! Projection matrix */
+            glutils::UniformHandle<glutils::UniformMat4> pMx;
+
+            /*! Normal matrix */
+            glutils::UniformHandle<glutils::UniformMat3> normMx;
+
+            /*! Clustered lighting uniforms */
+            ClusteredLighting::UniformHandles lighting;
+
+            /*! Light pre-pass uniforms */
+            LightPrePass::UniformHandles lightBuffer;
+
+            /*! Base color factor */
+            glutils::UniformHandle<glutils::Uniform3f> baseColorFactor;
+
+            /*! Emissive factor */
+            glutils::UniformHandle<glutils::Uniform3f> emissiveFactor;
+
+            /*! Metallic factor */
+            glutils::UniformHandle<glutils::Uniform1f> metallicFactor;
+
+            /*! Roughness factor */
+            glutils::UniformHandle<glutils::Uniform1f> roughnessFactor;
+
+            /*! Base color texture flag */
+            glutils::UniformHandle<glutils::Uniform1i> hasBaseColorTex;
+
+            /*! Emissive texture flag */
+            glutils::UniformHandle<glutils::Uniform1i> hasEmissiveTex;
+
+            /*! Normal texture flag */
+            glutils::UniformHandle<glutils::Uniform1i> hasNormalTex;
+
+            /*! Occlusion texture flag */
+            glutils::UniformHandle<glutils::Uniform1i> hasOcclusionTex;
+
+            /*! Metallic-roughness texture flag */
+            glutils::UniformHandle<glutils::Uniform1i> hasMetalRoughnessTex;
+        };
+
+        /*! Uniform handles of each shader variant */
+        UniformHandles m_uniforms[SHADER_VARIANT_COUNT];
     };
 }
 
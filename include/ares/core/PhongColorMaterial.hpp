@@ -35,6 +35,8 @@
 #include <memory>
 #include <GLES2/gl2.h>
 
+#include "ares/core/ClusteredLighting.hpp"
+#include "ares/core/LightPrePass.hpp"
 #include "ares/core/Material.hpp"
 #include "ares/glutils/RGBAColor.hpp"
 
@@ -83,6 +85,13 @@ namespace core
         PhongColorMaterial(const PhongColorMaterial&) = delete;
         PhongColorMaterial& operator=(const PhongColorMaterial&) = delete;
 
+        /*!
+         * @brief Material class name getter
+         * 
+         * @return "PhongColorMaterial"
+         */
+        const char* className() const override { return "PhongColorMaterial"; }
+
         /*!
          * @brief Ambient color setter
          * 
@@ -211,7 +220,61 @@ namespace core
          * @param[in] normalMatrix - Normal matrix for drawing
          * @param[in] lightVec - Vector of lights for drawing
          */
-        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+        void onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec) override;
+
+        /*!
+         * @brief Method to resolve the material uniforms of a shader variant
+         * 
+         * @param[in] shader - Shader variant to configure
+         * @param[in] variant - Shader variant type
+         */
+        void resolveUniforms(glutils::Shader& shader, ShaderVariant variant) override;
+
+    private:
+        /*!
+         * @brief Uniform handles of a shader variant
+         */
+        struct UniformHandles
+        {
+            /*! Model-view matrix */
+            glutils::UniformHandle<glutils::UniformMat4> mvMx;
+
+            /*! Projection matrix */
+            glutils::UniformHandle<glutils::UniformMat4> pMx;
+
+            /*! Normal matrix */
+            glutils::UniformHandle<glutils::UniformMat3> normMx;
+
+            /*! Ambient coefficient */
+            glutils::UniformHandle<glutils::Uniform1f> ka;
+
+            /*! Diffuse coefficient */
+            glutils::UniformHandle<glutils::Uniform1f> kd;
+
+            /*! Specular coefficient */
+            glutils::UniformHandle<glutils::Uniform1f> ks;
+
+            /*! Shininess */
+            glutils::UniformHandle<glutils::Uniform1f> shininess;
+
+            /*! Ambient color */
+            glutils::UniformHandle<glutils::Uniform3f> ambientColor;
+
+            /*! Diffuse color */
+            glutils::UniformHandle<glutils::Uniform3f> diffuseColor;
+
+            /*! Specular color */
+            glutils::UniformHandle<glutils::Uniform3f> specularColor;
+
+            /*! Clustered lighting uniforms */
+            ClusteredLighting::UniformHandles lighting;
+
+            /*! Light pre-pass uniforms */
+            LightPrePass::UniformHandles lightBuffer;
+        };
+
+        /*! Uniform handles of each shader variant */
+        UniformHandles m_uniforms[SHADER_VARIANT_COUNT];
     };
 }
 
@@ -0,0 +1,163 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef PIPELINESTATE_HPP_INCLUDED
+#define PIPELINESTATE_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GLES2/gl2.h>
+
+#include "ares/core/Material.hpp"
+#include "ares/glutils/AttributeData.hpp"
+#include "ares/glutils/Shader.hpp"
+#include "ares/glutils/VertexLayout.hpp"
+
+namespace ares
+{
+
+namespace core
+{
+    class PipelineState;
+    using PipelineStatePtr = std::shared_ptr<PipelineState>;
+
+    /*!
+     * @brief Class bundling the OpenGL state to draw a geometry with a material
+     * 
+     * A pipeline state is created for each shader variant a primitive is drawn
+     * with. It holds the shader program, the vertex layout of the geometry for
+     * that program and the raster state (culling, blending and depth writes)
+     * of the material; the material keeps the texture unit assignments and
+     * the resolved uniform handles of the variant. Everything is resolved and
+     * validated once when the pipeline state is created, so that drawing only
+     * binds it, sets the per-draw constants through Material::setup and draws.
+     */
+    class PipelineState
+    {
+    public:
+        /*!
+         * @brief Raster state of a pipeline
+         */
+        struct RasterState
+        {
+            /*! Back-face culling enable flag */
+            bool cullFace;
+
+            /*! Alpha blending enable flag */
+            bool blend;
+
+            /*! Depth write enable flag */
+            bool depthWrite;
+        };
+
+        /*!
+         * @brief Class constructor
+         * 
+         * The attributes of the shader must all be provided by the geometry,
+         * except the instance attributes of the instanced variant, otherwise
+         * an exception is thrown. The geometry attributes not used by the
+         * shader are ignored and reported by unusedAttributes, as compilers
+         * remove unused attributes from the programs.
+         * 
+         * @param[in] material - Material the geometry is drawn with
+         * @param[in] variant - Shader variant of the material
+         * @param[in] attributeData - Attribute data of the geometry
+         * @param[in] indicesData - Index data of the geometry, nullptr for non-indexed geometries
+         */
+        PipelineState(Material& material,
+                      Material::ShaderVariant variant,
+                      const std::vector<glutils::AttributeDataPtr>& attributeData,
+                      const glutils::AttributeDataPtr& indicesData);
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~PipelineState() = default;
+
+        PipelineState() = delete;
+        PipelineState(const PipelineState&) = delete;
+        PipelineState& operator=(const PipelineState&) = delete;
+
+        /*!
+         * @brief Binds the pipeline state
+         * 
+         * This method binds the program, the raster state and the vertex layout.
+         */
+        void bind();
+
+        /*!
+         * @brief Unbinds the pipeline state
+         * 
+         * The program and vertex layout are only unbound if unbinding
+         * to zero is enabled in the current GlState.
+         */
+        void unbind();
+
+        /*!
+         * @brief Shader getter
+         * 
+         * @return Shader program of the pipeline
+         */
+        const glutils::ShaderPtr& shader() const { return m_shader; }
+
+        /*!
+         * @brief Raster state getter
+         * 
+         * @return Raster state of the pipeline
+         */
+        const RasterState& rasterState() const { return m_rasterState; }
+
+        /*!
+         * @brief Unused attributes getter
+         * 
+         * @return Names of the geometry attributes not used by the shader
+         */
+        const std::vector<std::string>& unusedAttributes() const { return m_unusedAttributes; }
+
+    private:
+        /*! Shader program */
+        glutils::ShaderPtr m_shader;
+
+        /*! Vertex layout of the geometry for the shader */
+        glutils::VertexLayoutPtr m_vertexLayout;
+
+        /*! Raster state */
+        RasterState m_rasterState;
+
+        /*! Names of the geometry attributes not used by the shader */
+        std::vector<std::string> m_unusedAttributes;
+    };
+}
+
+}
+
+#endif
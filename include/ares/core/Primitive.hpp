@@ -33,10 +33,13 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include <GLES2/gl2.h>
 
 #include "ares/core/Material.hpp"
+#include "ares/core/PipelineState.hpp"
 #include "ares/glutils/AttributeData.hpp"
+#include "ares/glutils/BoundingVolume.hpp"
 #include "ares/glutils/LinearAlgebra.hpp"
 
 namespace ares
@@ -56,7 +59,12 @@ namespace core
      * This class implements a drawable primitive. The geometry is provided
      * as a vector of AttributeData which contains the Vbo and configuration
      * data for the primitive attributes. If attribute data for the indices
-     * is provided, the primitive is considered as indexed
+     * is provided, the primitive is considered as indexed.
+     * The pipeline state of the material default shader variant is created
+     * and validated with the primitive, the ones of the other variants on
+     * first use.
+     * The primitive bounds are in the primitive local coordinate system and
+     * are infinite (i.e. never culled) until set by the primitive creator.
      */
     class Primitive
     {
@@ -76,6 +84,8 @@ namespace core
          * 
          * Creates a Primitive object with the provided Vbo. When the primitive is drawn, the Vbo
          * is drawn using the provided primitive type and vertex count.
+         * An exception is thrown if the material shader uses an attribute
+         * not provided by the primitive.
          * 
          * @param[in] attributeData - Vector of attributes for the primitive
          * @param[in] primitiveType - Primitive type for the drawing
@@ -128,6 +138,37 @@ namespace core
          */
         const glutils::AttributeDataPtr& indicesData() const { return m_indicesData; }
 
+        /*!
+         * @brief Bounding box setter
+         * 
+         * The bounding sphere is updated accordingly.
+         * 
+         * @param[in] boundingBox - Bounding box in the primitive coordinate system
+         */
+        void setBoundingBox(const glutils::BoundingBox& boundingBox);
+
+        /*!
+         * @brief Bounding box getter
+         * 
+         * @return Bounding box in the primitive coordinate system
+         */
+        const glutils::BoundingBox& boundingBox() const { return m_boundingBox; }
+
+        /*!
+         * @brief Bounding sphere getter
+         * 
+         * @return Bounding sphere in the primitive coordinate system
+         */
+        const glutils::BoundingSphere& boundingSphere() const { return m_boundingSphere; }
+
+        /*!
+         * @brief Pipeline state getter
+         * 
+         * @param[in] variant - Shader variant of the material
+         * @return Pipeline state of the variant, created on first use, nullptr if the variant is not available
+         */
+        PipelineState* pipelineState(Material::ShaderVariant variant = Material::ShaderVariant::Default);
+
         /*!
          * @brief Method to draw the primitive
          *
@@ -135,8 +176,33 @@ namespace core
          * @param[in] projectionMatrix - Projection matrix for the drawing
          * @param[in] normalMatrix - Normal matrix for the drawing
          * @param[in] lightVec - Vector of light for the drawing
+         * @param[in] variant - Shader variant of the material to draw with
+         */
+        void draw(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec,
+                  Material::ShaderVariant variant = Material::ShaderVariant::Default);
+
+        /*!
+         * @brief Method to draw several instances of the primitive
+         * 
+         * The material must support instancing. The instance model matrices
+         * are passed as per-instance attributes: if an instance buffer is
+         * provided and instanced arrays are supported, the instances are
+         * drawn with a single instanced draw call; otherwise each instance is
+         * drawn after setting the instance attributes as constant values,
+         * without setting the material up again (pseudo-instancing).
+         *
+         * @param[in] viewMatrix - View matrix for the drawing
+         * @param[in] projectionMatrix - Projection matrix for the drawing
+         * @param[in] viewNormalMatrix - Normal matrix combined with the instance model matrices
+         * @param[in] lightVec - Vector of light for the drawing
+         * @param[in] instanceData - Instance model matrices, as INSTANCE_MATRIX_ROWS rows of 4 floats per instance
+         * @param[in] instanceCount - Number of instances
+         * @param[in] instanceVbo - Buffer to upload the instance data to, nullptr to use pseudo-instancing
+         * @param[in] variant - Instanced shader variant of the material to draw with
          */
-        void draw(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec);
+        void drawInstanced(const glutils::Mat4& viewMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& viewNormalMatrix, const std::vector<LightNodePtr>& lightVec,
+                           const float* instanceData, GLsizei instanceCount, glutils::Vbo* instanceVbo,
+                           Material::ShaderVariant variant = Material::ShaderVariant::Instanced);
 
     protected:
         /*! Attribute data */
@@ -153,6 +219,22 @@ namespace core
 
         /*! Attribute data for indices */
         glutils::AttributeDataPtr m_indicesData;
+
+        /*! Bounding box */
+        glutils::BoundingBox m_boundingBox;
+
+        /*! Bounding sphere */
+        glutils::BoundingSphere m_boundingSphere;
+
+        /*! Pipeline states of each shader variant of the material */
+        PipelineStatePtr m_pipelineStates[Material::SHADER_VARIANT_COUNT];
+
+        /*!
+         * @brief Helper method to issue the draw call
+         * 
+         * @param[in] instanceCount - Number of instances for an instanced draw call, 0 for a regular draw call
+         */
+        void drawVertices(GLsizei instanceCount);
     };
 }
 
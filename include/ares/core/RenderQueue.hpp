@@ -0,0 +1,202 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef RENDERQUEUE_HPP_INCLUDED
+#define RENDERQUEUE_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ares/core/Primitive.hpp"
+#include "ares/glutils/LinearAlgebra.hpp"
+
+namespace ares
+{
+
+namespace core
+{
+    class RenderQueue;
+    using RenderQueuePtr = std::shared_ptr<RenderQueue>;
+
+    /*!
+     * @brief Render queue to collect and sort draw items
+     * 
+     * This class collects the primitives to draw in a frame into a flat
+     * array of draw items and sorts them by a packed 64-bit key, so that
+     * the items can be submitted in state order instead of scene order.
+     * The key is made of (from most to least significant bits) a translucency
+     * bit, the shader program, the material, the material textures and the
+     * view depth, so that opaque items sharing the same state are drawn
+     * front-to-back. Items whose material uses blending are translucent:
+     * their key has the translucency bit set and the inverted view depth
+     * ahead of the state fields, so that they are drawn after all the opaque
+     * items and back-to-front.
+     * The queue does not own the primitives, which must stay valid until
+     * the queue is cleared.
+     */
+    class RenderQueue
+    {
+    public:
+        /*!
+         * @brief Draw item
+         */
+        struct Item
+        {
+            /*! Sort key */
+            uint64_t key;
+
+            /*! Primitive to draw */
+            Primitive* primitive;
+
+            /*! Material of the primitive */
+            Material* material;
+
+            /*! Model (world) matrix */
+            glutils::Mat4 modelMatrix;
+
+            /*! Depth in the view coordinate system (positive in front of the camera) */
+            float viewDepth;
+        };
+
+        /*!
+         * @brief Class constructor
+         */
+        RenderQueue();
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~RenderQueue() = default;
+
+        RenderQueue(const RenderQueue&) = delete;
+        RenderQueue& operator=(const RenderQueue&) = delete;
+
+        /*!
+         * @brief Removes all items from the queue
+         * 
+         * The allocated memory is kept, so that it can be reused
+         * in the next frame.
+         */
+        void clear();
+
+        /*!
+         * @brief Adds a draw item to the queue
+         * 
+         * @param[in] primitive - Primitive to draw
+         * @param[in] modelMatrix - Model (world) matrix of the primitive
+         * @param[in] viewDepth - Depth of the primitive in the view coordinate system
+         */
+        void push(Primitive* primitive, const glutils::Mat4& modelMatrix, float viewDepth);
+
+        /*!
+         * @brief Appends the items of another queue
+         * 
+         * This method is used to merge the queues filled by
+         * several threads, in insertion order.
+         * 
+         * @param[in] other - Queue whose items are appended
+         */
+        void append(const RenderQueue& other);
+
+        /*!
+         * @brief Sorts the queue by the item keys
+         */
+        void sort();
+
+        /*!
+         * @brief Number of items getter
+         * 
+         * @return Number of items in the queue
+         */
+        size_t size() const { return m_items.size(); }
+
+        /*!
+         * @brief Checks if the queue is empty
+         * 
+         * @return true if the queue is empty, false otherwise
+         */
+        bool empty() const { return m_items.empty(); }
+
+        /*!
+         * @brief Item getter in submission order
+         * 
+         * The order is the sorted order if sort was called after the
+         * last push, the insertion order otherwise.
+         * 
+         * @param[in] i - Index of the item in submission order
+         * @return Requested item
+         */
+        const Item& operator[](size_t i) const { return m_items[m_order[i].second]; }
+
+        /*!
+         * @brief Computes the sort key for a draw item
+         * 
+         * @param[in] program - OpenGL shader program ID
+         * @param[in] materialId - Material ID
+         * @param[in] textureKey - Material texture key
+         * @param[in] viewDepth - Depth in the view coordinate system
+         * @param[in] translucent - true if the material uses blending, false otherwise
+         * @return Packed sort key
+         */
+        static uint64_t makeKey(GLuint program, uint32_t materialId, uint32_t textureKey, float viewDepth, bool translucent);
+
+        /*!
+         * @brief Extracts the state part of a sort key
+         * 
+         * Items with the same state key share program, material
+         * and textures, and only differ by their depth.
+         * 
+         * @param[in] key - Packed sort key
+         * @return Sort key without the depth field
+         */
+        static uint64_t stateKey(uint64_t key);
+
+        /*!
+         * @brief Checks the translucency bit of a sort key
+         * 
+         * @param[in] key - Packed sort key
+         * @return true if the item is translucent, false otherwise
+         */
+        static bool isTranslucent(uint64_t key);
+
+    private:
+        /*! Draw items in insertion order */
+        std::vector<Item> m_items;
+
+        /*! Sort keys and item indices in submission order */
+        std::vector<std::pair<uint64_t, uint32_t>> m_order;
+    };
+}
+
+}
+
+#endif
@@ -34,7 +34,15 @@
 #include <cstdint>
 #include <memory>
 
+#include "ares/core/ClusteredLighting.hpp"
+#include "ares/core/LightPrePass.hpp"
+#include "ares/core/OcclusionCuller.hpp"
+#include "ares/core/RenderQueue.hpp"
 #include "ares/core/Scene.hpp"
+#include "ares/core/TaskPool.hpp"
+#include "ares/glutils/Frustum.hpp"
+#include "ares/glutils/GlState.hpp"
+#include "ares/glutils/GpuTimer.hpp"
 #include "ares/glutils/RGBAColor.hpp"
 
 namespace ares
@@ -51,7 +59,27 @@ namespace core
      * This class implements a renderer that can be used
      * to render a scene. The renderer retrieves all relevant
      * information to render the scene (active camera, mvp matrix,
-     * lights, etc.) and walks the scene graph to render all meshes.
+     * lights, etc.), queries the scene spatial index for the mesh nodes
+     * whose bounds intersect the camera frustum and collects their
+     * primitives into a render queue. When occlusion culling is enabled,
+     * the visible occluder nodes are rasterized in a software depth buffer
+     * and the other primitives are tested against it before being queued.
+     * The queue is sorted by state and depth before being submitted to OpenGL,
+     * blended primitives last and back-to-front.
+     * When instancing is enabled, the queued copies of the same opaque primitive
+     * sharing the same state are drawn together with an instanced draw call.
+     * The lights are assigned to the clusters of a view space grid before
+     * drawing, so that each fragment is only shaded with the lights reaching it.
+     * In the light pre-pass render mode, the normals and depths of the opaque
+     * primitives are rendered first, the lights are accumulated in a light
+     * buffer as screen-space volumes and the primitives are drawn again reading
+     * it; blended primitives and materials without light pre-pass support are
+     * still shaded with the clustered lighting.
+     * When enabled, the render statistics report the OpenGL work and the CPU
+     * time split by stage of the last frame.
+     * The scene update and the per-node culling and queueing run on a task
+     * pool; only the submission of the sorted queue calls OpenGL, from the
+     * thread calling render.
      */
     class Renderer
     {
@@ -59,6 +87,7 @@ namespace core
         /*!
          * @brief Class constructor
          * 
+         * The renderer creates its own task pool using all hardware threads.
          */
         Renderer();
 
@@ -70,6 +99,81 @@ namespace core
         Renderer(const Renderer&) = delete;
         Renderer& operator=(const Renderer&) = delete;
 
+        /*!
+         * @brief Render mode enumeration
+         */
+        enum class RenderMode
+        {
+            Forward,      /*!< Clustered forward shading                      */
+            LightPrePass  /*!< Light pre-pass (deferred lighting) shading     */
+        };
+
+        /*!
+         * @brief Per-frame rendering statistics
+         */
+        struct RenderStats
+        {
+            /*! Number of draw calls */
+            uint32_t drawCalls;
+
+            /*! Number of triangles drawn, instances included */
+            uint64_t triangles;
+
+            /*! Number of program binds */
+            uint32_t programBinds;
+
+            /*! Number of texture binds */
+            uint32_t textureBinds;
+
+            /*! Number of buffer binds */
+            uint32_t bufferBinds;
+
+            /*! Number of vertex array object binds */
+            uint32_t vertexArrayBinds;
+
+            /*! Number of uniform uploads */
+            uint32_t uniformUploads;
+
+            /*! Number of OpenGL state calls, binds included */
+            uint32_t stateChanges;
+
+            /*! Number of redundant OpenGL state calls skipped by the state cache */
+            uint32_t skippedStateChanges;
+
+            /*! Number of mesh nodes returned by the spatial index */
+            uint32_t visibleMeshNodes;
+
+            /*! Number of mesh nodes culled by the spatial index */
+            uint32_t culledMeshNodes;
+
+            /*! Number of primitives queued for drawing */
+            uint32_t visiblePrimitives;
+
+            /*! Number of primitives of the visible nodes culled by the frustum or occlusion tests */
+            uint32_t culledPrimitives;
+
+            /*! Time spent updating the scene, camera and light clusters (ms) */
+            float updateTimeMs;
+
+            /*! Time spent querying the spatial index and rasterizing the occluders (ms) */
+            float cullTimeMs;
+
+            /*! Time spent testing and queueing the primitives of the visible nodes (ms) */
+            float gatherTimeMs;
+
+            /*! Time spent sorting the render queue (ms) */
+            float sortTimeMs;
+
+            /*! Time spent clearing and submitting the draw calls (ms) */
+            float submitTimeMs;
+
+            /*! Time spent finalizing the draw with the drawing context (ms) */
+            float swapTimeMs;
+
+            /*! Sum of the frame times above (ms) */
+            float frameTimeMs;
+        };
+
         /*!
          * @brief Background color setter
          * 
@@ -77,18 +181,189 @@ namespace core
          */
         void setBgColor(const glutils::RGBAColor& bgColor) { m_bgColor = bgColor; }
 
+        /*!
+         * @brief Task pool setter
+         * 
+         * This method allows sharing a task pool between renderers
+         * or other application tasks.
+         * 
+         * @param[in] taskPool - Task pool for the scene update and culling, nullptr to run single-threaded
+         */
+        void setTaskPool(TaskPoolPtr taskPool) { m_taskPool = taskPool; }
+
+        /*!
+         * @brief Task pool getter
+         * 
+         * @return Task pool for the scene update and culling
+         */
+        TaskPoolPtr taskPool() const { return m_taskPool; }
+
+        /*!
+         * @brief Frustum culling enable setter
+         * 
+         * @param[in] enable - true to skip nodes outside the camera frustum (default), false otherwise
+         */
+        void setFrustumCulling(bool enable) { m_frustumCulling = enable; }
+
+        /*!
+         * @brief Frustum culling enable getter
+         * 
+         * @return true if frustum culling is enabled, false otherwise
+         */
+        bool frustumCulling() const { return m_frustumCulling; }
+
+        /*!
+         * @brief Occlusion culling enable setter
+         * 
+         * When enabled, the mesh nodes designated as occluders are rasterized
+         * in a software depth buffer, and the primitives hidden behind them are
+         * not drawn. Occluder meshes must provide their occluder geometry.
+         * 
+         * @param[in] enable - true to enable occlusion culling, false otherwise (default)
+         */
+        void setOcclusionCulling(bool enable) { m_occlusionCulling = enable; }
+
+        /*!
+         * @brief Occlusion culling enable getter
+         * 
+         * @return true if occlusion culling is enabled, false otherwise
+         */
+        bool occlusionCulling() const { return m_occlusionCulling; }
+
+        /*!
+         * @brief Instancing enable setter
+         * 
+         * When enabled, the copies of a primitive drawn with the same
+         * material are drawn with a single instanced draw call if instanced
+         * arrays are supported, otherwise with pseudo-instancing (i.e. the
+         * material is set up once and only the instance matrix changes
+         * between the draw calls). Copies with non-uniform scale or shear
+         * are drawn one by one, as their normals need a full normal matrix.
+         * 
+         * @param[in] enable - true to enable instancing (default), false otherwise
+         */
+        void setInstancing(bool enable) { m_instancing = enable; }
+
+        /*!
+         * @brief Instancing enable getter
+         * 
+         * @return true if instancing is enabled, false otherwise
+         */
+        bool instancing() const { return m_instancing; }
+
+        /*!
+         * @brief Render mode setter
+         * 
+         * The light pre-pass mode falls back to the forward mode when its
+         * offscreen targets are not supported by the context.
+         * 
+         * @param[in] renderMode - Render mode (default Forward)
+         */
+        void setRenderMode(RenderMode renderMode) { m_renderMode = renderMode; }
+
+        /*!
+         * @brief Render mode getter
+         * 
+         * @return Render mode
+         */
+        RenderMode renderMode() const { return m_renderMode; }
+
+        /*!
+         * @brief Statistics enable setter
+         * 
+         * When enabled, the renderer times the stages of each frame and
+         * collects the OpenGL counters of the current state tracker in the
+         * render statistics, and times the passes with the GPU timer. When
+         * disabled, no time is measured and the statistics are not updated.
+         * 
+         * @param[in] enable - true to collect the render statistics, false otherwise (default)
+         */
+        void setStatsEnabled(bool enable) { m_statsEnabled = enable; }
+
+        /*!
+         * @brief Statistics enable getter
+         * 
+         * @return true if the render statistics are collected, false otherwise
+         */
+        bool statsEnabled() const { return m_statsEnabled; }
+
+        /*!
+         * @brief Render statistics getter
+         * 
+         * @return Statistics of the last frame rendered with statistics enabled
+         */
+        const RenderStats& renderStats() const { return m_stats; }
+
+        /*!
+         * @brief GPU timer getter
+         * 
+         * When the statistics are enabled, the GPU timer measures the scopes
+         * "frame" (the whole render call), "clear", "normalDepth" and
+         * "lightAccumulation" (light pre-pass only), "opaque" (the shaded
+         * primitives) and "swap", and a scope per material class named after
+         * the class within the normalDepth and opaque scopes. The results are
+         * the times of a previous frame, as they are read back a few frames later.
+         * 
+         * @return GPU timer of the renderer
+         */
+        const glutils::GpuTimer& gpuTimer() const { return m_gpuTimer; }
+
+        /*!
+         * @brief Occlusion culling statistics getter
+         * 
+         * @return Occlusion culling statistics of the last rendered frame
+         */
+        const OcclusionCuller::Stats& occlusionStats() const { return m_occlusionCuller.stats(); }
+
+        /*!
+         * @brief Clustered lighting getter
+         * 
+         * @return Clustered lighting engine of the renderer
+         */
+        ClusteredLighting& clusteredLighting() { return m_clusteredLighting; }
+
+        /*!
+         * @brief Clustered lighting statistics getter
+         * 
+         * @return Lighting statistics of the last rendered frame
+         */
+        const ClusteredLighting::Stats& lightingStats() const { return m_clusteredLighting.stats(); }
+
         /*!
          * @brief Renders the scene
          * 
          * This method is the main entry point for the
          * scene rendering. It collects all relevant information,
-         * activates the scene and renders all meshes found in the scene
+         * activates the scene and renders all meshes found in the scene.
+         * The memory registry is dumped at the end of the frame when its
+         * dump interval elapses (see MemoryTracker::setDumpInterval).
          * 
          * @param[in] scene - Scene to render
          */
         void render(ScenePtr scene);
 
     private:
+        /*!
+         * @brief Results of a gathering chunk
+         */
+        struct GatherChunk
+        {
+            /*! Items queued by the chunk */
+            RenderQueue queue;
+
+            /*! Number of frustum culled primitives */
+            uint32_t frustumCulled;
+
+            /*! Number of occlusion tested primitives */
+            uint32_t occlusionTested;
+
+            /*! Number of occlusion culled primitives */
+            uint32_t occlusionCulled;
+        };
+
+        /*! Task pool for the scene update and culling */
+        TaskPoolPtr m_taskPool;
+
         /*! View matrix from the active camera */
         glutils::Mat4 m_viewMatrix;
 
@@ -98,18 +373,154 @@ namespace core
         /*! Background/clear color for the framebuffer */
         glutils::RGBAColor m_bgColor;
 
+        /*! Frustum culling enable flag */
+        bool m_frustumCulling;
+
+        /*! Camera frustum in world coordinates */
+        glutils::Frustum m_frustum;
+
+        /*! Occlusion culling enable flag */
+        bool m_occlusionCulling;
+
+        /*! Software occlusion culler */
+        OcclusionCuller m_occlusionCuller;
+
+        /*! Clustered lighting engine */
+        ClusteredLighting m_clusteredLighting;
+
+        /*! Render mode */
+        RenderMode m_renderMode;
+
+        /*! Light pre-pass engine */
+        LightPrePass m_lightPrePass;
+
+        /*! Mesh nodes visible in the current frame, kept across frames to reuse its memory */
+        std::vector<MeshNode*> m_visibleMeshNodes;
+
+        /*! Render queue, kept across frames to reuse its memory */
+        RenderQueue m_renderQueue;
+
+        /*! Per-chunk gathering results, kept across frames to reuse their memory */
+        std::vector<std::unique_ptr<GatherChunk>> m_gatherChunks;
+
+        /*! Instancing enable flag */
+        bool m_instancing;
+
+        /*! Queue indices of a run of items grouped by primitive, kept to reuse its memory */
+        std::vector<size_t> m_runOrder;
+
+        /*! Instance model matrix rows of the current instanced draw, kept to reuse its memory */
+        std::vector<float> m_instanceData;
+
+        /*! Instance attribute buffer, created on first use if instanced arrays are supported */
+        glutils::VboPtr m_instanceVbo;
+
+        /*! Statistics enable flag */
+        bool m_statsEnabled;
+
+        /*! Statistics of the last frame */
+        RenderStats m_stats;
+
+        /*! GPU and CPU timer of the passes */
+        glutils::GpuTimer m_gpuTimer;
+
+        /*! Timer scope of the whole frame */
+        uint32_t m_frameScope;
+
+        /*! Timer scope of the clear */
+        uint32_t m_clearScope;
+
+        /*! Timer scope of the light pre-pass normal and depth pass */
+        uint32_t m_normalDepthScope;
+
+        /*! Timer scope of the light pre-pass light accumulation */
+        uint32_t m_lightAccumulationScope;
+
+        /*! Timer scope of the shaded primitives */
+        uint32_t m_opaqueScope;
+
+        /*! Timer scope of the draw finalization */
+        uint32_t m_swapScope;
+
+        /*!
+         * @brief Method to collect the primitives of the visible mesh nodes
+         * 
+         * The visible nodes are split in chunks gathered in parallel, then
+         * the chunk queues are merged in order into the render queue.
+         */
+        void gatherVisibleMeshNodes();
+
+        /*!
+         * @brief Method to collect the primitives of a mesh node
+         * 
+         * This method pushes the mesh primitives of the node into the
+         * chunk queue using the cached node world transform. It does not
+         * modify the renderer, so it can run concurrently.
+         * 
+         * @param[in] meshNode - Visible mesh node
+         * @param[in,out] chunk - Results of the gathering chunk
+         */
+        void gatherMeshNode(const MeshNode& meshNode, GatherChunk& chunk) const;
+
+        /*!
+         * @brief Method to rasterize the visible occluders
+         * 
+         * @param[in] viewProjectionMatrix - View-projection matrix of the frame
+         */
+        void rasterizeOccluders(const glutils::Mat4& viewProjectionMatrix);
+
+        /*!
+         * @brief Method to complete the statistics of the frame
+         * 
+         * @param[in] scene - Rendered scene
+         * @param[in] startCounters - OpenGL counters at the start of the frame
+         * @param[in] endCounters - OpenGL counters at the end of the frame
+         */
+        void collectStats(const Scene& scene, const glutils::GlState::Counters& startCounters, const glutils::GlState::Counters& endCounters);
+
+        /*!
+         * @brief Method to begin a timer scope if the statistics are enabled
+         * 
+         * @param[in] scope - Timer scope identifier
+         */
+        void beginTimerScope(uint32_t scope);
+
+        /*!
+         * @brief Method to end the last timer scope if the statistics are enabled
+         */
+        void endTimerScope();
+
         /*!
-         * @brief Recursive method to render a node
+         * @brief Method to draw the sorted render queue
          * 
-         * This method calculates the node transform from the parent
-         * transform and local node transform, calculates the mvp
-         * matrix if the node has a mesh and draws such mesh.
+         * In the NormalDepth pass the items whose material does not support the
+         * light pre-pass or is blended are skipped, in the LightBuffer pass they
+         * are drawn with the Default variant. When the statistics are enabled,
+         * the runs are timed by material class.
+         * 
+         * @param[in] lightVec - Vector of lights for the drawing
+         * @param[in] variant - Non-instanced shader variant of the pass
+         */
+        void submitQueue(const std::vector<LightNodePtr>& lightVec, Material::ShaderVariant variant);
+
+        /*!
+         * @brief Method to draw a run of queue items sharing the same state with instancing
+         * 
+         * @param[in] begin - Index of the first item of the run in the queue
+         * @param[in] end - Index past the last item of the run in the queue
+         * @param[in] lightVec - Vector of lights for the drawing
+         * @param[in] variant - Non-instanced shader variant of the items
+         */
+        void submitInstancedRun(size_t begin, size_t end, const std::vector<LightNodePtr>& lightVec, Material::ShaderVariant variant);
+
+        /*!
+         * @brief Method to draw a single queue item
          * 
-         * @param[in] node - Current node
-         * @param[in] parentXform - Cumulative parent node transform
+         * @param[in] item - Item to draw
          * @param[in] lightVec - Vector of lights for the drawing
+         * @param[in] variant - Non-instanced shader variant of the item
          */
-        void renderNode(NodePtr node, const glutils::Mat4& parentXform, const std::vector<LightNodePtr>& lightVec);
+        void submitItem(const RenderQueue::Item& item, const std::vector<LightNodePtr>& lightVec, Material::ShaderVariant variant);
     };
 }
 
@@ -38,10 +38,14 @@
 #include <unordered_map>
 #include <vector>
 
+#include "ares/core/Bvh.hpp"
 #include "ares/core/DrawingContext.hpp"
 #include "ares/core/Node.hpp"
 #include "ares/core/CameraNode.hpp"
 #include "ares/core/LightNode.hpp"
+#include "ares/core/MeshNode.hpp"
+#include "ares/core/TaskPool.hpp"
+#include "ares/glutils/Frustum.hpp"
 
 namespace ares
 {
@@ -60,6 +64,12 @@ namespace core
      * All nodes within a given scene must have unique names.
      * The scene must be activated before any other operation on nodes,
      * meshes or any other scene object is performed.
+     * The scene keeps registries of the mesh, light and camera nodes,
+     * updated when nodes are created or removed, so that they can be
+     * enumerated without walking the scene graph.
+     * The scene keeps a spatial index (BVH) of the world bounds of mesh
+     * nodes and of the world positions of light nodes, which is kept
+     * up to date by the update method and is used for the spatial queries.
      */
     class Scene
     {
@@ -85,7 +95,7 @@ namespace core
         /*!
          * @brief Active camera node setter
          * 
-         * @param[in] cameraNode - Camera node to set as active
+         * @param[in] cameraNode - Camera node to set as active, the active camera is reset when its node is removed
          */
         void setActiveCameraNode(CameraNodePtr cameraNode) { m_activeCameraNode = cameraNode; }
 
@@ -127,6 +137,72 @@ namespace core
          */
         void deactivate();
 
+        /*!
+         * @brief Updates the transform matrices and bounds of all nodes that changed
+         * 
+         * This method should be called once per frame before using the
+         * node transforms or bounds; only the branches of the scene graph
+         * with changed transforms or bounds are recomputed.
+         * The spatial index is updated accordingly: new nodes are inserted,
+         * moved nodes are refitted and the index is rebuilt with the SAH
+         * when too many incremental updates degraded it.
+         * When a task pool is given, the dirty branches are split into
+         * independent subtrees updated in parallel; the spatial index is
+         * always updated by the calling thread.
+         * 
+         * @param[in] taskPool - Optional task pool for the transform update
+         */
+        void update(TaskPool* taskPool = nullptr);
+
+        /*!
+         * @brief Builds the spatial index from scratch with the SAH
+         * 
+         * This method should be called after loading a scene; it updates
+         * all node transforms and bounds and rebuilds the spatial index.
+         */
+        void buildSpatialIndex();
+
+        /*!
+         * @brief Collects the mesh nodes whose world bounds intersect a frustum
+         * 
+         * @param[in] frustum - Frustum in world coordinates
+         * @param[out] meshNodes - Vector where the mesh nodes are appended
+         */
+        void queryMeshNodes(const glutils::Frustum& frustum, std::vector<MeshNode*>& meshNodes) const;
+
+        /*!
+         * @brief Finds the closest mesh node whose world bounds are hit by a ray
+         * 
+         * @param[in] origin - Ray origin in world coordinates
+         * @param[in] direction - Ray direction in world coordinates
+         * @param[in,out] distance - Maximum distance as input, distance of the hit along the ray as output
+         * @return Hit mesh node, nullptr if nothing is hit
+         */
+        MeshNodePtr raycast(const glutils::Vec3& origin, const glutils::Vec3& direction, float& distance) const;
+
+        /*!
+         * @brief Collects the light nodes closest to a point
+         * 
+         * The light index is rebuilt first if light nodes were added or
+         * removed since the last update, so that it matches the registry.
+         * 
+         * @param[in] point - Query point in world coordinates
+         * @param[in] count - Maximum number of light nodes to collect
+         * @return Light nodes sorted by distance from the point
+         */
+        std::vector<LightNodePtr> nearestLightNodes(const glutils::Vec3& point, size_t count) const;
+
+        /*!
+         * @brief Updates the light positions and directions in the view coordinate system
+         * 
+         * The positions are recomputed for all lights if the view matrix
+         * changed since the previous call, otherwise only for the lights
+         * whose world transform changed during the scene updates.
+         * 
+         * @param[in] viewMatrix - View matrix of the frame
+         */
+        void updateLightPositions(const glutils::Mat4& viewMatrix);
+
         /*!
          * @brief Templated method to create a node to add to the scene
          * 
@@ -154,15 +230,43 @@ namespace core
             /* Add to parent */
             parent->addChild(newNode);
 
+            /* Add to registries and spatial index */
+            registerNode(newNode);
+
             return newNode;
         }
 
+        /*!
+         * @brief Removes a node and its whole subtree from the scene
+         * 
+         * The removed nodes are taken out of the registries and of the
+         * spatial index. The method throws a runtime error exception if the
+         * node is the root node or if it does not belong to the scene.
+         * 
+         * @param[in] node - Node to remove
+         */
+        void removeNode(NodePtr node);
+
         /*!
          * @brief Method to get all light nodes in the scene
          * 
-         * @return Vector with all light nodes in the scene
+         * @return Vector with all light nodes in the scene, in no particular order
          */
-        std::vector<LightNodePtr> getLightNodes() const;
+        const std::vector<LightNodePtr>& getLightNodes() const { return m_indexedLightNodes; }
+
+        /*!
+         * @brief Method to get all mesh nodes in the scene
+         * 
+         * @return Vector with all mesh nodes in the scene, in no particular order
+         */
+        const std::vector<MeshNodePtr>& getMeshNodes() const { return m_indexedMeshNodes; }
+
+        /*!
+         * @brief Method to get all camera nodes in the scene
+         * 
+         * @return Vector with all camera nodes in the scene, in no particular order
+         */
+        const std::vector<CameraNodePtr>& getCameraNodes() const { return m_cameraNodes; }
 
     private:
         /*! Scene name */
@@ -177,16 +281,87 @@ namespace core
         /*! Active camera node */
         CameraNodePtr m_activeCameraNode;
 
+        /*! Spatial index of mesh node world bounds */
+        Bvh m_meshIndex;
+
+        /*! Mesh node registry, also the spatial index items, indexed by node spatial ID */
+        std::vector<MeshNodePtr> m_indexedMeshNodes;
+
+        /*! Spatial index of light node world positions, rebuilt on query if dirty */
+        mutable Bvh m_lightIndex;
+
+        /*! Light node registry, also the spatial index items, indexed by node spatial ID */
+        std::vector<LightNodePtr> m_indexedLightNodes;
+
+        /*! Flag set if light nodes were added, moved or removed since the last light index build */
+        mutable bool m_lightIndexDirty;
+
+        /*! View matrix of the last light positions update */
+        glutils::Mat4 m_lightViewMatrix;
+
+        /*! Camera node registry, indexed by node spatial ID */
+        std::vector<CameraNodePtr> m_cameraNodes;
+
+        /*! Nodes whose bounds changed during the last update, kept to reuse its memory */
+        std::vector<Node*> m_changedNodes;
+
+        /*! Roots of the subtrees updated in parallel, kept to reuse its memory */
+        std::vector<Node*> m_updateTasks;
+
+        /*! Nodes split into parallel subtrees, in top-down order, kept to reuse its memory */
+        std::vector<Node*> m_splitNodes;
+
+        /*! Nodes whose bounds changed, per parallel update chunk */
+        std::vector<std::vector<Node*>> m_taskChangedNodes;
+
         /*!
-         * @brief Helper method to parse a node for light nodes
+         * @brief Helper method to update the dirty branches in parallel
          * 
-         * This method checks if the input node is a light node, if so it adds it to the
-         * vector passed as input, and then performs recursion on child nodes
+         * @param[in] taskPool - Task pool running the subtree updates
+         */
+        void updateParallel(TaskPool& taskPool);
+
+        /*!
+         * @brief Helper method to add a new node to the registries and spatial index
+         * 
+         * The node is inserted in the index at the next update.
          * 
-         * @param[in]  node - Node to parse
-         * @param[out] lightVec - Vector of light nodes to populate
+         * @param[in] node - New node
+         */
+        void registerNode(NodePtr node);
+
+        /*!
+         * @brief Helper method to remove a node from the registries and spatial index
+         * 
+         * The last node of the registry takes the place of the removed one.
+         * 
+         * @param[in] node - Node to remove
+         */
+        void unregisterNode(Node& node);
+
+        /*!
+         * @brief Templated helper method to remove a node from a registry
+         * 
+         * @param[in] registry - Registry of the node type
+         * @param[in] node - Node to remove
+         * @return Index of the removed node, where the last node of the registry has been moved
+         */
+        template<class T>
+        uint32_t removeFromRegistry(std::vector<std::shared_ptr<T>>& registry, Node& node)
+        {
+            /* Move the last node in place of the removed one */
+            uint32_t index = static_cast<uint32_t>(node.m_spatialId);
+            registry[index] = registry.back();
+            registry[index]->m_spatialId = static_cast<int32_t>(index);
+            registry.pop_back();
+            node.m_spatialId = -1;
+            return index;
+        }
+
+        /*!
+         * @brief Helper method to rebuild the light index from the light node positions
          */
-        void parseNodeForLight(NodePtr node, std::vector<LightNodePtr>& lightVec) const;
+        void rebuildLightIndex() const;
     };
 }
 
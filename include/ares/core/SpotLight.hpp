@@ -0,0 +1,118 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef SPOTLIGHT_HPP_INCLUDED
+#define SPOTLIGHT_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+
+#include "ares/core/Light.hpp"
+
+namespace ares
+{
+
+namespace core
+{
+    class SpotLight;
+    using SpotLightPtr = std::shared_ptr<SpotLight>;
+
+    /*!
+     * @brief Spot light specialization of the generic Light class
+     * 
+     * Implements a cone of light emitted along the -Z axis of the
+     * light node. The intensity is full inside the inner cone angle
+     * and falls off to zero at the outer cone angle.
+     */
+    class SpotLight : public Light
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] innerConeAngle - Angle from the axis where the falloff starts (rad)
+         * @param[in] outerConeAngle - Angle from the axis where the falloff ends (rad)
+         */
+        SpotLight(float innerConeAngle = 0.F, float outerConeAngle = 0.7853981634F);
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~SpotLight() = default;
+
+        SpotLight(const SpotLight&) = delete;
+        SpotLight& operator=(const SpotLight&) = delete;
+
+        /*!
+         * @brief Cone angles setter
+         * 
+         * @param[in] innerConeAngle - Angle from the axis where the falloff starts (rad)
+         * @param[in] outerConeAngle - Angle from the axis where the falloff ends (rad), at most PI/2
+         */
+        void setConeAngles(float innerConeAngle, float outerConeAngle);
+
+        /*!
+         * @brief Inner cone angle getter
+         * 
+         * @return Angle from the axis where the falloff starts (rad)
+         */
+        float innerConeAngle() const { return m_innerConeAngle; }
+
+        /*!
+         * @brief Outer cone angle getter
+         * 
+         * @return Angle from the axis where the falloff ends (rad)
+         */
+        float outerConeAngle() const { return m_outerConeAngle; }
+
+        /*!
+         * @brief Computes the cone falloff coefficients
+         * 
+         * The falloff is clamp(cos(angle) * scale + offset, 0, 1), where
+         * angle is the angle from the axis, so that it is 0 at the outer
+         * cone angle and 1 at the inner cone angle.
+         * 
+         * @param[out] scale - Scale of the cosine of the angle from the axis
+         * @param[out] offset - Offset of the falloff
+         */
+        void coneFalloff(float& scale, float& offset) const;
+
+    private:
+        /*! Angle from the axis where the falloff starts */
+        float m_innerConeAngle;
+
+        /*! Angle from the axis where the falloff ends */
+        float m_outerConeAngle;
+    };
+}
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef TASKPOOL_HPP_INCLUDED
+#define TASKPOOL_HPP_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ares
+{
+
+namespace core
+{
+    class TaskPool;
+    using TaskPoolPtr = std::shared_ptr<TaskPool>;
+
+    /*!
+     * @brief Pool of worker threads for data-parallel tasks
+     * 
+     * This class owns a fixed set of worker threads that execute
+     * parallel loops split in chunks. The thread calling parallelFor
+     * takes part in the loop and returns when all chunks are done, so
+     * the caller (e.g. the thread owning the GL context) can use the
+     * results right away. Chunk boundaries only depend on the loop size
+     * and grain size, so results collected per chunk can be merged in a
+     * deterministic order. The loop body must not call OpenGL.
+     */
+    class TaskPool
+    {
+    public:
+        /*!
+         * @brief Loop body, called with chunk index and item range [begin, end)
+         */
+        using ChunkFunction = std::function<void(size_t chunk, size_t begin, size_t end)>;
+
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] workerCount - Number of worker threads, besides the calling thread.
+         *                          If negative, one less than the number of hardware threads is used
+         */
+        explicit TaskPool(int32_t workerCount = -1);
+
+        /*!
+         * @brief Class destructor, joins the worker threads
+         */
+        virtual ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        /*!
+         * @brief Number of threads getter
+         * 
+         * @return Number of threads taking part in loops, including the calling thread
+         */
+        size_t threadCount() const { return m_workers.size() + 1U; }
+
+        /*!
+         * @brief Computes the number of chunks for a loop
+         * 
+         * @param[in] count - Number of items
+         * @param[in] grainSize - Maximum number of items per chunk
+         * @return Number of chunks
+         */
+        static size_t chunkCount(size_t count, size_t grainSize);
+
+        /*!
+         * @brief Runs a parallel loop and waits for its completion
+         * 
+         * The items are split in chunks of at most grainSize items, each
+         * chunk is processed by one thread. Exceptions thrown by the loop
+         * body are rethrown in the calling thread.
+         * 
+         * @param[in] count - Number of items
+         * @param[in] grainSize - Maximum number of items per chunk
+         * @param[in] func - Loop body
+         */
+        void parallelFor(size_t count, size_t grainSize, const ChunkFunction& func);
+
+    private:
+        /*! Worker threads */
+        std::vector<std::thread> m_workers;
+
+        /*! Mutex for the job state */
+        std::mutex m_mutex;
+
+        /*! Condition to wake up workers on new jobs */
+        std::condition_variable m_jobCondition;
+
+        /*! Condition to wake up the caller on job completion */
+        std::condition_variable m_doneCondition;
+
+        /*! Job generation, incremented for each loop */
+        uint64_t m_generation;
+
+        /*! Flag set to stop the workers */
+        bool m_stop;
+
+        /*! Current loop body */
+        const ChunkFunction* m_func;
+
+        /*! Current loop size */
+        size_t m_count;
+
+        /*! Current loop grain size */
+        size_t m_grainSize;
+
+        /*! Current loop number of chunks */
+        size_t m_chunkCount;
+
+        /*! Next chunk to process */
+        std::atomic<size_t> m_nextChunk;
+
+        /*! Number of completed chunks */
+        size_t m_doneChunks;
+
+        /*! Number of workers currently processing the job */
+        size_t m_activeWorkers;
+
+        /*! First exception thrown by the loop body */
+        std::exception_ptr m_exception;
+
+        /*!
+         * @brief Worker thread main loop
+         */
+        void workerLoop();
+
+        /*!
+         * @brief Helper method to process chunks until none is left
+         * 
+         * @param[in] func - Loop body
+         * @return Number of processed chunks
+         */
+        size_t processChunks(const ChunkFunction& func);
+    };
+}
+
+}
+
+#endif
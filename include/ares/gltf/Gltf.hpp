@@ -31,8 +31,10 @@
 #ifndef GLTF_HPP_INCLUDED
 #define GLTF_HPP_INCLUDED
 
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /* Forwards */
@@ -45,6 +47,7 @@ namespace tinygltf
     class Camera;
     class Light;
     class Mesh;
+    class Primitive;
 }
 
 namespace ares
@@ -64,6 +67,7 @@ namespace core
     using LightPtr = std::shared_ptr<Light>;
     class Mesh;
     using MeshPtr = std::shared_ptr<Mesh>;
+    class Primitive;
     class Material;
     using MaterialPtr = std::shared_ptr<Material>;
 }
@@ -72,10 +76,16 @@ namespace glutils
 {
     class Vbo;
     using VboPtr = std::shared_ptr<Vbo>;
+    class AttributeData;
+    using AttributeDataPtr = std::shared_ptr<AttributeData>;
     class Image;
     using ImagePtr = std::shared_ptr<Image>;
     class Texture;
     using TexturePtr = std::shared_ptr<Texture>;
+    namespace MemoryTracker
+    {
+        class Allocation;
+    }
 }
 
 namespace gltf
@@ -88,7 +98,19 @@ namespace gltf
      *
      * This class can be used to load gltf file, parse
      * their content and construct an ARES scene with nodes
-     * and meshes defined in the gltf
+     * and meshes defined in the gltf.
+     * Nodes with a "static" boolean set in their extras are flagged
+     * as static, together with their subtree. When static batching is
+     * enabled, the opaque primitives of the static mesh nodes sharing
+     * the same material are pre-transformed in world space and merged
+     * into batches drawn with a single draw call each.
+     * The NORMAL, TANGENT and TEXCOORD_0 attributes read by a material but
+     * missing from a primitive are generated: smooth normals, tangents
+     * following the texture coordinates (or any direction orthogonal to
+     * the normal without them) and constant texture coordinates.
+     * The resources created while loading and parsing a file, and the
+     * file data kept by the loader, are attributed to the file path
+     * in the MemoryTracker.
      */
     class Gltf
     {
@@ -133,6 +155,44 @@ namespace gltf
          */
         std::vector<core::ScenePtr> parse();
 
+        /*!
+         * @brief Static batching enable setter
+         *
+         * Batching trades the per-node culling of the merged primitives
+         * for fewer draw calls, so it is meant for scenes made of many
+         * small static pieces. It must be set before parsing.
+         *
+         * @param[in] enable - true to merge the static mesh nodes (default), false otherwise
+         */
+        void setStaticBatching(bool enable) { m_staticBatching = enable; }
+
+        /*!
+         * @brief Static batching enable getter
+         *
+         * @return true if static batching is enabled, false otherwise
+         */
+        bool staticBatching() const { return m_staticBatching; }
+
+        /*!
+         * @brief Strict pipeline validation enable setter
+         *
+         * The pipeline state of each primitive is validated when the primitive
+         * is created, and primitives missing an attribute used by their material
+         * shader are always rejected. When strict validation is enabled, the
+         * primitives providing attributes not used by the shader are rejected too.
+         * It must be set before parsing.
+         *
+         * @param[in] enable - true to reject primitives with unused attributes, false otherwise (default)
+         */
+        void setStrictPipelineValidation(bool enable) { m_strictPipelineValidation = enable; }
+
+        /*!
+         * @brief Strict pipeline validation enable getter
+         *
+         * @return true if primitives with unused attributes are rejected, false otherwise
+         */
+        bool strictPipelineValidation() const { return m_strictPipelineValidation; }
+
     private:
 
         /*! Drawing context */
@@ -144,6 +204,12 @@ namespace gltf
         /*! TinyGLTF model */
         tinygltf::Model* m_model;
 
+        /*! Asset name of the loaded file in the memory tracker */
+        std::string m_assetName;
+
+        /*! Memory reported for the buffers and decoded images of the model */
+        std::unique_ptr<glutils::MemoryTracker::Allocation> m_modelMemory;
+
         /*! Vector of Vbo object */
         std::vector<glutils::VboPtr> m_vboVector;
 
@@ -165,6 +231,18 @@ namespace gltf
         /*! Vector of Texture object */
         std::vector<glutils::TexturePtr> m_textureVector;
 
+        /*! Static batching enable flag */
+        bool m_staticBatching;
+
+        /*! Strict pipeline validation enable flag */
+        bool m_strictPipelineValidation;
+
+        /*! Gltf primitive of each parsed Primitive object, used for static batching */
+        std::unordered_map<const core::Primitive*, const tinygltf::Primitive*> m_primitiveSources;
+
+        /*! Vertex data of the attributes generated for each gltf primitive, used for static batching */
+        std::unordered_map<const tinygltf::Primitive*, std::map<std::string, std::vector<float>>> m_generatedAttributes;
+
         /*! Method to parse buffers in the gltf */
         void parseBuffers();
 
@@ -186,11 +264,20 @@ namespace gltf
         /*! Method to parse meshes in the gltf */
         void parseMeshes();
 
+        /*! Method to generate the attributes read by the material of a primitive but missing from the gltf */
+        void generateAttributes(const tinygltf::Primitive& primitive, const core::MaterialPtr& material, std::vector<glutils::AttributeDataPtr>& attrDataVec);
+
         /*! Method to parse a scene in the gltf */
         core::ScenePtr parseScene(const tinygltf::Scene& scene);
 
         /*! Method to parse a node in the gltf */
         void parseNode(const tinygltf::Node& node, core::ScenePtr scene, core::NodePtr parentNode);
+
+        /*! Method to parse the instances of a node with the EXT_mesh_gpu_instancing extension */
+        void parseMeshInstances(const tinygltf::Node& node, core::ScenePtr scene, core::NodePtr parentNode);
+
+        /*! Method to merge the primitives of the static mesh nodes of a scene */
+        void batchStaticNodes(core::ScenePtr scene);
     };
 }
 
@@ -41,18 +41,15 @@ namespace ares
 
 namespace glutils
 {
-    class AttributeData;
-    using AttributeDataPtr = std::shared_ptr<AttributeData>;
-
     class Attribute;
     using AttributePtr = std::shared_ptr<Attribute>;
 
     /*!
      * @brief Class representing an OpenGL vertex attribute
      * 
-     * This class can be used to handle vertex attributes in the shader,
-     * to set attribute location, size, stride and offset in the Vbo used
-     * to contain the buffer data and to enable/disable the vertex arrays
+     * This class describes an active vertex attribute of a shader.
+     * The attribute data of a geometry is bound to the attribute
+     * locations by the VertexLayout class.
      */
     class Attribute
     {
@@ -71,20 +68,6 @@ namespace glutils
         Attribute(const Attribute&) = delete;
         Attribute& operator=(const Attribute&) = delete;
 
-        /*!
-         * @brief Activates the attribute and vertex buffer array
-         *
-         * @param[in] data - Data for the attribute
-         */
-        void activate(const AttributeDataPtr& data);
-
-        /*!
-         * @brief Deactivates the attribute and vertex buffer array
-         *
-         * @param[in] data - Data for the attribute
-         */
-        void deactivate(const AttributeDataPtr& data);
-
         /*!
          * @brief Name getter
          * 
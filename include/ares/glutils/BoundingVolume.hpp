@@ -0,0 +1,224 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef BOUNDINGVOLUME_HPP_INCLUDED
+#define BOUNDINGVOLUME_HPP_INCLUDED
+
+#include <cstdint>
+#include <limits>
+
+#include "ares/glutils/LinearAlgebra.hpp"
+
+namespace ares
+{
+
+namespace glutils
+{
+    /*!
+     * @brief Axis aligned bounding box
+     * 
+     * This class implements an axis aligned bounding box defined by its
+     * minimum and maximum corners. A default constructed box is empty
+     * (i.e. it contains nothing) and grows as points or boxes are added.
+     * An infinite box can be used to represent geometry with unknown
+     * bounds, which must never be culled.
+     */
+    class BoundingBox
+    {
+    public:
+        /*!
+         * @brief Class constructor, creates an empty box
+         */
+        BoundingBox();
+
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] minCorner - Minimum corner
+         * @param[in] maxCorner - Maximum corner
+         */
+        BoundingBox(const Vec3& minCorner, const Vec3& maxCorner);
+
+        /*!
+         * @brief Creates an infinite box
+         * 
+         * @return Infinite box
+         */
+        static BoundingBox infinite();
+
+        /*!
+         * @brief Minimum corner getter
+         * 
+         * @return Minimum corner
+         */
+        const Vec3& min() const { return m_min; }
+
+        /*!
+         * @brief Maximum corner getter
+         * 
+         * @return Maximum corner
+         */
+        const Vec3& max() const { return m_max; }
+
+        /*!
+         * @brief Box center getter
+         * 
+         * @return Box center
+         */
+        Vec3 center() const { return (m_min + m_max) * 0.5F; }
+
+        /*!
+         * @brief Box half-size getter
+         * 
+         * @return Half of the box size along each axis
+         */
+        Vec3 extents() const { return (m_max - m_min) * 0.5F; }
+
+        /*!
+         * @brief Checks if the box is empty
+         * 
+         * @return true if the box contains nothing, false otherwise
+         */
+        bool isEmpty() const { return (m_min[0] > m_max[0]) || (m_min[1] > m_max[1]) || (m_min[2] > m_max[2]); }
+
+        /*!
+         * @brief Checks if the box is infinite
+         * 
+         * @return true if the box is unbounded on any axis, false otherwise
+         */
+        bool isInfinite() const;
+
+        /*!
+         * @brief Box surface area getter
+         * 
+         * @return Box surface area, 0 for empty boxes
+         */
+        float surfaceArea() const;
+
+        /*!
+         * @brief Grows the box to include a point
+         * 
+         * @param[in] point - Point to include
+         */
+        void expand(const Vec3& point);
+
+        /*!
+         * @brief Grows the box to include another box
+         * 
+         * @param[in] box - Box to include
+         */
+        void expand(const BoundingBox& box);
+
+        /*!
+         * @brief Computes the box enclosing this box transformed by a matrix
+         * 
+         * @param[in] matrix - Affine transform matrix
+         * @return Transformed box
+         */
+        BoundingBox transformed(const Mat4& matrix) const;
+
+    private:
+        /*! Minimum corner */
+        Vec3 m_min;
+
+        /*! Maximum corner */
+        Vec3 m_max;
+    };
+
+    /*!
+     * @brief Bounding sphere
+     * 
+     * This class implements a bounding sphere defined by its center and
+     * radius. A negative radius represents an empty sphere.
+     */
+    class BoundingSphere
+    {
+    public:
+        /*!
+         * @brief Class constructor, creates an empty sphere
+         */
+        BoundingSphere();
+
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] center - Sphere center
+         * @param[in] radius - Sphere radius
+         */
+        BoundingSphere(const Vec3& center, float radius);
+
+        /*!
+         * @brief Creates the sphere enclosing a box
+         * 
+         * @param[in] box - Box to enclose
+         * @return Sphere enclosing the box
+         */
+        static BoundingSphere fromBox(const BoundingBox& box);
+
+        /*!
+         * @brief Sphere center getter
+         * 
+         * @return Sphere center
+         */
+        const Vec3& center() const { return m_center; }
+
+        /*!
+         * @brief Sphere radius getter
+         * 
+         * @return Sphere radius
+         */
+        float radius() const { return m_radius; }
+
+        /*!
+         * @brief Checks if the sphere is empty
+         * 
+         * @return true if the sphere contains nothing, false otherwise
+         */
+        bool isEmpty() const { return m_radius < 0.F; }
+
+        /*!
+         * @brief Checks if the sphere is infinite
+         * 
+         * @return true if the sphere is unbounded, false otherwise
+         */
+        bool isInfinite() const { return m_radius == std::numeric_limits<float>::infinity(); }
+
+    private:
+        /*! Sphere center */
+        Vec3 m_center;
+
+        /*! Sphere radius */
+        float m_radius;
+    };
+}
+
+}
+
+#endif
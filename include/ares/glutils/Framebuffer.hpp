@@ -0,0 +1,150 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef FRAMEBUFFER_HPP_INCLUDED
+#define FRAMEBUFFER_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <GLES2/gl2.h>
+
+#include "ares/glutils/Renderbuffer.hpp"
+#include "ares/glutils/Texture.hpp"
+
+namespace ares
+{
+
+namespace glutils
+{
+    class Framebuffer;
+    using FramebufferPtr = std::shared_ptr<Framebuffer>;
+
+    /*!
+     * @brief Framebuffer class to wrap OpenGL framebuffer functionality
+     * 
+     * This class creates an OpenGL framebuffer object rendering to a
+     * color texture, with an optional depth attachment that is either a
+     * depth texture (requires OES_depth_texture) or a renderbuffer.
+     * The framebuffer keeps its attachments alive, which can be shared
+     * with other framebuffers.
+     * GLES2 has a single color attachment, so each render target needs
+     * its own framebuffer.
+     */
+    class Framebuffer
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         * 
+         * The framebuffer is left unbound, its completeness can be checked
+         * with isComplete. If both a depth texture and a depth renderbuffer
+         * are provided, the depth texture is attached.
+         * 
+         * @param[in] colorTex - Color texture
+         * @param[in] depthTex - Optional depth texture
+         * @param[in] depthRb - Optional depth renderbuffer
+         */
+        Framebuffer(TexturePtr colorTex, TexturePtr depthTex = nullptr, RenderbufferPtr depthRb = nullptr);
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~Framebuffer();
+
+        Framebuffer() = delete;
+        Framebuffer(const Framebuffer&) = delete;
+        Framebuffer& operator=(const Framebuffer&) = delete;
+
+        /*!
+         * @brief Checks the framebuffer completeness
+         * 
+         * @return true if the framebuffer can be rendered to, false otherwise
+         */
+        bool isComplete() const { return m_complete; }
+
+        /*!
+         * @brief Binds the framebuffer for rendering
+         */
+        void bind();
+
+        /*!
+         * @brief Binds the default framebuffer for rendering
+         */
+        static void bindDefault();
+
+        /*!
+         * @brief OpenGL framebuffer ID getter
+         * 
+         * @return OpenGL framebuffer ID
+         */
+        GLuint fbo() const { return m_fbo; }
+
+        /*!
+         * @brief Color texture getter
+         * 
+         * @return Color texture
+         */
+        const TexturePtr& colorTexture() const { return m_colorTex; }
+
+        /*!
+         * @brief Depth texture getter
+         * 
+         * @return Depth texture, nullptr if depth is not a texture
+         */
+        const TexturePtr& depthTexture() const { return m_depthTex; }
+
+        /*!
+         * @brief Depth renderbuffer getter
+         * 
+         * @return Depth renderbuffer, nullptr if depth is not a renderbuffer
+         */
+        const RenderbufferPtr& depthRenderbuffer() const { return m_depthRb; }
+
+    private:
+        /*! OpenGL framebuffer object ID */
+        GLuint m_fbo;
+
+        /*! Color texture */
+        TexturePtr m_colorTex;
+
+        /*! Depth texture */
+        TexturePtr m_depthTex;
+
+        /*! Depth renderbuffer */
+        RenderbufferPtr m_depthRb;
+
+        /*! Completeness flag */
+        bool m_complete;
+    };
+}
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef FRUSTUM_HPP_INCLUDED
+#define FRUSTUM_HPP_INCLUDED
+
+#include <cstdint>
+
+#include "ares/glutils/BoundingVolume.hpp"
+#include "ares/glutils/LinearAlgebra.hpp"
+
+namespace ares
+{
+
+namespace glutils
+{
+    /*!
+     * @brief View frustum for visibility tests
+     * 
+     * This class extracts the six clipping planes from a projection (or
+     * view-projection) matrix and tests bounding volumes against them.
+     * The planes are stored as structure of arrays, so that each test
+     * evaluates four planes at a time with SIMD instructions.
+     * Planes are expressed in the space the matrix transforms from, e.g.
+     * a view-projection matrix yields planes in world space.
+     */
+    class Frustum
+    {
+    public:
+        /*!
+         * @brief Number of frustum planes
+         */
+        static constexpr size_t PLANE_COUNT = 6U;
+
+        /*!
+         * @brief Class constructor, creates a frustum that contains everything
+         */
+        Frustum();
+
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] matrix - Projection or view-projection matrix
+         */
+        explicit Frustum(const Mat4& matrix);
+
+        /*!
+         * @brief Extracts the frustum planes from a matrix
+         * 
+         * @param[in] matrix - Projection or view-projection matrix
+         */
+        void setMatrix(const Mat4& matrix);
+
+        /*!
+         * @brief Plane getter
+         * 
+         * @param[in] i - Plane index
+         * @return Plane (a, b, c, d) such that a*x + b*y + c*z + d >= 0 inside the frustum
+         */
+        Vec4 plane(size_t i) const;
+
+        /*!
+         * @brief Tests a box against the frustum
+         * 
+         * The test is conservative: boxes close to the frustum corners
+         * might be reported as intersecting even if they are outside.
+         * 
+         * @param[in] box - Box to test
+         * @return false if the box is completely outside, true otherwise
+         */
+        bool intersects(const BoundingBox& box) const;
+
+        /*!
+         * @brief Tests a sphere against the frustum
+         * 
+         * @param[in] sphere - Sphere to test
+         * @return false if the sphere is completely outside, true otherwise
+         */
+        bool intersects(const BoundingSphere& sphere) const;
+
+    private:
+        /*! Number of plane slots, padded to a multiple of the SIMD width */
+        static constexpr size_t PLANE_SLOTS = 8U;
+
+        /*! Plane coefficients as structure of arrays (a, b, c, d) */
+        float m_planes[4][PLANE_SLOTS];
+    };
+}
+
+}
+
+#endif
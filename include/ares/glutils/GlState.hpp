@@ -0,0 +1,453 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef GLSTATE_HPP_INCLUDED
+#define GLSTATE_HPP_INCLUDED
+
+#include <cstdint>
+#include <GLES2/gl2.h>
+
+namespace ares
+{
+
+namespace glutils
+{
+    /*!
+     * @brief Shadow copy of the OpenGL state of a context
+     * 
+     * This class records the OpenGL state set through it (current program,
+     * buffer bindings, active texture unit, per-unit texture bindings,
+     * vertex array object, enabled vertex arrays, vertex attribute pointers,
+     * capabilities, face culling, depth and blending) and skips the calls that
+     * would not change it. Each context owns its own state object, which
+     * is made current together with the context; the glutils classes
+     * always go through the current state object.
+     * All values start unknown, so that the first call always reaches
+     * OpenGL. If the state is modified without this class, invalidate
+     * must be called before using it again.
+     */
+    class GlState
+    {
+    public:
+        /*!
+         * @brief Call counters
+         */
+        struct Counters
+        {
+            /*! Number of calls forwarded to OpenGL */
+            uint64_t calls;
+
+            /*! Number of redundant calls skipped */
+            uint64_t skippedCalls;
+
+            /*! Number of program binds forwarded to OpenGL */
+            uint64_t programBinds;
+
+            /*! Number of texture binds forwarded to OpenGL */
+            uint64_t textureBinds;
+
+            /*! Number of buffer binds forwarded to OpenGL */
+            uint64_t bufferBinds;
+
+            /*! Number of vertex array object binds forwarded to OpenGL */
+            uint64_t vertexArrayBinds;
+
+            /*! Number of uniform uploads */
+            uint64_t uniformUploads;
+
+            /*! Number of draw calls */
+            uint64_t drawCalls;
+
+            /*! Number of triangles drawn, instances included */
+            uint64_t triangles;
+        };
+
+        /*! Number of texture units tracked, bindings on other units are always forwarded */
+        static constexpr uint32_t MAX_TRACKED_TEXTURE_UNITS = 32U;
+
+        /*! Number of vertex attribute locations tracked, other locations are always forwarded */
+        static constexpr uint32_t MAX_TRACKED_VERTEX_ATTRIBS = 32U;
+
+        /*!
+         * @brief Class constructor
+         */
+        GlState();
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~GlState() = default;
+
+        GlState(const GlState&) = delete;
+        GlState& operator=(const GlState&) = delete;
+
+        /*!
+         * @brief Current state getter
+         * 
+         * @return State object of the context current in the calling thread,
+         *         or a per-thread default state object if none was set
+         */
+        static GlState& current();
+
+        /*!
+         * @brief Current state setter
+         * 
+         * This method must be called when making a context current.
+         * 
+         * @param[in] state - State object of the context made current in the calling thread, nullptr to use the default one
+         */
+        static void setCurrent(GlState* state);
+
+        /*!
+         * @brief Marks the whole state as unknown
+         * 
+         * The next call for each state value is forwarded to OpenGL.
+         */
+        void invalidate();
+
+        /*!
+         * @brief Unbind to zero enable setter
+         * 
+         * When enabled, the objects deactivation methods restore the
+         * default bindings (program, buffers, textures and vertex arrays).
+         * This is only needed when sharing the context with code that
+         * does not use this class, as every activation binds its own objects.
+         * 
+         * @param[in] enable - true to unbind objects on deactivation, false otherwise (default)
+         */
+        void setUnbindToZero(bool enable) { m_unbindToZero = enable; }
+
+        /*!
+         * @brief Unbind to zero enable getter
+         * 
+         * @return true if objects are unbound on deactivation, false otherwise
+         */
+        bool unbindToZero() const { return m_unbindToZero; }
+
+        /*!
+         * @brief Call counters getter
+         * 
+         * The state counters sum forwarded and skipped calls since the last reset,
+         * their total is the number of calls that would be made without the cache.
+         * The bind counters split the forwarded binds by object type. The uniform
+         * and draw counters sum the uploads and draws reported by their objects.
+         * 
+         * @return Call counters
+         */
+        const Counters& counters() const { return m_counters; }
+
+        /*!
+         * @brief Resets the call counters
+         */
+        void resetCounters();
+
+        /*!
+         * @brief Counts a draw call
+         * 
+         * This method must be called by the objects issuing draw calls,
+         * as draws do not go through the state cache.
+         * 
+         * @param[in] mode - Primitive mode of the draw
+         * @param[in] vertexCount - Number of vertices or indices drawn per instance
+         * @param[in] instanceCount - Number of instances drawn
+         */
+        void countDraw(GLenum mode, GLsizei vertexCount, GLsizei instanceCount = 1);
+
+        /*!
+         * @brief Counts a uniform upload
+         * 
+         * This method must be called by the uniform objects, as the uniform
+         * values are cached by the uniforms themselves.
+         */
+        void countUniformUpload() { ++m_counters.uniformUploads; }
+
+        /*!
+         * @brief Sets the current program (glUseProgram)
+         * 
+         * @param[in] program - OpenGL program ID, 0 for none
+         */
+        void useProgram(GLuint program);
+
+        /*!
+         * @brief Binds a buffer (glBindBuffer)
+         * 
+         * @param[in] target - GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+         * @param[in] buffer - OpenGL buffer ID, 0 for none
+         */
+        void bindBuffer(GLenum target, GLuint buffer);
+
+        /*!
+         * @brief Deletes a buffer (glDeleteBuffers)
+         * 
+         * OpenGL unbinds deleted buffers, so the bindings are updated accordingly.
+         * 
+         * @param[in] buffer - OpenGL buffer ID
+         */
+        void deleteBuffer(GLuint buffer);
+
+        /*!
+         * @brief Selects the active texture unit (glActiveTexture)
+         * 
+         * @param[in] unit - Texture unit index, starting from 0
+         */
+        void activeTexture(uint32_t unit);
+
+        /*!
+         * @brief Binds a 2D texture to a texture unit (glActiveTexture and glBindTexture)
+         * 
+         * @param[in] unit - Texture unit index, starting from 0
+         * @param[in] texture - OpenGL texture ID, 0 for none
+         */
+        void bindTexture(uint32_t unit, GLuint texture);
+
+        /*!
+         * @brief Unbinds a 2D texture from all the units it is bound to
+         * 
+         * @param[in] texture - OpenGL texture ID
+         */
+        void unbindTexture(GLuint texture);
+
+        /*!
+         * @brief Deletes a texture (glDeleteTextures)
+         * 
+         * OpenGL unbinds deleted textures, so the bindings are updated accordingly.
+         * 
+         * @param[in] texture - OpenGL texture ID
+         */
+        void deleteTexture(GLuint texture);
+
+        /*!
+         * @brief Enables a vertex attribute array (glEnableVertexAttribArray)
+         * 
+         * @param[in] location - Attribute location
+         */
+        void enableVertexAttribArray(GLuint location);
+
+        /*!
+         * @brief Disables a vertex attribute array (glDisableVertexAttribArray)
+         * 
+         * @param[in] location - Attribute location
+         */
+        void disableVertexAttribArray(GLuint location);
+
+        /*!
+         * @brief Disables all the vertex attribute arrays not in a set
+         * 
+         * Arrays left enabled by previous draws are only disabled when
+         * a draw does not use them.
+         * 
+         * @param[in] locationMask - Bit mask of the attribute locations to keep enabled
+         */
+        void retainVertexAttribArrays(uint32_t locationMask);
+
+        /*!
+         * @brief Sets a vertex attribute pointer (glBindBuffer and glVertexAttribPointer)
+         * 
+         * The array buffer is only bound if the pointer changes.
+         * 
+         * @param[in] location - Attribute location
+         * @param[in] buffer - OpenGL buffer ID containing the attribute data
+         * @param[in] size - Number of components per vertex
+         * @param[in] type - Component type
+         * @param[in] normalized - true to normalize integer components, false otherwise
+         * @param[in] stride - Byte stride between vertices
+         * @param[in] offset - Byte offset of the first component in the buffer
+         */
+        void vertexAttribPointer(GLuint location, GLuint buffer, GLint size, GLenum type, bool normalized, GLsizei stride, uintptr_t offset);
+
+        /*!
+         * @brief Binds a vertex array object (glBindVertexArrayOES)
+         * 
+         * The element array buffer binding, the enabled vertex arrays and the
+         * vertex attribute pointers are part of the vertex array object, so
+         * they become unknown when the binding changes.
+         * Binding 0 without vertex array object support has no effect.
+         * 
+         * @param[in] vertexArray - OpenGL vertex array object ID, 0 for the default one
+         */
+        void bindVertexArray(GLuint vertexArray);
+
+        /*!
+         * @brief Deletes a vertex array object (glDeleteVertexArraysOES)
+         * 
+         * OpenGL unbinds deleted vertex array objects, so the binding is updated accordingly.
+         * 
+         * @param[in] vertexArray - OpenGL vertex array object ID
+         */
+        void deleteVertexArray(GLuint vertexArray);
+
+        /*!
+         * @brief Enables or disables a capability (glEnable/glDisable)
+         * 
+         * @param[in] capability - OpenGL capability
+         * @param[in] enable - true to enable the capability, false to disable it
+         */
+        void setCapability(GLenum capability, bool enable);
+
+        /*!
+         * @brief Sets the culled faces (glCullFace)
+         * 
+         * @param[in] mode - Culled faces
+         */
+        void cullFace(GLenum mode);
+
+        /*!
+         * @brief Sets the front face winding (glFrontFace)
+         * 
+         * @param[in] mode - Front face winding
+         */
+        void frontFace(GLenum mode);
+
+        /*!
+         * @brief Sets the depth test function (glDepthFunc)
+         * 
+         * @param[in] func - Depth test function
+         */
+        void depthFunc(GLenum func);
+
+        /*!
+         * @brief Sets the depth buffer write mask (glDepthMask)
+         * 
+         * @param[in] enable - true to write depth, false otherwise
+         */
+        void depthMask(bool enable);
+
+        /*!
+         * @brief Sets the blending factors (glBlendFunc)
+         * 
+         * @param[in] srcFactor - Source blending factor
+         * @param[in] dstFactor - Destination blending factor
+         */
+        void blendFunc(GLenum srcFactor, GLenum dstFactor);
+
+    private:
+        /*!
+         * @brief Vertex attribute pointer parameters
+         */
+        struct VertexAttribPointer
+        {
+            /*! Buffer containing the attribute data */
+            GLuint buffer;
+
+            /*! Number of components per vertex */
+            GLint size;
+
+            /*! Component type */
+            GLenum type;
+
+            /*! Normalization flag */
+            bool normalized;
+
+            /*! Byte stride between vertices */
+            GLsizei stride;
+
+            /*! Byte offset of the first component */
+            uintptr_t offset;
+        };
+
+        /*! Unbind to zero enable flag */
+        bool m_unbindToZero;
+
+        /*! Call counters */
+        Counters m_counters;
+
+        /*! Current program */
+        GLuint m_program;
+
+        /*! Bound array buffer */
+        GLuint m_arrayBuffer;
+
+        /*! Bound element array buffer */
+        GLuint m_elementArrayBuffer;
+
+        /*! Active texture unit */
+        uint32_t m_activeTextureUnit;
+
+        /*! 2D texture bound to each unit */
+        GLuint m_textures[MAX_TRACKED_TEXTURE_UNITS];
+
+        /*! Bit mask of the enabled vertex attribute arrays */
+        uint32_t m_enabledVertexAttribArrays;
+
+        /*! Bit mask of the vertex attribute arrays with a known enable state */
+        uint32_t m_knownVertexAttribArrays;
+
+        /*! Attribute pointer set for each location */
+        VertexAttribPointer m_vertexAttribPointers[MAX_TRACKED_VERTEX_ATTRIBS];
+
+        /*! Bound vertex array object */
+        GLuint m_vertexArray;
+
+        /*! Bit mask of the enabled capabilities */
+        uint32_t m_enabledCapabilities;
+
+        /*! Bit mask of the capabilities with a known enable state */
+        uint32_t m_knownCapabilities;
+
+        /*! Number of vertex attribute locations, queried on first use */
+        uint32_t m_maxVertexAttribs;
+
+        /*! Culled faces */
+        GLenum m_cullFace;
+
+        /*! Front face winding */
+        GLenum m_frontFace;
+
+        /*! Depth test function */
+        GLenum m_depthFunc;
+
+        /*! Depth write mask */
+        GLuint m_depthMask;
+
+        /*! Source blending factor */
+        GLenum m_blendSrcFactor;
+
+        /*! Destination blending factor */
+        GLenum m_blendDstFactor;
+
+        /*!
+         * @brief Helper method to update a cached value
+         * 
+         * @param[in,out] cached - Cached value
+         * @param[in] value - New value
+         * @return true if the call must be forwarded to OpenGL, false if it is redundant
+         */
+        bool update(GLuint& cached, GLuint value);
+
+        /*!
+         * @brief Helper method to mark the state of the bound vertex array object as unknown
+         */
+        void invalidateVertexArrayState();
+    };
+}
+
+}
+
+#endif
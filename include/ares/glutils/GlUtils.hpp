@@ -34,6 +34,16 @@
 #include <cstdint>
 #include <GLES2/gl2.h>
 
+/*! Build-time OpenGL error checking levels, see GlUtils::ErrorCheckMode */
+#define ARES_GL_ERROR_CHECK_OFF        0
+#define ARES_GL_ERROR_CHECK_FRAME      1
+#define ARES_GL_ERROR_CHECK_EVERY_CALL 2
+
+/*! Build-time OpenGL error checking level, set by the ARES_GL_ERROR_CHECK CMake option */
+#ifndef ARES_GL_ERROR_CHECK
+#define ARES_GL_ERROR_CHECK ARES_GL_ERROR_CHECK_EVERY_CALL
+#endif
+
 namespace ares
 {
 
@@ -43,14 +53,101 @@ namespace glutils
 namespace GlUtils
 {
 
+    /*!
+     * @brief OpenGL error checking mode enumeration
+     * 
+     * Checking for errors after each call can serialize the pipeline
+     * on tiled GPUs, so checks can be limited to one per frame or
+     * disabled. The build-time level is the most detailed mode
+     * available at runtime, the checks above it are compiled out.
+     */
+    enum class ErrorCheckMode
+    {
+        Off = ARES_GL_ERROR_CHECK_OFF,
+        Frame = ARES_GL_ERROR_CHECK_FRAME,
+        EveryCall = ARES_GL_ERROR_CHECK_EVERY_CALL
+    };
+
+    /*!
+     * @brief Error checking mode setter
+     * 
+     * If the debug output callback is installed, it is disabled in Off
+     * mode and enabled otherwise; a context must be current in that case.
+     * 
+     * @param[in] mode - Error checking mode, limited to the build-time level (the default)
+     */
+    void setErrorCheckMode(ErrorCheckMode mode);
+
+    /*!
+     * @brief Error checking mode getter
+     * 
+     * @return Current error checking mode
+     */
+    ErrorCheckMode errorCheckMode();
+
+#if ARES_GL_ERROR_CHECK == ARES_GL_ERROR_CHECK_EVERY_CALL
      /*!
      * @brief Utility method to check if there was a error in the OpenGL pipeline
      * 
+     * The check is only done in EveryCall mode and when no debug output
+     * callback is installed, as the callback reports the errors instead.
+     * 
      * @param[in] functionLastCalled - Name of the last OpenGL function called
      * @param[in] throwExcpt - If set, an expection is thrown if an error occurred
      * @return false if an error occurred, true otherwise
      */
     bool checkGLError(const char* functionLastCalled, bool throwExcpt = false);
+#else
+    inline bool checkGLError(const char* functionLastCalled, bool throwExcpt = false) { (void)functionLastCalled; (void)throwExcpt; return true; }
+#endif
+
+#if ARES_GL_ERROR_CHECK != ARES_GL_ERROR_CHECK_OFF
+    /*!
+     * @brief Utility method to check the errors of a whole frame
+     * 
+     * This method must be called once per frame. In Frame mode it reads
+     * all the pending OpenGL errors; if a debug output callback is installed,
+     * it reports the errors received by the callback since the previous call.
+     * 
+     * @param[in] throwExcpt - If set, an expection is thrown if an error occurred
+     * @return false if an error occurred, true otherwise
+     */
+    bool checkFrameGLErrors(bool throwExcpt = false);
+
+    /*!
+     * @brief Installs a GL_KHR_debug message callback
+     * 
+     * When GL_KHR_debug is supported, errors and high severity messages
+     * are reported asynchronously by the driver and printed to the
+     * standard error, and the per-call checks are skipped. The debug
+     * output is only enabled while the error checking mode is not Off.
+     * A context must be current when calling this method.
+     * 
+     * @return true if the callback is installed, false if the extension is not supported
+     */
+    bool enableDebugOutput();
+
+    /*!
+     * @brief Checks if the GL_KHR_debug message callback is installed and enabled
+     * 
+     * @return true if the driver reports the errors, false if they are polled or not checked
+     */
+    bool debugOutputEnabled();
+#else
+    inline bool checkFrameGLErrors(bool throwExcpt = false) { (void)throwExcpt; return true; }
+    inline bool enableDebugOutput() { return false; }
+    inline bool debugOutputEnabled() { return false; }
+#endif
+
+    /*!
+     * @brief Utility method to check if an OpenGL extension is supported
+     * 
+     * A context must be current when calling this method.
+     * 
+     * @param[in] extensionName - Name of the extension (e.g. "GL_EXT_instanced_arrays")
+     * @return true if the extension is supported by the current context, false otherwise
+     */
+    bool hasExtension(const char* extensionName);
 
 }
 
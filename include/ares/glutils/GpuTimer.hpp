@@ -0,0 +1,291 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef GPUTIMER_HPP_INCLUDED
+#define GPUTIMER_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GLES2/gl2.h>
+
+namespace ares
+{
+
+namespace glutils
+{
+    class GpuTimer;
+    using GpuTimerPtr = std::shared_ptr<GpuTimer>;
+
+    /*!
+     * @brief GpuTimer class to time named scopes of the frames
+     * 
+     * This class measures the time spent by the GPU and the CPU in named
+     * scopes of each frame. The GPU times are measured with the
+     * EXT_disjoint_timer_query time elapsed queries. The queries of a frame
+     * are kept in a ring of frames and read back a few frames later, when
+     * they are available, so that the measure does not stall the pipeline;
+     * the frames whose results are not available yet when their ring slot is
+     * reused, or that are affected by a disjoint operation (e.g. a GPU clock
+     * change), have no GPU times. When the extension is not supported, only
+     * the CPU times are measured.
+     * Scopes can be nested: as elapsed time queries cannot overlap, the query
+     * running when a scope begins or ends is stopped and a new one is started,
+     * and the time of each query is added to all the scopes open during it.
+     * The scopes must be timed between beginFrame and endFrame, with the
+     * context of the timer current. When the profiler is enabled, the GPU
+     * times read back are also recorded on the GPU track of the trace, laid
+     * out back to back from the CPU time the frame began.
+     */
+    class GpuTimer
+    {
+    public:
+        /*! Maximum number of nested scopes */
+        static constexpr uint32_t MAX_SCOPE_DEPTH = 8U;
+
+        /*!
+         * @brief Times of a scope in a frame
+         */
+        struct ScopeTimes
+        {
+            /*! Scope name */
+            std::string name;
+
+            /*! GPU time (ms), 0 if not measured */
+            float gpuTimeMs;
+
+            /*! CPU time (ms) */
+            float cpuTimeMs;
+        };
+
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] frameLatency - Number of frames between the timing of a frame and the readback of its results
+         */
+        GpuTimer(uint32_t frameLatency = 3U);
+
+        /*!
+         * @brief Class destructor
+         * 
+         * The queries are deleted, the context of the timer must be current.
+         */
+        virtual ~GpuTimer();
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        /*!
+         * @brief Checks if GPU timer queries are supported
+         * 
+         * @return true if EXT_disjoint_timer_query is supported by the current context, false otherwise
+         */
+        static bool isSupported();
+
+        /*!
+         * @brief Scope identifier getter
+         * 
+         * Scopes are registered on first use, the identifier should be
+         * resolved once and kept to avoid the lookup.
+         * 
+         * @param[in] name - Scope name
+         * @return Identifier of the scope, also its index in the results
+         */
+        uint32_t scopeId(const std::string& name);
+
+        /*!
+         * @brief Begins the timing of a frame
+         * 
+         * The results of the oldest frame of the ring are read back,
+         * if available, before its slot is reused for the new frame.
+         */
+        void beginFrame();
+
+        /*!
+         * @brief Ends the timing of a frame
+         * 
+         * All the scopes of the frame must have been ended.
+         */
+        void endFrame();
+
+        /*!
+         * @brief Begins a scope
+         * 
+         * @param[in] scope - Identifier of the scope
+         */
+        void beginScope(uint32_t scope);
+
+        /*!
+         * @brief Ends the last scope begun
+         */
+        void endScope();
+
+        /*!
+         * @brief Checks if the results have GPU times
+         * 
+         * @return true if the GPU times of the results frame were measured, false otherwise
+         */
+        bool hasGpuTimes() const { return m_resultsHaveGpuTimes; }
+
+        /*!
+         * @brief Current frame number getter
+         * 
+         * @return Number of the last frame begun, counting from 1, 0 before the first frame
+         */
+        uint64_t frameNumber() const { return m_frameNumber; }
+
+        /*!
+         * @brief Frame latency getter
+         * 
+         * The results of a frame are read back when this number of
+         * frames has begun after it.
+         * 
+         * @return Number of frames between a frame and its results
+         */
+        uint32_t frameLatency() const { return static_cast<uint32_t>(m_frames.size()); }
+
+        /*!
+         * @brief Results frame getter
+         * 
+         * @return Number of the frame of the results, counting from 1, 0 if there are no results yet
+         */
+        uint64_t resultsFrame() const { return m_resultsFrame; }
+
+        /*!
+         * @brief Results getter
+         * 
+         * @return Times of the results frame, indexed by scope identifier
+         */
+        const std::vector<ScopeTimes>& results() const { return m_results; }
+
+    private:
+        /*!
+         * @brief Time elapsed query and the scopes open during it
+         */
+        struct Interval
+        {
+            /*! Query index in the frame query pool */
+            uint32_t query;
+
+            /*! Open scopes */
+            uint32_t scopes[MAX_SCOPE_DEPTH];
+
+            /*! Number of open scopes */
+            uint32_t depth;
+        };
+
+        /*!
+         * @brief Timing data of a frame of the ring
+         */
+        struct Frame
+        {
+            /*! Frame number, 0 if the slot is unused */
+            uint64_t number;
+
+            /*! Profiler time the frame began (ns) */
+            uint64_t startNs;
+
+            /*! Pool of queries, grown on demand and reused */
+            std::vector<GLuint> queries;
+
+            /*! Query intervals of the frame */
+            std::vector<Interval> intervals;
+
+            /*! CPU times of the scopes (ms) */
+            std::vector<float> cpuTimesMs;
+        };
+
+        /*! Ring of frames */
+        std::vector<Frame> m_frames;
+
+        /*! Index of the current frame in the ring */
+        uint32_t m_currentFrame;
+
+        /*! Number of the current frame */
+        uint64_t m_frameNumber;
+
+        /*! GPU timing enable flag, set if the queries are supported */
+        bool m_gpuTiming;
+
+        /*! Scope identifiers by name */
+        std::map<std::string, uint32_t> m_scopeIds;
+
+        /*! Interned scope names of the trace events, indexed by scope identifier */
+        std::vector<const char*> m_traceNames;
+
+        /*! Open scopes */
+        uint32_t m_scopeStack[MAX_SCOPE_DEPTH];
+
+        /*! CPU start times of the open scopes */
+        std::chrono::steady_clock::time_point m_scopeStartTimes[MAX_SCOPE_DEPTH];
+
+        /*! Number of open scopes */
+        uint32_t m_scopeDepth;
+
+        /*! Query running flag */
+        bool m_queryRunning;
+
+        /*! Times of the results frame */
+        std::vector<ScopeTimes> m_results;
+
+        /*! Number of the results frame */
+        uint64_t m_resultsFrame;
+
+        /*! GPU times flag of the results frame */
+        bool m_resultsHaveGpuTimes;
+
+        /*!
+         * @brief Method to stop the running query and start a new one for the open scopes
+         */
+        void switchQuery();
+
+        /*!
+         * @brief Method to read back the results of a frame of the ring
+         * 
+         * @param[in] frame - Frame of the ring
+         */
+        void readResults(Frame& frame);
+
+        /*!
+         * @brief Method to record the GPU times of a frame on the profiler GPU track
+         * 
+         * @param[in] frame - Frame of the ring
+         * @param[in] elapsedNs - Elapsed time of each interval of the frame (ns)
+         */
+        void recordTraceEvents(const Frame& frame, const std::vector<uint64_t>& elapsedNs) const;
+    };
+}
+
+}
+
+#endif
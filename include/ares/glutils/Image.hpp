@@ -36,6 +36,8 @@
 #include <vector>
 #include <GLES2/gl2.h>
 
+#include "ares/glutils/MemoryTracker.hpp"
+
 namespace ares
 {
 
@@ -50,6 +52,7 @@ namespace glutils
      * 
      * This class holds image data, including raw
      * color data/bitmap, format, dimensions.
+     * The image data is reported to the MemoryTracker.
      */
     class Image
     {
@@ -129,6 +132,9 @@ namespace glutils
 
         /*! Image height */
         int32_t m_height;
+
+        /*! Memory reported for the image data */
+        MemoryTracker::Allocation m_memory;
     };
 
 }
@@ -0,0 +1,96 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef INSTANCING_HPP_INCLUDED
+#define INSTANCING_HPP_INCLUDED
+
+#include <cstdint>
+#include <GLES2/gl2.h>
+
+namespace ares
+{
+
+namespace glutils
+{
+
+/*!
+ * @brief Instanced drawing entry points
+ * 
+ * GLES2 has no core instanced drawing, this namespace wraps the
+ * GL_EXT_instanced_arrays and GL_ANGLE_instanced_arrays extensions.
+ * The entry points are loaded on the first call to isSupported,
+ * which must be done with a current context.
+ */
+namespace Instancing
+{
+
+    /*!
+     * @brief Checks if instanced arrays are supported
+     * 
+     * @return true if instanced draws and attribute divisors are available, false otherwise
+     */
+    bool isSupported();
+
+    /*!
+     * @brief Sets the rate at which an attribute advances during instanced draws
+     * 
+     * @param[in] index - Attribute location
+     * @param[in] divisor - Number of instances per attribute value, 0 to advance per vertex
+     */
+    void vertexAttribDivisor(GLuint index, GLuint divisor);
+
+    /*!
+     * @brief Draws several instances of non-indexed primitives
+     * 
+     * @param[in] mode - Primitive type
+     * @param[in] first - First vertex
+     * @param[in] count - Number of vertices
+     * @param[in] instanceCount - Number of instances
+     */
+    void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount);
+
+    /*!
+     * @brief Draws several instances of indexed primitives
+     * 
+     * @param[in] mode - Primitive type
+     * @param[in] count - Number of indices
+     * @param[in] type - Index type
+     * @param[in] indices - Offset of the indices in the bound element array buffer
+     * @param[in] instanceCount - Number of instances
+     */
+    void drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount);
+
+}
+
+}
+
+}
+
+#endif
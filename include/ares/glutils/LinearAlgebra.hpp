@@ -31,6 +31,8 @@
 #ifndef LINEARALGEBRA_HPP_INCLUDED
 #define LINEARALGEBRA_HPP_INCLUDED
 
+#include "ares/glutils/Simd.hpp"
+
 #include <cstdint>
 #include <cstring>
 #include <cmath>
@@ -373,8 +375,8 @@ namespace glutils
         float* data() { return m_data; }
 
     private:
-        /*! Vector data */
-        float m_data[N];
+        /*! Vector data, 16-byte aligned for the SIMD loads of Vec4 */
+        alignas((4 == N) ? 16 : alignof(float)) float m_data[N];
     };
 
     using Vec2 = Vec<2>;
@@ -409,7 +411,6 @@ namespace glutils
          */
         Mat(const float* m)
         {
-            memset(m_data, 0, sizeof(m_data));
             for (size_t c = 0; c < N; ++c)
             {
                 for (size_t r = 0; r < N; ++r)
@@ -426,7 +427,6 @@ namespace glutils
          */
         Mat(const float m[N][N])
         {
-            memset(m_data, 0, sizeof(m_data));
             for (size_t c = 0; c < N; ++c)
             {
                 for (size_t r = 0; r < N; ++r)
@@ -443,7 +443,6 @@ namespace glutils
          */
         Mat(const std::vector<double> m)
         {
-            memset(m_data, 0, sizeof(m_data));
             for (size_t c = 0; c < N; ++c)
             {
                 for (size_t r = 0; r < N; ++r)
@@ -477,7 +476,6 @@ namespace glutils
          */
         Mat& operator=(const float* m)
         {
-            memset(m_data, 0, sizeof(m_data));
             for (size_t c = 0; c < N; ++c)
             {
                 for (size_t r = 0; r < N; ++r)
@@ -495,7 +493,6 @@ namespace glutils
          */
         Mat& operator=(const float m[N][N])
         {
-            memset(m_data, 0, sizeof(m_data));
             for (size_t c = 0; c < N; ++c)
             {
                 for (size_t r = 0; r < N; ++r)
@@ -506,6 +503,28 @@ namespace glutils
             return *this;
         }
 
+        /*!
+         * @brief Equality operator, comparing all entries exactly
+         * 
+         * @param[in] rhs - Matrix to compare
+         * @return true if all entries are equal, false otherwise
+         */
+        bool operator==(const Mat& rhs) const
+        {
+            return (0 == memcmp(m_data, rhs.m_data, sizeof(m_data)));
+        }
+
+        /*!
+         * @brief Inequality operator, comparing all entries exactly
+         * 
+         * @param[in] rhs - Matrix to compare
+         * @return true if any entry differs, false otherwise
+         */
+        bool operator!=(const Mat& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
         /*!
          * @brief Row getter
          * 
@@ -729,6 +748,39 @@ namespace glutils
          */
         Mat& invert();
 
+        /*!
+         * @brief Inverts the matrix assuming it is affine, i.e. with (0, 0, 0, 1) as last row
+         * 
+         * The inverse is computed as the inverse of the upper 3x3 block
+         * and the opposite of the translation transformed by it, which is
+         * much cheaper than the general inverse.
+         * NOTE: only available for Mat4 template
+         * 
+         * @return Inverted matrix
+         */
+        Mat& invertAffine();
+
+        /*!
+         * @brief Checks if the upper 3x3 block is a rotation with uniform scale
+         * 
+         * NOTE: only available for Mat4 template
+         * 
+         * @param[in] tolerance - Tolerance relative to the squared scale
+         * @return true if the columns of the block are orthogonal and have the same length, false otherwise
+         */
+        bool hasUniformScale(float tolerance) const;
+
+        /*!
+         * @brief Calculates the normal matrix, i.e. the inverse transpose of the upper 3x3 block
+         * 
+         * With a uniform scale s the normal matrix is the upper 3x3 block
+         * divided by s^2, so the inverse is skipped.
+         * NOTE: only available for Mat4 template
+         * 
+         * @return Normal matrix
+         */
+        Mat<3> normalMatrix() const;
+
         /*!
          * @brief Gets the translation information from the matrix
          * 
@@ -835,14 +887,83 @@ namespace glutils
         float* data() { return reinterpret_cast<float*>(m_data); }
 
     private:
-        /*! Matrix data */
-        float m_data[N][N];
+        /*! Tag type for the constructor leaving the entries uninitialized */
+        struct NoInit {};
+
+        /*!
+         * @brief Constructor leaving the entries uninitialized, for results fully overwritten
+         */
+        explicit Mat(NoInit) {}
+
+        /*! Matrix data, column-major, 16-byte aligned for the SIMD loads of Mat4 */
+        alignas((4 == N) ? 16 : alignof(float)) float m_data[N][N];
     };
 
     using Mat2 = Mat<2>;
     using Mat3 = Mat<3>;
     using Mat4 = Mat<4>;
 
+#if defined(ARES_SIMD_SSE2) || defined(ARES_SIMD_NEON)
+    /*
+     * SIMD specializations of the hot Mat4 operations. Each column of the
+     * matrix maps on a Float4, so every product is a sum of columns scaled
+     * by the splatted entries of the other operand.
+     */
+
+    template<>
+    inline Vec4 Mat4::operator*(const Vec4& rhs) const
+    {
+        Float4 res = Float4::load(m_data[0]) * Float4::splat(rhs[0]);
+        res = Float4::madd(Float4::load(m_data[1]), Float4::splat(rhs[1]), res);
+        res = Float4::madd(Float4::load(m_data[2]), Float4::splat(rhs[2]), res);
+        res = Float4::madd(Float4::load(m_data[3]), Float4::splat(rhs[3]), res);
+        Vec4 v;
+        res.store(v.data());
+        return v;
+    }
+
+    template<>
+    inline Mat4 Mat4::operator*(const Mat4& rhs) const
+    {
+        const Float4 c0 = Float4::load(m_data[0]);
+        const Float4 c1 = Float4::load(m_data[1]);
+        const Float4 c2 = Float4::load(m_data[2]);
+        const Float4 c3 = Float4::load(m_data[3]);
+        Mat4 res((NoInit()));
+        for (size_t c = 0; c < 4; ++c)
+        {
+            Float4 col = c0 * Float4::splat(rhs.m_data[c][0]);
+            col = Float4::madd(c1, Float4::splat(rhs.m_data[c][1]), col);
+            col = Float4::madd(c2, Float4::splat(rhs.m_data[c][2]), col);
+            col = Float4::madd(c3, Float4::splat(rhs.m_data[c][3]), col);
+            col.store(res.m_data[c]);
+        }
+        return res;
+    }
+
+    template<>
+    inline Mat4& Mat4::operator*=(const Mat4& rhs)
+    {
+        *this = *this * rhs;
+        return *this;
+    }
+
+    template<>
+    inline Mat4& Mat4::transpose()
+    {
+        Float4 c0 = Float4::load(m_data[0]);
+        Float4 c1 = Float4::load(m_data[1]);
+        Float4 c2 = Float4::load(m_data[2]);
+        Float4 c3 = Float4::load(m_data[3]);
+        Float4::transpose(c0, c1, c2, c3);
+        c0.store(m_data[0]);
+        c1.store(m_data[1]);
+        c2.store(m_data[2]);
+        c3.store(m_data[3]);
+        return *this;
+    }
+#endif
+
     /*!
      * @brief Conversion function from Euler angles to quaternion
      * 
@@ -0,0 +1,281 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef MEMORYTRACKER_HPP_INCLUDED
+#define MEMORYTRACKER_HPP_INCLUDED
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <GLES2/gl2.h>
+
+namespace ares
+{
+
+namespace glutils
+{
+
+/*!
+ * @brief Registry of the memory used by the engine resources
+ * 
+ * Each resource owning GPU or CPU memory (buffer objects, textures,
+ * renderbuffers, images, loader model data) holds an Allocation that
+ * reports its size by category to the registry. Allocations are attributed
+ * to the asset whose AssetScope is active on the creating thread when they
+ * are created, or to the "engine" asset otherwise (e.g. render targets).
+ * GPU sizes are estimated from the allocated storage, as the driver may
+ * pad or compress it. The registry can be queried at any time, checked
+ * against a budget and dumped periodically by the renderer.
+ */
+namespace MemoryTracker
+{
+
+    /*!
+     * @brief Memory category enumeration
+     */
+    enum class Category
+    {
+        VertexBuffer,  /*!< GPU vertex buffers                  */
+        IndexBuffer,   /*!< GPU index buffers                   */
+        Texture,       /*!< GPU textures, mip chain included     */
+        Renderbuffer,  /*!< GPU renderbuffers                   */
+        Image,         /*!< CPU image copies                    */
+        ModelData,     /*!< CPU data kept by the model loaders  */
+        Count
+    };
+
+    /*! Number of memory categories */
+    constexpr uint32_t CATEGORY_COUNT = static_cast<uint32_t>(Category::Count);
+
+    /*!
+     * @brief Memory used by an asset
+     */
+    struct AssetUsage
+    {
+        /*! Asset name */
+        std::string name;
+
+        /*! Bytes used per category */
+        uint64_t bytes[CATEGORY_COUNT];
+
+        /*!
+         * @brief Total bytes getter
+         * 
+         * @return Bytes used in all categories
+         */
+        uint64_t totalBytes() const;
+    };
+
+    /*!
+     * @brief Category name getter
+     * 
+     * @param[in] category - Memory category
+     * @return Name of the category
+     */
+    const char* categoryName(Category category);
+
+    /*!
+     * @brief Bytes of a category getter
+     * 
+     * @param[in] category - Memory category
+     * @return Bytes currently used in the category by all assets
+     */
+    uint64_t categoryBytes(Category category);
+
+    /*!
+     * @brief Total bytes getter
+     * 
+     * @return Bytes currently used in all categories
+     */
+    uint64_t totalBytes();
+
+    /*!
+     * @brief Peak total bytes getter
+     * 
+     * @return Highest total bytes used since startup
+     */
+    uint64_t peakBytes();
+
+    /*!
+     * @brief Usage of all assets getter
+     * 
+     * @return Snapshot of the memory used by each asset, the released assets included
+     */
+    std::vector<AssetUsage> assetUsage();
+
+    /*!
+     * @brief Memory budget setter
+     * 
+     * @param[in] bytes - Budget of the total bytes, 0 for no budget (default)
+     */
+    void setBudget(uint64_t bytes);
+
+    /*!
+     * @brief Memory budget getter
+     * 
+     * @return Budget of the total bytes, 0 if there is no budget
+     */
+    uint64_t budget();
+
+    /*!
+     * @brief Checks the total bytes against the budget
+     * 
+     * @return true if a budget is set and exceeded, false otherwise
+     */
+    bool isOverBudget();
+
+    /*!
+     * @brief Writes the memory used per category and per asset
+     * 
+     * @param[in] os - Output stream
+     */
+    void dump(std::ostream& os);
+
+    /*!
+     * @brief Periodic dump interval setter
+     * 
+     * @param[in] frames - Number of frames between two dumps to the standard error, 0 to disable them (default)
+     */
+    void setDumpInterval(uint32_t frames);
+
+    /*!
+     * @brief Counts a frame and dumps the registry when the dump interval elapses
+     * 
+     * The renderer calls this method at the end of each frame.
+     */
+    void endFrame();
+
+    /*!
+     * @brief Memory reported by a resource, released on destruction
+     */
+    class Allocation
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         * 
+         * The allocation is attributed to the active asset of the calling thread.
+         * 
+         * @param[in] category - Memory category
+         * @param[in] bytes - Initial size in bytes
+         */
+        explicit Allocation(Category category, uint64_t bytes = 0U);
+
+        /*!
+         * @brief Class destructor
+         */
+        ~Allocation();
+
+        Allocation(const Allocation&) = delete;
+        Allocation& operator=(const Allocation&) = delete;
+
+        /*!
+         * @brief Size setter, for resources whose storage is reallocated
+         * 
+         * @param[in] bytes - New size in bytes
+         */
+        void setBytes(uint64_t bytes);
+
+        /*!
+         * @brief Size getter
+         * 
+         * @return Size in bytes
+         */
+        uint64_t bytes() const { return m_bytes; }
+
+    private:
+        /*! Memory category */
+        Category m_category;
+
+        /*! Index of the asset */
+        uint32_t m_asset;
+
+        /*! Size in bytes */
+        uint64_t m_bytes;
+    };
+
+    /*!
+     * @brief Scope attributing the allocations of the calling thread to an asset
+     * 
+     * Scopes can be nested, the previous asset is restored on destruction.
+     */
+    class AssetScope
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] name - Asset name, e.g. the path of the loaded file
+         */
+        explicit AssetScope(const std::string& name);
+
+        /*!
+         * @brief Class destructor
+         */
+        ~AssetScope();
+
+        AssetScope(const AssetScope&) = delete;
+        AssetScope& operator=(const AssetScope&) = delete;
+
+    private:
+        /*! Index of the asset active before the scope */
+        uint32_t m_previousAsset;
+    };
+
+    /*!
+     * @brief Size of the storage of a texture level
+     * 
+     * @param[in] width - Level width
+     * @param[in] height - Level height
+     * @param[in] format - OpenGL pixel format (e.g. GL_RGBA)
+     * @param[in] type - OpenGL pixel type (e.g. GL_UNSIGNED_BYTE)
+     * @param[in] mipmaps - If set, the size of the whole mip chain down to 1x1 is returned
+     * @return Size in bytes
+     */
+    uint64_t textureBytes(int32_t width, int32_t height, GLenum format, GLenum type, bool mipmaps);
+
+    /*!
+     * @brief Size of the storage of a renderbuffer
+     * 
+     * @param[in] width - Renderbuffer width
+     * @param[in] height - Renderbuffer height
+     * @param[in] format - OpenGL internal format (e.g. GL_DEPTH_COMPONENT16)
+     * @return Size in bytes
+     */
+    uint64_t renderbufferBytes(int32_t width, int32_t height, GLenum format);
+
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef PROFILER_HPP_INCLUDED
+#define PROFILER_HPP_INCLUDED
+
+#include <cstdint>
+#include <string>
+
+/*! Build-time profiling switch, set by the ARES_PROFILING CMake option */
+#ifndef ARES_PROFILING
+#define ARES_PROFILING 1
+#endif
+
+#define ARES_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ARES_PROFILE_CONCAT(a, b) ARES_PROFILE_CONCAT_IMPL(a, b)
+
+#if ARES_PROFILING
+/*!
+ * @brief Records the enclosing scope as a trace event when the profiler is enabled
+ * 
+ * @param[in] category - Event category, a string literal
+ * @param[in] name - Event name, a string literal
+ */
+#define ARES_PROFILE_SCOPE(category, name) \
+    ares::glutils::Profiler::ScopedEvent ARES_PROFILE_CONCAT(aresProfileEvent, __LINE__)(category, name)
+#else
+#define ARES_PROFILE_SCOPE(category, name)
+#endif
+
+namespace ares
+{
+
+namespace glutils
+{
+
+/*!
+ * @brief Trace-event profiler
+ * 
+ * The profiler records timed events of the engine hot paths, marked with
+ * the ARES_PROFILE_SCOPE macro, and writes them in the Chrome trace-event
+ * JSON format, which can be opened in chrome://tracing or Perfetto.
+ * Each thread records its events in its own buffer without locking; the
+ * buffers are drained when the trace is written. The GPU times measured
+ * by the GpuTimer objects are recorded on a separate GPU track.
+ * The profiler is disabled at startup: a disabled scope only checks the
+ * enable flag, and the scopes are compiled out if ARES_PROFILING is 0.
+ */
+namespace Profiler
+{
+
+    /*!
+     * @brief Event recording enable flag setter
+     * 
+     * @param[in] enabled - If set, events are recorded
+     */
+    void setEnabled(bool enabled);
+
+    /*!
+     * @brief Event recording enable flag getter
+     * 
+     * @return true if events are recorded, false otherwise
+     */
+    bool isEnabled();
+
+    /*!
+     * @brief Sets the name of the track of the calling thread
+     * 
+     * @param[in] name - Thread name, a string literal
+     */
+    void setThreadName(const char* name);
+
+    /*!
+     * @brief Returns a copy of a name that stays valid until the program exits
+     * 
+     * Event names are stored as pointers, names that are not string
+     * literals must be interned once before recording events with them.
+     * 
+     * @param[in] name - Name to intern
+     * @return Interned name
+     */
+    const char* internName(const std::string& name);
+
+    /*!
+     * @brief Profiler clock
+     * 
+     * @return Current time (ns)
+     */
+    uint64_t now();
+
+    /*!
+     * @brief Records an event on the track of the calling thread
+     * 
+     * @param[in] category - Event category
+     * @param[in] name - Event name
+     * @param[in] startNs - Event start time (ns), from the profiler clock
+     * @param[in] endNs - Event end time (ns), from the profiler clock
+     */
+    void recordEvent(const char* category, const char* name, uint64_t startNs, uint64_t endNs);
+
+    /*!
+     * @brief Records an event on the GPU track
+     * 
+     * @param[in] name - Event name
+     * @param[in] startNs - Event start time (ns), from the profiler clock
+     * @param[in] endNs - Event end time (ns), from the profiler clock
+     */
+    void recordGpuEvent(const char* name, uint64_t startNs, uint64_t endNs);
+
+    /*!
+     * @brief Writes the recorded events to a trace file
+     * 
+     * The events written are removed from the buffers, so that each file
+     * contains the events recorded since the previous call.
+     * 
+     * @param[in] filename - Path of the JSON trace file
+     * @return true if the file was written, false otherwise
+     */
+    bool writeTrace(const std::string& filename);
+
+    /*!
+     * @brief Scoped event, recorded from construction to destruction
+     */
+    class ScopedEvent
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] category - Event category, a string literal
+         * @param[in] name - Event name, a string literal
+         */
+        ScopedEvent(const char* category, const char* name)
+            : m_category(category)
+            , m_name(name)
+            , m_startNs((isEnabled()) ? (now()) : (0U))
+        {
+        }
+
+        /*!
+         * @brief Class destructor
+         */
+        ~ScopedEvent()
+        {
+            if (0U != m_startNs)
+            {
+                recordEvent(m_category, m_name, m_startNs, now());
+            }
+        }
+
+        ScopedEvent(const ScopedEvent&) = delete;
+        ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+    private:
+        /*! Event category */
+        const char* m_category;
+
+        /*! Event name */
+        const char* m_name;
+
+        /*! Start time (ns), 0 if the profiler was disabled */
+        uint64_t m_startNs;
+    };
+
+}
+
+}
+
+}
+
+#endif
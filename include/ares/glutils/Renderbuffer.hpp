@@ -0,0 +1,116 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef RENDERBUFFER_HPP_INCLUDED
+#define RENDERBUFFER_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <GLES2/gl2.h>
+
+#include "ares/glutils/MemoryTracker.hpp"
+
+namespace ares
+{
+
+namespace glutils
+{
+    class Renderbuffer;
+    using RenderbufferPtr = std::shared_ptr<Renderbuffer>;
+
+    /*!
+     * @brief Renderbuffer class to wrap OpenGL renderbuffer functionality
+     * 
+     * This class creates an OpenGL renderbuffer storage, e.g. a depth
+     * buffer for a Framebuffer whose depth is never sampled, and frees
+     * it when destroyed. A renderbuffer can be attached to several
+     * framebuffers to share it between render passes. The storage is
+     * reported to the MemoryTracker.
+     */
+    class Renderbuffer
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] width - Renderbuffer width
+         * @param[in] height - Renderbuffer height
+         * @param[in] format - Internal format, e.g. GL_DEPTH_COMPONENT16
+         */
+        Renderbuffer(int32_t width, int32_t height, GLenum format);
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~Renderbuffer();
+
+        Renderbuffer() = delete;
+        Renderbuffer(const Renderbuffer&) = delete;
+        Renderbuffer& operator=(const Renderbuffer&) = delete;
+
+        /*!
+         * @brief OpenGL renderbuffer ID getter
+         * 
+         * @return OpenGL renderbuffer ID
+         */
+        GLuint rb() const { return m_rb; }
+
+        /*!
+         * @brief Renderbuffer width getter
+         * 
+         * @return Renderbuffer width
+         */
+        int32_t width() const { return m_width; }
+
+        /*!
+         * @brief Renderbuffer height getter
+         * 
+         * @return Renderbuffer height
+         */
+        int32_t height() const { return m_height; }
+
+    private:
+        /*! OpenGL renderbuffer object ID */
+        GLuint m_rb;
+
+        /*! Renderbuffer width */
+        int32_t m_width;
+
+        /*! Renderbuffer height */
+        int32_t m_height;
+
+        /*! Memory reported for the renderbuffer storage */
+        MemoryTracker::Allocation m_memory;
+    };
+}
+
+}
+
+#endif
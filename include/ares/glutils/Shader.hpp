@@ -35,10 +35,10 @@
 #include <memory>
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 #include <GLES2/gl2.h>
 
 #include "ares/glutils/Attribute.hpp"
-#include "ares/glutils/AttributeData.hpp"
 #include "ares/glutils/Uniform.hpp"
 
 namespace ares
@@ -54,8 +54,10 @@ namespace glutils
      * 
      * This class implements a shader interface to handle shader operations,
      * such as activation/deactivation, attributes and uniforms.
-     * The uniforms are handled via the Uniform class. Uniform objects can be
-     * retrieved via the Shader class.
+     * The uniforms are handled via the Uniform class. The active attributes
+     * and uniforms are enumerated when the shader object is created, and the
+     * uniforms can be set through typed handles resolved once by name, so
+     * that drawing does not need any lookup.
      * This class does not provide shader compilation functionality. Shaders
      * should be compiled via the ShaderManager class, which manages the shader
      * programs created in the application and re-uses already created shader
@@ -68,7 +70,8 @@ namespace glutils
          * @brief Class constructor
          * 
          * Creates a shader object with a specified OpenGL shader program ID.
-         * The OpenGL shader program must have been already compiled.
+         * The OpenGL shader program must have been already compiled and linked,
+         * its active attributes and uniforms are enumerated here.
          * 
          * @param[in] prog - OpenGL shader program ID
          */
@@ -86,16 +89,18 @@ namespace glutils
         /*!
          * @brief Activates the shader
          *
-         * @param[in] attributeData - Data for the attributes
+         * The vertex attributes are not set by the shader,
+         * geometries are bound through their VertexLayout.
          */
-        void activate(const std::vector<glutils::AttributeDataPtr>& attributeData);
+        void activate();
 
         /*!
          * @brief Deactivates the shader
          *
-         * @param[in] attributeData - Data for the attributes
+         * The program is only reset if unbinding to
+         * zero is enabled in the current GlState.
          */
-        void deactivate(const std::vector<glutils::AttributeDataPtr>& attributeData);
+        void deactivate();
 
         /*!
          * @brief OpenGL shader program ID getter
@@ -119,49 +124,35 @@ namespace glutils
         GLint getUniformLocation(const std::string& unifName) const;
 
         /*!
-         * @brief Gets an attribute object
-         * 
-         * This method gets the object pointer for an attribute that was
-         * previously added with addAttribute. If the attribute was not added,
-         * the method returns nullptr.
-         * 
-         * @param[in] attribName - Requested attribute name
-         * @return Requested attribute object pointer, or nullptr if not found
-         */
-        AttributePtr getAttribute(const std::string& attribName) const;
-
-        /*!
-         * @brief Adds an attribute
-         * 
-         * This method adds a new attribute object to the shader object.
-         * If the attribute was already added the existing attribute object is returned.
-         * If the attribute was not already added, a new attribute object is created.
+         * @brief Active attributes getter
          * 
-         * @param[in] name - Attribute name
-         * @return Requested attribute object pointer
+         * @return Attribute objects of the attributes active in the shader program
          */
-        AttributePtr addAttribute(const std::string& name);
+        const std::vector<AttributePtr>& attributes() const { return m_attributes; }
 
         /*!
-         * @brief Adds attributes
+         * @brief Gets an attribute object
          * 
-         * This method adds new attribute objects to the shader object.
-         * The overall stride and offset for each attribute are calculated based on
-         * the other attributes in the provided vector
+         * This method gets the object pointer for an attribute active in the
+         * shader program. The active attributes are enumerated once when the
+         * shader object is created, and looked up by a linear scan, as programs
+         * only have a few attributes.
          * 
-         * @param[in] names - Attribute names
+         * @param[in] attribName - Requested attribute name
+         * @return Requested attribute object pointer, or nullptr if not active
          */
-        void addAttributes(const std::vector<std::string>& names);
+        AttributePtr getAttribute(const std::string& attribName) const;
 
         /*!
          * @brief Gets a uniform object
          * 
-         * This method gets the object pointer for a uniform that was
-         * previously added with addUniform. If the uniform was not added,
-         * the method returns nullptr.
+         * This method gets the object pointer for a uniform active in the
+         * shader program. The active uniforms are enumerated once when the
+         * shader object is created, with an object of the type matching the
+         * uniform declaration.
          * 
          * @param[in] unifName - Requested uniform name
-         * @return Requested uniform object pointer, or nullptr if not found
+         * @return Requested uniform object pointer, or nullptr if not active
          */
         UniformPtr getUniform(const std::string& unifName) const;
 
@@ -182,48 +173,85 @@ namespace glutils
         }
 
         /*!
-         * @brief Adds a uniform
+         * @brief Resolves a typed uniform handle
          * 
-         * This method adds a new uniform object to the shader object.
-         * If the uniform was already added and its type matches the input type,
-         * the existing uniform object is returned.
-         * If the uniform was already added but its type does not match the input type,
-         * an expection is thrown.
-         * If the uniform was not already added, a new uniform object is created.
+         * The handle must be resolved once, when the material is created,
+         * and then used with setUniform to set the uniform without lookups.
+         * If the uniform is declared with a type not matching the requested
+         * one, an exception is thrown.
          * 
          * @param[in] unifName - Requested uniform name
-         * @return Requested uniform object pointer
+         * @return Uniform handle, invalid if the uniform is not active
          */
         template<class T>
-        std::shared_ptr<T> addUniform(const std::string& unifName)
+        UniformHandle<T> uniformHandle(const std::string& unifName) const
         {
-            std::shared_ptr<T> retval;
-            UniformPtr unifPtr = getUniform(unifName);
-            if (nullptr == unifPtr)
+            UniformHandle<T> retval;
+            auto it = m_uniformIndices.find(unifName);
+            if (m_uniformIndices.end() != it)
             {
-                retval = std::make_shared<T>(unifName, getUniformLocation(unifName));
-                m_uniformMap.emplace(unifName, retval);
-            }
-            else
-            {
-                retval = std::dynamic_pointer_cast<T>(unifPtr);
-                if (nullptr == retval)
+                /* Check the type once, so that setUniform can skip it */
+                if (nullptr == dynamic_cast<T*>(m_uniforms[it->second].get()))
                 {
-                    throw std::runtime_error("Uniform already added with different type");
+                    throw std::runtime_error("Uniform " + unifName + " declared with different type");
                 }
+                retval.index = static_cast<int32_t>(it->second);
             }
             return retval;
         }
 
+        /*!
+         * @brief Sets and commits a uniform through its handle
+         * 
+         * Invalid handles are ignored. The shader MUST be activated first.
+         * 
+         * @param[in] handle - Uniform handle resolved with uniformHandle
+         * @param[in] value - Uniform value
+         */
+        template<class T, class V>
+        void setUniform(UniformHandle<T> handle, const V& value)
+        {
+            if (handle.isValid())
+            {
+                static_cast<T*>(m_uniforms[static_cast<size_t>(handle.index)].get())->setAndCommit(value);
+            }
+        }
+
+        /*!
+         * @brief Sets the texture unit of a sampler uniform
+         * 
+         * Sampler units never change after linking, and uniform values
+         * are kept by the program, so samplers are set once when the
+         * program is created instead of at each draw.
+         * The program is left in use.
+         * 
+         * @param[in] unifName - Sampler uniform name
+         * @param[in] unit - Texture unit of the sampler
+         */
+        void setSampler(const std::string& unifName, int32_t unit);
+
     private:
         /*! OpenGL shader program ID */
         GLuint m_program;
 
-        /*! Map of attribute objects added to the shader */
-        std::unordered_map<std::string, AttributePtr> m_attributeMap;
+        /*! Attribute objects of the active attributes */
+        std::vector<AttributePtr> m_attributes;
+
+        /*! Uniform objects of the active uniforms, indexed by the uniform handles */
+        std::vector<UniformPtr> m_uniforms;
 
-        /*! Map of uniform objects added to the shader */
-        std::unordered_map<std::string, UniformPtr> m_uniformMap;
+        /*! Map of uniform names to indices in m_uniforms, only used to resolve handles */
+        std::unordered_map<std::string, size_t> m_uniformIndices;
+
+        /*!
+         * @brief Method to enumerate the active attributes of the program
+         */
+        void reflectAttributes();
+
+        /*!
+         * @brief Method to enumerate the active uniforms of the program
+         */
+        void reflectUniforms();
     };
 }
 
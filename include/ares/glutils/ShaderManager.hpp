@@ -55,12 +55,19 @@ namespace ShaderManager
      * both vertex and fragment shaders and link a new shader program.
      * When getShader gets called a second time, the function will re-use any
      * existing shader programs if possible.
+     * Optional headers can be inserted in the vertex and fragment shaders
+     * after their first line (i.e. the version directive) to build variants
+     * of the same source, e.g. through preprocessor definitions, or to share
+     * common code. As for the sources, the variants are identified by the
+     * address of the header strings, which must then be static strings.
      * 
      * @param[in] vertShaderSource - Vertex shader code
      * @param[in] fragShaderSource - Fragment shader code
+     * @param[in] vertShaderHeader - Optional code inserted after the first line of the vertex shader
+     * @param[in] fragShaderHeader - Optional code inserted after the first line of the fragment shader
      * @return Shader object for the requested program
      */
-    ShaderPtr getShader(const char* vertShaderSource, const char* fragShaderSource);
+    ShaderPtr getShader(const char* vertShaderSource, const char* fragShaderSource, const char* vertShaderHeader = nullptr, const char* fragShaderHeader = nullptr);
 
     //TODO add facilities to delete shaders
 }
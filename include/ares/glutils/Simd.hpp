@@ -0,0 +1,559 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef SIMD_HPP_INCLUDED
+#define SIMD_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+
+/* ARES_NO_SIMD forces the scalar fallback, e.g. to compare the SIMD results with it */
+#if defined(ARES_NO_SIMD)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define ARES_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ARES_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace ares
+{
+
+namespace glutils
+{
+    /*!
+     * @brief Vector of four floats mapped on SIMD registers
+     * 
+     * This class provides a minimal set of vertical operations on
+     * four packed floats, implemented with SSE2 or NEON intrinsics
+     * when available and with a scalar fallback otherwise.
+     */
+    class Float4
+    {
+    public:
+#if defined(ARES_SIMD_SSE2)
+        /*! Native register type */
+        using Native = __m128;
+#elif defined(ARES_SIMD_NEON)
+        /*! Native register type */
+        using Native = float32x4_t;
+#else
+        /*! Native register type */
+        struct Native
+        {
+            /*! Lane values */
+            float v[4];
+        };
+#endif
+
+        /*!
+         * @brief Class constructor, values are left uninitialized
+         */
+        Float4() = default;
+
+        /*!
+         * @brief Constructor from native register
+         * 
+         * @param[in] v - Native register
+         */
+        explicit Float4(Native v) : m_v(v) {}
+
+        /*!
+         * @brief Loads four floats from memory, no alignment required
+         * 
+         * @param[in] p - Pointer to the data
+         * @return Loaded vector
+         */
+        static Float4 load(const float* p)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_loadu_ps(p));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vld1q_f32(p));
+#else
+            Native v = { { p[0], p[1], p[2], p[3] } };
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Creates a vector with all lanes set to the same value
+         * 
+         * @param[in] f - Value for all lanes
+         * @return Resulting vector
+         */
+        static Float4 splat(float f)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_set1_ps(f));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vdupq_n_f32(f));
+#else
+            Native v = { { f, f, f, f } };
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Creates a vector from four values
+         * 
+         * @param[in] x - Lane 0 value
+         * @param[in] y - Lane 1 value
+         * @param[in] z - Lane 2 value
+         * @param[in] w - Lane 3 value
+         * @return Resulting vector
+         */
+        static Float4 set(float x, float y, float z, float w)
+        {
+            const float tmp[4] = { x, y, z, w };
+            return load(tmp);
+        }
+
+        /*!
+         * @brief Stores the four floats to memory, no alignment required
+         * 
+         * @param[out] p - Pointer to the destination
+         */
+        void store(float* p) const
+        {
+#if defined(ARES_SIMD_SSE2)
+            _mm_storeu_ps(p, m_v);
+#elif defined(ARES_SIMD_NEON)
+            vst1q_f32(p, m_v);
+#else
+            p[0] = m_v.v[0];
+            p[1] = m_v.v[1];
+            p[2] = m_v.v[2];
+            p[3] = m_v.v[3];
+#endif
+        }
+
+        /*!
+         * @brief Native register getter
+         * 
+         * @return Native register
+         */
+        Native native() const { return m_v; }
+
+        /*!
+         * @brief First lane getter
+         * 
+         * @return Value of lane 0
+         */
+        float first() const
+        {
+#if defined(ARES_SIMD_SSE2)
+            return _mm_cvtss_f32(m_v);
+#elif defined(ARES_SIMD_NEON)
+            return vgetq_lane_f32(m_v, 0);
+#else
+            return m_v.v[0];
+#endif
+        }
+
+        /*!
+         * @brief Combines two lanes of each vector, as the SSE shuffle
+         * 
+         * @tparam I0 - Lane of a for lane 0
+         * @tparam I1 - Lane of a for lane 1
+         * @tparam I2 - Lane of b for lane 2
+         * @tparam I3 - Lane of b for lane 3
+         * @param[in] a - Vector of the low lanes
+         * @param[in] b - Vector of the high lanes
+         * @return Resulting vector (a[I0], a[I1], b[I2], b[I3])
+         */
+        template<int I0, int I1, int I2, int I3>
+        static Float4 shuffle(const Float4& a, const Float4& b)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_shuffle_ps(a.m_v, b.m_v, _MM_SHUFFLE(I3, I2, I1, I0)));
+#elif defined(ARES_SIMD_NEON)
+            float32x4_t v = vdupq_n_f32(vgetq_lane_f32(a.m_v, I0));
+            v = vsetq_lane_f32(vgetq_lane_f32(a.m_v, I1), v, 1);
+            v = vsetq_lane_f32(vgetq_lane_f32(b.m_v, I2), v, 2);
+            v = vsetq_lane_f32(vgetq_lane_f32(b.m_v, I3), v, 3);
+            return Float4(v);
+#else
+            Native v = { { a.m_v.v[I0], a.m_v.v[I1], b.m_v.v[I2], b.m_v.v[I3] } };
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Reorders the lanes of a vector
+         * 
+         * @param[in] a - Vector to reorder
+         * @return Resulting vector (a[I0], a[I1], a[I2], a[I3])
+         */
+        template<int I0, int I1, int I2, int I3>
+        static Float4 swizzle(const Float4& a)
+        {
+            return shuffle<I0, I1, I2, I3>(a, a);
+        }
+
+        /*!
+         * @brief Transposes the 4x4 matrix made of four vectors
+         * 
+         * @param[in,out] r0 - Row 0, replaced by column 0
+         * @param[in,out] r1 - Row 1, replaced by column 1
+         * @param[in,out] r2 - Row 2, replaced by column 2
+         * @param[in,out] r3 - Row 3, replaced by column 3
+         */
+        static void transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3)
+        {
+#if defined(ARES_SIMD_SSE2)
+            _MM_TRANSPOSE4_PS(r0.m_v, r1.m_v, r2.m_v, r3.m_v);
+#elif defined(ARES_SIMD_NEON)
+            float32x4x2_t t01 = vtrnq_f32(r0.m_v, r1.m_v);
+            float32x4x2_t t23 = vtrnq_f32(r2.m_v, r3.m_v);
+            r0.m_v = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+            r1.m_v = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+            r2.m_v = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+            r3.m_v = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#else
+            Float4* rows[4] = { &r0, &r1, &r2, &r3 };
+            for (int i = 0; i < 4; ++i)
+            {
+                for (int j = i + 1; j < 4; ++j)
+                {
+                    float tmp = rows[i]->m_v.v[j];
+                    rows[i]->m_v.v[j] = rows[j]->m_v.v[i];
+                    rows[j]->m_v.v[i] = tmp;
+                }
+            }
+#endif
+        }
+
+        /*!
+         * @brief Horizontal sum
+         * 
+         * @param[in] a - Vector to sum
+         * @return Vector with the sum of the lanes of a in all lanes
+         */
+        static Float4 sum(const Float4& a)
+        {
+            Float4 t = a + swizzle<2, 3, 0, 1>(a);
+            return t + swizzle<1, 0, 3, 2>(t);
+        }
+
+        /*!
+         * @brief Lane-wise sum
+         */
+        Float4 operator+(const Float4& rhs) const
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_add_ps(m_v, rhs.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vaddq_f32(m_v, rhs.m_v));
+#else
+            Native v = { { m_v.v[0] + rhs.m_v.v[0], m_v.v[1] + rhs.m_v.v[1], m_v.v[2] + rhs.m_v.v[2], m_v.v[3] + rhs.m_v.v[3] } };
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise difference
+         */
+        Float4 operator-(const Float4& rhs) const
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_sub_ps(m_v, rhs.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vsubq_f32(m_v, rhs.m_v));
+#else
+            Native v = { { m_v.v[0] - rhs.m_v.v[0], m_v.v[1] - rhs.m_v.v[1], m_v.v[2] - rhs.m_v.v[2], m_v.v[3] - rhs.m_v.v[3] } };
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise product
+         */
+        Float4 operator*(const Float4& rhs) const
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_mul_ps(m_v, rhs.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vmulq_f32(m_v, rhs.m_v));
+#else
+            Native v = { { m_v.v[0] * rhs.m_v.v[0], m_v.v[1] * rhs.m_v.v[1], m_v.v[2] * rhs.m_v.v[2], m_v.v[3] * rhs.m_v.v[3] } };
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise multiply and add (a * b + c)
+         * 
+         * @param[in] a - First factor
+         * @param[in] b - Second factor
+         * @param[in] c - Addend
+         * @return Resulting vector
+         */
+        static Float4 madd(const Float4& a, const Float4& b, const Float4& c)
+        {
+#if defined(ARES_SIMD_NEON)
+            return Float4(vmlaq_f32(c.m_v, a.m_v, b.m_v));
+#else
+            return (a * b) + c;
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise minimum
+         */
+        static Float4 min(const Float4& a, const Float4& b)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_min_ps(a.m_v, b.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vminq_f32(a.m_v, b.m_v));
+#else
+            Native v;
+            for (int i = 0; i < 4; ++i)
+            {
+                v.v[i] = (a.m_v.v[i] < b.m_v.v[i]) ? (a.m_v.v[i]) : (b.m_v.v[i]);
+            }
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise maximum
+         */
+        static Float4 max(const Float4& a, const Float4& b)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_max_ps(a.m_v, b.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vmaxq_f32(a.m_v, b.m_v));
+#else
+            Native v;
+            for (int i = 0; i < 4; ++i)
+            {
+                v.v[i] = (a.m_v.v[i] > b.m_v.v[i]) ? (a.m_v.v[i]) : (b.m_v.v[i]);
+            }
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise absolute value
+         */
+        static Float4 abs(const Float4& a)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_andnot_ps(_mm_set1_ps(-0.F), a.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vabsq_f32(a.m_v));
+#else
+            Native v;
+            for (int i = 0; i < 4; ++i)
+            {
+                v.v[i] = (a.m_v.v[i] < 0.F) ? (-a.m_v.v[i]) : (a.m_v.v[i]);
+            }
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise less-than comparison
+         * 
+         * @param[in] a - Left operand
+         * @param[in] b - Right operand
+         * @return Lane mask, with all bits of lane i set if lane i of a is less than lane i of b
+         */
+        static Float4 lessThan(const Float4& a, const Float4& b)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_cmplt_ps(a.m_v, b.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vreinterpretq_f32_u32(vcltq_f32(a.m_v, b.m_v)));
+#else
+            Native v;
+            for (int i = 0; i < 4; ++i)
+            {
+                v.v[i] = laneMask(a.m_v.v[i] < b.m_v.v[i]);
+            }
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise greater-or-equal comparison
+         * 
+         * @param[in] a - Left operand
+         * @param[in] b - Right operand
+         * @return Lane mask, with all bits of lane i set if lane i of a is greater than or equal to lane i of b
+         */
+        static Float4 greaterEqual(const Float4& a, const Float4& b)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_cmpge_ps(a.m_v, b.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vreinterpretq_f32_u32(vcgeq_f32(a.m_v, b.m_v)));
+#else
+            Native v;
+            for (int i = 0; i < 4; ++i)
+            {
+                v.v[i] = laneMask(a.m_v.v[i] >= b.m_v.v[i]);
+            }
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise bitwise and, to combine lane masks
+         */
+        Float4 operator&(const Float4& rhs) const
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_and_ps(m_v, rhs.m_v));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(m_v), vreinterpretq_u32_f32(rhs.m_v))));
+#else
+            Native v;
+            for (int i = 0; i < 4; ++i)
+            {
+                uint32_t lhsBits;
+                uint32_t rhsBits;
+                memcpy(&lhsBits, &m_v.v[i], sizeof(lhsBits));
+                memcpy(&rhsBits, &rhs.m_v.v[i], sizeof(rhsBits));
+                lhsBits &= rhsBits;
+                memcpy(&v.v[i], &lhsBits, sizeof(lhsBits));
+            }
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise selection with a lane mask
+         * 
+         * @param[in] mask - Lane mask, as returned by the comparison methods
+         * @param[in] a - Values for lanes with mask set
+         * @param[in] b - Values for lanes with mask clear
+         * @return Resulting vector
+         */
+        static Float4 select(const Float4& mask, const Float4& a, const Float4& b)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return Float4(_mm_or_ps(_mm_and_ps(mask.m_v, a.m_v), _mm_andnot_ps(mask.m_v, b.m_v)));
+#elif defined(ARES_SIMD_NEON)
+            return Float4(vbslq_f32(vreinterpretq_u32_f32(mask.m_v), a.m_v, b.m_v));
+#else
+            Native v;
+            for (int i = 0; i < 4; ++i)
+            {
+                uint32_t maskBits;
+                memcpy(&maskBits, &mask.m_v.v[i], sizeof(maskBits));
+                v.v[i] = (0U != maskBits) ? (a.m_v.v[i]) : (b.m_v.v[i]);
+            }
+            return Float4(v);
+#endif
+        }
+
+        /*!
+         * @brief Converts a lane mask to a bit mask
+         * 
+         * @param[in] mask - Lane mask, as returned by the comparison methods
+         * @return Bit mask with bit i set if lane i of the mask is set
+         */
+        static uint32_t bitMask(const Float4& mask)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return static_cast<uint32_t>(_mm_movemask_ps(mask.m_v));
+#elif defined(ARES_SIMD_NEON)
+            static const uint32_t laneBits[4] = { 1U, 2U, 4U, 8U };
+            uint32x4_t m = vandq_u32(vreinterpretq_u32_f32(mask.m_v), vld1q_u32(laneBits));
+            uint32x2_t s = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+            return vget_lane_u32(s, 0) | vget_lane_u32(s, 1);
+#else
+            uint32_t retval = 0U;
+            for (int i = 0; i < 4; ++i)
+            {
+                uint32_t maskBits;
+                memcpy(&maskBits, &mask.m_v.v[i], sizeof(maskBits));
+                retval |= (0U != maskBits) ? (1U << i) : (0U);
+            }
+            return retval;
+#endif
+        }
+
+        /*!
+         * @brief Lane-wise less-than comparison
+         * 
+         * @param[in] a - Left operand
+         * @param[in] b - Right operand
+         * @return Bit mask with bit i set if lane i of a is less than lane i of b
+         */
+        static uint32_t lessMask(const Float4& a, const Float4& b)
+        {
+#if defined(ARES_SIMD_SSE2)
+            return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(a.m_v, b.m_v)));
+#elif defined(ARES_SIMD_NEON)
+            static const uint32_t laneBits[4] = { 1U, 2U, 4U, 8U };
+            uint32x4_t m = vandq_u32(vcltq_f32(a.m_v, b.m_v), vld1q_u32(laneBits));
+            uint32x2_t s = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+            return vget_lane_u32(s, 0) | vget_lane_u32(s, 1);
+#else
+            uint32_t retval = 0U;
+            for (int i = 0; i < 4; ++i)
+            {
+                retval |= (a.m_v.v[i] < b.m_v.v[i]) ? (1U << i) : (0U);
+            }
+            return retval;
+#endif
+        }
+
+    private:
+        /*! Register data */
+        Native m_v;
+
+#if !defined(ARES_SIMD_SSE2) && !defined(ARES_SIMD_NEON)
+        /*!
+         * @brief Helper method to build a scalar lane mask
+         * 
+         * @param[in] set - Lane mask value
+         * @return Float with all bits set if set is true, zero otherwise
+         */
+        static float laneMask(bool set)
+        {
+            uint32_t bits = (set) ? (0xFFFFFFFFU) : (0U);
+            float retval;
+            memcpy(&retval, &bits, sizeof(retval));
+            return retval;
+        }
+#endif
+    };
+}
+
+}
+
+#endif
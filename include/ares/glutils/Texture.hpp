@@ -36,6 +36,7 @@
 #include <GLES2/gl2.h>
 
 #include "ares/glutils/Image.hpp"
+#include "ares/glutils/MemoryTracker.hpp"
 
 namespace ares
 {
@@ -49,7 +50,8 @@ namespace glutils
      * @brief Texture to create and handle OpenGL textures
      * 
      * This class implements an OpenGL texture and provides
-     * functionalities to create, activate and deactivate textures
+     * functionalities to create, activate and deactivate textures.
+     * The texture storage, mip chain included, is reported to the MemoryTracker.
      */
     class Texture
     {
@@ -91,6 +93,23 @@ namespace glutils
          */
         Texture(ImagePtr image, WrapType wrapS = WrapType::ClampToEdge, WrapType wrapT = WrapType::ClampToEdge, FilterType minF = FilterType::Nearest, FilterType magF = FilterType::Nearest);
 
+        /*!
+         * @brief Class constructor for data textures
+         * 
+         * This constructor creates an OpenGL texture without mipmaps
+         * whose content is uploaded with setData, e.g. for data read
+         * by shaders. The content is left undefined if data is nullptr.
+         * 
+         * @param[in] width - Texture width
+         * @param[in] height - Texture height
+         * @param[in] format - OpenGL pixel format (e.g. GL_RGBA)
+         * @param[in] type - OpenGL pixel type (e.g. GL_UNSIGNED_BYTE)
+         * @param[in] data - Optional initial texture data
+         * @param[in] minF - Min Filter mode, must not use mipmaps
+         * @param[in] magF - Mag Filter mode
+         */
+        Texture(int32_t width, int32_t height, GLenum format, GLenum type, const void* data = nullptr, FilterType minF = FilterType::Nearest, FilterType magF = FilterType::Nearest);
+
         /*!
          * @brief Class destructor
          * 
@@ -111,6 +130,10 @@ namespace glutils
 
         /*!
          * @brief Deactivates the texture
+         * 
+         * The texture is only unbound if unbinding to zero is
+         * enabled in the current GlState, otherwise it stays bound
+         * until another texture is activated on the same unit.
          */
         void deactivate();
 
@@ -121,10 +144,63 @@ namespace glutils
          */
         GLuint tex() const { return m_tex; }
 
+        /*!
+         * @brief Texture width getter
+         * 
+         * @return Texture width
+         */
+        int32_t width() const { return m_width; }
+
+        /*!
+         * @brief Texture height getter
+         * 
+         * @return Texture height
+         */
+        int32_t height() const { return m_height; }
+
+        /*!
+         * @brief Uploads the texture data
+         * 
+         * The texture storage is only reallocated if the size changes,
+         * otherwise the data is replaced in the existing storage.
+         * The data must have the format and type of the texture.
+         * 
+         * @param[in] width - Data width
+         * @param[in] height - Data height
+         * @param[in] data - Texture data
+         */
+        void setData(int32_t width, int32_t height, const void* data);
+
     private:
         /*! OpenGL Texture object ID */
         GLuint m_tex;
 
+        /*! Texture width */
+        int32_t m_width;
+
+        /*! Texture height */
+        int32_t m_height;
+
+        /*! OpenGL pixel format */
+        GLenum m_format;
+
+        /*! OpenGL pixel type */
+        GLenum m_type;
+
+        /*! Memory reported for the texture storage */
+        MemoryTracker::Allocation m_memory;
+
+        /*!
+         * @brief Helper method to create and configure the texture object
+         * 
+         * The texture is left bound on unit 0.
+         * 
+         * @param[in] wrapS - Wrap mode over X
+         * @param[in] wrapT - Wrap mode over Y
+         * @param[in] minF - Min Filter mode
+         * @param[in] magF - Mag Filter mode
+         */
+        void create(WrapType wrapS, WrapType wrapT, FilterType minF, FilterType magF);
 
     };
 }
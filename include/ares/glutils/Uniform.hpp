@@ -79,10 +79,18 @@ namespace glutils
         /*!
          * @brief Method to set value in the shader
          * 
-         * Pure virtual method to set the uniform value in the shader.
+         * The value is only uploaded if it changed since the last upload,
+         * as uniform values are kept by the shader program.
          * The shader MUST be activated first
          */
-        virtual void commit() = 0;
+        void commit();
+
+        /*!
+         * @brief Dirty flag getter
+         * 
+         * @return true if the value changed since the last upload, false otherwise
+         */
+        bool isDirty() const { return m_dirty; }
 
         /*!
          * @brief Uniform name getter
@@ -104,6 +112,37 @@ namespace glutils
 
         /*! Uniform location in the shader */
         int32_t m_location;
+
+        /*! Flag set if the value changed since the last upload */
+        bool m_dirty;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         * 
+         * Pure virtual method to set the uniform value in the shader.
+         */
+        virtual void upload() = 0;
+    };
+
+    /*!
+     * @brief Typed handle to a uniform of a shader
+     * 
+     * Handles are resolved once by name with Shader::uniformHandle and then
+     * used with Shader::setUniform to set the uniform without any lookup.
+     * An invalid handle refers to a uniform not active in the shader.
+     */
+    template<class T>
+    struct UniformHandle
+    {
+        /*! Index of the uniform in the shader, -1 if not active */
+        int32_t index = -1;
+
+        /*!
+         * @brief Checks if the handle refers to an active uniform
+         * 
+         * @return true if the handle is valid, false otherwise
+         */
+        bool isValid() const { return index >= 0; }
     };
 
     class Uniform1f;
@@ -137,15 +176,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(float v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -156,6 +192,11 @@ namespace glutils
     private:
         /*! Uniform value */
         float m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 
     class Uniform2f;
@@ -189,15 +230,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(const Vec2& v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -208,6 +246,11 @@ namespace glutils
     private:
         /*! Uniform value */
         Vec2 m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 
     class Uniform3f;
@@ -241,15 +284,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(const Vec3& v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -260,6 +300,11 @@ namespace glutils
     private:
         /*! Uniform value */
         Vec3 m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 
     class Uniform4f;
@@ -293,15 +338,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(const Vec4& v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -312,6 +354,11 @@ namespace glutils
     private:
         /*! Uniform value */
         Vec4 m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 
     class Uniformfv;
@@ -345,15 +392,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(const std::vector<float>& v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -364,6 +408,11 @@ namespace glutils
     private:
         /*! Uniform value */
         std::vector<float> m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 
     class Uniform1i;
@@ -397,15 +446,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(int32_t v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -416,6 +462,11 @@ namespace glutils
     private:
         /*! Uniform value */
         int32_t m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 
     class UniformMat2;
@@ -449,15 +500,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(const Mat2& v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -468,6 +516,11 @@ namespace glutils
     private:
         /*! Uniform value */
         Mat2 m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 
     class UniformMat3;
@@ -501,15 +554,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(const Mat3& v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -520,6 +570,11 @@ namespace glutils
     private:
         /*! Uniform value */
         Mat3 m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 
     class UniformMat4;
@@ -553,15 +608,12 @@ namespace glutils
         /*!
          * @brief Value setter
          * 
+         * The uniform is marked dirty only if the value changes.
+         * 
          * @param[in] v0 - Uniform value
          */
         void setValue(const Mat4& v0);
 
-        /*!
-         * @brief Method to set value in the shader
-         */
-        void commit() override;
-
         /*!
          * @brief Method to set and commit value
          * 
@@ -572,6 +624,11 @@ namespace glutils
     private:
         /*! Uniform value */
         Mat4 m_value;
+
+        /*!
+         * @brief Method to upload the value in the shader
+         */
+        void upload() override;
     };
 }
 
@@ -36,6 +36,8 @@
 #include <vector>
 #include <GLES2/gl2.h>
 
+#include "ares/glutils/MemoryTracker.hpp"
+
 namespace ares
 {
 
@@ -51,7 +53,7 @@ namespace glutils
      * to VBO in OpenGL.
      * The class allows to create an OpenGL VBO with buffer data,
      * activate the buffers during a draw operation and free any resources
-     * when destroyed.
+     * when destroyed. The buffer storage is reported to the MemoryTracker.
      */
     class Vbo
     {
@@ -66,6 +68,16 @@ namespace glutils
             ElementArrayBuffer = GL_ELEMENT_ARRAY_BUFFER
         };
 
+        /*!
+         * @brief Usage hint enumeration
+         */
+        enum class Usage
+        {
+            StaticDraw = GL_STATIC_DRAW,    /*!< Data set once and drawn many times        */
+            DynamicDraw = GL_DYNAMIC_DRAW,  /*!< Data modified repeatedly and drawn often  */
+            StreamDraw = GL_STREAM_DRAW     /*!< Data set each time and drawn a few times  */
+        };
+
         /*!
          * @brief Class constructor
          * 
@@ -75,8 +87,9 @@ namespace glutils
          * @param[in] data     - Buffer data to be set in the OpenGL VBO
          * @param[in] dataSize - Buffer size in bytes
          * @param[in] target - Buffer target
+         * @param[in] usage - Usage hint for the buffer data
          */
-        Vbo(const void* data, int32_t dataSize, TargetType target);
+        Vbo(const void* data, int32_t dataSize, TargetType target, Usage usage = Usage::StaticDraw);
 
         /*!
          * @brief Class destructor
@@ -92,17 +105,33 @@ namespace glutils
         /*!
          * @brief Method to activate the VBO for drawing
          * 
-         * This method binds the OpenGL VBO object
+         * This method binds the OpenGL VBO object, unless it is already bound.
+         * Index buffers are bound with the default vertex array object, geometries
+         * must be bound for drawing through their VertexLayout.
          */
         void activate();
 
         /*!
          * @brief Method to deactivate the VBO
          * 
-         * This method unbinds the OpenGL VBO object
+         * This method unbinds the OpenGL VBO object if unbinding
+         * to zero is enabled in the current GlState, otherwise
+         * the buffer stays bound until another one is activated
          */
         void deactivate();
 
+        /*!
+         * @brief Replaces the buffer data
+         * 
+         * The buffer storage is re-specified with the construction usage
+         * hint, so that the driver does not need to wait for pending draws
+         * using the old data. The buffer is not bound at the end of the method.
+         * 
+         * @param[in] data     - Buffer data to be set in the OpenGL VBO
+         * @param[in] dataSize - Buffer size in bytes
+         */
+        void setData(const void* data, int32_t dataSize);
+
         /*!
          * @brief OpenGL VBO ID getter
          */
@@ -119,6 +148,12 @@ namespace glutils
 
         /*! Target for the buffer */
         TargetType m_target;
+
+        /*! Usage hint for the buffer data */
+        Usage m_usage;
+
+        /*! Memory reported for the buffer storage */
+        MemoryTracker::Allocation m_memory;
     };
 }
 
@@ -0,0 +1,92 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef VERTEXARRAYOBJECT_HPP_INCLUDED
+#define VERTEXARRAYOBJECT_HPP_INCLUDED
+
+#include <cstdint>
+#include <GLES2/gl2.h>
+
+namespace ares
+{
+
+namespace glutils
+{
+
+/*!
+ * @brief Vertex array object entry points
+ * 
+ * GLES2 has no core vertex array objects, this namespace wraps the
+ * GL_OES_vertex_array_object extension.
+ * The entry points are loaded on the first call to isSupported,
+ * which must be done with a current context.
+ */
+namespace VertexArrayObject
+{
+
+    /*!
+     * @brief Checks if vertex array objects are supported
+     * 
+     * @return true if vertex array objects are available, false otherwise
+     */
+    bool isSupported();
+
+    /*!
+     * @brief Creates a vertex array object
+     * 
+     * @return OpenGL vertex array object ID
+     */
+    GLuint genVertexArray();
+
+    /*!
+     * @brief Binds a vertex array object
+     * 
+     * This method should only be called by GlState, which tracks the binding.
+     * 
+     * @param[in] vertexArray - OpenGL vertex array object ID, 0 for the default one
+     */
+    void bindVertexArray(GLuint vertexArray);
+
+    /*!
+     * @brief Deletes a vertex array object
+     * 
+     * This method should only be called by GlState, which tracks the binding.
+     * 
+     * @param[in] vertexArray - OpenGL vertex array object ID
+     */
+    void deleteVertexArray(GLuint vertexArray);
+
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef VERTEXLAYOUT_HPP_INCLUDED
+#define VERTEXLAYOUT_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <GLES2/gl2.h>
+
+#include "ares/glutils/AttributeData.hpp"
+#include "ares/glutils/Shader.hpp"
+#include "ares/glutils/Vbo.hpp"
+
+namespace ares
+{
+
+namespace glutils
+{
+    class VertexLayout;
+    using VertexLayoutPtr = std::shared_ptr<VertexLayout>;
+
+    /*!
+     * @brief Class representing the vertex layout of a geometry for a shader
+     * 
+     * This class binds the attribute data of a geometry to the attribute
+     * locations of a shader, together with its index buffer. The layout is
+     * immutable and resolved once when it is created, so it must be created
+     * for each pair of geometry and shader.
+     * When GL_OES_vertex_array_object is supported the layout is recorded in
+     * a vertex array object on the first bind, and binding it is a single call.
+     * Otherwise the layout is set up through the current GlState, which only
+     * forwards the attribute pointers and arrays that differ from the
+     * previously bound layout.
+     */
+    class VertexLayout
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         * 
+         * Attribute data not matching any active attribute of the shader is ignored.
+         * 
+         * @param[in] shader - Shader the layout is used with
+         * @param[in] attributeData - Attribute data of the geometry
+         * @param[in] indicesData - Index data of the geometry, nullptr for non-indexed geometries
+         */
+        VertexLayout(const Shader& shader, const std::vector<AttributeDataPtr>& attributeData, const AttributeDataPtr& indicesData);
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~VertexLayout();
+
+        VertexLayout() = delete;
+        VertexLayout(const VertexLayout&) = delete;
+        VertexLayout& operator=(const VertexLayout&) = delete;
+
+        /*!
+         * @brief Binds the layout
+         * 
+         * A context must be current, the vertex array object is created on the first bind.
+         */
+        void bind();
+
+        /*!
+         * @brief Unbinds the layout
+         * 
+         * The layout is only unbound if unbinding to zero is enabled in the
+         * current GlState, as the next bind sets its own layout.
+         */
+        void unbind();
+
+        /*!
+         * @brief Attribute location mask getter
+         * 
+         * @return Bit mask of the attribute locations enabled by the layout
+         */
+        uint32_t locationMask() const { return m_locationMask; }
+
+    private:
+        /*!
+         * @brief Binding of an attribute data to an attribute location
+         */
+        struct Binding
+        {
+            /*! Attribute location */
+            GLuint location;
+
+            /*! Buffer containing the attribute data */
+            VboPtr vbo;
+
+            /*! Number of components per vertex */
+            GLint size;
+
+            /*! Component type */
+            GLenum type;
+
+            /*! Normalization flag */
+            bool normalized;
+
+            /*! Byte stride between vertices */
+            GLsizei stride;
+
+            /*! Byte offset of the first component */
+            uintptr_t offset;
+        };
+
+        /*! Attribute bindings, sorted by location */
+        std::vector<Binding> m_bindings;
+
+        /*! Index buffer, nullptr for non-indexed geometries */
+        VboPtr m_indexVbo;
+
+        /*! Bit mask of the attribute locations enabled by the layout */
+        uint32_t m_locationMask;
+
+        /*! Vertex array object, 0 until the first bind or if not supported */
+        GLuint m_vertexArray;
+
+        /*!
+         * @brief Method to set up the layout in the bound vertex array object
+         */
+        void setUp();
+    };
+}
+
+}
+
+#endif
@@ -54,6 +54,9 @@ namespace port
      * The derived class must also implement the eglNativeDisplayType and
      * eglNativeWindowType methods to return the EGL native display and
      * window types used for EGL initialization.
+     * Offscreen devices override the surfaceType method to request a
+     * pbuffer surface instead of a window surface, and the eglPlatform
+     * method to select the EGL platform of the display.
      */
     class DisplayDevice
     {
@@ -65,6 +68,13 @@ namespace port
             Open
         };
 
+        /*! EGL surface type enumeration */
+        enum class SurfaceType
+        {
+            Window,  /*!< On-screen window surface created from the native window */
+            Pbuffer  /*!< Offscreen pbuffer surface with the device size            */
+        };
+
         /*!
          * @brief Class constructor
          * 
@@ -133,6 +143,26 @@ namespace port
          */
         virtual EGLNativeWindowType  eglNativeWindowType()  const = 0;
 
+        /*!
+         * @brief EGL surface type getter
+         * 
+         * This method can be overridden by derived classes rendering
+         * offscreen, which do not provide a native window.
+         * 
+         * @return type of the EGL surface to create for the device (default Window)
+         */
+        virtual SurfaceType surfaceType() const { return SurfaceType::Window; }
+
+        /*!
+         * @brief EGL platform getter
+         * 
+         * This method can be overridden by derived classes to get the EGL
+         * display of a specific platform with eglGetPlatformDisplayEXT.
+         * 
+         * @return EGL platform of the display, EGL_NONE to get the display from the native display type (default)
+         */
+        virtual EGLenum eglPlatform() const { return EGL_NONE; }
+
         /*!
          * @brief State getter
          * 
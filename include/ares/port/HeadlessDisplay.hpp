@@ -0,0 +1,114 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef HEADLESSDISPLAY_HPP_INCLUDED
+#define HEADLESSDISPLAY_HPP_INCLUDED
+
+#include "ares/port/DisplayDevice.hpp"
+
+namespace ares
+{
+
+namespace port
+{
+    class HeadlessDisplay;
+    using HeadlessDisplayPtr = std::shared_ptr<HeadlessDisplay>;
+
+    /*!
+     * @brief HeadlessDisplay interface for offscreen device implementation
+     * 
+     * The HeadlessDisplay class implements the DisplayDevice interface
+     * without any window system, so that the rendering can run on machines
+     * without a display server (e.g. servers, benchmarks or thumbnail
+     * generation). The drawing context renders in an offscreen pbuffer
+     * surface with the device size. The EGL display is taken from the
+     * Mesa surfaceless platform if available, otherwise from the default
+     * EGL display.
+     */
+    class HeadlessDisplay : public DisplayDevice
+    {
+    public:
+        /*!
+         * @brief Class constructor
+         * 
+         * @param[in] width  - Offscreen surface width
+         * @param[in] height - Offscreen surface height
+         */
+        HeadlessDisplay(int32_t width, int32_t height);
+
+        /*!
+         * @brief Class destructor
+         */
+        virtual ~HeadlessDisplay();
+
+        HeadlessDisplay(const HeadlessDisplay&) = delete;
+        HeadlessDisplay& operator=(const HeadlessDisplay&) = delete;
+
+        /*!
+         * @brief Method to close the display
+         * 
+         * There are no native resources to release, the method
+         * only sets the display state to closed.
+         */
+        void close() override;
+
+        /*!
+         * @brief EGL native display type getter
+         * 
+         * @return EGL default display
+         */
+        EGLNativeDisplayType eglNativeDisplayType() const override;
+
+        /*!
+         * @brief EGL native window type getter
+         * 
+         * @return null window, as the device has no native window
+         */
+        EGLNativeWindowType  eglNativeWindowType()  const override;
+
+        /*!
+         * @brief EGL surface type getter
+         * 
+         * @return Pbuffer surface type
+         */
+        SurfaceType surfaceType() const override { return SurfaceType::Pbuffer; }
+
+        /*!
+         * @brief EGL platform getter
+         * 
+         * @return Mesa surfaceless platform
+         */
+        EGLenum eglPlatform() const override;
+    };
+}
+
+}
+
+#endif
@@ -0,0 +1,621 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/core/Bvh.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace ares
+{
+
+namespace core
+{
+    /* Number of bins for the SAH evaluation during builds */
+    constexpr size_t SAH_BIN_COUNT = 12U;
+
+    /* Initial capacity of the traversal stacks */
+    constexpr size_t TRAVERSAL_STACK_SIZE = 64U;
+
+    static bool sameBox(const glutils::BoundingBox& lhs, const glutils::BoundingBox& rhs)
+    {
+        bool retval = true;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            retval = retval && (lhs.min()[i] == rhs.min()[i]) && (lhs.max()[i] == rhs.max()[i]);
+        }
+        return retval;
+    }
+
+    static bool rayHitsBox(const glutils::Vec3& origin, const glutils::Vec3& invDirection, const glutils::BoundingBox& box, float maxDistance, float& distance)
+    {
+        /* Slab test */
+        float tMin = 0.F;
+        float tMax = maxDistance;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            float t1 = (box.min()[i] - origin[i]) * invDirection[i];
+            float t2 = (box.max()[i] - origin[i]) * invDirection[i];
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+
+        distance = tMin;
+        return (tMin <= tMax);
+    }
+
+    static float squaredDistance(const glutils::Vec3& point, const glutils::BoundingBox& box)
+    {
+        float retval = 0.F;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            float d = std::max(std::max(box.min()[i] - point[i], 0.F), point[i] - box.max()[i]);
+            retval += (d * d);
+        }
+        return retval;
+    }
+
+    Bvh::Bvh()
+        : m_nodes()
+        , m_freeNodes()
+        , m_root(-1)
+        , m_items()
+        , m_unboundedItems()
+        , m_itemCount(0U)
+        , m_updatesSinceBuild(0U)
+    {
+    }
+
+    void Bvh::clear()
+    {
+        m_nodes.clear();
+        m_freeNodes.clear();
+        m_root = -1;
+        m_items.clear();
+        m_unboundedItems.clear();
+        m_itemCount = 0U;
+        m_updatesSinceBuild = 0U;
+    }
+
+    void Bvh::build(const std::vector<glutils::BoundingBox>& boxes)
+    {
+        clear();
+
+        /* Sort items between tree, unbounded list and empty */
+        std::vector<uint32_t> treeItems;
+        std::vector<glutils::Vec3> centroids(boxes.size());
+        m_items.resize(boxes.size());
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            m_items[i].box = boxes[i];
+            m_items[i].leaf = -1;
+            m_items[i].unbounded = -1;
+
+            if (!boxes[i].isEmpty())
+            {
+                ++m_itemCount;
+                if (boxes[i].isInfinite())
+                {
+                    setUnbounded(i, true);
+                }
+                else
+                {
+                    treeItems.push_back(i);
+                    centroids[i] = boxes[i].center();
+                }
+            }
+        }
+
+        /* Build tree */
+        if (!treeItems.empty())
+        {
+            m_nodes.reserve((2U * treeItems.size()) - 1U);
+            m_root = buildRecursive(treeItems, centroids, 0U, treeItems.size(), -1);
+        }
+    }
+
+    void Bvh::rebuild()
+    {
+        /* Collect current boxes and build again */
+        std::vector<glutils::BoundingBox> boxes;
+        boxes.reserve(m_items.size());
+        for (const auto& itemData : m_items)
+        {
+            boxes.push_back(itemData.box);
+        }
+        build(boxes);
+    }
+
+    void Bvh::update(uint32_t item, const glutils::BoundingBox& box)
+    {
+        /* Add item slots if needed */
+        if (item >= m_items.size())
+        {
+            ItemData emptyItem = { glutils::BoundingBox(), -1, -1 };
+            m_items.resize(item + 1U, emptyItem);
+        }
+
+        /* Update item count */
+        bool wasEmpty = m_items[item].box.isEmpty();
+        if (wasEmpty && (!box.isEmpty()))
+        {
+            ++m_itemCount;
+        }
+        else if ((!wasEmpty) && box.isEmpty())
+        {
+            --m_itemCount;
+        }
+
+        m_items[item].box = box;
+        ++m_updatesSinceBuild;
+
+        int32_t leaf = m_items[item].leaf;
+        if (box.isEmpty() || box.isInfinite())
+        {
+            /* Take the item out of the tree */
+            if (leaf >= 0)
+            {
+                removeLeaf(leaf);
+                releaseNode(leaf);
+                m_items[item].leaf = -1;
+            }
+            setUnbounded(item, box.isInfinite());
+        }
+        else
+        {
+            setUnbounded(item, false);
+            if (leaf >= 0)
+            {
+                /* Refit leaf and ancestors */
+                m_nodes[leaf].box = box;
+                refitFrom(m_nodes[leaf].parent);
+            }
+            else
+            {
+                /* Insert new leaf */
+                leaf = allocateNode();
+                m_nodes[leaf].box = box;
+                m_nodes[leaf].item = static_cast<int32_t>(item);
+                m_items[item].leaf = leaf;
+                insertLeaf(leaf);
+            }
+        }
+    }
+
+    void Bvh::remove(uint32_t item)
+    {
+        /* Set empty bounds, which takes the item out of the tree */
+        if (item < m_items.size())
+        {
+            update(item, glutils::BoundingBox());
+        }
+    }
+
+    void Bvh::queryFrustum(const glutils::Frustum& frustum, std::vector<uint32_t>& items) const
+    {
+        /* Unbounded items are always reported */
+        items.insert(items.end(), m_unboundedItems.begin(), m_unboundedItems.end());
+
+        if (m_root >= 0)
+        {
+            std::vector<int32_t> stack;
+            stack.reserve(TRAVERSAL_STACK_SIZE);
+            stack.push_back(m_root);
+            while (!stack.empty())
+            {
+                const TreeNode& node = m_nodes[stack.back()];
+                stack.pop_back();
+
+                /* Skip subtrees outside the frustum */
+                if (frustum.intersects(node.box))
+                {
+                    if (node.item >= 0)
+                    {
+                        items.push_back(static_cast<uint32_t>(node.item));
+                    }
+                    else
+                    {
+                        stack.push_back(node.right);
+                        stack.push_back(node.left);
+                    }
+                }
+            }
+        }
+    }
+
+    int32_t Bvh::queryRay(const glutils::Vec3& origin, const glutils::Vec3& direction, float& distance) const
+    {
+        int32_t retval = -1;
+
+        if (m_root >= 0)
+        {
+            glutils::Vec3 invDirection(1.F / direction[0], 1.F / direction[1], 1.F / direction[2]);
+            std::vector<int32_t> stack;
+            stack.reserve(TRAVERSAL_STACK_SIZE);
+            stack.push_back(m_root);
+            while (!stack.empty())
+            {
+                const TreeNode& node = m_nodes[stack.back()];
+                stack.pop_back();
+
+                /* Skip subtrees not hit before the closest hit found so far */
+                float hitDistance = 0.F;
+                if (rayHitsBox(origin, invDirection, node.box, distance, hitDistance))
+                {
+                    if (node.item >= 0)
+                    {
+                        retval = node.item;
+                        distance = hitDistance;
+                    }
+                    else
+                    {
+                        stack.push_back(node.right);
+                        stack.push_back(node.left);
+                    }
+                }
+            }
+        }
+
+        return retval;
+    }
+
+    void Bvh::queryNearest(const glutils::Vec3& point, size_t count, std::vector<uint32_t>& items) const
+    {
+        if ((m_root >= 0) && (count > 0U))
+        {
+            /* Best-first traversal, box distances are lower bounds for the items they contain */
+            using QueueEntry = std::pair<float, int32_t>;
+            std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+            queue.push(std::make_pair(squaredDistance(point, m_nodes[m_root].box), m_root));
+
+            size_t found = 0U;
+            while ((!queue.empty()) && (found < count))
+            {
+                const TreeNode& node = m_nodes[queue.top().second];
+                queue.pop();
+
+                if (node.item >= 0)
+                {
+                    items.push_back(static_cast<uint32_t>(node.item));
+                    ++found;
+                }
+                else
+                {
+                    queue.push(std::make_pair(squaredDistance(point, m_nodes[node.left].box), node.left));
+                    queue.push(std::make_pair(squaredDistance(point, m_nodes[node.right].box), node.right));
+                }
+            }
+        }
+    }
+
+    int32_t Bvh::allocateNode()
+    {
+        int32_t retval = -1;
+        TreeNode node = { glutils::BoundingBox(), -1, -1, -1, -1 };
+
+        /* Reuse a free node if available */
+        if (!m_freeNodes.empty())
+        {
+            retval = m_freeNodes.back();
+            m_freeNodes.pop_back();
+            m_nodes[retval] = node;
+        }
+        else
+        {
+            retval = static_cast<int32_t>(m_nodes.size());
+            m_nodes.push_back(node);
+        }
+
+        return retval;
+    }
+
+    void Bvh::releaseNode(int32_t index)
+    {
+        m_nodes[index].item = -1;
+        m_freeNodes.push_back(index);
+    }
+
+    int32_t Bvh::buildRecursive(std::vector<uint32_t>& items, const std::vector<glutils::Vec3>& centroids, size_t begin, size_t end, int32_t parent)
+    {
+        int32_t index = allocateNode();
+        m_nodes[index].parent = parent;
+
+        /* Single item: create leaf */
+        if (1U == (end - begin))
+        {
+            uint32_t item = items[begin];
+            m_nodes[index].box = m_items[item].box;
+            m_nodes[index].item = static_cast<int32_t>(item);
+            m_items[item].leaf = index;
+            return index;
+        }
+
+        /* Compute node bounds and centroid bounds */
+        glutils::BoundingBox box;
+        glutils::BoundingBox centroidBox;
+        for (size_t i = begin; i < end; ++i)
+        {
+            box.expand(m_items[items[i]].box);
+            centroidBox.expand(centroids[items[i]]);
+        }
+
+        /* Evaluate binned SAH along each axis */
+        int32_t bestAxis = -1;
+        size_t bestSplit = 0U;
+        float bestCost = std::numeric_limits<float>::max();
+        glutils::Vec3 centroidSize = centroidBox.max() - centroidBox.min();
+        if (box.surfaceArea() > 0.F)
+        {
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                if (centroidSize[axis] <= 0.F)
+                {
+                    continue;
+                }
+
+                /* Fill bins */
+                glutils::BoundingBox binBoxes[SAH_BIN_COUNT];
+                size_t binCounts[SAH_BIN_COUNT] = { 0U };
+                float scale = static_cast<float>(SAH_BIN_COUNT) / centroidSize[axis];
+                for (size_t i = begin; i < end; ++i)
+                {
+                    size_t bin = std::min(SAH_BIN_COUNT - 1U, static_cast<size_t>((centroids[items[i]][axis] - centroidBox.min()[axis]) * scale));
+                    ++binCounts[bin];
+                    binBoxes[bin].expand(m_items[items[i]].box);
+                }
+
+                /* Sweep from the right to accumulate right side areas and counts */
+                float rightAreas[SAH_BIN_COUNT];
+                size_t rightCounts[SAH_BIN_COUNT];
+                glutils::BoundingBox accBox;
+                size_t accCount = 0U;
+                for (size_t bin = SAH_BIN_COUNT - 1U; bin > 0U; --bin)
+                {
+                    accBox.expand(binBoxes[bin]);
+                    accCount += binCounts[bin];
+                    rightAreas[bin] = accBox.surfaceArea();
+                    rightCounts[bin] = accCount;
+                }
+
+                /* Sweep from the left and evaluate split costs */
+                accBox = glutils::BoundingBox();
+                accCount = 0U;
+                for (size_t bin = 1U; bin < SAH_BIN_COUNT; ++bin)
+                {
+                    accBox.expand(binBoxes[bin - 1U]);
+                    accCount += binCounts[bin - 1U];
+                    if ((accCount > 0U) && (rightCounts[bin] > 0U))
+                    {
+                        float cost = (accBox.surfaceArea() * static_cast<float>(accCount)) + (rightAreas[bin] * static_cast<float>(rightCounts[bin]));
+                        if (cost < bestCost)
+                        {
+                            bestCost = cost;
+                            bestAxis = static_cast<int32_t>(axis);
+                            bestSplit = bin;
+                        }
+                    }
+                }
+            }
+        }
+
+        size_t mid = begin;
+        if (bestAxis >= 0)
+        {
+            /* Partition items on the best split */
+            float scale = static_cast<float>(SAH_BIN_COUNT) / centroidSize[bestAxis];
+            float minCentroid = centroidBox.min()[bestAxis];
+            auto midIt = std::partition(items.begin() + begin, items.begin() + end, [&](uint32_t item)
+            {
+                size_t bin = std::min(SAH_BIN_COUNT - 1U, static_cast<size_t>((centroids[item][bestAxis] - minCentroid) * scale));
+                return (bin < bestSplit);
+            });
+            mid = static_cast<size_t>(midIt - items.begin());
+        }
+
+        if ((mid == begin) || (mid == end))
+        {
+            /* Degenerate bounds: median split on the largest centroid axis */
+            size_t axis = 0U;
+            for (size_t i = 1U; i < 3U; ++i)
+            {
+                axis = (centroidSize[i] > centroidSize[axis]) ? (i) : (axis);
+            }
+            mid = (begin + end) / 2U;
+            std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end, [&](uint32_t lhs, uint32_t rhs)
+            {
+                return (centroids[lhs][axis] < centroids[rhs][axis]);
+            });
+        }
+
+        /* Build children, nodes are referenced by index as the node vector can grow */
+        int32_t left = buildRecursive(items, centroids, begin, mid, index);
+        int32_t right = buildRecursive(items, centroids, mid, end, index);
+        m_nodes[index].box = box;
+        m_nodes[index].left = left;
+        m_nodes[index].right = right;
+
+        return index;
+    }
+
+    void Bvh::insertLeaf(int32_t leaf)
+    {
+        /* First leaf becomes the root */
+        if (m_root < 0)
+        {
+            m_root = leaf;
+            m_nodes[leaf].parent = -1;
+            return;
+        }
+
+        /* Descend the tree choosing the child with the lowest SAH cost increase */
+        glutils::BoundingBox leafBox = m_nodes[leaf].box;
+        int32_t index = m_root;
+        while (m_nodes[index].item < 0)
+        {
+            const TreeNode& node = m_nodes[index];
+
+            glutils::BoundingBox combinedBox = node.box;
+            combinedBox.expand(leafBox);
+            float combinedArea = combinedBox.surfaceArea();
+
+            /* Cost of creating a new parent for this node and the leaf */
+            float cost = 2.F * combinedArea;
+
+            /* Minimum cost of pushing the leaf further down the tree */
+            float inheritanceCost = 2.F * (combinedArea - node.box.surfaceArea());
+
+            float childCosts[2];
+            int32_t children[2] = { node.left, node.right };
+            for (size_t i = 0; i < 2; ++i)
+            {
+                const TreeNode& child = m_nodes[children[i]];
+                glutils::BoundingBox childBox = leafBox;
+                childBox.expand(child.box);
+                childCosts[i] = childBox.surfaceArea() + inheritanceCost;
+                if (child.item < 0)
+                {
+                    childCosts[i] -= child.box.surfaceArea();
+                }
+            }
+
+            if ((cost < childCosts[0]) && (cost < childCosts[1]))
+            {
+                break;
+            }
+
+            index = (childCosts[0] < childCosts[1]) ? (children[0]) : (children[1]);
+        }
+
+        /* Create a new parent for the sibling and the leaf */
+        int32_t sibling = index;
+        int32_t oldParent = m_nodes[sibling].parent;
+        int32_t newParent = allocateNode();
+        m_nodes[newParent].parent = oldParent;
+        m_nodes[newParent].box = leafBox;
+        m_nodes[newParent].box.expand(m_nodes[sibling].box);
+        m_nodes[newParent].left = sibling;
+        m_nodes[newParent].right = leaf;
+        m_nodes[sibling].parent = newParent;
+        m_nodes[leaf].parent = newParent;
+
+        if (oldParent < 0)
+        {
+            m_root = newParent;
+        }
+        else
+        {
+            if (m_nodes[oldParent].left == sibling)
+            {
+                m_nodes[oldParent].left = newParent;
+            }
+            else
+            {
+                m_nodes[oldParent].right = newParent;
+            }
+            refitFrom(oldParent);
+        }
+    }
+
+    void Bvh::removeLeaf(int32_t leaf)
+    {
+        /* Removing the root leaves an empty tree */
+        if (leaf == m_root)
+        {
+            m_root = -1;
+            return;
+        }
+
+        /* Replace the parent with the sibling */
+        int32_t parent = m_nodes[leaf].parent;
+        int32_t grandParent = m_nodes[parent].parent;
+        int32_t sibling = (m_nodes[parent].left == leaf) ? (m_nodes[parent].right) : (m_nodes[parent].left);
+        m_nodes[sibling].parent = grandParent;
+
+        if (grandParent < 0)
+        {
+            m_root = sibling;
+        }
+        else
+        {
+            if (m_nodes[grandParent].left == parent)
+            {
+                m_nodes[grandParent].left = sibling;
+            }
+            else
+            {
+                m_nodes[grandParent].right = sibling;
+            }
+            refitFrom(grandParent);
+        }
+
+        releaseNode(parent);
+    }
+
+    void Bvh::refitFrom(int32_t index)
+    {
+        /* Walk up until the root or until a box does not change */
+        while (index >= 0)
+        {
+            TreeNode& node = m_nodes[index];
+            glutils::BoundingBox box = m_nodes[node.left].box;
+            box.expand(m_nodes[node.right].box);
+            if (sameBox(box, node.box))
+            {
+                break;
+            }
+            node.box = box;
+            index = node.parent;
+        }
+    }
+
+    void Bvh::setUnbounded(uint32_t item, bool unbounded)
+    {
+        int32_t listIndex = m_items[item].unbounded;
+        if (unbounded && (listIndex < 0))
+        {
+            /* Append to list */
+            m_items[item].unbounded = static_cast<int32_t>(m_unboundedItems.size());
+            m_unboundedItems.push_back(item);
+        }
+        else if ((!unbounded) && (listIndex >= 0))
+        {
+            /* Swap with last and remove */
+            uint32_t lastItem = m_unboundedItems.back();
+            m_unboundedItems[listIndex] = lastItem;
+            m_items[lastItem].unbounded = listIndex;
+            m_unboundedItems.pop_back();
+            m_items[item].unbounded = -1;
+        }
+    }
+}
+
+}
@@ -0,0 +1,719 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/core/ClusteredLighting.hpp"
+#include "ares/core/SpotLight.hpp"
+#include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/Profiler.hpp"
+#include "ares/glutils/Simd.hpp"
+
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace ares
+{
+
+namespace core
+{
+    constexpr uint32_t ClusteredLighting::TILES_X;
+    constexpr uint32_t ClusteredLighting::TILES_Y;
+    constexpr uint32_t ClusteredLighting::SLICES;
+    constexpr uint32_t ClusteredLighting::MAX_DIRECTIONAL_LIGHTS;
+    constexpr uint32_t ClusteredLighting::MAX_CLUSTER_LIGHTS;
+    constexpr uint32_t ClusteredLighting::MAX_LIGHTS;
+    constexpr int32_t ClusteredLighting::GRID_TEX_UNIT;
+    constexpr int32_t ClusteredLighting::INDEX_TEX_UNIT;
+    constexpr int32_t ClusteredLighting::LIGHT_TEX_UNIT;
+
+    /* Uniform names */
+    constexpr char CLUSTER_SCALE_UNIF_NAME[]  = "u_clusterScale";
+    constexpr char CLUSTER_PARAMS_UNIF_NAME[] = "u_clusterParams";
+    constexpr char GRID_TEX_UNIF_NAME[]       = "u_clusterGridTex";
+    constexpr char INDEX_TEX_UNIF_NAME[]      = "u_clusterIndexTex";
+    constexpr char LIGHT_TEX_UNIF_NAME[]      = "u_lightDataTex";
+
+    /* Texture layout, the shader header below must match it */
+    constexpr uint32_t INDEX_TEX_WIDTH     = 1024U;
+    constexpr uint32_t LIGHT_TEXELS        = 3U;
+    constexpr uint32_t LIGHTS_PER_ROW      = 128U;
+    constexpr uint32_t LIGHT_FLOATS        = LIGHT_TEXELS * 4U;
+    constexpr uint32_t LIGHT_TEX_WIDTH     = LIGHTS_PER_ROW * LIGHT_TEXELS;
+
+    /* Clustering limits */
+    constexpr float MIN_NEAR_DEPTH          = 0.01F;
+    constexpr float DEFAULT_MAX_DEPTH       = 1000.F;
+    constexpr size_t SLICE_GRAIN_SIZE       = 4U;
+
+    /*
+     * The header is inserted after the version directive, so it sets its own
+     * default precision: the list offsets and light indices need highp floats.
+     * Grid: 16x8 tiles, 24 slices; index texture width: 1024; light data
+     * texture width: 384 (3 texels per light, 128 lights per row).
+     */
+    const char ClusteredLighting::FRAG_SHADER_HEADER[] =
+        "#define ARES_CLUSTERED_LIGHTING\n"
+        "#define ARES_MAX_LIGHTS 68\n"
+        "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+        "precision highp float;\n"
+        "#else\n"
+        "precision mediump float;\n"
+        "#endif\n"
+        "uniform vec4 u_clusterScale;\n"
+        "uniform vec4 u_clusterParams;\n"
+        "uniform sampler2D u_clusterGridTex;\n"
+        "uniform sampler2D u_clusterIndexTex;\n"
+        "uniform sampler2D u_lightDataTex;\n"
+        "float aresLightCount(vec3 viewPos, out float listOffset)\n"
+        "{\n"
+        "  vec2 tile = clamp(floor(gl_FragCoord.xy * u_clusterScale.xy), vec2(0.0), vec2(15.0, 7.0));\n"
+        "  float slice = clamp(floor(log(max(-viewPos.z, 0.0001)) * u_clusterScale.z + u_clusterScale.w), 0.0, 23.0);\n"
+        "  vec4 cell = floor(texture2D(u_clusterGridTex, vec2((slice * 16.0 + tile.x + 0.5) / 384.0, (tile.y + 0.5) / 8.0)) * 255.0 + 0.5);\n"
+        "  listOffset = cell.r + cell.g * 256.0 + cell.b * 65536.0;\n"
+        "  return u_clusterParams.x + cell.a * u_clusterParams.y;\n"
+        "}\n"
+        "void aresLight(float i, float listOffset, vec3 viewPos, out vec3 L, out vec3 radiance)\n"
+        "{\n"
+        "  float lightIndex = i;\n"
+        "  if (i >= u_clusterParams.x)\n"
+        "  {\n"
+        "    float idx = listOffset + i - u_clusterParams.x;\n"
+        "    float idxRow = floor(idx / 1024.0);\n"
+        "    vec4 entry = texture2D(u_clusterIndexTex, vec2((idx - idxRow * 1024.0 + 0.5) / 1024.0, (idxRow + 0.5) * u_clusterParams.z));\n"
+        "    lightIndex = floor(entry.r * 255.0 + 0.5) + floor(entry.a * 255.0 + 0.5) * 256.0;\n"
+        "  }\n"
+        "  float lightRow = floor(lightIndex / 128.0);\n"
+        "  float u = (lightIndex - lightRow * 128.0) * 3.0;\n"
+        "  float v = (lightRow + 0.5) * u_clusterParams.w;\n"
+        "  vec4 t0 = texture2D(u_lightDataTex, vec2((u + 0.5) / 384.0, v));\n"
+        "  vec4 t1 = texture2D(u_lightDataTex, vec2((u + 1.5) / 384.0, v));\n"
+        "  vec4 t2 = texture2D(u_lightDataTex, vec2((u + 2.5) / 384.0, v));\n"
+        "  if (i < u_clusterParams.x)\n"
+        "  {\n"
+        "    L = -t2.xyz;\n"
+        "    radiance = t1.rgb;\n"
+        "  }\n"
+        "  else\n"
+        "  {\n"
+        "    vec3 toLight = t0.xyz - viewPos;\n"
+        "    float dist2 = max(dot(toLight, toLight), 0.0001);\n"
+        "    L = toLight * inversesqrt(dist2);\n"
+        "    float x = dist2 * t0.w;\n"
+        "    float rangeAtt = clamp(1.0 - x * x, 0.0, 1.0);\n"
+        "    float spotAtt = clamp(dot(t2.xyz, -L) * t1.w + t2.w, 0.0, 1.0);\n"
+        "    radiance = t1.rgb * (rangeAtt * rangeAtt * spotAtt * spotAtt / dist2);\n"
+        "  }\n"
+        "}\n";
+
+    /* Lighting currently bound for the materials */
+    static const ClusteredLighting* sg_currentLighting = nullptr;
+
+    /*!
+     * @brief Converts a float to a half float
+     * 
+     * Values too large are converted to infinity, values too small to zero.
+     * 
+     * @param[in] f - Float value
+     * @return Half float bits
+     */
+    static uint16_t floatToHalf(float f)
+    {
+        uint32_t bits = 0U;
+        std::memcpy(&bits, &f, sizeof(bits));
+        const uint32_t sign = (bits >> 16) & 0x8000U;
+        const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFU) - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFFU;
+
+        uint32_t retval = sign;
+        if (exponent >= 31)
+        {
+            retval |= 0x7C00U;
+        }
+        else if (exponent > 0)
+        {
+            retval |= (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        }
+        else if (exponent >= -10)
+        {
+            mantissa |= 0x800000U;
+            retval |= mantissa >> static_cast<uint32_t>(14 - exponent);
+        }
+        return static_cast<uint16_t>(retval);
+    }
+
+    ClusteredLighting::ClusteredLighting()
+        : m_maxDepth(DEFAULT_MAX_DEPTH)
+        , m_lightDataType(0)
+        , m_projectionMatrix()
+        , m_boundsDirty(true)
+        , m_near(MIN_NEAR_DEPTH)
+        , m_far(DEFAULT_MAX_DEPTH)
+        , m_clusterScale()
+        , m_clusterParams(0.F, 0.F, 1.F, 1.F)
+        , m_sliceDepths(SLICES + 1U)
+        , m_clusterMinX(SLICES * TILES_X)
+        , m_clusterMaxX(SLICES * TILES_X)
+        , m_clusterMinY(SLICES * TILES_Y)
+        , m_clusterMaxY(SLICES * TILES_Y)
+        , m_lightBounds()
+        , m_clusterLights(SLICES * TILES_Y * TILES_X)
+        , m_sliceDropped(SLICES)
+        , m_gridData()
+        , m_indexData()
+        , m_lightData()
+        , m_halfLightData()
+        , m_gridTex()
+        , m_indexTex()
+        , m_lightTex()
+        , m_stats()
+    {
+    }
+
+    bool ClusteredLighting::isSupported()
+    {
+        return glutils::GlUtils::hasExtension("GL_OES_texture_float") || glutils::GlUtils::hasExtension("GL_OES_texture_half_float");
+    }
+
+    void ClusteredLighting::setMaxDepth(float maxDepth)
+    {
+        m_maxDepth = maxDepth;
+        m_boundsDirty = true;
+    }
+
+    void ClusteredLighting::update(const std::vector<LightNodePtr>& lightVec, const glutils::Mat4& projectionMatrix, int32_t viewportWidth, int32_t viewportHeight, TaskPool* taskPool)
+    {
+        ARES_PROFILE_SCOPE("render", "ClusteredLighting::update");
+
+        /* Choose the light data type once, nothing to do if unsupported */
+        if (0 == m_lightDataType)
+        {
+            if (glutils::GlUtils::hasExtension("GL_OES_texture_float"))
+            {
+                m_lightDataType = GL_FLOAT;
+            }
+            else if (glutils::GlUtils::hasExtension("GL_OES_texture_half_float"))
+            {
+                m_lightDataType = GL_HALF_FLOAT_OES;
+            }
+            else
+            {
+                m_stats = Stats();
+                return;
+            }
+        }
+
+        /* Recompute the cluster bounds if the projection changed */
+        if (m_boundsDirty || (projectionMatrix != m_projectionMatrix))
+        {
+            updateClusterBounds(projectionMatrix);
+        }
+        m_clusterScale[0] = static_cast<float>(TILES_X) / static_cast<float>(std::max(viewportWidth, 1));
+        m_clusterScale[1] = static_cast<float>(TILES_Y) / static_cast<float>(std::max(viewportHeight, 1));
+        m_stats = Stats();
+
+        /* Pack the directional lights first, they affect all clusters */
+        m_lightData.clear();
+        m_lightBounds.clear();
+        for (const LightNodePtr& lightNode : lightVec)
+        {
+            const LightPtr light = lightNode->light();
+            if ((nullptr == light) || (Light::Type::Directional != light->type()))
+            {
+                continue;
+            }
+            if (MAX_DIRECTIONAL_LIGHTS == m_stats.directionalLights)
+            {
+                ++m_stats.droppedLights;
+                continue;
+            }
+
+            const glutils::Vec3& dir = lightNode->lightDirection();
+            const glutils::Vec3& color = light->color();
+            const float intensity = light->intensity();
+            const float data[LIGHT_FLOATS] = {
+                                               0.F, 0.F, 0.F, 0.F,
+                                               color[0] * intensity, color[1] * intensity, color[2] * intensity, 0.F,
+                                               dir[0], dir[1], dir[2], 1.F
+                                             };
+            m_lightData.insert(m_lightData.end(), data, data + LIGHT_FLOATS);
+            ++m_stats.directionalLights;
+        }
+        uint32_t lightCount = m_stats.directionalLights;
+
+        /* Pack the point and spot lights which can affect a cluster */
+        for (const LightNodePtr& lightNode : lightVec)
+        {
+            const LightPtr light = lightNode->light();
+            if ((nullptr == light) || ((Light::Type::Point != light->type()) && (Light::Type::Spotlight != light->type())))
+            {
+                continue;
+            }
+            if (MAX_LIGHTS == lightCount)
+            {
+                ++m_stats.droppedLights;
+                continue;
+            }
+
+            LightBounds bounds;
+            const float range = std::max(light->effectiveRange(), MIN_NEAR_DEPTH);
+            if (!computeLightBounds(lightNode->lightPosition(), range, bounds))
+            {
+                continue;
+            }
+            bounds.index = static_cast<uint16_t>(lightCount);
+            m_lightBounds.push_back(bounds);
+
+            /* Spot cone falloff as a scale and offset of the cosine of the angle from the axis */
+            float spotScale = 0.F;
+            float spotOffset = 1.F;
+            if (Light::Type::Spotlight == light->type())
+            {
+                static_cast<const SpotLight&>(*light).coneFalloff(spotScale, spotOffset);
+            }
+
+            const glutils::Vec3& pos = lightNode->lightPosition();
+            const glutils::Vec3& dir = lightNode->lightDirection();
+            const glutils::Vec3& color = light->color();
+            const float intensity = light->intensity();
+            const float data[LIGHT_FLOATS] = {
+                                               pos[0], pos[1], pos[2], 1.F / (range * range),
+                                               color[0] * intensity, color[1] * intensity, color[2] * intensity, spotScale,
+                                               dir[0], dir[1], dir[2], spotOffset
+                                             };
+            m_lightData.insert(m_lightData.end(), data, data + LIGHT_FLOATS);
+            ++lightCount;
+        }
+        m_stats.lights = lightCount;
+
+        /* Assign the lights to the clusters, slices are independent */
+        if (nullptr != taskPool)
+        {
+            taskPool->parallelFor(SLICES, SLICE_GRAIN_SIZE, [this](size_t, size_t begin, size_t end)
+            {
+                for (size_t s = begin; s < end; ++s)
+                {
+                    binSlice(static_cast<uint32_t>(s));
+                }
+            });
+        }
+        else
+        {
+            for (uint32_t s = 0U; s < SLICES; ++s)
+            {
+                binSlice(s);
+            }
+        }
+
+        uploadTextures(lightCount);
+    }
+
+    void ClusteredLighting::bind()
+    {
+        /* Nothing to bind if the textures were never uploaded */
+        if ((nullptr == m_gridTex) || (nullptr == m_indexTex) || (nullptr == m_lightTex))
+        {
+            return;
+        }
+
+        m_gridTex->activate(GRID_TEX_UNIT);
+        m_indexTex->activate(INDEX_TEX_UNIT);
+        m_lightTex->activate(LIGHT_TEX_UNIT);
+        sg_currentLighting = this;
+    }
+
+    void ClusteredLighting::unbind()
+    {
+        if (this == sg_currentLighting)
+        {
+            m_gridTex->deactivate();
+            m_indexTex->deactivate();
+            m_lightTex->deactivate();
+            sg_currentLighting = nullptr;
+        }
+    }
+
+    void ClusteredLighting::resolveUniforms(glutils::Shader& shader, UniformHandles& handles)
+    {
+        handles.clusterScale  = shader.uniformHandle<glutils::Uniform4f>(CLUSTER_SCALE_UNIF_NAME);
+        handles.clusterParams = shader.uniformHandle<glutils::Uniform4f>(CLUSTER_PARAMS_UNIF_NAME);
+        shader.setSampler(GRID_TEX_UNIF_NAME, GRID_TEX_UNIT);
+        shader.setSampler(INDEX_TEX_UNIF_NAME, INDEX_TEX_UNIT);
+        shader.setSampler(LIGHT_TEX_UNIF_NAME, LIGHT_TEX_UNIT);
+    }
+
+    void ClusteredLighting::setUniforms(glutils::Shader& shader, const UniformHandles& handles)
+    {
+        /* Without a current lighting, the light count evaluates to zero */
+        if (nullptr != sg_currentLighting)
+        {
+            /* Bind the textures again, their units are shared with the light buffer of the light pre-pass */
+            sg_currentLighting->m_gridTex->activate(GRID_TEX_UNIT);
+            sg_currentLighting->m_indexTex->activate(INDEX_TEX_UNIT);
+            sg_currentLighting->m_lightTex->activate(LIGHT_TEX_UNIT);
+            shader.setUniform(handles.clusterScale, sg_currentLighting->m_clusterScale);
+            shader.setUniform(handles.clusterParams, sg_currentLighting->m_clusterParams);
+        }
+        else
+        {
+            shader.setUniform(handles.clusterScale, glutils::Vec4(0.F, 0.F, 0.F, 0.F));
+            shader.setUniform(handles.clusterParams, glutils::Vec4(0.F, 0.F, 1.F, 1.F));
+        }
+    }
+
+    void ClusteredLighting::updateClusterBounds(const glutils::Mat4& projectionMatrix)
+    {
+        m_projectionMatrix = projectionMatrix;
+        m_boundsDirty = false;
+
+        /* Column-major projection entries */
+        const float* p = projectionMatrix.const_data();
+        const float p00 = p[0];
+        const float p11 = p[5];
+        const float p02 = p[8];
+        const float p12 = p[9];
+        const float p22 = p[10];
+        const float p32 = p[11];
+        const float p03 = p[12];
+        const float p13 = p[13];
+        const float p23 = p[14];
+        const float p33 = p[15];
+
+        /* Extract the near and far planes, the far plane may be at infinity */
+        float nearDepth = 0.F;
+        float farDepth = std::numeric_limits<float>::infinity();
+        if (0.F != p32)
+        {
+            nearDepth = p23 / (p22 - 1.F);
+            if (std::fabs(p22 + 1.F) > 1e-6F)
+            {
+                farDepth = p23 / (p22 + 1.F);
+            }
+        }
+        else
+        {
+            nearDepth = (p23 + 1.F) / p22;
+            farDepth = (p23 - 1.F) / p22;
+        }
+        m_near = std::max(nearDepth, MIN_NEAR_DEPTH);
+        m_far = std::max(farDepth, m_near);
+
+        /* Distribute the slices exponentially up to the maximum clustered depth */
+        const float clusteredFar = std::max(std::min(m_far, m_maxDepth), 2.F * m_near);
+        const float sliceScale = static_cast<float>(SLICES) / std::log(clusteredFar / m_near);
+        const float sliceBias = -std::log(m_near) * sliceScale;
+        m_clusterScale[2] = sliceScale;
+        m_clusterScale[3] = sliceBias;
+        for (uint32_t s = 0U; s <= SLICES; ++s)
+        {
+            m_sliceDepths[s] = std::exp((static_cast<float>(s) - sliceBias) / sliceScale);
+        }
+        m_sliceDepths[SLICES] = clusteredFar;
+
+        /* View coordinate of a NDC coordinate at a view depth */
+        auto viewCoord = [p32, p33](float ndc, float z, float scale, float offsetZ, float offset)
+        {
+            return (ndc * (p32 * z + p33) - offsetZ * z - offset) / scale;
+        };
+
+        /* Cluster bounds are the AABBs of the tile sub-frusta between the slice depths */
+        for (uint32_t s = 0U; s < SLICES; ++s)
+        {
+            const float z0 = -m_sliceDepths[s];
+            const float z1 = -m_sliceDepths[s + 1U];
+            for (uint32_t t = 0U; t < TILES_X; ++t)
+            {
+                const float ndc0 = -1.F + 2.F * static_cast<float>(t) / static_cast<float>(TILES_X);
+                const float ndc1 = -1.F + 2.F * static_cast<float>(t + 1U) / static_cast<float>(TILES_X);
+                const float x[4] = {
+                                     viewCoord(ndc0, z0, p00, p02, p03), viewCoord(ndc0, z1, p00, p02, p03),
+                                     viewCoord(ndc1, z0, p00, p02, p03), viewCoord(ndc1, z1, p00, p02, p03)
+                                   };
+                m_clusterMinX[s * TILES_X + t] = *std::min_element(x, x + 4);
+                m_clusterMaxX[s * TILES_X + t] = *std::max_element(x, x + 4);
+            }
+            for (uint32_t t = 0U; t < TILES_Y; ++t)
+            {
+                const float ndc0 = -1.F + 2.F * static_cast<float>(t) / static_cast<float>(TILES_Y);
+                const float ndc1 = -1.F + 2.F * static_cast<float>(t + 1U) / static_cast<float>(TILES_Y);
+                const float y[4] = {
+                                     viewCoord(ndc0, z0, p11, p12, p13), viewCoord(ndc0, z1, p11, p12, p13),
+                                     viewCoord(ndc1, z0, p11, p12, p13), viewCoord(ndc1, z1, p11, p12, p13)
+                                   };
+                m_clusterMinY[s * TILES_Y + t] = *std::min_element(y, y + 4);
+                m_clusterMaxY[s * TILES_Y + t] = *std::max_element(y, y + 4);
+            }
+        }
+    }
+
+    bool ClusteredLighting::computeLightBounds(const glutils::Vec3& position, float radius, LightBounds& bounds) const
+    {
+        /* Cull the lights in front of the near plane or beyond the far plane */
+        const float depth = -position[2];
+        if ((depth + radius < m_near) || (depth - radius > m_far))
+        {
+            return false;
+        }
+
+        bounds.position[0] = position[0];
+        bounds.position[1] = position[1];
+        bounds.position[2] = position[2];
+        bounds.radius = radius;
+
+        /* Slice range of the sphere depth range */
+        auto sliceIndex = [this](float d)
+        {
+            const float s = std::floor(std::log(d) * m_clusterScale[2] + m_clusterScale[3]);
+            return static_cast<uint8_t>(std::min(std::max(s, 0.F), static_cast<float>(SLICES - 1U)));
+        };
+        bounds.slice0 = sliceIndex(std::max(depth - radius, m_near));
+        bounds.slice1 = sliceIndex(depth + radius);
+
+        /* Lights crossing the near plane cover the whole screen */
+        bounds.tileX0 = 0U;
+        bounds.tileX1 = static_cast<uint8_t>(TILES_X - 1U);
+        bounds.tileY0 = 0U;
+        bounds.tileY1 = static_cast<uint8_t>(TILES_Y - 1U);
+        if (depth - radius <= m_near)
+        {
+            return true;
+        }
+
+        /* Otherwise project the corners of the sphere AABB, all in front of the near plane */
+        const float* p = m_projectionMatrix.const_data();
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = -std::numeric_limits<float>::max();
+        float maxY = -std::numeric_limits<float>::max();
+        for (uint32_t corner = 0U; corner < 8U; ++corner)
+        {
+            const float x = position[0] + ((0U != (corner & 1U)) ? (radius) : (-radius));
+            const float y = position[1] + ((0U != (corner & 2U)) ? (radius) : (-radius));
+            const float z = position[2] + ((0U != (corner & 4U)) ? (radius) : (-radius));
+            const float invW = 1.F / (p[3] * x + p[7] * y + p[11] * z + p[15]);
+            const float ndcX = (p[0] * x + p[4] * y + p[8] * z + p[12]) * invW;
+            const float ndcY = (p[1] * x + p[5] * y + p[9] * z + p[13]) * invW;
+            minX = std::min(minX, ndcX);
+            maxX = std::max(maxX, ndcX);
+            minY = std::min(minY, ndcY);
+            maxY = std::max(maxY, ndcY);
+        }
+        if ((maxX < -1.F) || (minX > 1.F) || (maxY < -1.F) || (minY > 1.F))
+        {
+            return false;
+        }
+
+        auto tileIndex = [](float ndc, uint32_t tiles)
+        {
+            const float t = std::floor((ndc + 1.F) * 0.5F * static_cast<float>(tiles));
+            return static_cast<uint8_t>(std::min(std::max(t, 0.F), static_cast<float>(tiles - 1U)));
+        };
+        bounds.tileX0 = tileIndex(minX, TILES_X);
+        bounds.tileX1 = tileIndex(maxX, TILES_X);
+        bounds.tileY0 = tileIndex(minY, TILES_Y);
+        bounds.tileY1 = tileIndex(maxY, TILES_Y);
+        return true;
+    }
+
+    void ClusteredLighting::binSlice(uint32_t slice)
+    {
+        /* Clear the lists of the slice */
+        std::vector<uint16_t>* sliceLists = &m_clusterLights[slice * TILES_Y * TILES_X];
+        for (uint32_t c = 0U; c < TILES_Y * TILES_X; ++c)
+        {
+            sliceLists[c].clear();
+        }
+
+        /* The last slice also holds the fragments beyond the clustered depth, its XY bounds do not apply there */
+        const float nearDepth = m_sliceDepths[slice];
+        const float farDepth = m_sliceDepths[slice + 1U];
+        const bool openSlice = ((SLICES - 1U) == slice) && (m_far > farDepth);
+        const float* minX = &m_clusterMinX[slice * TILES_X];
+        const float* maxX = &m_clusterMaxX[slice * TILES_X];
+        const float* minY = &m_clusterMinY[slice * TILES_Y];
+        const float* maxY = &m_clusterMaxY[slice * TILES_Y];
+        const glutils::Float4 zero = glutils::Float4::splat(0.F);
+        const glutils::Float4 lanes = glutils::Float4::set(0.F, 1.F, 2.F, 3.F);
+
+        uint32_t dropped = 0U;
+        for (const LightBounds& bounds : m_lightBounds)
+        {
+            if ((slice < bounds.slice0) || (slice > bounds.slice1))
+            {
+                continue;
+            }
+
+            /* Squared distance along the depth from the slice */
+            const float depth = -bounds.position[2];
+            const float dz = std::max(std::max(nearDepth - depth, 0.F), openSlice ? (0.F) : (depth - farDepth));
+            const float radius2 = bounds.radius * bounds.radius;
+            const glutils::Float4 px = glutils::Float4::splat(bounds.position[0]);
+            const glutils::Float4 firstTile = glutils::Float4::splat(static_cast<float>(bounds.tileX0));
+            const glutils::Float4 lastTile = glutils::Float4::splat(static_cast<float>(bounds.tileX1) + 1.F);
+
+            for (uint32_t ty = bounds.tileY0; ty <= bounds.tileY1; ++ty)
+            {
+                /* Squared distance left for the X axis after the Y and depth axes */
+                float remaining = radius2 - dz * dz;
+                if (!openSlice)
+                {
+                    const float dy = std::max(std::max(minY[ty] - bounds.position[1], bounds.position[1] - maxY[ty]), 0.F);
+                    remaining -= dy * dy;
+                }
+                if (remaining < 0.F)
+                {
+                    continue;
+                }
+                const glutils::Float4 remaining4 = glutils::Float4::splat(openSlice ? (std::numeric_limits<float>::max()) : (remaining));
+
+                /* Test four tiles of the row at a time */
+                for (uint32_t tx = bounds.tileX0 & ~3U; tx <= bounds.tileX1; tx += 4U)
+                {
+                    const glutils::Float4 dx = glutils::Float4::max(glutils::Float4::max(glutils::Float4::load(minX + tx) - px, px - glutils::Float4::load(maxX + tx)), zero);
+                    const glutils::Float4 tileIdx = glutils::Float4::splat(static_cast<float>(tx)) + lanes;
+                    const uint32_t mask = glutils::Float4::lessMask(dx * dx, remaining4)
+                                        & (~glutils::Float4::lessMask(tileIdx, firstTile))
+                                        & glutils::Float4::lessMask(tileIdx, lastTile);
+                    for (uint32_t lane = 0U; lane < 4U; ++lane)
+                    {
+                        if (0U != (mask & (1U << lane)))
+                        {
+                            std::vector<uint16_t>& list = sliceLists[ty * TILES_X + tx + lane];
+                            if (list.size() < MAX_CLUSTER_LIGHTS)
+                            {
+                                list.push_back(bounds.index);
+                            }
+                            else
+                            {
+                                ++dropped;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        m_sliceDropped[slice] = dropped;
+    }
+
+    void ClusteredLighting::uploadTextures(uint32_t lightCount)
+    {
+        /* Pack the grid, each cell holds the offset of its list in RGB and the list size in A */
+        constexpr uint32_t gridWidth = TILES_X * SLICES;
+        m_gridData.resize(gridWidth * TILES_Y * 4U);
+        m_indexData.clear();
+        uint32_t offset = 0U;
+        for (uint32_t s = 0U; s < SLICES; ++s)
+        {
+            for (uint32_t ty = 0U; ty < TILES_Y; ++ty)
+            {
+                for (uint32_t tx = 0U; tx < TILES_X; ++tx)
+                {
+                    const std::vector<uint16_t>& list = m_clusterLights[(s * TILES_Y + ty) * TILES_X + tx];
+                    uint8_t* cell = &m_gridData[(ty * gridWidth + s * TILES_X + tx) * 4U];
+                    cell[0] = static_cast<uint8_t>(offset & 0xFFU);
+                    cell[1] = static_cast<uint8_t>((offset >> 8) & 0xFFU);
+                    cell[2] = static_cast<uint8_t>((offset >> 16) & 0xFFU);
+                    cell[3] = static_cast<uint8_t>(list.size());
+                    for (uint16_t index : list)
+                    {
+                        m_indexData.push_back(static_cast<uint8_t>(index & 0xFFU));
+                        m_indexData.push_back(static_cast<uint8_t>(index >> 8));
+                    }
+                    offset += static_cast<uint32_t>(list.size());
+                    m_stats.maxClusterLights = std::max(m_stats.maxClusterLights, static_cast<uint32_t>(list.size()));
+                }
+            }
+        }
+        m_stats.lightIndices = offset;
+        for (uint32_t dropped : m_sliceDropped)
+        {
+            m_stats.droppedLights += dropped;
+        }
+
+        /* Pad the index list to whole rows */
+        const uint32_t indexRows = std::max((offset + INDEX_TEX_WIDTH - 1U) / INDEX_TEX_WIDTH, 1U);
+        m_indexData.resize(indexRows * INDEX_TEX_WIDTH * 2U, 0U);
+
+        /* Pad the light data to whole rows, the light texture never shrinks */
+        uint32_t lightRows = std::max((lightCount + LIGHTS_PER_ROW - 1U) / LIGHTS_PER_ROW, 1U);
+        if (nullptr != m_lightTex)
+        {
+            lightRows = std::max(lightRows, static_cast<uint32_t>(m_lightTex->height()));
+        }
+        m_lightData.resize(lightRows * LIGHT_TEX_WIDTH * 4U, 0.F);
+
+        /* Upload the textures */
+        const int32_t gridW = static_cast<int32_t>(gridWidth);
+        const int32_t gridH = static_cast<int32_t>(TILES_Y);
+        if (nullptr == m_gridTex)
+        {
+            m_gridTex = std::make_shared<glutils::Texture>(gridW, gridH, GL_RGBA, GL_UNSIGNED_BYTE, m_gridData.data());
+        }
+        else
+        {
+            m_gridTex->setData(gridW, gridH, m_gridData.data());
+        }
+
+        const int32_t indexW = static_cast<int32_t>(INDEX_TEX_WIDTH);
+        const int32_t indexH = static_cast<int32_t>(indexRows);
+        if (nullptr == m_indexTex)
+        {
+            m_indexTex = std::make_shared<glutils::Texture>(indexW, indexH, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, m_indexData.data());
+        }
+        else
+        {
+            m_indexTex->setData(indexW, indexH, m_indexData.data());
+        }
+
+        const void* lightData = m_lightData.data();
+        if (GL_HALF_FLOAT_OES == m_lightDataType)
+        {
+            m_halfLightData.resize(m_lightData.size());
+            std::transform(m_lightData.begin(), m_lightData.end(), m_halfLightData.begin(), floatToHalf);
+            lightData = m_halfLightData.data();
+        }
+        const int32_t lightW = static_cast<int32_t>(LIGHT_TEX_WIDTH);
+        const int32_t lightH = static_cast<int32_t>(lightRows);
+        if (nullptr == m_lightTex)
+        {
+            m_lightTex = std::make_shared<glutils::Texture>(lightW, lightH, GL_RGBA, m_lightDataType, lightData);
+        }
+        else
+        {
+            m_lightTex->setData(lightW, lightH, lightData);
+        }
+
+        /* Directional light count, list size multiplier and texture row scales */
+        m_clusterParams = glutils::Vec4(static_cast<float>(m_stats.directionalLights), 1.F, 1.F / static_cast<float>(indexRows), 1.F / static_cast<float>(lightRows));
+    }
+}
+
+}
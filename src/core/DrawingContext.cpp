@@ -29,7 +29,12 @@
  *****************************************************************************/
 
 #include "ares/core/DrawingContext.hpp"
+#include "ares/glutils/Framebuffer.hpp"
+#include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/Profiler.hpp"
 
+#include <EGL/eglext.h>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
@@ -45,6 +50,7 @@ namespace core
         , m_eglSurface(EGL_NO_SURFACE)
         , m_eglContext(EGL_NO_CONTEXT)
         , m_active(false)
+        , m_glState()
     {
         /* Check device object validity */
         if ((nullptr == m_device) || (port::DisplayDevice::State::Closed == m_device->state()))
@@ -58,6 +64,9 @@ namespace core
         createEGLSurface();
         createEGLContext();
         activate();
+
+        /* Report OpenGL errors with the debug output if available */
+        glutils::GlUtils::enableDebugOutput();
     }
 
     DrawingContext::~DrawingContext()
@@ -76,6 +85,7 @@ namespace core
             eglMakeCurrent(m_eglDisplay, m_eglSurface, m_eglSurface, m_eglContext);
             checkEGLError("eglMakeCurrent", true);
             m_active = true;
+            glutils::GlState::setCurrent(&m_glState);
         }
     }
 
@@ -88,21 +98,58 @@ namespace core
             eglMakeCurrent(m_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
             checkEGLError("eglMakeCurrent", true);
             m_active = false;
+            glutils::GlState::setCurrent(nullptr);
         }
     }
 
     void DrawingContext::draw() const
     {
+        ARES_PROFILE_SCOPE("render", "DrawingContext::draw");
+
+        /* Check the errors of the frame before presenting it */
+        glutils::GlUtils::checkFrameGLErrors();
+
         /* Swap buffers to refresh screen */
         eglSwapBuffers(m_eglDisplay, m_eglSurface);
         checkEGLError("eglSwapBuffers", true);
     }
 
+    void DrawingContext::readPixels(std::vector<uint8_t>& pixels) const
+    {
+        /* Read the RGBA pixels of the default framebuffer, bottom row first */
+        const int32_t width = m_device->width();
+        const int32_t height = m_device->height();
+        pixels.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 4U);
+        glutils::Framebuffer::bindDefault();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glutils::GlUtils::checkGLError("glReadPixels");
+    }
+
     void DrawingContext::createEGLDisplay()
     {
-        /* Get EGL display from native display */
-        m_eglDisplay = eglGetDisplay(m_device->eglNativeDisplayType());
-        
+        /* Get EGL display of the device platform if the platform extensions are supported */
+        const EGLenum platform = m_device->eglPlatform();
+        if (EGL_NONE != platform)
+        {
+            const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+            PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if ((nullptr != clientExtensions) && (nullptr != std::strstr(clientExtensions, "EGL_EXT_platform_base")) && (nullptr != getPlatformDisplay))
+            {
+                m_eglDisplay = getPlatformDisplay(platform, reinterpret_cast<void*>(m_device->eglNativeDisplayType()), NULL);
+            }
+
+            /* Clear the error of an unsupported platform, the native display is used instead */
+            eglGetError();
+        }
+
+        /* Get EGL display from native display otherwise */
+        if (EGL_NO_DISPLAY == m_eglDisplay)
+        {
+            m_eglDisplay = eglGetDisplay(m_device->eglNativeDisplayType());
+        }
+
         /* Check we could get a valid EGL display */
         if (m_eglDisplay == EGL_NO_DISPLAY)
         {
@@ -129,8 +176,9 @@ namespace core
     {
         /* Choose configuration */
         //TODO Make this configurable by user
+        const EGLint surfaceBit = (port::DisplayDevice::SurfaceType::Pbuffer == m_device->surfaceType()) ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT;
         const EGLint configurationAttributes[] = {
-                                                   EGL_SURFACE_TYPE,    EGL_WINDOW_BIT,
+                                                   EGL_SURFACE_TYPE,    surfaceBit,
                                                    EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
                                                    EGL_DEPTH_SIZE, 16,
                                                    EGL_SAMPLE_BUFFERS, 1,
@@ -146,9 +194,19 @@ namespace core
 
     void DrawingContext::createEGLSurface()
     {
-        /* Create EGL surface from native device */
-        m_eglSurface = eglCreateWindowSurface(m_eglDisplay, m_eglConfig, m_device->eglNativeWindowType(), NULL);
-        checkEGLError("eglCreateWindowSurface", true);
+        if (port::DisplayDevice::SurfaceType::Pbuffer == m_device->surfaceType())
+        {
+            /* Create offscreen EGL surface with the device size */
+            const EGLint pbufferAttributes[] = { EGL_WIDTH, m_device->width(), EGL_HEIGHT, m_device->height(), EGL_NONE };
+            m_eglSurface = eglCreatePbufferSurface(m_eglDisplay, m_eglConfig, pbufferAttributes);
+            checkEGLError("eglCreatePbufferSurface", true);
+        }
+        else
+        {
+            /* Create EGL surface from native device */
+            m_eglSurface = eglCreateWindowSurface(m_eglDisplay, m_eglConfig, m_device->eglNativeWindowType(), NULL);
+            checkEGLError("eglCreateWindowSurface", true);
+        }
     }
 
     void DrawingContext::createEGLContext()
@@ -179,7 +237,7 @@ namespace core
         if (lastError != EGL_SUCCESS)
         {
             /* Print message and throw exception if needed */
-            std::cout << functionLastCalled << " failed (" << lastError << ")" << std::endl;
+            std::cerr << functionLastCalled << " failed (" << lastError << ")" << std::endl;
             if (throwExcpt)
             {
                 throw std::runtime_error("EGL Error");
@@ -29,7 +29,6 @@
  *****************************************************************************/
 
 #include "ares/core/FlatColorMaterial.hpp"
-#include "ares/glutils/ShaderManager.hpp"
 
 namespace ares
 {
@@ -63,7 +62,11 @@ namespace core
         "void main(void)\n"
         "{\n"
         "  v_color = COLOR_0;\n"
+        "#ifdef ARES_INSTANCING\n"
+        "  gl_Position = u_mvp * instanceModelMatrix() * vec4(POSITION, 1.0);\n"
+        "#else\n"
         "  gl_Position = u_mvp * vec4(POSITION, 1.0);\n"
+        "#endif\n"
         "}";
 
     /* Fragment shader code */
@@ -82,32 +85,29 @@ namespace core
         , m_color(c)
     {
         /* Get/compile shader */
-        m_shader = glutils::ShaderManager::getShader(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE);
-        if (nullptr != m_shader)
-        {
-            /* Add uniforms */
-            m_shader->addUniform<glutils::UniformMat4>(MVP_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform4f>(COLOR_UNIF_NAME);
-        }
+        setShaderSources(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE);
     }
 
-    void FlatColorMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    void FlatColorMaterial::resolveUniforms(glutils::Shader& shader, ShaderVariant variant)
     {
-        /* Get uniforms */
-        glutils::UniformMat4Ptr mvpUnif   = m_shader->getUniform<glutils::UniformMat4>(MVP_UNIF_NAME);
-        glutils::Uniform4fPtr   colorUnif = m_shader->getUniform<glutils::Uniform4f>(COLOR_UNIF_NAME);
+        /* Resolve uniform handles */
+        UniformHandles& handles = m_uniforms[static_cast<size_t>(variant)];
+        handles.mvp   = shader.uniformHandle<glutils::UniformMat4>(MVP_UNIF_NAME);
+        handles.color = shader.uniformHandle<glutils::Uniform4f>(COLOR_UNIF_NAME);
+    }
+
+    void FlatColorMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    {
+        /* Get uniform handles of the active variant */
+        const UniformHandles& handles = m_uniforms[static_cast<size_t>(m_activeVariant)];
 
-        /* Make sure uniforms are valid */
-        if ((nullptr != mvpUnif) && (nullptr != colorUnif))
-        {
-            /* Calculate mvp */
-            glutils::Mat4 mvp(projectionMatrix);
-            mvp *= mvMatrix;
+        /* Calculate mvp */
+        glutils::Mat4 mvp(projectionMatrix);
+        mvp *= mvMatrix;
 
-            /* Set uniforms */
-            mvpUnif->setAndCommit(mvp);
-            colorUnif->setAndCommit(m_color.toVec4());
-        }
+        /* Set uniforms */
+        m_activeShader->setUniform(handles.mvp, mvp);
+        m_activeShader->setUniform(handles.color, m_color.toVec4());
     }
 
 }
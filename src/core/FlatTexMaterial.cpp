@@ -29,7 +29,6 @@
  *****************************************************************************/
 
 #include "ares/core/FlatTexMaterial.hpp"
-#include "ares/glutils/ShaderManager.hpp"
 
 #include <stdexcept>
 
@@ -65,7 +64,11 @@ namespace core
         "void main(void)\n"
         "{\n"
         "  v_uv = TEXCOORD_0;\n"
+        "#ifdef ARES_INSTANCING\n"
+        "  gl_Position = u_mvp * instanceModelMatrix() * vec4(POSITION, 1.0);\n"
+        "#else\n"
         "  gl_Position = u_mvp * vec4(POSITION, 1.0);\n"
+        "#endif\n"
         "}";
 
     /* Fragment shader code */
@@ -89,31 +92,31 @@ namespace core
         }
 
         /* Get/compile shader */
-        m_shader = glutils::ShaderManager::getShader(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE);
-        if (nullptr != m_shader)
-        {
-            /* Add uniforms */
-            m_shader->addUniform<glutils::UniformMat4>(MVP_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(TEX_UNIF_NAME);
-        }
+        setShaderSources(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE);
+    }
+
+    void FlatTexMaterial::resolveUniforms(glutils::Shader& shader, ShaderVariant variant)
+    {
+        /* Resolve uniform handles */
+        UniformHandles& handles = m_uniforms[static_cast<size_t>(variant)];
+        handles.mvp = shader.uniformHandle<glutils::UniformMat4>(MVP_UNIF_NAME);
+        shader.setSampler(TEX_UNIF_NAME, 0);
     }
 
-    void FlatTexMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    void FlatTexMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec)
     {
-        /* Get uniforms */
-        glutils::UniformMat4Ptr mvpUnif   = m_shader->getUniform<glutils::UniformMat4>(MVP_UNIF_NAME);
-        glutils::Uniform1iPtr   texUnif   = m_shader->getUniform<glutils::Uniform1i>(TEX_UNIF_NAME);
+        /* Get uniform handles of the active variant */
+        const UniformHandles& handles = m_uniforms[static_cast<size_t>(m_activeVariant)];
 
-        /* Make sure uniforms are valid */
-        if ((nullptr != mvpUnif) && (nullptr != texUnif) && (nullptr != m_texture))
+        /* Make sure texture is valid */
+        if (nullptr != m_texture)
         {
             /* Calculate mvp */
             glutils::Mat4 mvp(projectionMatrix);
             mvp *= mvMatrix;
 
             /* Set uniforms */
-            mvpUnif->setAndCommit(mvp);
-            texUnif->setAndCommit(0);
+            m_activeShader->setUniform(handles.mvp, mvp);
 
             /* Activate texture */
             m_texture->activate(0);
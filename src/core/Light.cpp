@@ -30,14 +30,35 @@
 
 #include "ares/core/Light.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace ares
 {
 
 namespace core
 {
+    /* Attenuated intensity below which a light with infinite range is ignored */
+    constexpr float LIGHT_INTENSITY_CUTOFF = 1.F / 256.F;
+
     Light::Light()
         : m_type(Type::Invalid)
+        , m_color(1.F, 1.F, 1.F)
+        , m_intensity(1.F)
+        , m_range(0.F)
+    {
+    }
+
+    float Light::effectiveRange() const
     {
+        /* Finite range, or distance where intensity / distance^2 reaches the cutoff */
+        float retval = m_range;
+        if (retval <= 0.F)
+        {
+            float maxIntensity = m_intensity * std::max(m_color[0], std::max(m_color[1], m_color[2]));
+            retval = std::sqrt(std::max(maxIntensity, 0.F) / LIGHT_INTENSITY_CUTOFF);
+        }
+        return retval;
     }
 }
 
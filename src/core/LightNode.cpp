@@ -39,6 +39,10 @@ namespace core
         : Node(name, parent)
         , m_light(nullptr)
         , m_lightPosition()
+        , m_lightDirection(0.F, 0.F, -1.F)
+        , m_worldPosition()
+        , m_worldDirection(0.F, 0.F, -1.F)
+        , m_lightPositionDirty(true)
     {
         /* Set type */
         m_type = Type::Light;
@@ -0,0 +1,559 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/core/LightPrePass.hpp"
+#include "ares/core/SpotLight.hpp"
+#include "ares/glutils/GlState.hpp"
+#include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/ShaderManager.hpp"
+
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ares
+{
+
+namespace core
+{
+    constexpr int32_t LightPrePass::LIGHT_BUFFER_TEX_UNIT;
+    constexpr float LightPrePass::LIGHT_BUFFER_SCALE;
+
+    /* Uniform names */
+    constexpr char LIGHT_BUFFER_PARAMS_UNIF_NAME[] = "u_lightBufferParams";
+    constexpr char LIGHT_BUFFER_TEX_UNIF_NAME[]    = "u_lightBufferTex";
+    constexpr char MVPMX_UNIF_NAME[]               = "u_mvpMx";
+    constexpr char INVPMX_UNIF_NAME[]              = "u_invPMx";
+    constexpr char INVVIEWPORT_UNIF_NAME[]         = "u_invViewport";
+    constexpr char LIGHTPOS_UNIF_NAME[]            = "u_lightPos";
+    constexpr char LIGHTCOLOR_UNIF_NAME[]          = "u_lightColor";
+    constexpr char LIGHTDIR_UNIF_NAME[]            = "u_lightDir";
+    constexpr char NORMAL_TEX_UNIF_NAME[]          = "u_normalTex";
+    constexpr char DEPTH_TEX_UNIF_NAME[]           = "u_depthTex";
+
+    /* Texture units of the light shader */
+    constexpr int32_t NORMAL_TEX_UNIT = 0;
+    constexpr int32_t DEPTH_TEX_UNIT  = 1;
+
+    /* Proxy geometry tessellation */
+    constexpr uint32_t SPHERE_RINGS    = 8U;
+    constexpr uint32_t SPHERE_SEGMENTS = 12U;
+    constexpr uint32_t CONE_SEGMENTS   = 16U;
+
+    /* Widest spot cone drawn with the cone proxy, wider ones use the sphere */
+    constexpr float MAX_CONE_PROXY_ANGLE = 1.2F;
+
+    /* Minimum light range, as in the clustered lighting */
+    constexpr float MIN_LIGHT_RANGE = 0.01F;
+
+    /* Clear color of the normal target: normal towards the viewer, packed inverse depth at infinity */
+    constexpr float NORMAL_CLEAR_COLOR[4] = { 0.5F, 0.5F, 0.F, 0.F };
+
+    constexpr float PI = 3.14159265359F;
+
+    /*
+     * The header is inserted after the version directive, so it sets its own
+     * default precision: the fragment coordinates need highp floats on large viewports.
+     */
+    const char LightPrePass::FRAG_SHADER_HEADER[] =
+        "#define ARES_LIGHT_PREPASS\n"
+        "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+        "precision highp float;\n"
+        "#else\n"
+        "precision mediump float;\n"
+        "#endif\n"
+        "uniform vec4 u_lightBufferParams;\n"
+        "uniform sampler2D u_lightBufferTex;\n"
+        "vec4 aresLightBuffer()\n"
+        "{\n"
+        "  return texture2D(u_lightBufferTex, gl_FragCoord.xy * u_lightBufferParams.xy) * u_lightBufferParams.z;\n"
+        "}\n";
+
+    /*
+     * Without depth textures the inverse view depth is packed instead of the
+     * window depth, as gl_FragCoord is mediump; it is scaled by a 0.05 minimum
+     * depth so that its fixed point precision is close to a 16 bit depth buffer.
+     */
+    const char LightPrePass::NORMAL_DEPTH_FRAG_SHADER[] =
+        "#version 100\n"
+        "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+        "precision highp float;\n"
+        "#else\n"
+        "precision mediump float;\n"
+        "#endif\n"
+        "varying vec3 v_pos;\n"
+        "varying vec3 v_norm;\n"
+        "void main()\n"
+        "{\n"
+        "  // Octahedral encoding of the normal\n"
+        "  vec3 N = normalize(v_norm);\n"
+        "  vec2 oct = N.xy / (abs(N.x) + abs(N.y) + abs(N.z));\n"
+        "  if (N.z < 0.0)\n"
+        "  {\n"
+        "    oct = (1.0 - abs(oct.yx)) * vec2((oct.x >= 0.0) ? 1.0 : -1.0, (oct.y >= 0.0) ? 1.0 : -1.0);\n"
+        "  }\n"
+        "  gl_FragColor.rg = oct * 0.5 + 0.5;\n"
+        "#ifdef ARES_PACKED_DEPTH\n"
+        "  // Inverse view depth in two 8 bit channels, gl_FragCoord.z is only mediump\n"
+        "  float invDepth = clamp(0.05 / max(-v_pos.z, 0.0001), 0.0, 0.99999);\n"
+        "  vec2 packedDepth = fract(vec2(1.0, 255.0) * invDepth);\n"
+        "  gl_FragColor.ba = packedDepth - vec2(packedDepth.y / 255.0, 0.0);\n"
+        "#else\n"
+        "  gl_FragColor.ba = vec2(0.0);\n"
+        "#endif\n"
+        "}";
+
+    /* Fragment shader headers selecting where the depth is stored */
+    constexpr char PACKED_DEPTH_FRAG_HEADER[]  = "#define ARES_PACKED_DEPTH\n";
+    constexpr char DEPTH_TEXTURE_FRAG_HEADER[] = "#define ARES_DEPTH_TEXTURE\n";
+
+    /* Light volume vertex shader code */
+    constexpr char LIGHT_VERT_SHADER_SOURCE[] =
+        "#version 100\n"
+        "attribute vec3 POSITION;\n"
+        "uniform mat4 u_mvpMx;\n"
+        "void main(void)\n"
+        "{\n"
+        "  gl_Position = u_mvpMx * vec4(POSITION, 1.0);\n"
+        "}";
+
+    /* Light volume fragment shader code, the light attenuation matches the ClusteredLighting one */
+    constexpr char LIGHT_FRAG_SHADER_SOURCE[] =
+        "#version 100\n"
+        "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+        "precision highp float;\n"
+        "#else\n"
+        "precision mediump float;\n"
+        "#endif\n"
+        "uniform sampler2D u_normalTex;\n"
+        "uniform sampler2D u_depthTex;\n"
+        "uniform mat4 u_invPMx;\n"
+        "uniform vec2 u_invViewport;\n"
+        "uniform vec4 u_lightPos;\n"
+        "uniform vec4 u_lightColor;\n"
+        "uniform vec4 u_lightDir;\n"
+        "void main()\n"
+        "{\n"
+        "  vec2 uv = gl_FragCoord.xy * u_invViewport;\n"
+        "  vec4 normalDepth = texture2D(u_normalTex, uv);\n"
+        "#ifdef ARES_DEPTH_TEXTURE\n"
+        "  // View position from the depth, skipping the background\n"
+        "  float depth = texture2D(u_depthTex, uv).r;\n"
+        "  if (depth >= 0.99999) discard;\n"
+        "  vec4 viewPos4 = u_invPMx * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);\n"
+        "  vec3 viewPos = viewPos4.xyz / viewPos4.w;\n"
+        "#else\n"
+        "  // View position on the view ray of the pixel from the inverse depth, skipping the background\n"
+        "  float invDepth = dot(normalDepth.ba, vec2(1.0, 1.0 / 255.0));\n"
+        "  if (invDepth <= 0.0) discard;\n"
+        "  vec4 ray4 = u_invPMx * vec4(uv * 2.0 - 1.0, 0.0, 1.0);\n"
+        "  vec3 ray = ray4.xyz / ray4.w;\n"
+        "  vec3 viewPos = ray * (-0.05 / (invDepth * ray.z));\n"
+        "#endif\n"
+        "  // Octahedral decoding of the normal\n"
+        "  vec2 oct = normalDepth.rg * 2.0 - 1.0;\n"
+        "  vec3 N = vec3(oct, 1.0 - abs(oct.x) - abs(oct.y));\n"
+        "  if (N.z < 0.0)\n"
+        "  {\n"
+        "    N.xy = (1.0 - abs(N.yx)) * vec2((N.x >= 0.0) ? 1.0 : -1.0, (N.y >= 0.0) ? 1.0 : -1.0);\n"
+        "  }\n"
+        "  N = normalize(N);\n"
+        "  vec3 L;\n"
+        "  vec3 radiance;\n"
+        "  if (u_lightPos.w < 0.0)\n"
+        "  {\n"
+        "    L = -u_lightDir.xyz;\n"
+        "    radiance = u_lightColor.rgb;\n"
+        "  }\n"
+        "  else\n"
+        "  {\n"
+        "    vec3 toLight = u_lightPos.xyz - viewPos;\n"
+        "    float dist2 = max(dot(toLight, toLight), 0.0001);\n"
+        "    L = toLight * inversesqrt(dist2);\n"
+        "    float x = dist2 * u_lightPos.w;\n"
+        "    float rangeAtt = clamp(1.0 - x * x, 0.0, 1.0);\n"
+        "    float spotAtt = clamp(dot(u_lightDir.xyz, -L) * u_lightColor.w + u_lightDir.w, 0.0, 1.0);\n"
+        "    radiance = u_lightColor.rgb * (rangeAtt * rangeAtt * spotAtt * spotAtt / dist2);\n"
+        "  }\n"
+        "  // Diffuse radiance and Blinn-Phong specular luminance, scaled down by LIGHT_BUFFER_SCALE\n"
+        "  float NdotL = max(dot(N, L), 0.0);\n"
+        "  vec3 H = normalize(L - normalize(viewPos));\n"
+        "  float spec = pow(max(dot(N, H), 0.0), 32.0) * NdotL;\n"
+        "  gl_FragColor = vec4(radiance * NdotL, spec * dot(radiance, vec3(0.2126, 0.7152, 0.0722))) * 0.25;\n"
+        "}";
+
+    /* Light pre-pass currently bound for the materials */
+    static const LightPrePass* sg_currentLightPrePass = nullptr;
+
+    LightPrePass::LightPrePass()
+        : m_depthTexture(false)
+        , m_width(0)
+        , m_height(0)
+        , m_normalTex()
+        , m_depthTex()
+        , m_depthRb()
+        , m_lightBufferTex()
+        , m_normalFbo()
+        , m_lightBufferFbo()
+        , m_lightShader()
+        , m_lightHandles()
+        , m_sphere()
+        , m_cone()
+        , m_quad()
+        , m_lightBufferParams()
+    {
+    }
+
+    bool LightPrePass::hasDepthTexture()
+    {
+        return glutils::GlUtils::hasExtension("GL_OES_depth_texture");
+    }
+
+    const char* LightPrePass::normalDepthFragHeader()
+    {
+        return (hasDepthTexture()) ? (nullptr) : (PACKED_DEPTH_FRAG_HEADER);
+    }
+
+    bool LightPrePass::beginNormalDepthPass(int32_t width, int32_t height)
+    {
+        /* Create the targets on first use or when the viewport is resized */
+        if ((nullptr == m_normalFbo) || (width != m_width) || (height != m_height))
+        {
+            createTargets(width, height);
+        }
+        if ((!m_normalFbo->isComplete()) || (!m_lightBufferFbo->isComplete()))
+        {
+            glutils::Framebuffer::bindDefault();
+            return false;
+        }
+        if (nullptr == m_lightShader)
+        {
+            createLightResources();
+        }
+
+        /* Bind and clear the normal and depth target, depth writes must be enabled to clear it */
+        m_normalFbo->bind();
+        glViewport(0, 0, m_width, m_height);
+        glutils::GlUtils::checkGLError("glViewport");
+        glutils::GlState& glState = glutils::GlState::current();
+        glState.setCapability(GL_DEPTH_TEST, true);
+        glState.depthFunc(GL_LEQUAL);
+        glState.depthMask(true);
+        glClearColor(NORMAL_CLEAR_COLOR[0], NORMAL_CLEAR_COLOR[1], NORMAL_CLEAR_COLOR[2], NORMAL_CLEAR_COLOR[3]);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glutils::GlUtils::checkGLError("glClear");
+        return true;
+    }
+
+    void LightPrePass::accumulateLights(const std::vector<LightNodePtr>& lightVec, const glutils::Mat4& projectionMatrix)
+    {
+        /* Bind and clear the light buffer */
+        glutils::GlState& glState = glutils::GlState::current();
+        m_lightBufferFbo->bind();
+        glClearColor(0.F, 0.F, 0.F, 0.F);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glutils::GlUtils::checkGLError("glClear");
+
+        /* Accumulate the lights without writing depth */
+        glState.setCapability(GL_BLEND, true);
+        glState.blendFunc(GL_ONE, GL_ONE);
+        glState.depthMask(false);
+
+        /* Bind the light shader and the normal and depth targets */
+        glutils::Mat4 invProjectionMatrix(projectionMatrix);
+        invProjectionMatrix.invert();
+        m_lightShader->activate();
+        m_lightShader->setUniform(m_lightHandles.invPMx, invProjectionMatrix);
+        m_lightShader->setUniform(m_lightHandles.invViewport, glutils::Vec2(1.F / static_cast<float>(m_width), 1.F / static_cast<float>(m_height)));
+        m_normalTex->activate(NORMAL_TEX_UNIT);
+        if (nullptr != m_depthTex)
+        {
+            m_depthTex->activate(DEPTH_TEX_UNIT);
+        }
+
+        /* Directional lights cover the whole screen */
+        glutils::Mat4 identity;
+        identity.setIdentity();
+        glState.setCapability(GL_DEPTH_TEST, false);
+        glState.setCapability(GL_CULL_FACE, false);
+        for (const LightNodePtr& lightNode : lightVec)
+        {
+            const LightPtr light = lightNode->light();
+            if ((nullptr != light) && (Light::Type::Directional == light->type()))
+            {
+                const glutils::Vec3& dir = lightNode->lightDirection();
+                const glutils::Vec3& color = light->color();
+                const float intensity = light->intensity();
+                m_lightShader->setUniform(m_lightHandles.lightPos, glutils::Vec4(0.F, 0.F, 0.F, -1.F));
+                m_lightShader->setUniform(m_lightHandles.lightColor, glutils::Vec4(color[0] * intensity, color[1] * intensity, color[2] * intensity, 0.F));
+                m_lightShader->setUniform(m_lightHandles.lightDir, glutils::Vec4(dir[0], dir[1], dir[2], 1.F));
+                drawProxy(m_quad, identity);
+            }
+        }
+
+        /* Point and spot lights cover their volume, whose back faces are drawn so that the camera can be inside it.
+         * The depth test rejects the pixels in front of the volume when the depth buffer is shared, the depth
+         * texture cannot be sampled and tested at the same time */
+        glState.setCapability(GL_CULL_FACE, true);
+        glState.cullFace(GL_FRONT);
+        if (nullptr == m_depthTex)
+        {
+            glState.setCapability(GL_DEPTH_TEST, true);
+            glState.depthFunc(GL_GEQUAL);
+        }
+        for (const LightNodePtr& lightNode : lightVec)
+        {
+            const LightPtr light = lightNode->light();
+            if ((nullptr == light) || ((Light::Type::Point != light->type()) && (Light::Type::Spotlight != light->type())))
+            {
+                continue;
+            }
+
+            /* Spot cone falloff, as in the clustered lighting */
+            const float range = std::max(light->effectiveRange(), MIN_LIGHT_RANGE);
+            float spotScale = 0.F;
+            float spotOffset = 1.F;
+            const Proxy* proxy = &m_sphere;
+            glutils::Vec3 scale(range, range, range);
+            if (Light::Type::Spotlight == light->type())
+            {
+                const SpotLight& spotLight = static_cast<const SpotLight&>(*light);
+                spotLight.coneFalloff(spotScale, spotOffset);
+                if (spotLight.outerConeAngle() <= MAX_CONE_PROXY_ANGLE)
+                {
+                    const float radius = range * std::tan(spotLight.outerConeAngle());
+                    scale = glutils::Vec3(radius, radius, range);
+                    proxy = &m_cone;
+                }
+            }
+
+            /* Light volume model-view matrix, the cone axis -Z is aligned to the light direction */
+            const glutils::Vec3& pos = lightNode->lightPosition();
+            const glutils::Vec3& dir = lightNode->lightDirection();
+            glutils::Vec3 axisZ(-dir[0], -dir[1], -dir[2]);
+            axisZ.normalize();
+            glutils::Vec3 up = (std::fabs(axisZ[1]) < 0.99F) ? (glutils::Vec3(0.F, 1.F, 0.F)) : (glutils::Vec3(1.F, 0.F, 0.F));
+            glutils::Vec3 axisX(up[1] * axisZ[2] - up[2] * axisZ[1], up[2] * axisZ[0] - up[0] * axisZ[2], up[0] * axisZ[1] - up[1] * axisZ[0]);
+            axisX.normalize();
+            glutils::Vec3 axisY(axisZ[1] * axisX[2] - axisZ[2] * axisX[1], axisZ[2] * axisX[0] - axisZ[0] * axisX[2], axisZ[0] * axisX[1] - axisZ[1] * axisX[0]);
+            glutils::Mat4 mvMatrix;
+            mvMatrix.setIdentity();
+            for (size_t r = 0; r < 3U; ++r)
+            {
+                mvMatrix.set(r, 0U, axisX[r] * scale[0]);
+                mvMatrix.set(r, 1U, axisY[r] * scale[1]);
+                mvMatrix.set(r, 2U, axisZ[r] * scale[2]);
+                mvMatrix.set(r, 3U, pos[r]);
+            }
+
+            const glutils::Vec3& color = light->color();
+            const float intensity = light->intensity();
+            m_lightShader->setUniform(m_lightHandles.lightPos, glutils::Vec4(pos[0], pos[1], pos[2], 1.F / (range * range)));
+            m_lightShader->setUniform(m_lightHandles.lightColor, glutils::Vec4(color[0] * intensity, color[1] * intensity, color[2] * intensity, spotScale));
+            m_lightShader->setUniform(m_lightHandles.lightDir, glutils::Vec4(dir[0], dir[1], dir[2], spotOffset));
+            drawProxy(*proxy, projectionMatrix * mvMatrix);
+        }
+
+        /* Release the targets and restore the renderer default state */
+        m_normalTex->deactivate();
+        if (nullptr != m_depthTex)
+        {
+            m_depthTex->deactivate();
+        }
+        m_lightShader->deactivate();
+        glutils::Framebuffer::bindDefault();
+        glState.setCapability(GL_BLEND, false);
+        glState.setCapability(GL_DEPTH_TEST, true);
+        glState.depthFunc(GL_LEQUAL);
+        glState.depthMask(true);
+        glState.cullFace(GL_BACK);
+    }
+
+    void LightPrePass::bind()
+    {
+        /* Nothing to bind if the light buffer was never created */
+        if (nullptr == m_lightBufferTex)
+        {
+            return;
+        }
+
+        m_lightBufferParams = glutils::Vec4(1.F / static_cast<float>(m_width), 1.F / static_cast<float>(m_height), LIGHT_BUFFER_SCALE, 0.F);
+        sg_currentLightPrePass = this;
+    }
+
+    void LightPrePass::unbind()
+    {
+        if (this == sg_currentLightPrePass)
+        {
+            m_lightBufferTex->deactivate();
+            sg_currentLightPrePass = nullptr;
+        }
+    }
+
+    void LightPrePass::resolveUniforms(glutils::Shader& shader, UniformHandles& handles)
+    {
+        handles.lightBufferParams = shader.uniformHandle<glutils::Uniform4f>(LIGHT_BUFFER_PARAMS_UNIF_NAME);
+        shader.setSampler(LIGHT_BUFFER_TEX_UNIF_NAME, LIGHT_BUFFER_TEX_UNIT);
+    }
+
+    void LightPrePass::setUniforms(glutils::Shader& shader, const UniformHandles& handles)
+    {
+        /* Without a current light buffer, the light buffer reads as zero */
+        if (nullptr != sg_currentLightPrePass)
+        {
+            /* Bind the light buffer again, its unit is shared with the clustered lighting */
+            sg_currentLightPrePass->m_lightBufferTex->activate(LIGHT_BUFFER_TEX_UNIT);
+            shader.setUniform(handles.lightBufferParams, sg_currentLightPrePass->m_lightBufferParams);
+        }
+        else
+        {
+            shader.setUniform(handles.lightBufferParams, glutils::Vec4(0.F, 0.F, 0.F, 0.F));
+        }
+    }
+
+    void LightPrePass::createTargets(int32_t width, int32_t height)
+    {
+        m_width = std::max(width, 1);
+        m_height = std::max(height, 1);
+
+        /* Release the previous targets first, to limit the memory peak */
+        m_normalFbo.reset();
+        m_lightBufferFbo.reset();
+        m_normalTex.reset();
+        m_depthTex.reset();
+        m_depthRb.reset();
+        m_lightBufferTex.reset();
+
+        /* The depth is either rendered to a texture, or to a renderbuffer shared by both framebuffers
+         * so that the light volumes are depth tested */
+        m_depthTexture = hasDepthTexture();
+        m_normalTex = std::make_shared<glutils::Texture>(m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE);
+        m_lightBufferTex = std::make_shared<glutils::Texture>(m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE);
+        if (m_depthTexture)
+        {
+            m_depthTex = std::make_shared<glutils::Texture>(m_width, m_height, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+            m_normalFbo = std::make_shared<glutils::Framebuffer>(m_normalTex, m_depthTex);
+            m_lightBufferFbo = std::make_shared<glutils::Framebuffer>(m_lightBufferTex);
+        }
+        else
+        {
+            m_depthRb = std::make_shared<glutils::Renderbuffer>(m_width, m_height, GL_DEPTH_COMPONENT16);
+            m_normalFbo = std::make_shared<glutils::Framebuffer>(m_normalTex, nullptr, m_depthRb);
+            m_lightBufferFbo = std::make_shared<glutils::Framebuffer>(m_lightBufferTex, nullptr, m_depthRb);
+        }
+    }
+
+    void LightPrePass::createLightResources()
+    {
+        /* Get/compile light shader and resolve its uniforms */
+        m_lightShader = glutils::ShaderManager::getShader(LIGHT_VERT_SHADER_SOURCE, LIGHT_FRAG_SHADER_SOURCE, nullptr, (m_depthTexture) ? (DEPTH_TEXTURE_FRAG_HEADER) : (nullptr));
+        m_lightHandles.mvpMx       = m_lightShader->uniformHandle<glutils::UniformMat4>(MVPMX_UNIF_NAME);
+        m_lightHandles.invPMx      = m_lightShader->uniformHandle<glutils::UniformMat4>(INVPMX_UNIF_NAME);
+        m_lightHandles.invViewport = m_lightShader->uniformHandle<glutils::Uniform2f>(INVVIEWPORT_UNIF_NAME);
+        m_lightHandles.lightPos    = m_lightShader->uniformHandle<glutils::Uniform4f>(LIGHTPOS_UNIF_NAME);
+        m_lightHandles.lightColor  = m_lightShader->uniformHandle<glutils::Uniform4f>(LIGHTCOLOR_UNIF_NAME);
+        m_lightHandles.lightDir    = m_lightShader->uniformHandle<glutils::Uniform4f>(LIGHTDIR_UNIF_NAME);
+        m_lightShader->setSampler(NORMAL_TEX_UNIF_NAME, NORMAL_TEX_UNIT);
+        m_lightShader->setSampler(DEPTH_TEX_UNIF_NAME, DEPTH_TEX_UNIT);
+
+        /* Unit sphere, enlarged so that its faces enclose the sphere */
+        std::vector<float> vertices;
+        std::vector<uint16_t> indices;
+        const float sphereScale = 1.F / (std::cos(PI / static_cast<float>(2U * SPHERE_RINGS)) * std::cos(PI / static_cast<float>(SPHERE_SEGMENTS)));
+        for (uint32_t ring = 0; ring <= SPHERE_RINGS; ++ring)
+        {
+            const float theta = PI * static_cast<float>(ring) / static_cast<float>(SPHERE_RINGS);
+            for (uint32_t segment = 0; segment < SPHERE_SEGMENTS; ++segment)
+            {
+                const float phi = 2.F * PI * static_cast<float>(segment) / static_cast<float>(SPHERE_SEGMENTS);
+                vertices.insert(vertices.end(), { sphereScale * std::sin(theta) * std::cos(phi), sphereScale * std::sin(theta) * std::sin(phi), sphereScale * std::cos(theta) });
+            }
+        }
+        for (uint32_t ring = 0; ring < SPHERE_RINGS; ++ring)
+        {
+            for (uint32_t segment = 0; segment < SPHERE_SEGMENTS; ++segment)
+            {
+                const uint16_t a = static_cast<uint16_t>(ring * SPHERE_SEGMENTS + segment);
+                const uint16_t b = static_cast<uint16_t>((ring + 1U) * SPHERE_SEGMENTS + segment);
+                const uint16_t c = static_cast<uint16_t>((ring + 1U) * SPHERE_SEGMENTS + ((segment + 1U) % SPHERE_SEGMENTS));
+                const uint16_t d = static_cast<uint16_t>(ring * SPHERE_SEGMENTS + ((segment + 1U) % SPHERE_SEGMENTS));
+                indices.insert(indices.end(), { a, b, c, a, c, d });
+            }
+        }
+        createProxy(vertices, indices, m_sphere);
+
+        /* Unit cone with the apex in the origin and the base in Z = -1, enlarged so that its faces enclose the cone */
+        vertices.assign({ 0.F, 0.F, 0.F });
+        indices.clear();
+        const float coneScale = 1.F / std::cos(PI / static_cast<float>(CONE_SEGMENTS));
+        for (uint32_t segment = 0; segment < CONE_SEGMENTS; ++segment)
+        {
+            const float phi = 2.F * PI * static_cast<float>(segment) / static_cast<float>(CONE_SEGMENTS);
+            vertices.insert(vertices.end(), { coneScale * std::cos(phi), coneScale * std::sin(phi), -1.F });
+        }
+        vertices.insert(vertices.end(), { 0.F, 0.F, -1.F });
+        const uint16_t baseCenter = static_cast<uint16_t>(CONE_SEGMENTS + 1U);
+        for (uint32_t segment = 0; segment < CONE_SEGMENTS; ++segment)
+        {
+            const uint16_t a = static_cast<uint16_t>(1U + segment);
+            const uint16_t b = static_cast<uint16_t>(1U + ((segment + 1U) % CONE_SEGMENTS));
+            indices.insert(indices.end(), { 0U, a, b, baseCenter, b, a });
+        }
+        createProxy(vertices, indices, m_cone);
+
+        /* Fullscreen quad in normalized device coordinates */
+        vertices.assign({ -1.F, -1.F, 0.F, 1.F, -1.F, 0.F, 1.F, 1.F, 0.F, -1.F, 1.F, 0.F });
+        indices.assign({ 0U, 1U, 2U, 0U, 2U, 3U });
+        createProxy(vertices, indices, m_quad);
+    }
+
+    void LightPrePass::createProxy(const std::vector<float>& vertices, const std::vector<uint16_t>& indices, Proxy& proxy) const
+    {
+        auto vbo = std::make_shared<glutils::Vbo>(vertices.data(), static_cast<int32_t>(vertices.size() * sizeof(float)), glutils::Vbo::TargetType::ArrayBuffer);
+        auto ibo = std::make_shared<glutils::Vbo>(indices.data(), static_cast<int32_t>(indices.size() * sizeof(uint16_t)), glutils::Vbo::TargetType::ElementArrayBuffer);
+        std::vector<glutils::AttributeDataPtr> attributeData(1U, std::make_shared<glutils::AttributeData>("POSITION", vbo, 3, glutils::AttributeData::AttributeType::Float, false, 0, 0));
+        auto indicesData = std::make_shared<glutils::AttributeData>("", ibo, 1, glutils::AttributeData::AttributeType::UnsignedShort, false, 0, 0);
+        proxy.layout = std::make_shared<glutils::VertexLayout>(*m_lightShader, attributeData, indicesData);
+        proxy.indexCount = static_cast<GLsizei>(indices.size());
+    }
+
+    void LightPrePass::drawProxy(const Proxy& proxy, const glutils::Mat4& mvpMatrix)
+    {
+        m_lightShader->setUniform(m_lightHandles.mvpMx, mvpMatrix);
+        proxy.layout->bind();
+        glDrawElements(GL_TRIANGLES, proxy.indexCount, GL_UNSIGNED_SHORT, nullptr);
+        glutils::GlUtils::checkGLError("glDrawElements");
+        glutils::GlState::current().countDraw(GL_TRIANGLES, proxy.indexCount);
+        proxy.layout->unbind();
+    }
+
+}
+
+}
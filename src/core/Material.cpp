@@ -29,37 +29,157 @@
  *****************************************************************************/
 
 #include "ares/core/Material.hpp"
+#include "ares/core/LightPrePass.hpp"
+#include "ares/glutils/Profiler.hpp"
+#include "ares/glutils/ShaderManager.hpp"
+
+#include <atomic>
 
 namespace ares
 {
 
 namespace core
 {
+    /* Counter to assign unique material IDs */
+    static std::atomic<uint32_t> s_nextMaterialId(1U);
+
+    /* Vertex shader header of the instanced variant, the instance model matrix rows are per-instance attributes */
+    constexpr char INSTANCING_VERT_HEADER[] =
+        "#define ARES_INSTANCING\n"
+        "attribute vec4 a_instanceRow0;\n"
+        "attribute vec4 a_instanceRow1;\n"
+        "attribute vec4 a_instanceRow2;\n"
+        "mat4 instanceModelMatrix()\n"
+        "{\n"
+        "  return mat4(a_instanceRow0.x, a_instanceRow1.x, a_instanceRow2.x, 0.0,\n"
+        "              a_instanceRow0.y, a_instanceRow1.y, a_instanceRow2.y, 0.0,\n"
+        "              a_instanceRow0.z, a_instanceRow1.z, a_instanceRow2.z, 0.0,\n"
+        "              a_instanceRow0.w, a_instanceRow1.w, a_instanceRow2.w, 1.0);\n"
+        "}\n"
+        "mat3 instanceNormalMatrix()\n"
+        "{\n"
+        "  return mat3(a_instanceRow0.x, a_instanceRow1.x, a_instanceRow2.x,\n"
+        "              a_instanceRow0.y, a_instanceRow1.y, a_instanceRow2.y,\n"
+        "              a_instanceRow0.z, a_instanceRow1.z, a_instanceRow2.z);\n"
+        "}\n";
+
+    /* Instance attribute names */
+    constexpr const char* INSTANCE_ATTRIB_NAMES[INSTANCE_MATRIX_ROWS] = { "a_instanceRow0", "a_instanceRow1", "a_instanceRow2" };
+
     Material::Material()
         : m_shader()
+        , m_activeShader(nullptr)
+        , m_activeVariant(ShaderVariant::Default)
+        , m_id(s_nextMaterialId++)
+        , m_vertShaderSource(nullptr)
+        , m_fragShaderSource(nullptr)
+        , m_fragShaderHeader(nullptr)
+        , m_lightBufferFragHeader(nullptr)
+        , m_variantShaders()
+        , m_instanceAttribLocations()
+        , m_doubleSided(false)
+        , m_blending(false)
     {
+        for (size_t v = 0; v < SHADER_VARIANT_COUNT; ++v)
+        {
+            for (uint32_t i = 0; i < INSTANCE_MATRIX_ROWS; ++i)
+            {
+                m_instanceAttribLocations[v][i] = -1;
+            }
+        }
     }
 
-    void Material::setup(const std::vector<glutils::AttributeDataPtr>& attributeData, const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    glutils::ShaderPtr Material::shader(ShaderVariant variant)
     {
-        /* Check shader validity */
-        if (nullptr != m_shader)
+        /* The default variant is created with the material */
+        if (ShaderVariant::Default == variant)
         {
-            /* Activate shader */
-            m_shader->activate(attributeData);
+            return m_shader;
+        }
 
-            /* Material type specific setup */
-            onSetup(mvMatrix, projectionMatrix, normalMatrix, lightVec);
+        /* Create variant on first use, if the material has the sources for it */
+        glutils::ShaderPtr& variantShader = m_variantShaders[static_cast<size_t>(variant)];
+        if ((nullptr == variantShader) && supportsInstancing())
+        {
+            const char* vertHeader = (isInstanced(variant)) ? (INSTANCING_VERT_HEADER) : (nullptr);
+            switch (variant)
+            {
+                case ShaderVariant::Instanced:
+                    variantShader = glutils::ShaderManager::getShader(m_vertShaderSource, m_fragShaderSource, vertHeader, m_fragShaderHeader);
+                    break;
+                case ShaderVariant::NormalDepth:
+                case ShaderVariant::NormalDepthInstanced:
+                    if (supportsLightPrePass())
+                    {
+                        variantShader = glutils::ShaderManager::getShader(m_vertShaderSource, LightPrePass::NORMAL_DEPTH_FRAG_SHADER, vertHeader, LightPrePass::normalDepthFragHeader());
+                    }
+                    break;
+                case ShaderVariant::LightBuffer:
+                case ShaderVariant::LightBufferInstanced:
+                    if (supportsLightPrePass())
+                    {
+                        variantShader = glutils::ShaderManager::getShader(m_vertShaderSource, m_fragShaderSource, vertHeader, m_lightBufferFragHeader);
+                    }
+                    break;
+                default:
+                    break;
+            }
+
+            /* Resolve the uniforms and instance attributes of the new variant */
+            if (nullptr != variantShader)
+            {
+                resolveUniforms(*variantShader, variant);
+                for (uint32_t i = 0; i < INSTANCE_MATRIX_ROWS; ++i)
+                {
+                    m_instanceAttribLocations[static_cast<size_t>(variant)][i] = variantShader->getAttribLocation(INSTANCE_ATTRIB_NAMES[i]);
+                }
+            }
         }
+        return variantShader;
     }
 
-    void Material::deactivate(const std::vector<glutils::AttributeDataPtr>& attributeData)
+    void Material::setShaderSources(const char* vertShaderSource, const char* fragShaderSource, const char* fragShaderHeader, const char* lightBufferFragHeader)
     {
-        /* Check shader validity */
+        /* Keep sources for the variants */
+        m_vertShaderSource = vertShaderSource;
+        m_fragShaderSource = fragShaderSource;
+        m_fragShaderHeader = fragShaderHeader;
+        m_lightBufferFragHeader = lightBufferFragHeader;
+
+        /* Get/compile default variant */
+        m_shader = glutils::ShaderManager::getShader(vertShaderSource, fragShaderSource, nullptr, fragShaderHeader);
         if (nullptr != m_shader)
         {
-            /* Deactivate shader */
-            m_shader->deactivate(attributeData);
+            resolveUniforms(*m_shader, ShaderVariant::Default);
+        }
+    }
+
+    bool Material::isInstanceAttribute(const std::string& name)
+    {
+        bool retval = false;
+        for (uint32_t i = 0; i < INSTANCE_MATRIX_ROWS; ++i)
+        {
+            if (name == INSTANCE_ATTRIB_NAMES[i])
+            {
+                retval = true;
+                break;
+            }
+        }
+        return retval;
+    }
+
+    void Material::setup(ShaderVariant variant, const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    {
+        ARES_PROFILE_SCOPE("render", "Material::setup");
+
+        /* Check shader validity, the non-default variants were created with the pipeline state */
+        glutils::Shader* variantShader = (ShaderVariant::Default == variant) ? (m_shader.get()) : (m_variantShaders[static_cast<size_t>(variant)].get());
+        if (nullptr != variantShader)
+        {
+            /* Material type specific setup */
+            m_activeShader = variantShader;
+            m_activeVariant = variant;
+            onSetup(mvMatrix, projectionMatrix, normalMatrix, lightVec);
         }
     }
 
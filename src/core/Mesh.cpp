@@ -29,8 +29,12 @@
  *****************************************************************************/
 
 #include "ares/core/Mesh.hpp"
+#include "ares/core/MeshNode.hpp"
 #include "ares/glutils/GlUtils.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace ares
 {
 
@@ -39,10 +43,59 @@ namespace core
     Mesh::Mesh(const std::string& name, const std::vector<PrimitivePtr>& primitives)
         : m_name(name)
         , m_primitives(primitives)
+        , m_boundingBox()
+        , m_boundingSphere()
+        , m_occluderVertices()
+        , m_occluderIndices()
+        , m_nodes()
+    {
+        /* Compute bounds from primitives */
+        updateBounds();
+    }
+
+    void Mesh::addPrimitive(PrimitivePtr primitive)
+    {
+        /* Add primitive and grow bounds */
+        m_primitives.push_back(primitive);
+        if (nullptr != primitive)
+        {
+            m_boundingBox.expand(primitive->boundingBox());
+            m_boundingSphere = glutils::BoundingSphere::fromBox(m_boundingBox);
+            notifyBoundsChanged();
+        }
+    }
+
+    void Mesh::updateBounds()
+    {
+        /* Merge primitive bounds */
+        m_boundingBox = glutils::BoundingBox();
+        for (auto& primitive : m_primitives)
+        {
+            if (nullptr != primitive)
+            {
+                m_boundingBox.expand(primitive->boundingBox());
+            }
+        }
+        m_boundingSphere = glutils::BoundingSphere::fromBox(m_boundingBox);
+        notifyBoundsChanged();
+    }
+
+    void Mesh::setOccluderGeometry(const std::vector<glutils::Vec3>& vertices, const std::vector<uint32_t>& indices)
     {
+        /* Check indices validity */
+        for (auto index : indices)
+        {
+            if (index >= vertices.size())
+            {
+                throw std::runtime_error("Invalid occluder index");
+            }
+        }
+
+        m_occluderVertices = vertices;
+        m_occluderIndices = indices;
     }
 
-    void Mesh::draw(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    void Mesh::draw(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec)
     {
         for (auto& primitive : m_primitives)
         {
@@ -52,6 +105,29 @@ namespace core
             }
         }
     }
+
+    void Mesh::attachNode(MeshNode* node)
+    {
+        m_nodes.push_back(node);
+    }
+
+    void Mesh::detachNode(MeshNode* node)
+    {
+        /* Remove one registration, a node is registered once per setMesh */
+        auto it = std::find(m_nodes.begin(), m_nodes.end(), node);
+        if (m_nodes.end() != it)
+        {
+            m_nodes.erase(it);
+        }
+    }
+
+    void Mesh::notifyBoundsChanged()
+    {
+        for (auto node : m_nodes)
+        {
+            node->invalidateBounds();
+        }
+    }
 }
 
 }
@@ -38,10 +38,42 @@ namespace core
     MeshNode::MeshNode(const std::string& name, NodePtr parent)
         : Node(name, parent)
         , m_mesh(nullptr)
+        , m_occluder(false)
     {
         /* Set type */
         m_type = Type::Mesh;
     }
+
+    MeshNode::~MeshNode()
+    {
+        /* Stop receiving the bounds changes of the mesh */
+        if (nullptr != m_mesh)
+        {
+            m_mesh->detachNode(this);
+        }
+    }
+
+    void MeshNode::setMesh(MeshPtr mesh)
+    {
+        /* Move the bounds change registration to the new mesh */
+        if (nullptr != m_mesh)
+        {
+            m_mesh->detachNode(this);
+        }
+        if (nullptr != mesh)
+        {
+            mesh->attachNode(this);
+        }
+
+        /* Store mesh and invalidate bounds */
+        m_mesh = mesh;
+        invalidateBounds();
+    }
+
+    glutils::BoundingBox MeshNode::localBoundingBox() const
+    {
+        return (nullptr != m_mesh) ? (m_mesh->boundingBox()) : (glutils::BoundingBox());
+    }
 }
 
 }
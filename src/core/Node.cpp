@@ -30,6 +30,8 @@
 
 #include "ares/core/Node.hpp"
 
+#include <algorithm>
+
 namespace ares
 {
 
@@ -42,11 +44,20 @@ namespace core
         , m_rotation(0.F, 0.F, 0.F, 1.0F)
         , m_scaling(1.F, 1.F, 1.F)
         , m_transformMatrix()
+        , m_totalTransformMatrix()
+        , m_totalTransformDirty(true)
+        , m_subtreeDirty(true)
+        , m_boundsDirty(true)
+        , m_worldBoundingBox()
+        , m_subtreeBoundingBox()
         , m_parent(parent)
         , m_children()
+        , m_spatialId(-1)
+        , m_static(false)
     {
         /* Initialize transform to an identity */
         m_transformMatrix.setIdentity();
+        m_totalTransformMatrix.setIdentity();
     }
 
     void Node::setPosition(float x, float y, float z)
@@ -77,20 +88,79 @@ namespace core
         updateTransformMatrix();
     }
 
-    glutils::Mat4 Node::totalTransformMatrix() const
+    void Node::setTransformMatrix(const glutils::Mat4& transformMatrix)
     {
-        /* Start from current transform */
-        glutils::Mat4 retval(m_transformMatrix);
+        /* Store value and invalidate cached transforms */
+        m_transformMatrix = transformMatrix;
+        invalidateTotalTransform();
+    }
 
-        /* Get parent if any */
-        NodePtr parentNode = parent();
-        if (nullptr != parentNode)
+    const glutils::Mat4& Node::totalTransformMatrix() const
+    {
+        /* Dirty nodes always have dirty descendants, so a clean node has clean ancestors */
+        if (m_totalTransformDirty)
+        {
+            /* Get parent if any */
+            NodePtr parentNode = parent();
+            if (nullptr != parentNode)
+            {
+                /* Apply parent transform to current transform */
+                m_totalTransformMatrix = parentNode->totalTransformMatrix() * m_transformMatrix;
+            }
+            else
+            {
+                /* Start from current transform */
+                m_totalTransformMatrix = m_transformMatrix;
+            }
+
+            m_totalTransformDirty = false;
+        }
+
+        return m_totalTransformMatrix;
+    }
+
+    void Node::updateSubtree(std::vector<Node*>* changedNodes)
+    {
+        /* Skip clean branches */
+        if (m_subtreeDirty)
+        {
+            /* Refresh own transform and bounds, parent has already been refreshed */
+            updateSelf(changedNodes);
+
+            /* Recursion on children, then merge their bounds */
+            for (auto& child : m_children)
+            {
+                child->updateSubtree(changedNodes);
+            }
+            updateSubtreeBounds();
+        }
+    }
+
+    void Node::updateSelf(std::vector<Node*>* changedNodes)
+    {
+        /* Refresh own transform */
+        const glutils::Mat4& worldMatrix = totalTransformMatrix();
+
+        /* Refresh own bounds if changed */
+        if (m_boundsDirty)
         {
-            /* Apply parent transform */
-            retval = parentNode->totalTransformMatrix() * retval;
+            m_worldBoundingBox = localBoundingBox().transformed(worldMatrix);
+            m_boundsDirty = false;
+            if (nullptr != changedNodes)
+            {
+                changedNodes->push_back(this);
+            }
         }
+    }
 
-        return retval;
+    void Node::updateSubtreeBounds()
+    {
+        m_subtreeBoundingBox = m_worldBoundingBox;
+        for (auto& child : m_children)
+        {
+            m_subtreeBoundingBox.expand(child->m_subtreeBoundingBox);
+        }
+        m_subtreeDirty = false;
     }
 
     void Node::updateTransformMatrix()
@@ -100,12 +170,75 @@ namespace core
         m_transformMatrix.scale(m_scaling[0], m_scaling[1], m_scaling[2]);
         m_transformMatrix.rotateXYZW(m_rotation[0], m_rotation[1], m_rotation[2], m_rotation[3]);
         m_transformMatrix.translate(m_position[0], m_position[1], m_position[2]);
+
+        /* Invalidate cached transforms */
+        invalidateTotalTransform();
+    }
+
+    void Node::invalidateTotalTransform()
+    {
+        /* Nothing to do if already dirty, as the whole subtree is dirty as well */
+        if (!m_totalTransformDirty)
+        {
+            m_totalTransformDirty = true;
+            m_boundsDirty = true;
+            m_subtreeDirty = true;
+
+            /* Recursion on children */
+            for (auto& child : m_children)
+            {
+                child->invalidateTotalTransform();
+            }
+        }
+
+        /* Let the update pass reach this node */
+        propagateDirtyToAncestors();
+    }
+
+    void Node::invalidateBounds()
+    {
+        /* Let the update pass reach this node and its ancestors */
+        m_boundsDirty = true;
+        m_subtreeDirty = true;
+        propagateDirtyToAncestors();
+    }
+
+    void Node::propagateDirtyToAncestors()
+    {
+        /* Walk up until an already flagged ancestor is found */
+        NodePtr parentNode = parent();
+        while ((nullptr != parentNode) && (!parentNode->m_subtreeDirty))
+        {
+            parentNode->m_subtreeDirty = true;
+            parentNode = parentNode->parent();
+        }
     }
 
     void Node::addChild(NodePtr node)
     {
         /* Add child to list */
         m_children.push_back(node);
+
+        /* New nodes start dirty, make sure the update pass reaches them */
+        if (nullptr != node)
+        {
+            node->propagateDirtyToAncestors();
+        }
+    }
+
+    void Node::removeChild(NodePtr node)
+    {
+        /* Remove child from list */
+        auto it = std::find(m_children.begin(), m_children.end(), node);
+        if (m_children.end() != it)
+        {
+            m_children.erase(it);
+            node->m_parent.reset();
+
+            /* Subtree bounds must be merged again without the child */
+            m_subtreeDirty = true;
+            propagateDirtyToAncestors();
+        }
     }
 }
 
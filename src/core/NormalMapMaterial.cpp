@@ -30,7 +30,6 @@
 
 #include "ares/core/NormalMapMaterial.hpp"
 #include "ares/core/LightNode.hpp"
-#include "ares/glutils/ShaderManager.hpp"
 
 #include <stdexcept>
 
@@ -53,7 +52,6 @@ namespace core
     constexpr char NORMMX_UNIF_NAME[]     = "u_normMx";
     constexpr char DIFFUSETEX_UNIF_NAME[] = "u_diffuseTex";
     constexpr char NORMALTEX_UNIF_NAME[]  = "u_normalTex";
-    constexpr char LIGHTPOS_UNIF_NAME[]   = "u_lightPos";
 
     /* Vertex shader code */
     //TODO the vertex shader will likely be the same for all materials, move somewhere common
@@ -67,7 +65,7 @@ namespace core
         "attribute vec3 COLOR_0;\n"
         "uniform mat4 u_mvMx;\n"
         "uniform mat4 u_pMx;\n"
-        "uniform mat4 u_normMx;\n"
+        "uniform mat3 u_normMx;\n"
         "varying vec3 v_pos;\n"
         "varying vec3 v_norm;\n"
         "varying vec3 v_tang;\n"
@@ -75,10 +73,17 @@ namespace core
         "varying vec2 v_uv;\n"
         "void main(void)\n"
         "{\n"
-        "  v_pos = vec3(u_mvMx * vec4(POSITION, 1.0));\n"
-        "  v_norm = normalize(mat3(u_normMx) * NORMAL);\n"
-        "  v_tang = normalize(mat3(u_normMx) * vec3(TANGENT));\n"
-        "  v_bita = normalize(mat3(u_normMx) * cross(NORMAL, vec3(TANGENT)));\n"
+        "#ifdef ARES_INSTANCING\n"
+        "  mat4 mvMx = u_mvMx * instanceModelMatrix();\n"
+        "  mat3 normMx = u_normMx * instanceNormalMatrix();\n"
+        "#else\n"
+        "  mat4 mvMx = u_mvMx;\n"
+        "  mat3 normMx = u_normMx;\n"
+        "#endif\n"
+        "  v_pos = vec3(mvMx * vec4(POSITION, 1.0));\n"
+        "  v_norm = normalize(normMx * NORMAL);\n"
+        "  v_tang = normalize(normMx * vec3(TANGENT));\n"
+        "  v_bita = normalize(normMx * cross(NORMAL, vec3(TANGENT)));\n"
         "  v_uv = TEXCOORD_0;\n"
         "  gl_Position = u_pMx * vec4(v_pos, 1.0);\n"
         "}";
@@ -92,7 +97,6 @@ namespace core
         "varying vec3 v_tang;\n"
         "varying vec3 v_bita;\n"
         "varying vec2 v_uv;\n"
-        "uniform vec3 u_lightPos;\n"
         "uniform sampler2D u_diffuseTex;\n"
         "uniform sampler2D u_normalTex;\n"
         "\n"
@@ -101,16 +105,31 @@ namespace core
         "  mat3 TBN = mat3(v_tang, v_bita, v_norm);\n"
         "  vec3 N = normalize(texture2D(u_normalTex, v_uv).rgb * 2.0 - 1.0);\n"
         "  N = normalize(TBN * N);\n"
-        "  vec3 L = normalize(u_lightPos - v_pos);\n"
-        "  vec3 R = reflect(-L, N);\n"
         "  vec3 V = normalize(-v_pos);\n"
-        "  float diff = max(dot(N, L), 0.0);\n"
-        "  // Compute the specular term\n"
-        "  float spec = max(dot(V, R), 0.0);\n"
         "  vec4 diffuseColor = texture2D(u_diffuseTex, v_uv);\n"
-        "  gl_FragColor = vec4(diff * diffuseColor.rgb +"
-        "                      0.3 * vec3(spec),"  //TODO add configuration for specular factor and color?
-        "                      diffuseColor.a);\n"
+        "  vec3 color = vec3(0.0);\n"
+        "#ifdef ARES_LIGHT_PREPASS\n"
+        "  // Diffuse radiance and specular luminance accumulated in the light buffer\n"
+        "  vec4 lightBuffer = aresLightBuffer();\n"
+        "  color = diffuseColor.rgb * lightBuffer.rgb + 0.3 * vec3(lightBuffer.a);\n"
+        "#else\n"
+        "  // Accumulate the lights of the fragment cluster\n"
+        "  float listOffset;\n"
+        "  float lightCount = aresLightCount(v_pos, listOffset);\n"
+        "  for (int i = 0; i < ARES_MAX_LIGHTS; ++i) {\n"
+        "    if (float(i) >= lightCount) break;\n"
+        "    vec3 L;\n"
+        "    vec3 radiance;\n"
+        "    aresLight(float(i), listOffset, v_pos, L, radiance);\n"
+        "    vec3 R = reflect(-L, N);\n"
+        "    float diff = max(dot(N, L), 0.0);\n"
+        "    // Compute the specular term\n"
+        "    float spec = max(dot(V, R), 0.0);\n"
+        "    color += (diff * diffuseColor.rgb +"
+        "              0.3 * vec3(spec)) * radiance;\n"  //TODO add configuration for specular factor and color?
+        "  }\n"
+        "#endif\n"
+        "  gl_FragColor = vec4(color, diffuseColor.a);\n"
         "}";
 
     NormalMapMaterial::NormalMapMaterial(glutils::TexturePtr diffuseTex, glutils::TexturePtr normalTex)
@@ -124,66 +143,44 @@ namespace core
         }
 
         /* Get/compile shader */
-        m_shader = glutils::ShaderManager::getShader(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE);
-        if (nullptr != m_shader)
-        {
-            /* Add uniforms */
-            m_shader->addUniform<glutils::UniformMat4>(MVMX_UNIF_NAME);
-            m_shader->addUniform<glutils::UniformMat4>(PMX_UNIF_NAME);
-            m_shader->addUniform<glutils::UniformMat4>(NORMMX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(DIFFUSETEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(NORMALTEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform3f>(LIGHTPOS_UNIF_NAME);
-        }
+        setShaderSources(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE, ClusteredLighting::FRAG_SHADER_HEADER, LightPrePass::FRAG_SHADER_HEADER);
+    }
+
+    void NormalMapMaterial::resolveUniforms(glutils::Shader& shader, ShaderVariant variant)
+    {
+        /* Resolve uniform handles */
+        UniformHandles& handles = m_uniforms[static_cast<size_t>(variant)];
+        handles.mvMx     = shader.uniformHandle<glutils::UniformMat4>(MVMX_UNIF_NAME);
+        handles.pMx      = shader.uniformHandle<glutils::UniformMat4>(PMX_UNIF_NAME);
+        handles.normMx   = shader.uniformHandle<glutils::UniformMat3>(NORMMX_UNIF_NAME);
+        shader.setSampler(DIFFUSETEX_UNIF_NAME, 0);
+        shader.setSampler(NORMALTEX_UNIF_NAME, 1);
+        ClusteredLighting::resolveUniforms(shader, handles.lighting);
+        LightPrePass::resolveUniforms(shader, handles.lightBuffer);
     }
 
-    void NormalMapMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    void NormalMapMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec)
     {
         if ((nullptr == m_diffuseTex) || (nullptr == m_normalTex))
         {
             throw std::runtime_error("Invalid texture");
         }
 
-        /* Get uniforms */
-        glutils::UniformMat4Ptr mvmxUnif          = m_shader->getUniform<glutils::UniformMat4>(MVMX_UNIF_NAME);
-        glutils::UniformMat4Ptr pmxUnif           = m_shader->getUniform<glutils::UniformMat4>(PMX_UNIF_NAME);
-        glutils::UniformMat4Ptr normmxUnif        = m_shader->getUniform<glutils::UniformMat4>(NORMMX_UNIF_NAME);
-        glutils::Uniform1iPtr   diffuseTexUnif    = m_shader->getUniform<glutils::Uniform1i>(DIFFUSETEX_UNIF_NAME);
-        glutils::Uniform1iPtr   normalTexUnif     = m_shader->getUniform<glutils::Uniform1i>(NORMALTEX_UNIF_NAME);
-        glutils::Uniform3fPtr   lightPosUnif      = m_shader->getUniform<glutils::Uniform3f>(LIGHTPOS_UNIF_NAME);
-
-        /* Make sure uniforms are valid */
-        if (
-            (nullptr != mvmxUnif)          &&
-            (nullptr != pmxUnif)           &&
-            (nullptr != normmxUnif)        &&
-            (nullptr != diffuseTexUnif)    &&
-            (nullptr != normalTexUnif)     &&
-            (nullptr != lightPosUnif)      &&
-            (nullptr != m_diffuseTex)      &&
-            (nullptr != m_normalTex)
-           )
-        {
-            /* Set uniforms */
-            mvmxUnif->setAndCommit(mvMatrix);
-            pmxUnif->setAndCommit(projectionMatrix);
-            normmxUnif->setAndCommit(normalMatrix);
-            diffuseTexUnif->setAndCommit(0);
-            normalTexUnif->setAndCommit(1);
-
-            /* Activate texture */
-            m_diffuseTex->activate(0);
-            m_normalTex->activate(1);
-
-            /* Set lights */
-            if (!lightVec.empty())
-            {
-                //TODO Add support for multiple lights
-                LightNodePtr lightNode = lightVec[0];
-                glutils::Vec3 lightPos = lightNode->lightPosition();
-                lightPosUnif->setAndCommit(lightPos);
-            }
-        }
+        /* Get uniform handles of the active variant */
+        const UniformHandles& handles = m_uniforms[static_cast<size_t>(m_activeVariant)];
+
+        /* Set uniforms */
+        m_activeShader->setUniform(handles.mvMx, mvMatrix);
+        m_activeShader->setUniform(handles.pMx, projectionMatrix);
+        m_activeShader->setUniform(handles.normMx, normalMatrix);
+
+        /* Activate texture */
+        m_diffuseTex->activate(0);
+        m_normalTex->activate(1);
+
+        /* Set lights */
+        ClusteredLighting::setUniforms(*m_activeShader, handles.lighting);
+        LightPrePass::setUniforms(*m_activeShader, handles.lightBuffer);
     }
 
 }
@@ -0,0 +1,321 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/core/OcclusionCuller.hpp"
+#include "ares/glutils/Simd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace ares
+{
+
+namespace core
+{
+    /* Minimum clip w for projected vertices */
+    constexpr float MIN_CLIP_W = 1e-5F;
+
+    /* Minimum doubled screen area of rasterized triangles (pixels) */
+    constexpr float MIN_TRIANGLE_AREA = 1e-6F;
+
+    /* Maximum size in texels of the candidate rectangle in the tested level */
+    constexpr uint32_t MAX_TEST_TEXELS = 4U;
+
+    /* SIMD width of the rasterizer */
+    constexpr uint32_t RASTER_LANES = 4U;
+
+    OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+        : m_width(((std::max(width, 1U) + RASTER_LANES - 1U) / RASTER_LANES) * RASTER_LANES)
+        , m_height(std::max(height, 1U))
+        , m_levels()
+        , m_viewProjectionMatrix()
+        , m_stats()
+    {
+        /* Allocate hierarchical-Z levels down to a single texel */
+        uint32_t levelWidth = m_width;
+        uint32_t levelHeight = m_height;
+        while (true)
+        {
+            Level level = { levelWidth, levelHeight, std::vector<float>(levelWidth * levelHeight, 1.F) };
+            m_levels.push_back(level);
+            if ((1U == levelWidth) && (1U == levelHeight))
+            {
+                break;
+            }
+            levelWidth = (levelWidth + 1U) / 2U;
+            levelHeight = (levelHeight + 1U) / 2U;
+        }
+
+        m_stats = Stats();
+    }
+
+    void OcclusionCuller::beginFrame(const glutils::Mat4& viewProjectionMatrix)
+    {
+        m_viewProjectionMatrix = viewProjectionMatrix;
+        m_stats = Stats();
+
+        /* Clear depth buffer to the far plane */
+        std::fill(m_levels[0].depth.begin(), m_levels[0].depth.end(), 1.F);
+    }
+
+    void OcclusionCuller::rasterizeOccluder(const std::vector<glutils::Vec3>& vertices, const std::vector<uint32_t>& indices, const glutils::Mat4& modelMatrix)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+
+        /* Transform vertices to screen space, flagging the ones not in front of the near plane */
+        glutils::Mat4 mvpMatrix = m_viewProjectionMatrix * modelMatrix;
+        std::vector<glutils::Vec3> screenVertices(vertices.size());
+        std::vector<bool> clipped(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            glutils::Vec4 clip = mvpMatrix * glutils::Vec4(vertices[i][0], vertices[i][1], vertices[i][2], 1.F);
+            clipped[i] = (clip[3] < MIN_CLIP_W) || (clip[2] < -clip[3]);
+            if (!clipped[i])
+            {
+                float invW = 1.F / clip[3];
+                screenVertices[i] = glutils::Vec3(((clip[0] * invW * 0.5F) + 0.5F) * static_cast<float>(m_width),
+                                                  ((clip[1] * invW * 0.5F) + 0.5F) * static_cast<float>(m_height),
+                                                  (clip[2] * invW * 0.5F) + 0.5F);
+            }
+        }
+
+        /* Rasterize triangles fully in front of the near plane */
+        for (size_t i = 0; (i + 2U) < indices.size(); i += 3U)
+        {
+            uint32_t i0 = indices[i];
+            uint32_t i1 = indices[i + 1U];
+            uint32_t i2 = indices[i + 2U];
+            if ((!clipped[i0]) && (!clipped[i1]) && (!clipped[i2]))
+            {
+                rasterizeTriangle(screenVertices[i0], screenVertices[i1], screenVertices[i2]);
+                ++m_stats.occluderTriangles;
+            }
+        }
+
+        ++m_stats.occluders;
+        m_stats.rasterTimeMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    void OcclusionCuller::buildHierarchy()
+    {
+        auto startTime = std::chrono::steady_clock::now();
+
+        /* Each texel holds the max depth of the 2x2 texels of the previous level */
+        for (size_t l = 1; l < m_levels.size(); ++l)
+        {
+            const Level& src = m_levels[l - 1U];
+            Level& dst = m_levels[l];
+            for (uint32_t y = 0; y < dst.height; ++y)
+            {
+                uint32_t sy0 = 2U * y;
+                uint32_t sy1 = std::min(sy0 + 1U, src.height - 1U);
+                for (uint32_t x = 0; x < dst.width; ++x)
+                {
+                    uint32_t sx0 = 2U * x;
+                    uint32_t sx1 = std::min(sx0 + 1U, src.width - 1U);
+                    float d0 = std::max(src.depth[(sy0 * src.width) + sx0], src.depth[(sy0 * src.width) + sx1]);
+                    float d1 = std::max(src.depth[(sy1 * src.width) + sx0], src.depth[(sy1 * src.width) + sx1]);
+                    dst.depth[(y * dst.width) + x] = std::max(d0, d1);
+                }
+            }
+        }
+
+        m_stats.rasterTimeMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    bool OcclusionCuller::isVisible(const glutils::BoundingBox& box) const
+    {
+        /* Unknown bounds are always visible */
+        if (box.isEmpty() || box.isInfinite())
+        {
+            return true;
+        }
+
+        /* Project box corners */
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float minZ = std::numeric_limits<float>::max();
+        float maxX = -std::numeric_limits<float>::max();
+        float maxY = -std::numeric_limits<float>::max();
+        for (uint32_t i = 0; i < 8U; ++i)
+        {
+            glutils::Vec4 corner((0U != (i & 1U)) ? (box.max()[0]) : (box.min()[0]),
+                                 (0U != (i & 2U)) ? (box.max()[1]) : (box.min()[1]),
+                                 (0U != (i & 4U)) ? (box.max()[2]) : (box.min()[2]),
+                                 1.F);
+            glutils::Vec4 clip = m_viewProjectionMatrix * corner;
+
+            /* Boxes crossing the near plane are visible */
+            if ((clip[3] < MIN_CLIP_W) || (clip[2] < -clip[3]))
+            {
+                return true;
+            }
+
+            float invW = 1.F / clip[3];
+            minX = std::min(minX, clip[0] * invW);
+            maxX = std::max(maxX, clip[0] * invW);
+            minY = std::min(minY, clip[1] * invW);
+            maxY = std::max(maxY, clip[1] * invW);
+            minZ = std::min(minZ, clip[2] * invW);
+        }
+
+        /* Get covered pixels, boxes outside the screen are left to the frustum test */
+        float fx0 = std::floor(((minX * 0.5F) + 0.5F) * static_cast<float>(m_width));
+        float fx1 = std::floor(((maxX * 0.5F) + 0.5F) * static_cast<float>(m_width));
+        float fy0 = std::floor(((minY * 0.5F) + 0.5F) * static_cast<float>(m_height));
+        float fy1 = std::floor(((maxY * 0.5F) + 0.5F) * static_cast<float>(m_height));
+        if ((fx1 < 0.F) || (fy1 < 0.F) || (fx0 >= static_cast<float>(m_width)) || (fy0 >= static_cast<float>(m_height)))
+        {
+            return true;
+        }
+        uint32_t x0 = static_cast<uint32_t>(std::max(fx0, 0.F));
+        uint32_t y0 = static_cast<uint32_t>(std::max(fy0, 0.F));
+        uint32_t x1 = static_cast<uint32_t>(std::min(fx1, static_cast<float>(m_width - 1U)));
+        uint32_t y1 = static_cast<uint32_t>(std::min(fy1, static_cast<float>(m_height - 1U)));
+
+        /* Select the level where the rectangle covers a few texels */
+        size_t level = 0U;
+        while (((level + 1U) < m_levels.size()) && ((((x1 >> level) - (x0 >> level)) >= MAX_TEST_TEXELS) || (((y1 >> level) - (y0 >> level)) >= MAX_TEST_TEXELS)))
+        {
+            ++level;
+        }
+
+        /* The box is visible if its nearest depth is not behind the farthest occluder depth of any texel */
+        float boxDepth = (minZ * 0.5F) + 0.5F;
+        const Level& hiz = m_levels[level];
+        for (uint32_t y = (y0 >> level); y <= (y1 >> level); ++y)
+        {
+            for (uint32_t x = (x0 >> level); x <= (x1 >> level); ++x)
+            {
+                if (hiz.depth[(y * hiz.width) + x] >= boxDepth)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void OcclusionCuller::addTestResults(uint32_t tested, uint32_t culled)
+    {
+        m_stats.tested += tested;
+        m_stats.culled += culled;
+    }
+
+    void OcclusionCuller::rasterizeTriangle(const glutils::Vec3& v0, const glutils::Vec3& vA, const glutils::Vec3& vB)
+    {
+        /* Make the triangle counter-clockwise */
+        float area = ((vA[0] - v0[0]) * (vB[1] - v0[1])) - ((vA[1] - v0[1]) * (vB[0] - v0[0]));
+        if (std::fabs(area) < MIN_TRIANGLE_AREA)
+        {
+            return;
+        }
+        const glutils::Vec3& v1 = (area > 0.F) ? (vA) : (vB);
+        const glutils::Vec3& v2 = (area > 0.F) ? (vB) : (vA);
+        area = std::fabs(area);
+
+        /* Get bounding rectangle, clamped to the buffer and aligned to the SIMD width */
+        float minX = std::min(v0[0], std::min(v1[0], v2[0]));
+        float maxX = std::max(v0[0], std::max(v1[0], v2[0]));
+        float minY = std::min(v0[1], std::min(v1[1], v2[1]));
+        float maxY = std::max(v0[1], std::max(v1[1], v2[1]));
+        if ((maxX < 0.F) || (maxY < 0.F) || (minX >= static_cast<float>(m_width)) || (minY >= static_cast<float>(m_height)))
+        {
+            return;
+        }
+        uint32_t x0 = static_cast<uint32_t>(std::max(minX, 0.F)) & ~(RASTER_LANES - 1U);
+        uint32_t y0 = static_cast<uint32_t>(std::max(minY, 0.F));
+        uint32_t x1 = static_cast<uint32_t>(std::min(maxX, static_cast<float>(m_width - 1U)));
+        uint32_t y1 = static_cast<uint32_t>(std::min(maxY, static_cast<float>(m_height - 1U)));
+
+        /* Edge functions as a*x + b*y + c, edge i is opposite to vertex i */
+        const glutils::Vec3* verts[3] = { &v0, &v1, &v2 };
+        float ea[3];
+        float eb[3];
+        float ec[3];
+        for (size_t i = 0; i < 3; ++i)
+        {
+            const glutils::Vec3& a = *verts[(i + 1U) % 3U];
+            const glutils::Vec3& b = *verts[(i + 2U) % 3U];
+            ea[i] = a[1] - b[1];
+            eb[i] = b[0] - a[0];
+            ec[i] = ((b[1] - a[1]) * a[0]) - ((b[0] - a[0]) * a[1]);
+        }
+
+        /* Depth interpolation from the barycentric weights of vertices 1 and 2 */
+        glutils::Float4 z0 = glutils::Float4::splat(v0[2]);
+        glutils::Float4 dz1 = glutils::Float4::splat((v1[2] - v0[2]) / area);
+        glutils::Float4 dz2 = glutils::Float4::splat((v2[2] - v0[2]) / area);
+
+        glutils::Float4 a0 = glutils::Float4::splat(ea[0]);
+        glutils::Float4 a1 = glutils::Float4::splat(ea[1]);
+        glutils::Float4 a2 = glutils::Float4::splat(ea[2]);
+        glutils::Float4 zero = glutils::Float4::splat(0.F);
+        glutils::Float4 laneStep = glutils::Float4::splat(static_cast<float>(RASTER_LANES));
+        glutils::Float4 laneCenters = glutils::Float4::set(0.5F, 1.5F, 2.5F, 3.5F);
+
+        float* depth = m_levels[0].depth.data();
+        for (uint32_t y = y0; y <= y1; ++y)
+        {
+            /* Row constant part of the edge functions at pixel centers */
+            float py = static_cast<float>(y) + 0.5F;
+            glutils::Float4 r0 = glutils::Float4::splat((eb[0] * py) + ec[0]);
+            glutils::Float4 r1 = glutils::Float4::splat((eb[1] * py) + ec[1]);
+            glutils::Float4 r2 = glutils::Float4::splat((eb[2] * py) + ec[2]);
+
+            glutils::Float4 px = glutils::Float4::splat(static_cast<float>(x0)) + laneCenters;
+            float* row = depth + (y * m_width);
+            for (uint32_t x = x0; x <= x1; x += RASTER_LANES)
+            {
+                /* Evaluate edge functions for four pixels */
+                glutils::Float4 w0 = glutils::Float4::madd(a0, px, r0);
+                glutils::Float4 w1 = glutils::Float4::madd(a1, px, r1);
+                glutils::Float4 w2 = glutils::Float4::madd(a2, px, r2);
+                glutils::Float4 inside = glutils::Float4::greaterEqual(w0, zero) & glutils::Float4::greaterEqual(w1, zero) & glutils::Float4::greaterEqual(w2, zero);
+
+                /* Keep the nearest depth for covered pixels */
+                if (0U != glutils::Float4::bitMask(inside))
+                {
+                    glutils::Float4 z = glutils::Float4::madd(w2, dz2, glutils::Float4::madd(w1, dz1, z0));
+                    glutils::Float4 current = glutils::Float4::load(row + x);
+                    glutils::Float4 update = inside & glutils::Float4::lessThan(z, current);
+                    glutils::Float4::select(update, z, current).store(row + x);
+                }
+
+                px = px + laneStep;
+            }
+        }
+    }
+}
+
+}
@@ -30,7 +30,6 @@
 
 #include "ares/core/PBRMaterial.hpp"
 #include "ares/core/LightNode.hpp"
-#include "ares/glutils/ShaderManager.hpp"
 
 namespace ares
 {
@@ -49,7 +48,6 @@ namespace core
     constexpr char MVMX_UNIF_NAME[]                    = "u_mvMx";
     constexpr char PMX_UNIF_NAME[]                     = "u_pMx";
     constexpr char NORMMX_UNIF_NAME[]                  = "u_normMx";
-    constexpr char LIGHTPOS_UNIF_NAME[]                = "u_lightPos";
     constexpr char BASE_COLOR_FACTOR_UNIF_NAME[]       = "u_baseColorFactor";
     constexpr char EMISSIVE_FACTOR_UNIF_NAME[]         = "u_emissiveFactor";
     constexpr char METALLIC_FACTOR_UNIF_NAME[]         = "u_metallicFactor";
@@ -77,7 +75,7 @@ namespace core
         "attribute vec3 COLOR_0;\n"
         "uniform mat4 u_mvMx;\n"
         "uniform mat4 u_pMx;\n"
-        "uniform mat4 u_normMx;\n"
+        "uniform mat3 u_normMx;\n"
         "varying vec3 v_pos;\n"
         "varying vec3 v_norm;\n"
         "varying vec3 v_tang;\n"
@@ -85,10 +83,17 @@ namespace core
         "varying vec2 v_uv;\n"
         "void main(void)\n"
         "{\n"
-        "  v_pos = vec3(u_mvMx * vec4(POSITION, 1.0));\n"
-        "  v_norm = normalize(mat3(u_normMx) * NORMAL);\n"
-        "  v_tang = normalize(mat3(u_normMx) * vec3(TANGENT));\n"
-        "  v_bita = normalize(mat3(u_normMx) * cross(NORMAL, vec3(TANGENT)));\n"
+        "#ifdef ARES_INSTANCING\n"
+        "  mat4 mvMx = u_mvMx * instanceModelMatrix();\n"
+        "  mat3 normMx = u_normMx * instanceNormalMatrix();\n"
+        "#else\n"
+        "  mat4 mvMx = u_mvMx;\n"
+        "  mat3 normMx = u_normMx;\n"
+        "#endif\n"
+        "  v_pos = vec3(mvMx * vec4(POSITION, 1.0));\n"
+        "  v_norm = normalize(normMx * NORMAL);\n"
+        "  v_tang = normalize(normMx * vec3(TANGENT));\n"
+        "  v_bita = normalize(normMx * cross(NORMAL, vec3(TANGENT)));\n"
         "  v_uv = TEXCOORD_0;\n"
         "  gl_Position = u_pMx * vec4(v_pos, 1.0);\n"
         "}";
@@ -102,7 +107,6 @@ namespace core
         "varying vec3 v_tang;\n"
         "varying vec3 v_bita;\n"
         "varying vec2 v_uv;\n"
-        "uniform vec3 u_lightPos;\n"
         "uniform vec3 u_baseColorFactor;\n"
         "uniform vec3 u_emissiveFactor;\n"
         "uniform float u_metallicFactor;\n"
@@ -201,39 +205,52 @@ namespace core
         "    // reflectance equation\n"
         "    vec3 Lo = vec3(0.0);\n"
         "\n"
-        "    // calculate per-light radiance\n"
-        "    vec3 L = normalize(u_lightPos - v_pos);\n"
-        "    vec3 H = normalize(V + L);\n"
-        "    float distance = length(L);\n"
-        "    float attenuation = 1.0 / (distance * distance);\n"
-        "    vec3 radiance = vec3(1.0) * attenuation;\n"
+        "#ifdef ARES_LIGHT_PREPASS\n"
+        "    // diffuse radiance and specular luminance accumulated in the light buffer\n"
+        "    vec4 lightBuffer = aresLightBuffer();\n"
+        "    Lo = (1.0 - metallic) * (vec3(1.0) - F0) * albedo / PI * lightBuffer.rgb + F0 * lightBuffer.a;\n"
+        "#else\n"
+        "    // accumulate the lights of the fragment cluster\n"
+        "    float listOffset;\n"
+        "    float lightCount = aresLightCount(v_pos, listOffset);\n"
+        "    for (int i = 0; i < ARES_MAX_LIGHTS; ++i)\n"
+        "    {\n"
+        "        if (float(i) >= lightCount) break;\n"
         "\n"
-        "    // Cook-Torrance BRDF\n"
-        "    float NDF = DistributionGGX(N, H, roughness);   \n"
-        "    float G   = GeometrySmith(N, V, L, roughness);     \n" 
-        "    vec3 F    = fresnelSchlick(max(dot(H, V), 0.0), F0);\n"
-        "       \n"
-        "    vec3 numerator    = NDF * G * F; \n"
-        "    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001; // + 0.0001 to prevent divide by zero\n"
-        "    vec3 specular = numerator / denominator;\n"
-        "    \n"
-        "    // kS is equal to Fresnel\n"
-        "    vec3 kS = F;\n"
-        "    // for energy conservation, the diffuse and specular light can't\n"
-        "    // be above 1.0 (unless the surface emits light); to preserve this\n"
-        "    // relationship the diffuse component (kD) should equal 1.0 - kS.\n"
-        "    vec3 kD = vec3(1.0) - kS;\n"
-        "    // multiply kD by the inverse metalness such that only non-metals \n"
-        "    // have diffuse lighting, or a linear blend if partly metal (pure metals\n"
-        "    // have no diffuse light).\n"
-        "    kD *= 1.0 - metallic;	  \n"
+        "        // calculate per-light direction and attenuated radiance\n"
+        "        vec3 L;\n"
+        "        vec3 radiance;\n"
+        "        aresLight(float(i), listOffset, v_pos, L, radiance);\n"
+        "        vec3 H = normalize(V + L);\n"
         "\n"
-        "    // scale light by NdotL\n"
-        "    float NdotL = max(dot(N, L), 0.0);        \n"
+        "        // Cook-Torrance BRDF\n"
+        "        float NDF = DistributionGGX(N, H, roughness);\n"
+        "        float G   = GeometrySmith(N, V, L, roughness);\n"
+        "        vec3 F    = fresnelSchlick(max(dot(H, V), 0.0), F0);\n"
+        "\n"
+        "        vec3 numerator    = NDF * G * F;\n"
+        "        float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001; // + 0.0001 to prevent divide by zero\n"
+        "        vec3 specular = numerator / denominator;\n"
+        "\n"
+        "        // kS is equal to Fresnel\n"
+        "        vec3 kS = F;\n"
+        "        // for energy conservation, the diffuse and specular light can't\n"
+        "        // be above 1.0 (unless the surface emits light); to preserve this\n"
+        "        // relationship the diffuse component (kD) should equal 1.0 - kS.\n"
+        "        vec3 kD = vec3(1.0) - kS;\n"
+        "        // multiply kD by the inverse metalness such that only non-metals \n"
+        "        // have diffuse lighting, or a linear blend if partly metal (pure metals\n"
+        "        // have no diffuse light).\n"
+        "        kD *= 1.0 - metallic;\n"
+        "\n"
+        "        // scale light by NdotL\n"
+        "        float NdotL = max(dot(N, L), 0.0);\n"
+        "\n"
+        "        // add to outgoing radiance Lo\n"
+        "        Lo += (kD * albedo / PI + specular) * radiance * NdotL;  // note that we already multiplied the BRDF by the Fresnel (kS) so we won't multiply by kS again\n"
+        "    }\n"
+        "#endif\n"
         "\n"
-        "    // add to outgoing radiance Lo\n"
-        "    Lo += (kD * albedo / PI + specular) * radiance * NdotL;  // note that we already multiplied the BRDF by the Fresnel (kS) so we won't multiply by kS again\n"
-        "    \n"
         "    // ambient lighting (note that the next IBL tutorial will replace \n"
         "    // this ambient lighting with environment lighting).\n"
         "    vec3 ambient = vec3(0.09) * albedo * ao;\n"
@@ -271,129 +288,82 @@ namespace core
         , m_metallicRoughnessTex(metallicRoughnessTex)
     {
         /* Get/compile shader */
-        m_shader = glutils::ShaderManager::getShader(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE);
-        if (nullptr != m_shader)
-        {
-            /* Add uniforms */
-            m_shader->addUniform<glutils::UniformMat4>(MVMX_UNIF_NAME);
-            m_shader->addUniform<glutils::UniformMat4>(PMX_UNIF_NAME);
-            m_shader->addUniform<glutils::UniformMat4>(NORMMX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform3f>(LIGHTPOS_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform3f>(BASE_COLOR_FACTOR_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform3f>(EMISSIVE_FACTOR_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1f>(METALLIC_FACTOR_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1f>(ROUGHNESS_FACTOR_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(BASE_COLOR_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(EMISSIVE_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(NORMAL_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(OCCLUSION_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(METAL_ROUGHNESS_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(HAS_BASE_COLOR_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(HAS_EMISSIVE_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(HAS_NORMAL_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(HAS_OCCLUSION_TEX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1i>(HAS_METAL_ROUGHNESS_TEX_UNIF_NAME);
-        }
+        setShaderSources(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE, ClusteredLighting::FRAG_SHADER_HEADER, LightPrePass::FRAG_SHADER_HEADER);
     }
 
-    void PBRMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    void PBRMaterial::resolveUniforms(glutils::Shader& shader, ShaderVariant variant)
     {
-        /* Get uniforms */
-        glutils::UniformMat4Ptr mvmxUnif                 = m_shader->getUniform<glutils::UniformMat4>(MVMX_UNIF_NAME);
-        glutils::UniformMat4Ptr pmxUnif                  = m_shader->getUniform<glutils::UniformMat4>(PMX_UNIF_NAME);
-        glutils::UniformMat4Ptr normmxUnif               = m_shader->getUniform<glutils::UniformMat4>(NORMMX_UNIF_NAME);
-        glutils::Uniform3fPtr   lightPosUnif             = m_shader->getUniform<glutils::Uniform3f>(LIGHTPOS_UNIF_NAME);
-        glutils::Uniform3fPtr   baseColorFactorUnif      = m_shader->getUniform<glutils::Uniform3f>(BASE_COLOR_FACTOR_UNIF_NAME);
-        glutils::Uniform3fPtr   emissiveFactorUnif       = m_shader->getUniform<glutils::Uniform3f>(EMISSIVE_FACTOR_UNIF_NAME);
-        glutils::Uniform1fPtr   metallicFactorUnif       = m_shader->getUniform<glutils::Uniform1f>(METALLIC_FACTOR_UNIF_NAME);
-        glutils::Uniform1fPtr   roughnessFactorUnif      = m_shader->getUniform<glutils::Uniform1f>(ROUGHNESS_FACTOR_UNIF_NAME);
-        glutils::Uniform1iPtr   baseColorTexUnif         = m_shader->getUniform<glutils::Uniform1i>(BASE_COLOR_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   emissiveTexUnif          = m_shader->getUniform<glutils::Uniform1i>(EMISSIVE_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   normalTexUnif            = m_shader->getUniform<glutils::Uniform1i>(NORMAL_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   occlusionTexUnif         = m_shader->getUniform<glutils::Uniform1i>(OCCLUSION_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   metalRoughnessTexUnif    = m_shader->getUniform<glutils::Uniform1i>(METAL_ROUGHNESS_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   hasBaseColorTexUnif      = m_shader->getUniform<glutils::Uniform1i>(HAS_BASE_COLOR_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   hasEmissiveTexUnif       = m_shader->getUniform<glutils::Uniform1i>(HAS_EMISSIVE_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   hasNormalTexUnif         = m_shader->getUniform<glutils::Uniform1i>(HAS_NORMAL_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   hasOcclusionTexUnif      = m_shader->getUniform<glutils::Uniform1i>(HAS_OCCLUSION_TEX_UNIF_NAME);
-        glutils::Uniform1iPtr   hasMetalRoughnessTexUnif = m_shader->getUniform<glutils::Uniform1i>(HAS_METAL_ROUGHNESS_TEX_UNIF_NAME);
+        /* Resolve uniform handles */
+        UniformHandles& handles = m_uniforms[static_cast<size_t>(variant)];
+        handles.mvMx                 = shader.uniformHandle<glutils::UniformMat4>(MVMX_UNIF_NAME);
+        handles.pMx                  = shader.uniformHandle<glutils::UniformMat4>(PMX_UNIF_NAME);
+        handles.normMx               = shader.uniformHandle<glutils::UniformMat3>(NORMMX_UNIF_NAME);
+        handles.baseColorFactor      = shader.uniformHandle<glutils::Uniform3f>(BASE_COLOR_FACTOR_UNIF_NAME);
+        handles.emissiveFactor       = shader.uniformHandle<glutils::Uniform3f>(EMISSIVE_FACTOR_UNIF_NAME);
+        handles.metallicFactor       = shader.uniformHandle<glutils::Uniform1f>(METALLIC_FACTOR_UNIF_NAME);
+        handles.roughnessFactor      = shader.uniformHandle<glutils::Uniform1f>(ROUGHNESS_FACTOR_UNIF_NAME);
+        handles.hasBaseColorTex      = shader.uniformHandle<glutils::Uniform1i>(HAS_BASE_COLOR_TEX_UNIF_NAME);
+        handles.hasEmissiveTex       = shader.uniformHandle<glutils::Uniform1i>(HAS_EMISSIVE_TEX_UNIF_NAME);
+        handles.hasNormalTex         = shader.uniformHandle<glutils::Uniform1i>(HAS_NORMAL_TEX_UNIF_NAME);
+        handles.hasOcclusionTex      = shader.uniformHandle<glutils::Uniform1i>(HAS_OCCLUSION_TEX_UNIF_NAME);
+        handles.hasMetalRoughnessTex = shader.uniformHandle<glutils::Uniform1i>(HAS_METAL_ROUGHNESS_TEX_UNIF_NAME);
+        shader.setSampler(BASE_COLOR_TEX_UNIF_NAME, 0);
+        shader.setSampler(EMISSIVE_TEX_UNIF_NAME, 1);
+        shader.setSampler(NORMAL_TEX_UNIF_NAME, 2);
+        shader.setSampler(OCCLUSION_TEX_UNIF_NAME, 3);
+        shader.setSampler(METAL_ROUGHNESS_TEX_UNIF_NAME, 4);
+        ClusteredLighting::resolveUniforms(shader, handles.lighting);
+        LightPrePass::resolveUniforms(shader, handles.lightBuffer);
+    }
 
-        /* Make sure uniforms are valid */
-        if (
-            (nullptr != mvmxUnif)              &&
-            (nullptr != pmxUnif)               &&
-            (nullptr != normmxUnif)            &&
-            (nullptr != baseColorFactorUnif)   &&
-            (nullptr != emissiveFactorUnif)    &&
-            (nullptr != roughnessFactorUnif)   &&
-            (nullptr != lightPosUnif)          &&
-            (nullptr != lightPosUnif)          &&
-            (nullptr != baseColorTexUnif)      &&
-            (nullptr != emissiveTexUnif)       &&
-            (nullptr != normalTexUnif)         &&
-            (nullptr != occlusionTexUnif)      &&
-            (nullptr != metalRoughnessTexUnif) &&
-            (nullptr != hasBaseColorTexUnif)   &&
-            (nullptr != hasEmissiveTexUnif)    &&
-            (nullptr != hasNormalTexUnif)      &&
-            (nullptr != hasOcclusionTexUnif)   &&
-            (nullptr != hasMetalRoughnessTexUnif)
-           )
-        {
-            /* Set uniforms */
-            mvmxUnif->setAndCommit(mvMatrix);
-            pmxUnif->setAndCommit(projectionMatrix);
-            normmxUnif->setAndCommit(normalMatrix);
-            baseColorFactorUnif->setAndCommit(m_baseColorFactor);
-            emissiveFactorUnif->setAndCommit(m_emissiveFactor);
-            metallicFactorUnif->setAndCommit(m_metallicFactor);
-            roughnessFactorUnif->setAndCommit(m_roughnessFactor);
-            baseColorTexUnif->setAndCommit(0);
-            emissiveTexUnif->setAndCommit(1);
-            normalTexUnif->setAndCommit(2);
-            occlusionTexUnif->setAndCommit(3);
-            metalRoughnessTexUnif->setAndCommit(4);
+    void PBRMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    {
+        /* Get uniform handles of the active variant */
+        const UniformHandles& handles = m_uniforms[static_cast<size_t>(m_activeVariant)];
 
-            /* Activate texture */
-            hasBaseColorTexUnif->setAndCommit((nullptr != m_baseColorTex) ? (1) : (0));
-            if (nullptr != m_baseColorTex)
-            {
-                m_baseColorTex->activate(0);
-            }
-            
-            hasEmissiveTexUnif->setAndCommit((nullptr != m_emissiveTex) ? (1) : (0));
-            if (nullptr != m_emissiveTex)
-            {
-                m_emissiveTex->activate(1);
-            }
+        /* Set uniforms */
+        m_activeShader->setUniform(handles.mvMx, mvMatrix);
+        m_activeShader->setUniform(handles.pMx, projectionMatrix);
+        m_activeShader->setUniform(handles.normMx, normalMatrix);
+        m_activeShader->setUniform(handles.baseColorFactor, m_baseColorFactor);
+        m_activeShader->setUniform(handles.emissiveFactor, m_emissiveFactor);
+        m_activeShader->setUniform(handles.metallicFactor, m_metallicFactor);
+        m_activeShader->setUniform(handles.roughnessFactor, m_roughnessFactor);
 
-            hasNormalTexUnif->setAndCommit((nullptr != m_normalTex) ? (1) : (0));
-            if (nullptr != m_normalTex)
-            {
-                m_normalTex->activate(2);
-            }
+        /* Activate texture */
+        m_activeShader->setUniform(handles.hasBaseColorTex, (nullptr != m_baseColorTex) ? (1) : (0));
+        if (nullptr != m_baseColorTex)
+        {
+            m_baseColorTex->activate(0);
+        }
 
-            hasOcclusionTexUnif->setAndCommit((nullptr != m_occlusionTex) ? (1) : (0));
-            if (nullptr != m_occlusionTex)
-            {
-                m_occlusionTex->activate(3);
-            }
+        m_activeShader->setUniform(handles.hasEmissiveTex, (nullptr != m_emissiveTex) ? (1) : (0));
+        if (nullptr != m_emissiveTex)
+        {
+            m_emissiveTex->activate(1);
+        }
 
-            hasMetalRoughnessTexUnif->setAndCommit((nullptr != m_metallicRoughnessTex) ? (1) : (0));
-            if (nullptr != m_metallicRoughnessTex)
-            {
-                m_metallicRoughnessTex->activate(4);
-            }
+        m_activeShader->setUniform(handles.hasNormalTex, (nullptr != m_normalTex) ? (1) : (0));
+        if (nullptr != m_normalTex)
+        {
+            m_normalTex->activate(2);
+        }
 
-            /* Set lights */
-            if (!lightVec.empty())
-            {
-                //TODO Add support for multiple lights
-                LightNodePtr lightNode = lightVec[0];
-                glutils::Vec3 lightPos = lightNode->lightPosition();
-                lightPosUnif->setAndCommit(lightPos);
-            }
+        m_activeShader->setUniform(handles.hasOcclusionTex, (nullptr != m_occlusionTex) ? (1) : (0));
+        if (nullptr != m_occlusionTex)
+        {
+            m_occlusionTex->activate(3);
         }
+
+        m_activeShader->setUniform(handles.hasMetalRoughnessTex, (nullptr != m_metallicRoughnessTex) ? (1) : (0));
+        if (nullptr != m_metallicRoughnessTex)
+        {
+            m_metallicRoughnessTex->activate(4);
+        }
+
+        /* Set lights */
+        ClusteredLighting::setUniforms(*m_activeShader, handles.lighting);
+        LightPrePass::setUniforms(*m_activeShader, handles.lightBuffer);
     }
 
 }
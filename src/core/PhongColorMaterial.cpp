@@ -30,7 +30,6 @@
 
 #include "ares/core/PhongColorMaterial.hpp"
 #include "ares/core/LightNode.hpp"
-#include "ares/glutils/ShaderManager.hpp"
 
 namespace ares
 {
@@ -56,7 +55,6 @@ namespace core
     constexpr char AMBIENTCOLOR_UNIF_NAME[]  = "u_ambientColor";
     constexpr char DIFFUSECOLOR_UNIF_NAME[]  = "u_diffuseColor";
     constexpr char SPECULARCOLOR_UNIF_NAME[] = "u_specularColor";
-    constexpr char LIGHTPOS_UNIF_NAME[]      = "u_lightPos";
 
     /* Vertex shader code */
     //TODO the vertex shader will likely be the same for all materials, move somewhere common
@@ -70,14 +68,21 @@ namespace core
         "attribute vec3 COLOR_0;\n"
         "uniform mat4 u_mvMx;\n"
         "uniform mat4 u_pMx;\n"
-        "uniform mat4 u_normMx;\n"
+        "uniform mat3 u_normMx;\n"
         "varying vec3 v_norm;\n"
         "varying vec3 v_pos;\n"
         "void main(void)\n"
         "{\n"
-        "  vec4 vertPos4 = u_mvMx * vec4(POSITION, 1.0);\n"
+        "#ifdef ARES_INSTANCING\n"
+        "  mat4 mvMx = u_mvMx * instanceModelMatrix();\n"
+        "  mat3 normMx = u_normMx * instanceNormalMatrix();\n"
+        "#else\n"
+        "  mat4 mvMx = u_mvMx;\n"
+        "  mat3 normMx = u_normMx;\n"
+        "#endif\n"
+        "  vec4 vertPos4 = mvMx * vec4(POSITION, 1.0);\n"
         "  v_pos = vec3(vertPos4) / vertPos4.w;\n"
-        "  v_norm = vec3(u_normMx * vec4(NORMAL, 0.0));\n"
+        "  v_norm = normMx * NORMAL;\n"
         "  gl_Position = u_pMx * vertPos4;\n"
         "}";
 
@@ -95,21 +100,33 @@ namespace core
         "uniform vec3 u_ambientColor;\n"
         "uniform vec3 u_diffuseColor;\n"
         "uniform vec3 u_specularColor;\n"
-        "uniform vec3 u_lightPos;\n"
         "\n"
         "void main() {\n"
         "  vec3 N = normalize(v_norm);\n"
-        "  vec3 L = normalize(u_lightPos - v_pos);\n"
-        "  // Lambert's cosine law\n"
-        "  float diff = max(dot(N, L), 0.0);\n"
-        "  vec3 R = reflect(-L, N);\n"
         "  vec3 V = normalize(-v_pos);\n"
-        "  // Compute the specular term\n"
-        "  float spec = pow(max(dot(V, R), 0.0), u_shininess);\n"
-        "  gl_FragColor = vec4(u_ka * u_ambientColor +\n"
-        "                      u_kd * diff * u_diffuseColor +\n"
-        "                      u_ks * spec * u_specularColor,\n"
-        "                      1.0);\n"
+        "  vec3 color = u_ka * u_ambientColor;\n"
+        "#ifdef ARES_LIGHT_PREPASS\n"
+        "  // Diffuse radiance and specular luminance accumulated in the light buffer\n"
+        "  vec4 lightBuffer = aresLightBuffer();\n"
+        "  color += u_kd * u_diffuseColor * lightBuffer.rgb + u_ks * u_specularColor * lightBuffer.a;\n"
+        "#else\n"
+        "  // Accumulate the lights of the fragment cluster\n"
+        "  float listOffset;\n"
+        "  float lightCount = aresLightCount(v_pos, listOffset);\n"
+        "  for (int i = 0; i < ARES_MAX_LIGHTS; ++i) {\n"
+        "    if (float(i) >= lightCount) break;\n"
+        "    vec3 L;\n"
+        "    vec3 radiance;\n"
+        "    aresLight(float(i), listOffset, v_pos, L, radiance);\n"
+        "    // Lambert's cosine law\n"
+        "    float diff = max(dot(N, L), 0.0);\n"
+        "    vec3 R = reflect(-L, N);\n"
+        "    // Compute the specular term\n"
+        "    float spec = pow(max(dot(V, R), 0.0), u_shininess);\n"
+        "    color += (u_kd * diff * u_diffuseColor + u_ks * spec * u_specularColor) * radiance;\n"
+        "  }\n"
+        "#endif\n"
+        "  gl_FragColor = vec4(color, 1.0);\n"
         "}";
 
     PhongColorMaterial::PhongColorMaterial(const glutils::RGBAColor& ambientColor,
@@ -130,75 +147,47 @@ namespace core
         , m_shininess(shininess)
     {
         /* Get/compile shader */
-        m_shader = glutils::ShaderManager::getShader(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE);
-        if (nullptr != m_shader)
-        {
-            /* Add uniforms */
-            m_shader->addUniform<glutils::UniformMat4>(MVMX_UNIF_NAME);
-            m_shader->addUniform<glutils::UniformMat4>(PMX_UNIF_NAME);
-            m_shader->addUniform<glutils::UniformMat4>(NORMMX_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1f>(KA_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1f>(KD_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1f>(KS_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform1f>(SHININESS_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform3f>(AMBIENTCOLOR_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform3f>(DIFFUSECOLOR_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform3f>(SPECULARCOLOR_UNIF_NAME);
-            m_shader->addUniform<glutils::Uniform3f>(LIGHTPOS_UNIF_NAME);
-        }
+        setShaderSources(VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE, ClusteredLighting::FRAG_SHADER_HEADER, LightPrePass::FRAG_SHADER_HEADER);
     }
 
-    void PhongColorMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    void PhongColorMaterial::resolveUniforms(glutils::Shader& shader, ShaderVariant variant)
     {
-        /* Get uniforms */
-        glutils::UniformMat4Ptr mvmxUnif          = m_shader->addUniform<glutils::UniformMat4>(MVMX_UNIF_NAME);
-        glutils::UniformMat4Ptr pmxUnif           = m_shader->addUniform<glutils::UniformMat4>(PMX_UNIF_NAME);
-        glutils::UniformMat4Ptr normmxUnif        = m_shader->addUniform<glutils::UniformMat4>(NORMMX_UNIF_NAME);
-        glutils::Uniform1fPtr   kaUnif            = m_shader->addUniform<glutils::Uniform1f>(KA_UNIF_NAME);
-        glutils::Uniform1fPtr   kdUnif            = m_shader->addUniform<glutils::Uniform1f>(KD_UNIF_NAME);
-        glutils::Uniform1fPtr   ksUnif            = m_shader->addUniform<glutils::Uniform1f>(KS_UNIF_NAME);
-        glutils::Uniform1fPtr   shininessUnif     = m_shader->addUniform<glutils::Uniform1f>(SHININESS_UNIF_NAME);
-        glutils::Uniform3fPtr   ambientColorUnif  = m_shader->addUniform<glutils::Uniform3f>(AMBIENTCOLOR_UNIF_NAME);
-        glutils::Uniform3fPtr   diffuseColorUnif  = m_shader->addUniform<glutils::Uniform3f>(DIFFUSECOLOR_UNIF_NAME);
-        glutils::Uniform3fPtr   specularColorUnif = m_shader->addUniform<glutils::Uniform3f>(SPECULARCOLOR_UNIF_NAME);
-        glutils::Uniform3fPtr   lightPosUnif      = m_shader->addUniform<glutils::Uniform3f>(LIGHTPOS_UNIF_NAME);
+        /* Resolve uniform handles */
+        UniformHandles& handles = m_uniforms[static_cast<size_t>(variant)];
+        handles.mvMx          = shader.uniformHandle<glutils::UniformMat4>(MVMX_UNIF_NAME);
+        handles.pMx           = shader.uniformHandle<glutils::UniformMat4>(PMX_UNIF_NAME);
+        handles.normMx        = shader.uniformHandle<glutils::UniformMat3>(NORMMX_UNIF_NAME);
+        handles.ka            = shader.uniformHandle<glutils::Uniform1f>(KA_UNIF_NAME);
+        handles.kd            = shader.uniformHandle<glutils::Uniform1f>(KD_UNIF_NAME);
+        handles.ks            = shader.uniformHandle<glutils::Uniform1f>(KS_UNIF_NAME);
+        handles.shininess     = shader.uniformHandle<glutils::Uniform1f>(SHININESS_UNIF_NAME);
+        handles.ambientColor  = shader.uniformHandle<glutils::Uniform3f>(AMBIENTCOLOR_UNIF_NAME);
+        handles.diffuseColor  = shader.uniformHandle<glutils::Uniform3f>(DIFFUSECOLOR_UNIF_NAME);
+        handles.specularColor = shader.uniformHandle<glutils::Uniform3f>(SPECULARCOLOR_UNIF_NAME);
+        ClusteredLighting::resolveUniforms(shader, handles.lighting);
+        LightPrePass::resolveUniforms(shader, handles.lightBuffer);
+    }
+
+    void PhongColorMaterial::onSetup(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    {
+        /* Get uniform handles of the active variant */
+        const UniformHandles& handles = m_uniforms[static_cast<size_t>(m_activeVariant)];
 
-        /* Make sure uniforms are valid */
-        if (
-            (nullptr != mvmxUnif)          &&
-            (nullptr != pmxUnif)           &&
-            (nullptr != normmxUnif)        &&
-            (nullptr != kaUnif)            &&
-            (nullptr != kdUnif)            &&
-            (nullptr != ksUnif)            &&
-            (nullptr != shininessUnif)     &&
-            (nullptr != ambientColorUnif)  &&
-            (nullptr != diffuseColorUnif)  &&
-            (nullptr != specularColorUnif) &&
-            (nullptr != lightPosUnif)
-           )
-        {
-            /* Set uniforms */
-            mvmxUnif->setAndCommit(mvMatrix);
-            pmxUnif->setAndCommit(projectionMatrix);
-            normmxUnif->setAndCommit(normalMatrix);
-            kaUnif->setAndCommit(m_ambientCoeff);
-            kdUnif->setAndCommit(m_diffuseCoeff);
-            ksUnif->setAndCommit(m_specularCoeff);
-            shininessUnif->setAndCommit(m_shininess);
-            ambientColorUnif->setAndCommit(m_ambientColor.toVec3());
-            diffuseColorUnif->setAndCommit(m_diffuseColor.toVec3());
-            specularColorUnif->setAndCommit(m_specularColor.toVec3());
+        /* Set uniforms */
+        m_activeShader->setUniform(handles.mvMx, mvMatrix);
+        m_activeShader->setUniform(handles.pMx, projectionMatrix);
+        m_activeShader->setUniform(handles.normMx, normalMatrix);
+        m_activeShader->setUniform(handles.ka, m_ambientCoeff);
+        m_activeShader->setUniform(handles.kd, m_diffuseCoeff);
+        m_activeShader->setUniform(handles.ks, m_specularCoeff);
+        m_activeShader->setUniform(handles.shininess, m_shininess);
+        m_activeShader->setUniform(handles.ambientColor, m_ambientColor.toVec3());
+        m_activeShader->setUniform(handles.diffuseColor, m_diffuseColor.toVec3());
+        m_activeShader->setUniform(handles.specularColor, m_specularColor.toVec3());
 
-            /* Set lights */
-            if (!lightVec.empty())
-            {
-                //TODO Add support for multiple lights
-                LightNodePtr lightNode = lightVec[0];
-                glutils::Vec3 lightPos = lightNode->lightPosition();
-                lightPosUnif->setAndCommit(lightPos);
-            }
-        }
+        /* Set lights */
+        ClusteredLighting::setUniforms(*m_activeShader, handles.lighting);
+        LightPrePass::setUniforms(*m_activeShader, handles.lightBuffer);
     }
 
 }
@@ -0,0 +1,111 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/core/PipelineState.hpp"
+#include "ares/glutils/GlState.hpp"
+
+#include <stdexcept>
+
+namespace ares
+{
+
+namespace core
+{
+    PipelineState::PipelineState(Material& material, Material::ShaderVariant variant, const std::vector<glutils::AttributeDataPtr>& attributeData, const glutils::AttributeDataPtr& indicesData)
+        : m_shader(material.shader(variant))
+        , m_vertexLayout()
+        , m_rasterState()
+        , m_unusedAttributes()
+    {
+        /* Check shader validity */
+        if (nullptr == m_shader)
+        {
+            throw std::runtime_error("Invalid shader");
+        }
+
+        /* Check that the geometry provides all the shader attributes */
+        for (const auto& attr : m_shader->attributes())
+        {
+            bool provided = Material::isInstanceAttribute(attr->name());
+            for (const auto& data : attributeData)
+            {
+                provided = provided || ((data->name() == attr->name()) && (nullptr != data->vbo()));
+            }
+            if (!provided)
+            {
+                throw std::runtime_error("Attribute " + attr->name() + " used by the shader is not provided by the geometry");
+            }
+        }
+
+        /* Report the geometry attributes not used by the shader */
+        for (const auto& data : attributeData)
+        {
+            if (nullptr == m_shader->getAttribute(data->name()))
+            {
+                m_unusedAttributes.push_back(data->name());
+            }
+        }
+
+        /* Resolve vertex layout and raster state */
+        m_vertexLayout = std::make_shared<glutils::VertexLayout>(*m_shader, attributeData, indicesData);
+        m_rasterState.cullFace = !material.doubleSided();
+        m_rasterState.blend = material.blending();
+        m_rasterState.depthWrite = !material.blending();
+    }
+
+    void PipelineState::bind()
+    {
+        /* Bind program */
+        m_shader->activate();
+
+        /* Set raster state, calls are skipped if already set by the previous draw */
+        glutils::GlState& state = glutils::GlState::current();
+        state.setCapability(GL_CULL_FACE, m_rasterState.cullFace);
+        state.setCapability(GL_BLEND, m_rasterState.blend);
+        if (m_rasterState.blend)
+        {
+            state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        state.depthMask(m_rasterState.depthWrite);
+
+        /* Bind geometry */
+        m_vertexLayout->bind();
+    }
+
+    void PipelineState::unbind()
+    {
+        /* Unbind geometry and program */
+        m_vertexLayout->unbind();
+        m_shader->deactivate();
+    }
+
+}
+
+}
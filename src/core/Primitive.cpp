@@ -29,7 +29,10 @@
  *****************************************************************************/
 
 #include "ares/core/Primitive.hpp"
+#include "ares/glutils/GlState.hpp"
 #include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/Instancing.hpp"
+#include "ares/glutils/Profiler.hpp"
 
 #include <stdexcept>
 
@@ -44,44 +47,166 @@ namespace core
         , m_vertexCount(vertexCount)
         , m_material(material)
         , m_indicesData(indicesData)
+        , m_boundingBox(glutils::BoundingBox::infinite())
+        , m_boundingSphere(glutils::BoundingSphere::fromBox(m_boundingBox))
+        , m_pipelineStates()
     {
         /* Check material validity */
         if (nullptr == material)
         {
             throw std::runtime_error("Invalid material");
         }
+
+        /* Create and validate the default pipeline state */
+        if (nullptr != material->shader())
+        {
+            m_pipelineStates[static_cast<size_t>(Material::ShaderVariant::Default)] = std::make_shared<PipelineState>(*material, Material::ShaderVariant::Default, m_attributeData, m_indicesData);
+        }
+    }
+
+    void Primitive::setBoundingBox(const glutils::BoundingBox& boundingBox)
+    {
+        /* Store box and derive sphere */
+        m_boundingBox = boundingBox;
+        m_boundingSphere = glutils::BoundingSphere::fromBox(boundingBox);
+    }
+
+    void Primitive::draw(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& normalMatrix, const std::vector<LightNodePtr>& lightVec,
+                         Material::ShaderVariant variant)
+    {
+        ARES_PROFILE_SCOPE("render", "Primitive::draw");
+
+        /* Check data validity */
+        PipelineState* pipeline = pipelineState(variant);
+        if (nullptr != pipeline)
+        {
+            /* Bind pipeline and set per-draw constants */
+            pipeline->bind();
+            m_material->setup(variant, mvMatrix, projectionMatrix, normalMatrix, lightVec);
+
+            /* Draw */
+            drawVertices(0);
+
+            /* Unbind pipeline */
+            pipeline->unbind();
+        }
     }
 
-    void Primitive::draw(const glutils::Mat4& mvMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat4& normalMatrix, const std::vector<LightNodePtr>& lightVec)
+    void Primitive::drawInstanced(const glutils::Mat4& viewMatrix, const glutils::Mat4& projectionMatrix, const glutils::Mat3& viewNormalMatrix, const std::vector<LightNodePtr>& lightVec,
+                                  const float* instanceData, GLsizei instanceCount, glutils::Vbo* instanceVbo,
+                                  Material::ShaderVariant variant)
     {
+        ARES_PROFILE_SCOPE("render", "Primitive::drawInstanced");
+
         /* Check data validity */
-        if (nullptr != m_material)
+        if ((nullptr == m_material) || (!m_material->supportsInstancing()) || (!Material::isInstanced(variant)) || (nullptr == instanceData) || (instanceCount <= 0))
         {
-            /* Setup material */
-            m_material->setup(m_attributeData, mvMatrix, projectionMatrix, normalMatrix, lightVec);
+            return;
+        }
+
+        /* Bind the pipeline of the instanced shader and set per-draw constants */
+        PipelineState* pipeline = pipelineState(variant);
+        if (nullptr == pipeline)
+        {
+            return;
+        }
+        pipeline->bind();
+        m_material->setup(variant, viewMatrix, projectionMatrix, viewNormalMatrix, lightVec);
+        const GLint* locations = m_material->instanceAttributeLocations(variant);
+        const GLsizei instanceStride = static_cast<GLsizei>(INSTANCE_MATRIX_ROWS * 4U * sizeof(float));
 
-            /* Check if this is an indexed primitive */
-            if ((nullptr != m_indicesData) && (nullptr != m_indicesData->vbo()))
+        if ((nullptr != instanceVbo) && glutils::Instancing::isSupported())
+        {
+            /* Upload instance data and set up the instance attributes */
+            glutils::GlState& glState = glutils::GlState::current();
+            instanceVbo->setData(instanceData, instanceCount * instanceStride);
+            for (uint32_t row = 0; row < INSTANCE_MATRIX_ROWS; ++row)
             {
-                /* Activate Vbo for indices */
-                m_indicesData->vbo()->activate();
+                if (locations[row] >= 0)
+                {
+                    glState.enableVertexAttribArray(static_cast<GLuint>(locations[row]));
+                    glState.vertexAttribPointer(static_cast<GLuint>(locations[row]), instanceVbo->vbo(), 4, GL_FLOAT, false, instanceStride, row * 4U * sizeof(float));
+                    glutils::Instancing::vertexAttribDivisor(static_cast<GLuint>(locations[row]), 1U);
+                }
+            }
+
+            /* Draw all instances at once */
+            drawVertices(instanceCount);
 
-                /* Draw */
+            /* Reset instance attributes, the arrays must be disabled for pseudo-instancing */
+            for (uint32_t row = 0; row < INSTANCE_MATRIX_ROWS; ++row)
+            {
+                if (locations[row] >= 0)
+                {
+                    glutils::Instancing::vertexAttribDivisor(static_cast<GLuint>(locations[row]), 0U);
+                    glState.disableVertexAttribArray(static_cast<GLuint>(locations[row]));
+                }
+            }
+        }
+        else
+        {
+            /* Draw each instance, only changing the constant instance attributes */
+            for (GLsizei instance = 0; instance < instanceCount; ++instance)
+            {
+                const float* instanceRows = instanceData + (instance * INSTANCE_MATRIX_ROWS * 4U);
+                for (uint32_t row = 0; row < INSTANCE_MATRIX_ROWS; ++row)
+                {
+                    if (locations[row] >= 0)
+                    {
+                        glVertexAttrib4fv(static_cast<GLuint>(locations[row]), instanceRows + (row * 4U));
+                        glutils::GlUtils::checkGLError("glVertexAttrib4fv");
+                    }
+                }
+                drawVertices(0);
+            }
+        }
+
+        /* Unbind pipeline */
+        pipeline->unbind();
+    }
+
+    PipelineState* Primitive::pipelineState(Material::ShaderVariant variant)
+    {
+        /* Create pipeline on first use, if the material has the variant */
+        PipelineStatePtr& pipeline = m_pipelineStates[static_cast<size_t>(variant)];
+        if ((nullptr == pipeline) && (nullptr != m_material->shader(variant)))
+        {
+            pipeline = std::make_shared<PipelineState>(*m_material, variant, m_attributeData, m_indicesData);
+        }
+        return pipeline.get();
+    }
+
+    void Primitive::drawVertices(GLsizei instanceCount)
+    {
+        /* Count the draw, instances are drawn one by one when instanceCount is 0 */
+        glutils::GlState::current().countDraw(static_cast<GLenum>(m_primitiveType), m_vertexCount, (instanceCount > 0) ? instanceCount : 1);
+
+        /* Check if this is an indexed primitive */
+        if ((nullptr != m_indicesData) && (nullptr != m_indicesData->vbo()))
+        {
+            /* Draw, the index buffer is bound with the vertex layout */
+            if (instanceCount > 0)
+            {
+                glutils::Instancing::drawElementsInstanced(static_cast<GLenum>(m_primitiveType), m_vertexCount, static_cast<GLenum>(m_indicesData->type()), (const void*)(intptr_t)m_indicesData->offset(), instanceCount);
+            }
+            else
+            {
                 glDrawElements(static_cast<GLenum>(m_primitiveType), m_vertexCount, static_cast<GLenum>(m_indicesData->type()), (const void*)(intptr_t)m_indicesData->offset());
                 glutils::GlUtils::checkGLError("glDrawElements");
-
-                /* Deactivate indices */
-                m_indicesData->vbo()->deactivate();
+            }
+        }
+        else
+        {
+            /* Draw */
+            if (instanceCount > 0)
+            {
+                glutils::Instancing::drawArraysInstanced(static_cast<GLenum>(m_primitiveType), 0, m_vertexCount, instanceCount);
             }
             else
             {
-                /* Draw */
                 glDrawArrays(static_cast<GLenum>(m_primitiveType), 0, m_vertexCount);
                 glutils::GlUtils::checkGLError("glDrawArrays");
             }
-
-            /* Deactivate material */
-            m_material->deactivate(m_attributeData);
         }
     }
 }
@@ -0,0 +1,150 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/core/RenderQueue.hpp"
+#include "ares/glutils/Profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ares
+{
+
+namespace core
+{
+    /* Size in bits of each field of the sort key */
+    constexpr uint32_t PROGRAM_KEY_BITS  = 11U;
+    constexpr uint32_t MATERIAL_KEY_BITS = 16U;
+    constexpr uint32_t TEXTURE_KEY_BITS  = 12U;
+    constexpr uint32_t DEPTH_KEY_BITS    = 24U;
+
+    /* Position of each field of the sort key */
+    constexpr uint32_t DEPTH_KEY_SHIFT    = 0U;
+    constexpr uint32_t TEXTURE_KEY_SHIFT  = DEPTH_KEY_SHIFT + DEPTH_KEY_BITS;
+    constexpr uint32_t MATERIAL_KEY_SHIFT = TEXTURE_KEY_SHIFT + TEXTURE_KEY_BITS;
+    constexpr uint32_t PROGRAM_KEY_SHIFT  = MATERIAL_KEY_SHIFT + MATERIAL_KEY_BITS;
+    constexpr uint32_t TRANSLUCENT_KEY_SHIFT = PROGRAM_KEY_SHIFT + PROGRAM_KEY_BITS;
+
+    /* Position of the depth field in the keys of translucent items, ahead of the state fields */
+    constexpr uint32_t TRANSLUCENT_DEPTH_KEY_SHIFT = TRANSLUCENT_KEY_SHIFT - DEPTH_KEY_BITS;
+
+    static_assert((TRANSLUCENT_KEY_SHIFT + 1U) == 64U, "Sort key fields must fill 64 bits");
+
+    RenderQueue::RenderQueue()
+        : m_items()
+        , m_order()
+    {
+    }
+
+    void RenderQueue::clear()
+    {
+        m_items.clear();
+        m_order.clear();
+    }
+
+    void RenderQueue::push(Primitive* primitive, const glutils::Mat4& modelMatrix, float viewDepth)
+    {
+        /* Check primitive and material validity */
+        if ((nullptr != primitive) && (nullptr != primitive->material()))
+        {
+            Material* material = primitive->material().get();
+            GLuint program = (nullptr != material->shader()) ? (material->shader()->program()) : (0U);
+
+            /* Add item and its key, the order is the insertion order until sorted */
+            Item item = { makeKey(program, material->id(), material->textureKey(), viewDepth, material->blending()), primitive, material, modelMatrix, viewDepth };
+            m_order.push_back(std::make_pair(item.key, static_cast<uint32_t>(m_items.size())));
+            m_items.push_back(item);
+        }
+    }
+
+    void RenderQueue::append(const RenderQueue& other)
+    {
+        /* Append items and their keys, shifting the item indices */
+        uint32_t offset = static_cast<uint32_t>(m_items.size());
+        m_items.insert(m_items.end(), other.m_items.begin(), other.m_items.end());
+        for (const auto& entry : other.m_order)
+        {
+            m_order.push_back(std::make_pair(entry.first, entry.second + offset));
+        }
+    }
+
+    void RenderQueue::sort()
+    {
+        ARES_PROFILE_SCOPE("render", "RenderQueue::sort");
+
+        /* Sort keys only, ties are resolved by insertion order to keep the result deterministic */
+        std::sort(m_order.begin(), m_order.end());
+    }
+
+    uint64_t RenderQueue::makeKey(GLuint program, uint32_t materialId, uint32_t textureKey, float viewDepth, bool translucent)
+    {
+        /* Positive floats are ordered as their bit patterns, so keep the most significant bits.
+         * Items behind the camera (or with invalid depth) are the nearest ones */
+        uint32_t depthBits = 0U;
+        if (viewDepth > 0.F)
+        {
+            memcpy(&depthBits, &viewDepth, sizeof(depthBits));
+            depthBits >>= (31U - DEPTH_KEY_BITS);
+        }
+
+        /* Pack fields */
+        uint64_t retval = 0U;
+        retval |= (static_cast<uint64_t>(program)    & ((1ULL << PROGRAM_KEY_BITS)  - 1U)) << PROGRAM_KEY_SHIFT;
+        retval |= (static_cast<uint64_t>(materialId) & ((1ULL << MATERIAL_KEY_BITS) - 1U)) << MATERIAL_KEY_SHIFT;
+        retval |= (static_cast<uint64_t>(textureKey) & ((1ULL << TEXTURE_KEY_BITS)  - 1U)) << TEXTURE_KEY_SHIFT;
+        uint64_t depth = static_cast<uint64_t>(depthBits) & ((1ULL << DEPTH_KEY_BITS) - 1U);
+
+        if (translucent)
+        {
+            /* Translucent items go last and back-to-front, the inverted depth takes precedence over the state */
+            uint64_t invertedDepth = depth ^ ((1ULL << DEPTH_KEY_BITS) - 1U);
+            retval = (1ULL << TRANSLUCENT_KEY_SHIFT) | (invertedDepth << TRANSLUCENT_DEPTH_KEY_SHIFT) | (retval >> DEPTH_KEY_BITS);
+        }
+        else
+        {
+            retval |= depth << DEPTH_KEY_SHIFT;
+        }
+
+        return retval;
+    }
+
+    uint64_t RenderQueue::stateKey(uint64_t key)
+    {
+        uint32_t depthShift = isTranslucent(key) ? (TRANSLUCENT_DEPTH_KEY_SHIFT) : (DEPTH_KEY_SHIFT);
+        return key & ~(((1ULL << DEPTH_KEY_BITS) - 1U) << depthShift);
+    }
+
+    bool RenderQueue::isTranslucent(uint64_t key)
+    {
+        return 0U != (key & (1ULL << TRANSLUCENT_KEY_SHIFT));
+    }
+}
+
+}
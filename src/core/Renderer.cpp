@@ -30,8 +30,15 @@
 
 #include "ares/core/Renderer.hpp"
 #include "ares/core/MeshNode.hpp"
+#include "ares/glutils/GlState.hpp"
 #include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/Instancing.hpp"
+#include "ares/glutils/MemoryTracker.hpp"
+#include "ares/glutils/Profiler.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <stdexcept>
 
 namespace ares
@@ -39,15 +46,59 @@ namespace ares
 
 namespace core
 {
+    /* Maximum number of mesh nodes gathered per chunk */
+    constexpr size_t GATHER_GRAIN_SIZE = 64U;
+
+    /* Minimum number of copies of a primitive to draw them with instancing */
+    constexpr size_t MIN_INSTANCE_COUNT = 2U;
+
+    /* Relative tolerance to consider a model matrix free of non-uniform scale and shear */
+    constexpr float UNIFORM_SCALE_TOLERANCE = 1.0E-3F;
+
+    /* Returns the time elapsed since the start of a lap (ms) and starts the next lap */
+    static float lapTimeMs(std::chrono::steady_clock::time_point& lapStart)
+    {
+        auto now = std::chrono::steady_clock::now();
+        float retval = std::chrono::duration<float, std::milli>(now - lapStart).count();
+        lapStart = now;
+        return retval;
+    }
+
     Renderer::Renderer()
-        : m_viewMatrix()
+        : m_taskPool(std::make_shared<TaskPool>())
+        , m_viewMatrix()
         , m_projectionMatrix()
         , m_bgColor()
+        , m_frustumCulling(true)
+        , m_frustum()
+        , m_occlusionCulling(false)
+        , m_occlusionCuller()
+        , m_clusteredLighting()
+        , m_renderMode(RenderMode::Forward)
+        , m_lightPrePass()
+        , m_visibleMeshNodes()
+        , m_renderQueue()
+        , m_gatherChunks()
+        , m_instancing(true)
+        , m_runOrder()
+        , m_instanceData()
+        , m_instanceVbo()
+        , m_statsEnabled(false)
+        , m_stats()
+        , m_gpuTimer()
+        , m_frameScope(m_gpuTimer.scopeId("frame"))
+        , m_clearScope(m_gpuTimer.scopeId("clear"))
+        , m_normalDepthScope(m_gpuTimer.scopeId("normalDepth"))
+        , m_lightAccumulationScope(m_gpuTimer.scopeId("lightAccumulation"))
+        , m_opaqueScope(m_gpuTimer.scopeId("opaque"))
+        , m_swapScope(m_gpuTimer.scopeId("swap"))
     {
     }
 
     void Renderer::render(ScenePtr scene)
     {
+        ARES_PROFILE_SCOPE("render", "Renderer::render");
+
         /* Check for valid scene */
         if (nullptr == scene)
         {
@@ -70,6 +121,21 @@ namespace core
         /* Activate the scene */
         scene->activate();
 
+        /* Start the statistics of the frame from the current OpenGL counters */
+        glutils::GlState& glState = glutils::GlState::current();
+        glutils::GlState::Counters startCounters = {};
+        std::chrono::steady_clock::time_point lapStart;
+        if (m_statsEnabled)
+        {
+            startCounters = glState.counters();
+            lapStart = std::chrono::steady_clock::now();
+            m_gpuTimer.beginFrame();
+            m_gpuTimer.beginScope(m_frameScope);
+        }
+
+        /* Update transforms and bounds of the nodes that changed since last frame */
+        scene->update(m_taskPool.get());
+
         /* Check for valid active camera */
         CameraNodePtr cameraNode = scene->activeCameraNode();
         if (nullptr == cameraNode)
@@ -91,91 +157,418 @@ namespace core
         /* Get projection matrix from camera */
         m_projectionMatrix = camera->projectionMatrix();
 
-        /* Get light vector from scene and set their position in the view */
-        std::vector<LightNodePtr> lightVec = scene->getLightNodes();
-        for (auto& lightNode : lightVec)
+        /* Extract world space frustum from view-projection matrix */
+        glutils::Mat4 viewProjectionMatrix = m_projectionMatrix * m_viewMatrix;
+        m_frustum.setMatrix(viewProjectionMatrix);
+
+        /* Get light registry from scene and refresh the outdated light positions in the view */
+        const std::vector<LightNodePtr>& lightVec = scene->getLightNodes();
+        scene->updateLightPositions(m_viewMatrix);
+
+        /* Assign the lights to the clusters of the view */
+        port::DisplayDevicePtr device = drawingContext->device();
+        m_clusteredLighting.update(lightVec, m_projectionMatrix, device->width(), device->height(), m_taskPool.get());
+        if (m_statsEnabled)
+        {
+            m_stats.updateTimeMs = lapTimeMs(lapStart);
+        }
+
+        /* Get visible mesh nodes from the scene spatial index */
+        m_visibleMeshNodes.clear();
+        scene->queryMeshNodes((m_frustumCulling) ? (m_frustum) : (glutils::Frustum()), m_visibleMeshNodes);
+
+        /* Fill software depth buffer with visible occluders */
+        if (m_occlusionCulling)
+        {
+            rasterizeOccluders(viewProjectionMatrix);
+        }
+        if (m_statsEnabled)
         {
-            /* Apply view matrix to total light node transform (i.e. model matrix) */
-            glutils::Mat4 lightMVMx(m_viewMatrix);
-            lightMVMx *= lightNode->totalTransformMatrix();
+            m_stats.cullTimeMs = lapTimeMs(lapStart);
+        }
 
-            /* Transform light node local origin with model-view matrix */
-            glutils::Vec4 lightPos(0.F, 0.F, 0.F, 1.F);
-            lightPos = lightMVMx * lightPos;
-            lightPos /= lightPos[3];
+        /* Collect primitives of visible mesh nodes */
+        gatherVisibleMeshNodes();
+        if (m_statsEnabled)
+        {
+            m_stats.gatherTimeMs = lapTimeMs(lapStart);
+        }
 
-            /* Set light position in the view coordinate system */
-            lightNode->setLightPosition(glutils::Vec3(lightPos[0], lightPos[1], lightPos[2]));
+        /* Sort primitives */
+        m_renderQueue.sort();
+        if (m_statsEnabled)
+        {
+            m_stats.sortTimeMs = lapTimeMs(lapStart);
         }
 
-        /* Enable back-face culling */
-        glEnable(GL_CULL_FACE);
-        glutils::GlUtils::checkGLError("glEnable");
-        glCullFace(GL_BACK);
-        glutils::GlUtils::checkGLError("glCullFace");
-        glFrontFace(GL_CCW);
-        glutils::GlUtils::checkGLError("glFrontFace");
+        /* Cull back faces when enabled by the pipeline states, calls are skipped if already set in the previous frame */
+        glState.cullFace(GL_BACK);
+        glState.frontFace(GL_CCW);
 
-        /* Enable depth test */
-        glEnable(GL_DEPTH_TEST);
-        glutils::GlUtils::checkGLError("glEnable");
-        glDepthFunc(GL_LEQUAL);
-        glutils::GlUtils::checkGLError("glDepthFunc");
+        /* Enable depth test, depth writes must be enabled to clear the depth buffer */
+        glState.setCapability(GL_DEPTH_TEST, true);
+        glState.depthFunc(GL_LEQUAL);
+        glState.depthMask(true);
 
         /* Clear color and depth buffers */
+        beginTimerScope(m_clearScope);
         glClearColor(m_bgColor.red(), m_bgColor.green(), m_bgColor.blue(), m_bgColor.alpha());
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glutils::GlUtils::checkGLError("glClear");
+        endTimerScope();
 
-        /* Render nodes starting from root */
-        glutils::Mat4 ident;
-        ident.setIdentity();
-        renderNode(scene->rootNode(), ident, lightVec);
+        /* Draw primitives */
+        m_clusteredLighting.bind();
+        bool lightPrePass = false;
+        if (RenderMode::LightPrePass == m_renderMode)
+        {
+            /* Render normals and depths if the light pre-pass targets are supported */
+            beginTimerScope(m_normalDepthScope);
+            lightPrePass = m_lightPrePass.beginNormalDepthPass(device->width(), device->height());
+            if (lightPrePass)
+            {
+                submitQueue(lightVec, Material::ShaderVariant::NormalDepth);
+            }
+            endTimerScope();
+        }
+        if (lightPrePass)
+        {
+            /* Accumulate the lights and draw the primitives with the light buffer */
+            beginTimerScope(m_lightAccumulationScope);
+            m_lightPrePass.accumulateLights(lightVec, m_projectionMatrix);
+            endTimerScope();
+            beginTimerScope(m_opaqueScope);
+            m_lightPrePass.bind();
+            submitQueue(lightVec, Material::ShaderVariant::LightBuffer);
+            m_lightPrePass.unbind();
+            endTimerScope();
+        }
+        else
+        {
+            beginTimerScope(m_opaqueScope);
+            submitQueue(lightVec, Material::ShaderVariant::Default);
+            endTimerScope();
+        }
+        m_clusteredLighting.unbind();
+        if (m_statsEnabled)
+        {
+            m_stats.submitTimeMs = lapTimeMs(lapStart);
+        }
 
         /* Finalize the draw */
+        beginTimerScope(m_swapScope);
         drawingContext->draw();
+        endTimerScope();
+
+        /* Complete the statistics of the frame */
+        if (m_statsEnabled)
+        {
+            m_stats.swapTimeMs = lapTimeMs(lapStart);
+            m_gpuTimer.endScope();
+            m_gpuTimer.endFrame();
+            collectStats(*scene, startCounters, glState.counters());
+        }
+
+        /* Dump the memory registry when its interval elapses */
+        glutils::MemoryTracker::endFrame();
+    }
+
+    void Renderer::beginTimerScope(uint32_t scope)
+    {
+        if (m_statsEnabled)
+        {
+            m_gpuTimer.beginScope(scope);
+        }
+    }
+
+    void Renderer::endTimerScope()
+    {
+        if (m_statsEnabled)
+        {
+            m_gpuTimer.endScope();
+        }
+    }
+
+    void Renderer::collectStats(const Scene& scene, const glutils::GlState::Counters& startCounters, const glutils::GlState::Counters& endCounters)
+    {
+        /* OpenGL counters of the frame */
+        m_stats.drawCalls = static_cast<uint32_t>(endCounters.drawCalls - startCounters.drawCalls);
+        m_stats.triangles = endCounters.triangles - startCounters.triangles;
+        m_stats.programBinds = static_cast<uint32_t>(endCounters.programBinds - startCounters.programBinds);
+        m_stats.textureBinds = static_cast<uint32_t>(endCounters.textureBinds - startCounters.textureBinds);
+        m_stats.bufferBinds = static_cast<uint32_t>(endCounters.bufferBinds - startCounters.bufferBinds);
+        m_stats.vertexArrayBinds = static_cast<uint32_t>(endCounters.vertexArrayBinds - startCounters.vertexArrayBinds);
+        m_stats.uniformUploads = static_cast<uint32_t>(endCounters.uniformUploads - startCounters.uniformUploads);
+        m_stats.stateChanges = static_cast<uint32_t>(endCounters.calls - startCounters.calls);
+        m_stats.skippedStateChanges = static_cast<uint32_t>(endCounters.skippedCalls - startCounters.skippedCalls);
+
+        /* Culling results, the culled primitives are counted when merging the gathering results */
+        m_stats.visibleMeshNodes = static_cast<uint32_t>(m_visibleMeshNodes.size());
+        m_stats.culledMeshNodes = static_cast<uint32_t>(scene.getMeshNodes().size() - m_visibleMeshNodes.size());
+        m_stats.visiblePrimitives = static_cast<uint32_t>(m_renderQueue.size());
+
+        m_stats.frameTimeMs = m_stats.updateTimeMs + m_stats.cullTimeMs + m_stats.gatherTimeMs +
+                              m_stats.sortTimeMs + m_stats.submitTimeMs + m_stats.swapTimeMs;
+    }
+
+    void Renderer::gatherVisibleMeshNodes()
+    {
+        ARES_PROFILE_SCOPE("render", "Renderer::gatherVisibleMeshNodes");
+
+        /* Prepare chunk results */
+        size_t chunks = TaskPool::chunkCount(m_visibleMeshNodes.size(), GATHER_GRAIN_SIZE);
+        while (m_gatherChunks.size() < chunks)
+        {
+            m_gatherChunks.push_back(std::unique_ptr<GatherChunk>(new GatherChunk()));
+        }
+
+        /* Cull and queue primitives per chunk */
+        auto gatherChunk = [this](size_t chunk, size_t begin, size_t end)
+        {
+            GatherChunk& results = *(m_gatherChunks[chunk]);
+            results.queue.clear();
+            results.frustumCulled = 0U;
+            results.occlusionTested = 0U;
+            results.occlusionCulled = 0U;
+            for (size_t i = begin; i < end; ++i)
+            {
+                gatherMeshNode(*(m_visibleMeshNodes[i]), results);
+            }
+        };
+        if (nullptr != m_taskPool)
+        {
+            m_taskPool->parallelFor(m_visibleMeshNodes.size(), GATHER_GRAIN_SIZE, gatherChunk);
+        }
+        else
+        {
+            for (size_t chunk = 0; chunk < chunks; ++chunk)
+            {
+                gatherChunk(chunk, chunk * GATHER_GRAIN_SIZE, std::min((chunk + 1U) * GATHER_GRAIN_SIZE, m_visibleMeshNodes.size()));
+            }
+        }
+
+        /* Merge chunk results in order */
+        m_renderQueue.clear();
+        uint32_t culledPrimitives = 0U;
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            const GatherChunk& results = *(m_gatherChunks[chunk]);
+            m_renderQueue.append(results.queue);
+            m_occlusionCuller.addTestResults(results.occlusionTested, results.occlusionCulled);
+            culledPrimitives += results.frustumCulled + results.occlusionCulled;
+        }
+        if (m_statsEnabled)
+        {
+            m_stats.culledPrimitives = culledPrimitives;
+        }
     }
 
-    void Renderer::renderNode(NodePtr node, const glutils::Mat4& parentXform, const std::vector<LightNodePtr>& lightVec)
+    void Renderer::gatherMeshNode(const MeshNode& meshNode, GatherChunk& chunk) const
     {
-        /* Check for valid node */
-        if (nullptr != node)
+        /* Get mesh */
+        MeshPtr mesh = meshNode.mesh();
+        if (nullptr != mesh)
         {
-            /* Get world transform */
-            glutils::Mat4 modelMatrix = parentXform * node->transformMatrix();
+            /* Get cached world transform */
+            const glutils::Mat4& modelMatrix = meshNode.totalTransformMatrix();
+
+            /* Calculate view depth of the node origin (the camera looks towards -Z) */
+            float viewDepth = -(m_viewMatrix * modelMatrix.column(3))[2];
+
+            /* Queue mesh primitives, testing each one if the mesh is split in several primitives */
+            bool testPrimitives = m_frustumCulling && (mesh->primitives().size() > 1U);
+            bool testOcclusion = m_occlusionCulling && (!meshNode.isOccluder());
+            for (auto& primitive : mesh->primitives())
+            {
+                if (nullptr != primitive)
+                {
+                    /* Frustum and occlusion tests on primitive world bounds */
+                    bool visible = true;
+                    if (testPrimitives || testOcclusion)
+                    {
+                        glutils::BoundingBox worldBox = primitive->boundingBox().transformed(modelMatrix);
+                        visible = (!testPrimitives) || m_frustum.intersects(worldBox);
+                        chunk.frustumCulled += (visible) ? (0U) : (1U);
+                        if (visible && testOcclusion)
+                        {
+                            visible = m_occlusionCuller.isVisible(worldBox);
+                            ++chunk.occlusionTested;
+                            chunk.occlusionCulled += (visible) ? (0U) : (1U);
+                        }
+                    }
+
+                    if (visible)
+                    {
+                        chunk.queue.push(primitive.get(), modelMatrix, viewDepth);
+                    }
+                }
+            }
+        }
+    }
 
-            /* Check for mesh type */
-            if (Node::Type::Mesh == node->type())
+    void Renderer::rasterizeOccluders(const glutils::Mat4& viewProjectionMatrix)
+    {
+        ARES_PROFILE_SCOPE("render", "Renderer::rasterizeOccluders");
+
+        m_occlusionCuller.beginFrame(viewProjectionMatrix);
+
+        /* Rasterize visible occluders with occluder geometry */
+        for (auto meshNode : m_visibleMeshNodes)
+        {
+            if (meshNode->isOccluder() && (nullptr != meshNode->mesh()))
             {
-                /* Get mesh */
-                MeshNodePtr meshNode = std::dynamic_pointer_cast<MeshNode>(node);
-                MeshPtr mesh = meshNode->mesh();
-                if (nullptr != mesh)
+                const Mesh& mesh = *(meshNode->mesh());
+                if (!mesh.occluderIndices().empty())
                 {
-                    /* Calculate model-view matrix */
-                    glutils::Mat4 mvMatrix(m_viewMatrix);
-                    mvMatrix *= modelMatrix;
+                    m_occlusionCuller.rasterizeOccluder(mesh.occluderVertices(), mesh.occluderIndices(), meshNode->totalTransformMatrix());
+                }
+            }
+        }
+
+        m_occlusionCuller.buildHierarchy();
+    }
+
+    void Renderer::submitQueue(const std::vector<LightNodePtr>& lightVec, Material::ShaderVariant variant)
+    {
+        ARES_PROFILE_SCOPE("render", "Renderer::submitQueue");
+
+        const char* timedClassName = nullptr;
+        size_t begin = 0U;
+        while (begin < m_renderQueue.size())
+        {
+            /* Find the run of items sharing the same state */
+            uint64_t stateKey = RenderQueue::stateKey(m_renderQueue[begin].key);
+            size_t end = begin + 1U;
+            while ((end < m_renderQueue.size()) && (RenderQueue::stateKey(m_renderQueue[end].key) == stateKey))
+            {
+                ++end;
+            }
 
-                    /* Calculate normal matrix */
-                    glutils::Mat4 normalMatrix(modelMatrix);
-                    normalMatrix.invert();
-                    normalMatrix.transpose();
+            /* Skip the runs the light pre-pass cannot draw in the normal and depth pass,
+             * and shade them forward in the light buffer pass; the material is part of the state */
+            const Material& material = *(m_renderQueue[begin].material);
+            Material::ShaderVariant runVariant = variant;
+            if ((Material::ShaderVariant::Default != variant) && ((!material.supportsLightPrePass()) || material.blending()))
+            {
+                if (Material::ShaderVariant::NormalDepth == variant)
+                {
+                    begin = end;
+                    continue;
+                }
+                runVariant = Material::ShaderVariant::Default;
+            }
 
-                    /* Draw mesh */
-                    mesh->draw(mvMatrix, m_projectionMatrix, normalMatrix, lightVec);
+            /* Time the runs by material class, the runs of a class are mostly contiguous as they share the program */
+            if (m_statsEnabled && (material.className() != timedClassName))
+            {
+                if (nullptr != timedClassName)
+                {
+                    m_gpuTimer.endScope();
                 }
+                timedClassName = material.className();
+                m_gpuTimer.beginScope(m_gpuTimer.scopeId(timedClassName));
             }
 
-            /* Recursion on children */
-            for (auto& childNode : node->children())
+            /* Draw run, translucent items are drawn one by one to keep their back-to-front order */
+            if (m_instancing && ((end - begin) >= MIN_INSTANCE_COUNT) && material.supportsInstancing() && (!material.blending()))
             {
-                renderNode(childNode, modelMatrix, lightVec);
+                submitInstancedRun(begin, end, lightVec, runVariant);
             }
+            else
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    submitItem(m_renderQueue[i], lightVec, runVariant);
+                }
+            }
+
+            begin = end;
         }
-        else
+
+        /* End the timing of the last material class */
+        if (nullptr != timedClassName)
+        {
+            m_gpuTimer.endScope();
+        }
+    }
+
+    void Renderer::submitInstancedRun(size_t begin, size_t end, const std::vector<LightNodePtr>& lightVec, Material::ShaderVariant variant)
+    {
+        /* Create instance buffer on first use */
+        if ((nullptr == m_instanceVbo) && glutils::Instancing::isSupported())
         {
-            throw std::runtime_error("Found null node during rendering");
+            m_instanceVbo = std::make_shared<glutils::Vbo>(nullptr, 0, glutils::Vbo::TargetType::ArrayBuffer, glutils::Vbo::Usage::StreamDraw);
         }
+
+        /* Group items by primitive, keeping the front-to-back order within each group */
+        m_runOrder.clear();
+        for (size_t i = begin; i < end; ++i)
+        {
+            m_runOrder.push_back(i);
+        }
+        std::stable_sort(m_runOrder.begin(), m_runOrder.end(), [this](size_t lhs, size_t rhs)
+        {
+            return std::less<const Primitive*>()(m_renderQueue[lhs].primitive, m_renderQueue[rhs].primitive);
+        });
+
+        /* The instanced shaders combine view and normal matrices with the instance model matrices,
+         * normals are transformed in world space as for the single draws */
+        glutils::Mat3 normalMatrix;
+        normalMatrix.setIdentity();
+
+        size_t groupBegin = 0U;
+        while (groupBegin < m_runOrder.size())
+        {
+            /* Collect the model matrices of the group items that can be instanced, draw the others */
+            Primitive* primitive = m_renderQueue[m_runOrder[groupBegin]].primitive;
+            const RenderQueue::Item* lastInstance = nullptr;
+            size_t groupEnd = groupBegin;
+            m_instanceData.clear();
+            for (; (groupEnd < m_runOrder.size()) && (m_renderQueue[m_runOrder[groupEnd]].primitive == primitive); ++groupEnd)
+            {
+                const RenderQueue::Item& item = m_renderQueue[m_runOrder[groupEnd]];
+                if (item.modelMatrix.hasUniformScale(UNIFORM_SCALE_TOLERANCE))
+                {
+                    for (uint32_t row = 0; row < INSTANCE_MATRIX_ROWS; ++row)
+                    {
+                        glutils::Vec4 rowData = item.modelMatrix.row(row);
+                        m_instanceData.insert(m_instanceData.end(), { rowData[0], rowData[1], rowData[2], rowData[3] });
+                    }
+                    lastInstance = &item;
+                }
+                else
+                {
+                    submitItem(item, lightVec, variant);
+                }
+            }
+
+            /* Draw instances */
+            size_t instanceCount = m_instanceData.size() / (INSTANCE_MATRIX_ROWS * 4U);
+            if (instanceCount >= MIN_INSTANCE_COUNT)
+            {
+                primitive->drawInstanced(m_viewMatrix, m_projectionMatrix, normalMatrix, lightVec, m_instanceData.data(), static_cast<GLsizei>(instanceCount), m_instanceVbo.get(),
+                                         Material::instancedVariant(variant));
+            }
+            else if (nullptr != lastInstance)
+            {
+                submitItem(*lastInstance, lightVec, variant);
+            }
+
+            groupBegin = groupEnd;
+        }
+    }
+
+    void Renderer::submitItem(const RenderQueue::Item& item, const std::vector<LightNodePtr>& lightVec, Material::ShaderVariant variant)
+    {
+        /* Calculate model-view matrix */
+        glutils::Mat4 mvMatrix(m_viewMatrix);
+        mvMatrix *= item.modelMatrix;
+
+        /* Calculate normal matrix */
+        glutils::Mat3 normalMatrix = item.modelMatrix.normalMatrix();
+
+        /* Draw primitive */
+        item.primitive->draw(mvMatrix, m_projectionMatrix, normalMatrix, lightVec, variant);
     }
 }
 
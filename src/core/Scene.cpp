@@ -29,16 +29,39 @@
  *****************************************************************************/
 
 #include "ares/core/Scene.hpp"
+#include "ares/glutils/Profiler.hpp"
+
 
 namespace ares
 {
 
 namespace core
 {
+    /* Minimum number of incremental updates before the mesh index is rebuilt */
+    constexpr size_t INDEX_REBUILD_MIN_UPDATES = 64U;
+
+    /* Number of parallel subtree updates per thread, to balance uneven subtrees */
+    constexpr size_t UPDATE_TASKS_PER_THREAD = 4U;
+
+    /* Maximum depth where dirty branches are split into parallel subtree updates */
+    constexpr uint32_t MAX_UPDATE_SPLIT_DEPTH = 8U;
+
     Scene::Scene(const std::string& name, DrawingContextPtr drawingContext)
         : m_name(name)
         , m_drawingContext(drawingContext)
         , m_rootNode(NodePtr(new Node(std::string(), nullptr)))
+        , m_activeCameraNode()
+        , m_meshIndex()
+        , m_indexedMeshNodes()
+        , m_lightIndex()
+        , m_indexedLightNodes()
+        , m_lightIndexDirty(false)
+        , m_lightViewMatrix()
+        , m_cameraNodes()
+        , m_changedNodes()
+        , m_updateTasks()
+        , m_splitNodes()
+        , m_taskChangedNodes()
     {
         /* Check for valid drawing context */
         if (nullptr == m_drawingContext)
@@ -71,33 +94,317 @@ namespace core
         }
     }
 
-    std::vector<LightNodePtr> Scene::getLightNodes() const
+    void Scene::update(TaskPool* taskPool)
     {
-        /* Parse all nodes for lights starting from root */
+        ARES_PROFILE_SCOPE("render", "Scene::update");
+
+        /* Update dirty branches starting from root */
+        m_changedNodes.clear();
+        if (nullptr != m_rootNode)
+        {
+            if ((nullptr != taskPool) && (taskPool->threadCount() > 1U))
+            {
+                updateParallel(*taskPool);
+            }
+            else
+            {
+                m_rootNode->updateSubtree(&m_changedNodes);
+            }
+        }
+
+        /* Refit or insert changed nodes in the spatial index */
+        for (auto node : m_changedNodes)
+        {
+            if (node->m_spatialId >= 0)
+            {
+                if (Node::Type::Mesh == node->type())
+                {
+                    m_meshIndex.update(static_cast<uint32_t>(node->m_spatialId), node->worldBoundingBox());
+                }
+                else if (Node::Type::Light == node->type())
+                {
+                    /* Cache the new world position and direction (i.e. -Z axis) of the light */
+                    LightNode* lightNode = static_cast<LightNode*>(node);
+                    const glutils::Mat4& worldMatrix = lightNode->totalTransformMatrix();
+                    glutils::Vec4 direction = worldMatrix * glutils::Vec4(0.F, 0.F, -1.F, 0.F);
+                    lightNode->m_worldPosition = worldMatrix.translation();
+                    lightNode->m_worldDirection = glutils::Vec3(direction[0], direction[1], direction[2]);
+                    lightNode->m_worldDirection.normalize();
+                    lightNode->m_lightPositionDirty = true;
+                    m_lightIndexDirty = true;
+                }
+            }
+        }
+
+        /* Rebuild the mesh index if incremental updates degraded it */
+        if ((m_meshIndex.updatesSinceBuild() > INDEX_REBUILD_MIN_UPDATES) && (m_meshIndex.updatesSinceBuild() >= m_meshIndex.itemCount()))
+        {
+            m_meshIndex.rebuild();
+        }
+
+        /* Light count is usually low, rebuild the light index from scratch */
+        if (m_lightIndexDirty)
+        {
+            rebuildLightIndex();
+        }
+    }
+
+    void Scene::updateParallel(TaskPool& taskPool)
+    {
+        /* Nothing to do if the whole graph is clean */
+        if (!m_rootNode->m_subtreeDirty)
+        {
+            return;
+        }
+
+        /* Split dirty branches top-down until there are enough independent subtrees,
+         * split nodes are refreshed here so that their children can be updated concurrently */
+        size_t targetTasks = taskPool.threadCount() * UPDATE_TASKS_PER_THREAD;
+        std::vector<Node*> nextTasks;
+        m_splitNodes.clear();
+        m_updateTasks.assign(1U, m_rootNode.get());
+        for (uint32_t depth = 0; (depth < MAX_UPDATE_SPLIT_DEPTH) && (m_updateTasks.size() < targetTasks); ++depth)
+        {
+            bool split = false;
+            nextTasks.clear();
+            for (auto node : m_updateTasks)
+            {
+                if (node->m_children.empty())
+                {
+                    nextTasks.push_back(node);
+                }
+                else
+                {
+                    node->updateSelf(&m_changedNodes);
+                    m_splitNodes.push_back(node);
+                    for (auto& child : node->m_children)
+                    {
+                        if (child->m_subtreeDirty)
+                        {
+                            nextTasks.push_back(child.get());
+                        }
+                    }
+                    split = true;
+                }
+            }
+            m_updateTasks.swap(nextTasks);
+
+            if (!split)
+            {
+                break;
+            }
+        }
+
+        /* Update subtrees in parallel, collecting changed nodes per chunk */
+        size_t chunks = TaskPool::chunkCount(m_updateTasks.size(), 1U);
+        if (m_taskChangedNodes.size() < chunks)
+        {
+            m_taskChangedNodes.resize(chunks);
+        }
+        taskPool.parallelFor(m_updateTasks.size(), 1U, [this](size_t chunk, size_t begin, size_t end)
+        {
+            m_taskChangedNodes[chunk].clear();
+            for (size_t i = begin; i < end; ++i)
+            {
+                m_updateTasks[i]->updateSubtree(&m_taskChangedNodes[chunk]);
+            }
+        });
+
+        /* Merge changed nodes in chunk order to keep the index updates deterministic */
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            m_changedNodes.insert(m_changedNodes.end(), m_taskChangedNodes[chunk].begin(), m_taskChangedNodes[chunk].end());
+        }
+
+        /* Merge bounds of split nodes bottom-up */
+        for (auto it = m_splitNodes.rbegin(); it != m_splitNodes.rend(); ++it)
+        {
+            (*it)->updateSubtreeBounds();
+        }
+    }
+
+    void Scene::buildSpatialIndex()
+    {
+        /* Update transforms and bounds, then build from scratch */
+        update();
+        m_meshIndex.rebuild();
+        rebuildLightIndex();
+    }
+
+    void Scene::queryMeshNodes(const glutils::Frustum& frustum, std::vector<MeshNode*>& meshNodes) const
+    {
+        /* Query index and map items to nodes */
+        std::vector<uint32_t> items;
+        m_meshIndex.queryFrustum(frustum, items);
+        meshNodes.reserve(meshNodes.size() + items.size());
+        for (auto item : items)
+        {
+            meshNodes.push_back(m_indexedMeshNodes[item].get());
+        }
+    }
+
+    MeshNodePtr Scene::raycast(const glutils::Vec3& origin, const glutils::Vec3& direction, float& distance) const
+    {
+        /* Query index and map item to node */
+        int32_t item = m_meshIndex.queryRay(origin, direction, distance);
+        return (item >= 0) ? (m_indexedMeshNodes[item]) : (nullptr);
+    }
+
+    std::vector<LightNodePtr> Scene::nearestLightNodes(const glutils::Vec3& point, size_t count) const
+    {
+        /* Removing a light node reorders the registry, the index items must match it again */
+        if (m_lightIndexDirty)
+        {
+            rebuildLightIndex();
+        }
+
+        /* Query index and map items to nodes */
+        std::vector<uint32_t> items;
+        m_lightIndex.queryNearest(point, count, items);
+
         std::vector<LightNodePtr> retval;
-        parseNodeForLight(m_rootNode, retval);
+        retval.reserve(items.size());
+        for (auto item : items)
+        {
+            retval.push_back(m_indexedLightNodes[item]);
+        }
         return retval;
     }
 
-    void Scene::parseNodeForLight(NodePtr node, std::vector<LightNodePtr>& lightVec) const
+    void Scene::updateLightPositions(const glutils::Mat4& viewMatrix)
+    {
+        /* All positions must be recomputed if the view changed */
+        bool viewChanged = (viewMatrix != m_lightViewMatrix);
+        m_lightViewMatrix = viewMatrix;
+
+        for (auto& lightNode : m_indexedLightNodes)
+        {
+            if (viewChanged || lightNode->m_lightPositionDirty)
+            {
+                /* Transform the cached light world position with the view matrix */
+                glutils::Vec4 lightPos(lightNode->m_worldPosition[0], lightNode->m_worldPosition[1], lightNode->m_worldPosition[2], 1.F);
+                lightPos = viewMatrix * lightPos;
+                lightPos /= lightPos[3];
+
+                /* Transform the cached light world direction with the view matrix */
+                glutils::Vec4 lightDir(lightNode->m_worldDirection[0], lightNode->m_worldDirection[1], lightNode->m_worldDirection[2], 0.F);
+                lightDir = viewMatrix * lightDir;
+                glutils::Vec3 lightDirection(lightDir[0], lightDir[1], lightDir[2]);
+                lightDirection.normalize();
+
+                /* Set light position and direction in the view coordinate system */
+                lightNode->setLightPosition(glutils::Vec3(lightPos[0], lightPos[1], lightPos[2]));
+                lightNode->setLightDirection(lightDirection);
+                lightNode->m_lightPositionDirty = false;
+            }
+        }
+    }
+
+    void Scene::removeNode(NodePtr node)
     {
-        /* Check for valid node */
-        if (nullptr != node)
+        /* Check the node is not the root */
+        if ((nullptr == node) || (node == m_rootNode))
+        {
+            throw std::runtime_error("Invalid node to remove");
+        }
+
+        /* Check the node belongs to this scene */
+        NodePtr ancestor = node->parent();
+        while ((nullptr != ancestor) && (ancestor != m_rootNode))
+        {
+            ancestor = ancestor->parent();
+        }
+        if (nullptr == ancestor)
+        {
+            throw std::runtime_error("Node " + node->name() + " does not belong to scene " + m_name);
+        }
+
+        /* Unregister the whole subtree */
+        std::vector<Node*> nodeStack(1U, node.get());
+        while (!nodeStack.empty())
         {
-            /* Check if it is a light node */
-            if (Node::Type::Light == node->type())
+            Node* subtreeNode = nodeStack.back();
+            nodeStack.pop_back();
+            for (auto& child : subtreeNode->m_children)
             {
-                /* Add light node to vector */
-                LightNodePtr lightNodePtr = std::dynamic_pointer_cast<LightNode>(node);
-                lightVec.push_back(lightNodePtr);
+                nodeStack.push_back(child.get());
             }
+            unregisterNode(*subtreeNode);
+        }
+
+        /* Detach the subtree from the graph */
+        node->parent()->removeChild(node);
+    }
+
+    void Scene::registerNode(NodePtr node)
+    {
+        /* Assign spatial ID to mesh, light and camera nodes */
+        if (Node::Type::Mesh == node->type())
+        {
+            node->m_spatialId = static_cast<int32_t>(m_indexedMeshNodes.size());
+            m_indexedMeshNodes.push_back(std::static_pointer_cast<MeshNode>(node));
+        }
+        else if (Node::Type::Light == node->type())
+        {
+            node->m_spatialId = static_cast<int32_t>(m_indexedLightNodes.size());
+            m_indexedLightNodes.push_back(std::static_pointer_cast<LightNode>(node));
+            m_lightIndexDirty = true;
+        }
+        else if (Node::Type::Camera == node->type())
+        {
+            node->m_spatialId = static_cast<int32_t>(m_cameraNodes.size());
+            m_cameraNodes.push_back(std::static_pointer_cast<CameraNode>(node));
+        }
+    }
+
+    void Scene::unregisterNode(Node& node)
+    {
+        /* Skip nodes not in a registry */
+        if (node.m_spatialId < 0)
+        {
+            return;
+        }
 
-            /* Recursion on children */
-            for (auto& child : node->children())
+        if (Node::Type::Mesh == node.type())
+        {
+            /* Take the node and the moved one out of the index, then insert the moved one at its new ID */
+            uint32_t lastItem = static_cast<uint32_t>(m_indexedMeshNodes.size() - 1U);
+            m_meshIndex.remove(static_cast<uint32_t>(node.m_spatialId));
+            m_meshIndex.remove(lastItem);
+            uint32_t item = removeFromRegistry(m_indexedMeshNodes, node);
+            if (item != lastItem)
+            {
+                m_meshIndex.update(item, m_indexedMeshNodes[item]->worldBoundingBox());
+            }
+        }
+        else if (Node::Type::Light == node.type())
+        {
+            /* Light index is rebuilt from scratch at the next update */
+            removeFromRegistry(m_indexedLightNodes, node);
+            m_lightIndexDirty = true;
+        }
+        else if (Node::Type::Camera == node.type())
+        {
+            /* Reset the active camera if removed */
+            if (m_activeCameraNode.get() == &node)
             {
-                parseNodeForLight(child, lightVec);
+                m_activeCameraNode.reset();
             }
+            removeFromRegistry(m_cameraNodes, node);
+        }
+    }
+
+    void Scene::rebuildLightIndex() const
+    {
+        /* Use a point box at each light world position */
+        std::vector<glutils::BoundingBox> boxes;
+        boxes.reserve(m_indexedLightNodes.size());
+        for (auto& lightNode : m_indexedLightNodes)
+        {
+            boxes.push_back(glutils::BoundingBox(lightNode->m_worldPosition, lightNode->m_worldPosition));
         }
+        m_lightIndex.build(boxes);
+        m_lightIndexDirty = false;
     }
 
 }
@@ -0,0 +1,73 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/core/SpotLight.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ares
+{
+
+namespace core
+{
+    /* Maximum outer cone angle, a spot light emits in a hemisphere at most */
+    constexpr float MAX_OUTER_CONE_ANGLE = 1.5707963268F;
+
+    /* Minimum difference between the cone angle cosines, to keep the falloff finite */
+    constexpr float MIN_COS_DELTA = 0.001F;
+
+    SpotLight::SpotLight(float innerConeAngle, float outerConeAngle)
+        : Light()
+        , m_innerConeAngle(0.F)
+        , m_outerConeAngle(0.F)
+    {
+        /* Set type */
+        m_type = Type::Spotlight;
+        setConeAngles(innerConeAngle, outerConeAngle);
+    }
+
+    void SpotLight::setConeAngles(float innerConeAngle, float outerConeAngle)
+    {
+        /* Keep 0 <= inner <= outer <= PI/2 */
+        m_outerConeAngle = std::min(std::max(outerConeAngle, 0.F), MAX_OUTER_CONE_ANGLE);
+        m_innerConeAngle = std::min(std::max(innerConeAngle, 0.F), m_outerConeAngle);
+    }
+
+    void SpotLight::coneFalloff(float& scale, float& offset) const
+    {
+        const float cosOuter = std::cos(m_outerConeAngle);
+        const float cosInner = std::cos(m_innerConeAngle);
+        scale = 1.F / std::max(cosInner - cosOuter, MIN_COS_DELTA);
+        offset = -cosOuter * scale;
+    }
+}
+
+}
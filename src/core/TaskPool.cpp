@@ -0,0 +1,201 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/core/TaskPool.hpp"
+#include "ares/glutils/Profiler.hpp"
+
+#include <algorithm>
+
+namespace ares
+{
+
+namespace core
+{
+    TaskPool::TaskPool(int32_t workerCount)
+        : m_workers()
+        , m_mutex()
+        , m_jobCondition()
+        , m_doneCondition()
+        , m_generation(0U)
+        , m_stop(false)
+        , m_func(nullptr)
+        , m_count(0U)
+        , m_grainSize(1U)
+        , m_chunkCount(0U)
+        , m_nextChunk(0U)
+        , m_doneChunks(0U)
+        , m_activeWorkers(0U)
+        , m_exception()
+    {
+        /* Use all hardware threads by default, the calling thread included */
+        if (workerCount < 0)
+        {
+            workerCount = std::max(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 0);
+        }
+
+        /* Start workers */
+        for (int32_t i = 0; i < workerCount; ++i)
+        {
+            m_workers.push_back(std::thread(&TaskPool::workerLoop, this));
+        }
+    }
+
+    TaskPool::~TaskPool()
+    {
+        /* Stop and join workers */
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_jobCondition.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t TaskPool::chunkCount(size_t count, size_t grainSize)
+    {
+        grainSize = std::max(grainSize, static_cast<size_t>(1U));
+        return (count + grainSize - 1U) / grainSize;
+    }
+
+    void TaskPool::parallelFor(size_t count, size_t grainSize, const ChunkFunction& func)
+    {
+        size_t chunks = chunkCount(count, grainSize);
+
+        /* Run inline if there is nothing to share */
+        if (m_workers.empty() || (chunks <= 1U))
+        {
+            grainSize = std::max(grainSize, static_cast<size_t>(1U));
+            for (size_t chunk = 0; chunk < chunks; ++chunk)
+            {
+                func(chunk, chunk * grainSize, std::min((chunk + 1U) * grainSize, count));
+            }
+            return;
+        }
+
+        /* Publish job */
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_func = &func;
+            m_count = count;
+            m_grainSize = std::max(grainSize, static_cast<size_t>(1U));
+            m_chunkCount = chunks;
+            m_nextChunk = 0U;
+            m_doneChunks = 0U;
+            m_exception = nullptr;
+            ++m_generation;
+        }
+        m_jobCondition.notify_all();
+
+        /* Take part in the job */
+        size_t processed = processChunks(func);
+
+        /* Wait for all chunks and for all workers to leave the job */
+        std::exception_ptr exception;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_doneChunks += processed;
+            m_doneCondition.wait(lock, [this]() { return (m_doneChunks == m_chunkCount) && (0U == m_activeWorkers); });
+            m_func = nullptr;
+            exception = m_exception;
+            m_exception = nullptr;
+        }
+
+        /* Forward loop body errors */
+        if (nullptr != exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    void TaskPool::workerLoop()
+    {
+        glutils::Profiler::setThreadName("TaskPool worker");
+
+        uint64_t lastGeneration = 0U;
+        while (true)
+        {
+            /* Wait for a new job */
+            const ChunkFunction* func = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobCondition.wait(lock, [&]() { return m_stop || ((m_generation != lastGeneration) && (nullptr != m_func)); });
+                if (m_stop)
+                {
+                    return;
+                }
+                lastGeneration = m_generation;
+                func = m_func;
+                ++m_activeWorkers;
+            }
+
+            /* Process chunks */
+            size_t processed = processChunks(*func);
+
+            /* Leave the job */
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_doneChunks += processed;
+                --m_activeWorkers;
+            }
+            m_doneCondition.notify_all();
+        }
+    }
+
+    size_t TaskPool::processChunks(const ChunkFunction& func)
+    {
+        ARES_PROFILE_SCOPE("task", "TaskPool::processChunks");
+
+        size_t processed = 0U;
+        for (size_t chunk = m_nextChunk++; chunk < m_chunkCount; chunk = m_nextChunk++)
+        {
+            try
+            {
+                func(chunk, chunk * m_grainSize, std::min((chunk + 1U) * m_grainSize, m_count));
+            }
+            catch (...)
+            {
+                /* Keep the first error, the other chunks are still processed */
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (nullptr == m_exception)
+                {
+                    m_exception = std::current_exception();
+                }
+            }
+            ++processed;
+        }
+        return processed;
+    }
+}
+
+}
@@ -33,17 +33,29 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "tiny_gltf.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <set>
 #include <stdexcept>
 #include <iostream>
 
 #include "ares/gltf/Gltf.hpp"
+#include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/MemoryTracker.hpp"
+#include "ares/glutils/Profiler.hpp"
 #include "ares/glutils/Vbo.hpp"
 #include "ares/core/Scene.hpp"
 #include "ares/core/CameraNode.hpp"
+#include "ares/core/DirectionalLight.hpp"
 #include "ares/core/LightNode.hpp"
 #include "ares/core/MeshNode.hpp"
 #include "ares/core/PerspectiveCamera.hpp"
 #include "ares/core/PBRMaterial.hpp"
+#include "ares/core/PointLight.hpp"
+#include "ares/core/SpotLight.hpp"
 #include "ares/glutils/Texture.hpp"
 
 namespace ares
@@ -52,6 +64,52 @@ namespace ares
 namespace gltf
 {
     constexpr char CAMERA_TYPE_PERSPECTIVE[] = "perspective";
+    constexpr char LIGHT_TYPE_DIRECTIONAL[] = "directional";
+    constexpr char LIGHT_TYPE_POINT[] = "point";
+    constexpr char LIGHT_TYPE_SPOT[] = "spot";
+    constexpr char ATTRIBUTE_POSITION[] = "POSITION";
+    constexpr char ALPHA_MODE_BLEND[] = "BLEND";
+
+    /* EXT_mesh_gpu_instancing extension and attribute names */
+    constexpr char EXT_MESH_GPU_INSTANCING[] = "EXT_mesh_gpu_instancing";
+    constexpr char INSTANCING_ATTRIBUTES[] = "attributes";
+    constexpr char INSTANCING_TRANSLATION[] = "TRANSLATION";
+    constexpr char INSTANCING_ROTATION[] = "ROTATION";
+    constexpr char INSTANCING_SCALE[] = "SCALE";
+
+    /* Node extras property flagging the node and its subtree as static */
+    constexpr char EXTRAS_STATIC[] = "static";
+
+    /* Static batching parameters */
+    constexpr char STATIC_BATCH_NAME[] = "staticBatch_";
+    constexpr size_t MAX_SHORT_INDEX_VERTICES = 65536U;
+    constexpr uint32_t BATCH_NORMAL = 1U;
+    constexpr uint32_t BATCH_TANGENT = 2U;
+    constexpr uint32_t BATCH_COLOR = 3U;
+    constexpr uint32_t BATCH_TEXCOORD = 4U;
+
+    /*!
+     * @brief Vertex attribute of the static batches
+     */
+    struct BatchAttribute
+    {
+        /*! Attribute name */
+        const char* name;
+
+        /*! Number of float components stored in the batch */
+        uint32_t size;
+    };
+
+    /* Attributes supported by the static batches, the layout of a batch is a bit mask of this array indices */
+    static const BatchAttribute BATCH_ATTRIBUTES[] =
+    {
+        { "POSITION",   3U },
+        { "NORMAL",     3U },
+        { "TANGENT",    4U },
+        { "COLOR_0",    4U },
+        { "TEXCOORD_0", 2U }
+    };
+    constexpr uint32_t BATCH_ATTRIBUTE_COUNT = sizeof(BATCH_ATTRIBUTES) / sizeof(BATCH_ATTRIBUTES[0]);
 
     static int32_t accessorTypeToSize(int32_t accessorType)
     {
@@ -114,6 +172,476 @@ namespace gltf
         return retval;
     }
 
+    static glutils::BoundingBox positionBounds(const tinygltf::Model& model, const tinygltf::Accessor& accessor)
+    {
+        /* Unknown bounds by default, so that the primitive is never culled */
+        glutils::BoundingBox retval = glutils::BoundingBox::infinite();
+
+        if ((accessor.minValues.size() >= 3U) && (accessor.maxValues.size() >= 3U))
+        {
+            /* Use accessor min/max if available */
+            retval = glutils::BoundingBox(glutils::Vec3(static_cast<float>(accessor.minValues[0]), static_cast<float>(accessor.minValues[1]), static_cast<float>(accessor.minValues[2])),
+                                          glutils::Vec3(static_cast<float>(accessor.maxValues[0]), static_cast<float>(accessor.maxValues[1]), static_cast<float>(accessor.maxValues[2])));
+        }
+        else if ((TINYGLTF_TYPE_VEC3 == accessor.type) && (TINYGLTF_COMPONENT_TYPE_FLOAT == accessor.componentType) &&
+                 (accessor.bufferView >= 0) && (!accessor.sparse.isSparse) && (accessor.count > 0U))
+        {
+            /* Compute bounds from position data */
+            const auto& bufferView = model.bufferViews[accessor.bufferView];
+            const auto& buffer = model.buffers[bufferView.buffer];
+            size_t stride = (bufferView.byteStride > 0U) ? (bufferView.byteStride) : (3U * sizeof(float));
+            size_t offset = bufferView.byteOffset + accessor.byteOffset;
+
+            /* Check that all positions are within the buffer */
+            if ((offset + ((accessor.count - 1U) * stride) + (3U * sizeof(float))) <= buffer.data.size())
+            {
+                retval = glutils::BoundingBox();
+                for (size_t i = 0; i < accessor.count; ++i)
+                {
+                    float pos[3];
+                    memcpy(pos, &(buffer.data[offset + (i * stride)]), sizeof(pos));
+                    retval.expand(glutils::Vec3(pos[0], pos[1], pos[2]));
+                }
+            }
+        }
+
+        return retval;
+    }
+
+    static bool readAccessorElement(const tinygltf::Model& model, const tinygltf::Accessor& accessor, size_t index, size_t componentCount, float* values)
+    {
+        /* Only plain (non-sparse) float or normalized integer data is supported */
+        if ((accessor.bufferView < 0) || (accessor.sparse.isSparse) || (index >= accessor.count) ||
+            (static_cast<size_t>(accessorTypeToSize(accessor.type)) != componentCount))
+        {
+            return false;
+        }
+
+        size_t componentSize = 0U;
+        switch (accessor.componentType)
+        {
+            case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                componentSize = sizeof(float);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_BYTE:
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                componentSize = sizeof(uint8_t);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_SHORT:
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                componentSize = sizeof(uint16_t);
+                break;
+            default:
+                return false;
+        }
+
+        /* Check that the element is within the buffer */
+        const auto& bufferView = model.bufferViews[accessor.bufferView];
+        const auto& buffer = model.buffers[bufferView.buffer];
+        size_t stride = (bufferView.byteStride > 0U) ? (bufferView.byteStride) : (componentCount * componentSize);
+        size_t offset = bufferView.byteOffset + accessor.byteOffset + (index * stride);
+        if ((offset + (componentCount * componentSize)) > buffer.data.size())
+        {
+            return false;
+        }
+
+        /* Convert components, normalized integers are mapped to [-1, 1] or [0, 1] */
+        const unsigned char* data = &(buffer.data[offset]);
+        for (size_t i = 0; i < componentCount; ++i)
+        {
+            switch (accessor.componentType)
+            {
+                case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                    memcpy(&(values[i]), data + (i * componentSize), sizeof(float));
+                    break;
+                case TINYGLTF_COMPONENT_TYPE_BYTE:
+                    values[i] = std::max(static_cast<float>(static_cast<int8_t>(data[i])) / 127.F, -1.F);
+                    break;
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                    values[i] = static_cast<float>(data[i]) / 255.F;
+                    break;
+                case TINYGLTF_COMPONENT_TYPE_SHORT:
+                {
+                    int16_t value;
+                    memcpy(&value, data + (i * componentSize), sizeof(value));
+                    values[i] = std::max(static_cast<float>(value) / 32767.F, -1.F);
+                    break;
+                }
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                {
+                    uint16_t value;
+                    memcpy(&value, data + (i * componentSize), sizeof(value));
+                    values[i] = static_cast<float>(value) / 65535.F;
+                    break;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    static bool batchLayout(const tinygltf::Model& model, const tinygltf::Primitive& primitive, const std::map<std::string, std::vector<float>>* generated, uint32_t& layout)
+    {
+        /* Only triangle lists with positions can be merged */
+        if (((primitive.mode >= 0) && (TINYGLTF_MODE_TRIANGLES != primitive.mode)) ||
+            (primitive.material < 0) || (primitive.attributes.end() == primitive.attributes.find(ATTRIBUTE_POSITION)))
+        {
+            return false;
+        }
+
+        layout = 0U;
+        for (const auto& attributePair : primitive.attributes)
+        {
+            /* Any other attribute would be lost by merging the primitive */
+            uint32_t attribute = 0U;
+            while ((attribute < BATCH_ATTRIBUTE_COUNT) && (attributePair.first != BATCH_ATTRIBUTES[attribute].name))
+            {
+                ++attribute;
+            }
+            if (BATCH_ATTRIBUTE_COUNT == attribute)
+            {
+                return false;
+            }
+
+            /* Check that the data can be read on the CPU, colors may have an alpha channel or not */
+            const auto& accessor = model.accessors[attributePair.second];
+            int32_t size = accessorTypeToSize(accessor.type);
+            bool validSize = (BATCH_COLOR == attribute) ? ((3 == size) || (4 == size)) : (static_cast<int32_t>(BATCH_ATTRIBUTES[attribute].size) == size);
+            if ((!validSize) || (accessor.bufferView < 0) || (accessor.sparse.isSparse))
+            {
+                return false;
+            }
+            layout |= (1U << attribute);
+        }
+
+        /* Generated attributes are always batch attributes */
+        if (nullptr != generated)
+        {
+            for (uint32_t attribute = 0; attribute < BATCH_ATTRIBUTE_COUNT; ++attribute)
+            {
+                if (generated->end() != generated->find(BATCH_ATTRIBUTES[attribute].name))
+                {
+                    layout |= (1U << attribute);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    static void appendIndices(const tinygltf::Model& model, const tinygltf::Primitive& primitive, uint32_t baseVertex, uint32_t vertexCount, std::vector<uint32_t>& indices)
+    {
+        if (primitive.indices < 0)
+        {
+            /* Non-indexed primitive, draw its vertices in order */
+            for (uint32_t i = 0; i < vertexCount; ++i)
+            {
+                indices.push_back(baseVertex + i);
+            }
+            return;
+        }
+
+        /* Get index size */
+        const auto& accessor = model.accessors[primitive.indices];
+        size_t indexSize = 0U;
+        switch (accessor.componentType)
+        {
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                indexSize = sizeof(uint8_t);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                indexSize = sizeof(uint16_t);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                indexSize = sizeof(uint32_t);
+                break;
+            default:
+                throw std::runtime_error("Invalid primitive index type");
+        }
+
+        /* Check that all indices are within the buffer */
+        const auto& bufferView = model.bufferViews[accessor.bufferView];
+        const auto& buffer = model.buffers[bufferView.buffer];
+        size_t offset = bufferView.byteOffset + accessor.byteOffset;
+        if ((offset + (accessor.count * indexSize)) > buffer.data.size())
+        {
+            throw std::runtime_error("Invalid primitive index data");
+        }
+
+        /* Copy indices, rebased on the first vertex of the primitive */
+        for (size_t i = 0; i < accessor.count; ++i)
+        {
+            uint32_t index = 0U;
+            const unsigned char* data = &(buffer.data[offset + (i * indexSize)]);
+            if (sizeof(uint8_t) == indexSize)
+            {
+                index = data[0];
+            }
+            else if (sizeof(uint16_t) == indexSize)
+            {
+                uint16_t value;
+                memcpy(&value, data, sizeof(value));
+                index = value;
+            }
+            else
+            {
+                memcpy(&index, data, sizeof(index));
+            }
+
+            if (index >= vertexCount)
+            {
+                throw std::runtime_error("Primitive index out of range");
+            }
+            indices.push_back(baseVertex + index);
+        }
+    }
+
+    static void appendBatchVertices(const tinygltf::Model& model, const tinygltf::Primitive& primitive, const std::map<std::string, std::vector<float>>* generated,
+                                    uint32_t layout, const glutils::Mat4& modelMatrix, std::vector<float>& vertices, glutils::BoundingBox& boundingBox)
+    {
+        /* Normals are transformed by the inverse transpose, tangents flip their handedness with mirroring transforms */
+        glutils::Mat4 normalMatrix(modelMatrix);
+        normalMatrix.invert();
+        normalMatrix.transpose();
+        glutils::Vec4 col0 = modelMatrix.column(0);
+        glutils::Vec4 col1 = modelMatrix.column(1);
+        glutils::Vec4 col2 = modelMatrix.column(2);
+        float determinant = (col0[0] * ((col1[1] * col2[2]) - (col1[2] * col2[1]))) -
+                            (col1[0] * ((col0[1] * col2[2]) - (col0[2] * col2[1]))) +
+                            (col2[0] * ((col0[1] * col1[2]) - (col0[2] * col1[1])));
+        float handedness = (determinant < 0.F) ? (-1.F) : (1.F);
+
+        /* Get accessors of the batch attributes, or their generated data */
+        const tinygltf::Accessor* accessors[BATCH_ATTRIBUTE_COUNT] = {};
+        const std::vector<float>* generatedData[BATCH_ATTRIBUTE_COUNT] = {};
+        for (uint32_t attribute = 0; attribute < BATCH_ATTRIBUTE_COUNT; ++attribute)
+        {
+            if (0U != (layout & (1U << attribute)))
+            {
+                auto attributeIt = primitive.attributes.find(BATCH_ATTRIBUTES[attribute].name);
+                if (primitive.attributes.end() != attributeIt)
+                {
+                    accessors[attribute] = &(model.accessors[attributeIt->second]);
+                }
+                else
+                {
+                    generatedData[attribute] = &(generated->at(BATCH_ATTRIBUTES[attribute].name));
+                }
+            }
+        }
+
+        /* Convert and transform each vertex, interleaving its attributes */
+        size_t vertexCount = accessors[0]->count;
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            for (uint32_t attribute = 0; attribute < BATCH_ATTRIBUTE_COUNT; ++attribute)
+            {
+                glutils::Vec4 value(0.F, 0.F, 0.F, 1.F);
+                size_t componentCount = BATCH_ATTRIBUTES[attribute].size;
+                if (nullptr != generatedData[attribute])
+                {
+                    memcpy(value.data(), &((*generatedData[attribute])[vertex * componentCount]), componentCount * sizeof(float));
+                }
+                else if (nullptr == accessors[attribute])
+                {
+                    continue;
+                }
+                else
+                {
+                    componentCount = static_cast<size_t>(accessorTypeToSize(accessors[attribute]->type));
+                    if (!readAccessorElement(model, *accessors[attribute], vertex, componentCount, value.data()))
+                    {
+                        throw std::runtime_error("Invalid static batch vertex data");
+                    }
+                }
+
+                if (0U == attribute)
+                {
+                    value = modelMatrix * value;
+                    boundingBox.expand(glutils::Vec3(value[0], value[1], value[2]));
+                }
+                else if ((BATCH_NORMAL == attribute) || (BATCH_TANGENT == attribute))
+                {
+                    float w = value[3];
+                    value[3] = 0.F;
+                    value = (BATCH_NORMAL == attribute) ? (normalMatrix * value) : (modelMatrix * value);
+                    float length = value.length();
+                    if (length > 0.F)
+                    {
+                        value *= (1.F / length);
+                    }
+                    value[3] = w * handedness;
+                }
+
+                vertices.insert(vertices.end(), value.const_data(), value.const_data() + BATCH_ATTRIBUTES[attribute].size);
+            }
+        }
+    }
+
+    static glutils::Vec3 cross(const glutils::Vec3& lhs, const glutils::Vec3& rhs)
+    {
+        return glutils::Vec3((lhs[1] * rhs[2]) - (lhs[2] * rhs[1]),
+                             (lhs[2] * rhs[0]) - (lhs[0] * rhs[2]),
+                             (lhs[0] * rhs[1]) - (lhs[1] * rhs[0]));
+    }
+
+    static bool readAttribute(const tinygltf::Model& model, const tinygltf::Accessor& accessor, size_t componentCount, std::vector<float>& values)
+    {
+        values.resize(accessor.count * componentCount);
+        for (size_t i = 0; i < accessor.count; ++i)
+        {
+            if (!readAccessorElement(model, accessor, i, componentCount, &(values[i * componentCount])))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static void triangleIndices(const tinygltf::Model& model, const tinygltf::Primitive& primitive, uint32_t vertexCount, std::vector<uint32_t>& triangles)
+    {
+        std::vector<uint32_t> indices;
+        appendIndices(model, primitive, 0U, vertexCount, indices);
+
+        /* Convert strips and fans to a triangle list, points and lines have no triangles */
+        int32_t mode = (primitive.mode >= 0) ? (primitive.mode) : (TINYGLTF_MODE_TRIANGLES);
+        triangles.clear();
+        for (size_t i = 2U; i < indices.size(); ++i)
+        {
+            switch (mode)
+            {
+                case TINYGLTF_MODE_TRIANGLES:
+                    if (2U == (i % 3U))
+                    {
+                        triangles.insert(triangles.end(), { indices[i - 2U], indices[i - 1U], indices[i] });
+                    }
+                    break;
+                case TINYGLTF_MODE_TRIANGLE_STRIP:
+                    if (0U == (i % 2U))
+                    {
+                        triangles.insert(triangles.end(), { indices[i - 2U], indices[i - 1U], indices[i] });
+                    }
+                    else
+                    {
+                        triangles.insert(triangles.end(), { indices[i - 1U], indices[i - 2U], indices[i] });
+                    }
+                    break;
+                case TINYGLTF_MODE_TRIANGLE_FAN:
+                    triangles.insert(triangles.end(), { indices[0], indices[i - 1U], indices[i] });
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    static glutils::Vec3 orthogonalVector(const glutils::Vec3& normal)
+    {
+        /* Cross the normal with the axis least aligned to it */
+        glutils::Vec3 axis = (fabsf(normal[0]) < 0.9F) ? (glutils::Vec3(1.F, 0.F, 0.F)) : (glutils::Vec3(0.F, 1.F, 0.F));
+        glutils::Vec3 retval = cross(normal, axis);
+        if (retval.length() > 0.F)
+        {
+            retval.normalize();
+        }
+        else
+        {
+            retval = axis;
+        }
+        return retval;
+    }
+
+    static void generateNormals(const std::vector<float>& positions, const std::vector<uint32_t>& triangles, size_t vertexCount, std::vector<float>& normals)
+    {
+        /* Accumulate the area weighted face normals on their vertices */
+        std::vector<glutils::Vec3> sums(vertexCount);
+        for (size_t i = 0; (i + 2U) < triangles.size(); i += 3U)
+        {
+            const float* p0 = &(positions[triangles[i] * 3U]);
+            const float* p1 = &(positions[triangles[i + 1U] * 3U]);
+            const float* p2 = &(positions[triangles[i + 2U] * 3U]);
+            glutils::Vec3 faceNormal = cross(glutils::Vec3(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]),
+                                             glutils::Vec3(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]));
+            for (size_t j = 0; j < 3U; ++j)
+            {
+                sums[triangles[i + j]] += faceNormal;
+            }
+        }
+
+        /* Vertices without faces point along Z */
+        normals.resize(vertexCount * 3U);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            glutils::Vec3 normal(0.F, 0.F, 1.F);
+            if (sums[vertex].length() > 0.F)
+            {
+                normal = sums[vertex];
+                normal.normalize();
+            }
+            memcpy(&(normals[vertex * 3U]), normal.const_data(), 3U * sizeof(float));
+        }
+    }
+
+    static void generateTangents(const std::vector<float>& positions, const std::vector<float>& normals, const std::vector<float>& uvs,
+                                 const std::vector<uint32_t>& triangles, size_t vertexCount, std::vector<float>& tangents)
+    {
+        /* Accumulate the texture space directions of the faces on their vertices, if texture coordinates are available */
+        std::vector<glutils::Vec3> uDirs(vertexCount);
+        std::vector<glutils::Vec3> vDirs(vertexCount);
+        for (size_t i = 0; (!uvs.empty()) && ((i + 2U) < triangles.size()); i += 3U)
+        {
+            const float* p0 = &(positions[triangles[i] * 3U]);
+            const float* p1 = &(positions[triangles[i + 1U] * 3U]);
+            const float* p2 = &(positions[triangles[i + 2U] * 3U]);
+            const float* uv0 = &(uvs[triangles[i] * 2U]);
+            const float* uv1 = &(uvs[triangles[i + 1U] * 2U]);
+            const float* uv2 = &(uvs[triangles[i + 2U] * 2U]);
+            glutils::Vec3 edge1(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+            glutils::Vec3 edge2(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
+            float du1 = uv1[0] - uv0[0];
+            float dv1 = uv1[1] - uv0[1];
+            float du2 = uv2[0] - uv0[0];
+            float dv2 = uv2[1] - uv0[1];
+
+            /* Skip faces with degenerate texture coordinates */
+            float determinant = (du1 * dv2) - (du2 * dv1);
+            if (0.F == determinant)
+            {
+                continue;
+            }
+
+            glutils::Vec3 uDir = ((edge1 * dv2) - (edge2 * dv1)) * (1.F / determinant);
+            glutils::Vec3 vDir = ((edge2 * du1) - (edge1 * du2)) * (1.F / determinant);
+            for (size_t j = 0; j < 3U; ++j)
+            {
+                uDirs[triangles[i + j]] += uDir;
+                vDirs[triangles[i + j]] += vDir;
+            }
+        }
+
+        /* Orthogonalize the tangents against the normals, the handedness is stored in w */
+        tangents.resize(vertexCount * 4U);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            glutils::Vec3 normal(normals[vertex * 3U], normals[(vertex * 3U) + 1U], normals[(vertex * 3U) + 2U]);
+            glutils::Vec3 tangent = uDirs[vertex] - (normal * normal.dot(uDirs[vertex]));
+            float handedness = 1.F;
+            if (tangent.length() > 0.F)
+            {
+                tangent.normalize();
+                handedness = (cross(normal, tangent).dot(vDirs[vertex]) < 0.F) ? (-1.F) : (1.F);
+            }
+            else
+            {
+                /* Any direction on the surface when the texture space is unknown */
+                tangent = orthogonalVector(normal);
+            }
+            glutils::Vec4 value(tangent[0], tangent[1], tangent[2], handedness);
+            memcpy(&(tangents[vertex * 4U]), value.const_data(), 4U * sizeof(float));
+        }
+    }
+
     static core::Primitive::PrimitiveType primitiveModeToType(int32_t mode)
     {
         core::Primitive::PrimitiveType retval = core::Primitive::PrimitiveType::Triangles;
@@ -212,6 +740,10 @@ namespace gltf
         : m_drawingContext(drawingContext)
         , m_loader(new tinygltf::TinyGLTF)
         , m_model(new tinygltf::Model)
+        , m_assetName("gltf")
+        , m_modelMemory()
+        , m_staticBatching(true)
+        , m_strictPipelineValidation(false)
     {
     }
 
@@ -223,6 +755,12 @@ namespace gltf
 
     bool Gltf::loadFile(const std::string& filename, FileType fileType)
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::loadFile");
+
+        /* Attribute the memory of the file to its path */
+        m_assetName = filename;
+        glutils::MemoryTracker::AssetScope assetScope(m_assetName);
+
         /* Assume failure */
         bool retval = false;
 
@@ -249,13 +787,13 @@ namespace gltf
             /* Print warnings if any */
             if (!warn.empty())
             {
-                std::cout << "WARN: " << warn << std::endl;
+                std::cerr << "WARN: " << warn << std::endl;
             }
 
             /* Print errors if any */
             if (!err.empty())
             {
-                std::cout << "ERR: " << err << std::endl;
+                std::cerr << "ERR: " << err << std::endl;
             }
         }
 
@@ -264,11 +802,25 @@ namespace gltf
             throw std::runtime_error("Failed to load gltf file");
         }
 
+        /* Report the buffers and decoded images kept by the model */
+        uint64_t modelBytes = 0U;
+        for (const auto& buffer : m_model->buffers)
+        {
+            modelBytes += buffer.data.size();
+        }
+        for (const auto& image : m_model->images)
+        {
+            modelBytes += image.image.size();
+        }
+        m_modelMemory.reset(new glutils::MemoryTracker::Allocation(glutils::MemoryTracker::Category::ModelData, modelBytes));
+
         return retval;
     }
 
     std::vector<core::ScenePtr> Gltf::parse()
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::parse");
+
         std::vector<core::ScenePtr> sceneVec;
 
         if (nullptr == m_model)
@@ -276,6 +828,9 @@ namespace gltf
             throw std::runtime_error("Invalid gltf model");
         }
 
+        /* Attribute the parsed resources to the loaded file */
+        glutils::MemoryTracker::AssetScope assetScope(m_assetName);
+
         /* Parse all data */
         parseBuffers();
         parseImages();
@@ -300,12 +855,16 @@ namespace gltf
         m_meshVector.clear();
         m_textureVector.clear();
         m_vboVector.clear();
+        m_primitiveSources.clear();
+        m_generatedAttributes.clear();
 
         return sceneVec;
     }
 
     void Gltf::parseBuffers()
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::parseBuffers");
+
         /* Parse buffers */
         for (const auto& bufferView : m_model->bufferViews)
         {
@@ -324,6 +883,8 @@ namespace gltf
 
     void Gltf::parseImages()
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::parseImages");
+
         /* Parse images */
         for (const auto& image : m_model->images)
         {
@@ -336,6 +897,8 @@ namespace gltf
 
     void Gltf::parseTextures()
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::parseTextures");
+
         /* Parse textures */
         for (const auto& texture : m_model->textures)
         {
@@ -360,6 +923,8 @@ namespace gltf
 
     void Gltf::parseMaterials()
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::parseMaterials");
+
         /* Parse materials */
         for (const auto& material : m_model->materials)
         {
@@ -413,6 +978,8 @@ namespace gltf
                                     normalTex,
                                     occlusionTex,
                                     metallicRoughnessTex);
+            aresMaterial->setDoubleSided(material.doubleSided);
+            aresMaterial->setBlending(ALPHA_MODE_BLEND == material.alphaMode);
 
             m_materialVector.push_back(aresMaterial);
         }
@@ -420,6 +987,8 @@ namespace gltf
 
     void Gltf::parseCameras()
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::parseCameras");
+
         /* Parse cameras */
         for (const auto& camera : m_model->cameras)
         {
@@ -436,15 +1005,46 @@ namespace gltf
 
     void Gltf::parseLights()
     {
-        /* Parse lights */
+        ARES_PROFILE_SCOPE("load", "Gltf::parseLights");
+
+        /* Parse KHR_lights_punctual lights */
         for (const auto& light : m_model->lights)
         {
-            //TODO
+            /* Create light by type, unknown types leave the light nodes without light */
+            core::LightPtr aresLight;
+            if (light.type == LIGHT_TYPE_DIRECTIONAL)
+            {
+                aresLight = std::make_shared<core::DirectionalLight>();
+            }
+            else if (light.type == LIGHT_TYPE_POINT)
+            {
+                aresLight = std::make_shared<core::PointLight>();
+            }
+            else if (light.type == LIGHT_TYPE_SPOT)
+            {
+                aresLight = std::make_shared<core::SpotLight>(static_cast<float>(light.spot.innerConeAngle), static_cast<float>(light.spot.outerConeAngle));
+            }
+
+            /* Set light properties */
+            if (nullptr != aresLight)
+            {
+                if (3U == light.color.size())
+                {
+                    aresLight->setColor(glutils::Vec3(static_cast<float>(light.color[0]), static_cast<float>(light.color[1]), static_cast<float>(light.color[2])));
+                }
+                aresLight->setIntensity(static_cast<float>(light.intensity));
+                aresLight->setRange(static_cast<float>(light.range));
+            }
+
+            /* Keep light indices aligned with the gltf ones */
+            m_lightVector.push_back(aresLight);
         }
     }
 
     core::ScenePtr Gltf::parseScene(const tinygltf::Scene& scene)
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::parseScene");
+
         /* Create scene */
         core::ScenePtr aresScene = std::make_shared<core::Scene>(scene.name, m_drawingContext);
 
@@ -456,6 +1056,12 @@ namespace gltf
             parseNode(node, aresScene, aresScene->rootNode());
         }
 
+        /* Merge static geometry */
+        if (m_staticBatching)
+        {
+            batchStaticNodes(aresScene);
+        }
+
         /* Create a default camera if none is defined */
         if (nullptr == aresScene->activeCameraNode())
         {
@@ -465,6 +1071,9 @@ namespace gltf
             aresScene->setActiveCameraNode(cameraNode);
         }
 
+        /* Build spatial index for the loaded nodes */
+        aresScene->buildSpatialIndex();
+
         return aresScene;
     }
 
@@ -472,6 +1081,10 @@ namespace gltf
     {
         core::NodePtr aresNode;
 
+        /* Static nodes make their whole subtree static */
+        bool isStatic = parentNode->isStatic() ||
+                        (node.extras.IsObject() && node.extras.Has(EXTRAS_STATIC) && node.extras.Get(EXTRAS_STATIC).IsBool() && node.extras.Get(EXTRAS_STATIC).Get<bool>());
+
         /* Check node type */
         if (node.camera >= 0)
         {
@@ -488,6 +1101,13 @@ namespace gltf
             aresLightNode->setLight(m_lightVector[node.light]);
             aresNode = aresLightNode;
         }
+        else if ((node.mesh >= 0) && (node.extensions.end() != node.extensions.find(EXT_MESH_GPU_INSTANCING)))
+        {
+            /* Instanced mesh, the node transform applies to all instances */
+            aresNode = scene->createNode<core::Node>(node.name, parentNode);
+            aresNode->setStatic(isStatic);
+            parseMeshInstances(node, scene, aresNode);
+        }
         else if (node.mesh >= 0)
         {
             /* Mesh node */
@@ -500,6 +1120,7 @@ namespace gltf
             /* Empty node */
             aresNode = scene->createNode<core::Node>(node.name, parentNode);
         }
+        aresNode->setStatic(isStatic);
         
         if (!node.matrix.empty())
         {
@@ -534,8 +1155,58 @@ namespace gltf
         }
     }
 
+    void Gltf::parseMeshInstances(const tinygltf::Node& node, core::ScenePtr scene, core::NodePtr parentNode)
+    {
+        /* Get instance attribute accessors */
+        const tinygltf::Value& extension = node.extensions.at(EXT_MESH_GPU_INSTANCING);
+        if ((!extension.IsObject()) || (!extension.Has(INSTANCING_ATTRIBUTES)))
+        {
+            throw std::runtime_error("Invalid EXT_mesh_gpu_instancing attributes");
+        }
+        const tinygltf::Value& attributes = extension.Get(INSTANCING_ATTRIBUTES);
+        const char* attributeNames[] = { INSTANCING_TRANSLATION, INSTANCING_ROTATION, INSTANCING_SCALE };
+        const tinygltf::Accessor* accessors[] = { nullptr, nullptr, nullptr };
+        size_t instanceCount = 0U;
+        for (size_t i = 0; i < 3U; ++i)
+        {
+            if (attributes.Has(attributeNames[i]))
+            {
+                int32_t accessorIdx = attributes.Get(attributeNames[i]).GetNumberAsInt();
+                if ((accessorIdx < 0) || (static_cast<size_t>(accessorIdx) >= m_model->accessors.size()))
+                {
+                    throw std::runtime_error("Invalid EXT_mesh_gpu_instancing accessor");
+                }
+                accessors[i] = &(m_model->accessors[accessorIdx]);
+                instanceCount = accessors[i]->count;
+            }
+        }
+
+        /* Create one mesh node per instance sharing the same mesh, the renderer draws them with instancing */
+        for (size_t instance = 0; instance < instanceCount; ++instance)
+        {
+            float translation[3] = { 0.F, 0.F, 0.F };
+            float rotation[4] = { 0.F, 0.F, 0.F, 1.F };
+            float scale[3] = { 1.F, 1.F, 1.F };
+            if (((nullptr != accessors[0]) && (!readAccessorElement(*m_model, *accessors[0], instance, 3U, translation))) ||
+                ((nullptr != accessors[1]) && (!readAccessorElement(*m_model, *accessors[1], instance, 4U, rotation)))    ||
+                ((nullptr != accessors[2]) && (!readAccessorElement(*m_model, *accessors[2], instance, 3U, scale))))
+            {
+                throw std::runtime_error("Unsupported EXT_mesh_gpu_instancing data");
+            }
+
+            auto aresMeshNode = scene->createNode<core::MeshNode>(node.name + "_" + std::to_string(instance), parentNode);
+            aresMeshNode->setMesh(m_meshVector[node.mesh]);
+            aresMeshNode->setPosition(translation[0], translation[1], translation[2]);
+            aresMeshNode->setRotationQuaternion(rotation[0], rotation[1], rotation[2], rotation[3]);
+            aresMeshNode->setScaling(scale[0], scale[1], scale[2]);
+            aresMeshNode->setStatic(parentNode->isStatic());
+        }
+    }
+
     void Gltf::parseMeshes()
     {
+        ARES_PROFILE_SCOPE("load", "Gltf::parseMeshes");
+
         /* Parse meshes */
         for (const auto& mesh : m_model->meshes)
         {
@@ -546,6 +1217,7 @@ namespace gltf
             {
                 std::vector<glutils::AttributeDataPtr> attrDataVec;
                 int32_t vertexCount = 0;
+                glutils::BoundingBox boundingBox = glutils::BoundingBox::infinite();
 
                 /* Parse attributes for this primitive */
                 for (const auto& attributePair : primitive.attributes)
@@ -569,6 +1241,12 @@ namespace gltf
                                                             accessor.byteOffset);
                     attrDataVec.push_back(attrData);
                     vertexCount = accessor.count;
+
+                    /* Get primitive bounds from positions */
+                    if (ATTRIBUTE_POSITION == attribName)
+                    {
+                        boundingBox = positionBounds(*m_model, accessor);
+                    }
                 }
 
                 /* Check if primitive has indices */
@@ -594,9 +1272,19 @@ namespace gltf
                     vertexCount = accessor.count;
                 }
 
-                /* Create primitive */
+                /* Generate the attributes read by the material but missing from the primitive */
+                generateAttributes(primitive, m_materialVector[primitive.material], attrDataVec);
+
+                /* Create primitive, its pipeline state is validated against the material shader */
                 auto aresPrim = std::make_shared<core::Primitive>(attrDataVec, primitiveModeToType(primitive.mode), vertexCount, m_materialVector[primitive.material], indicesVbo);
+                core::PipelineState* pipeline = aresPrim->pipelineState();
+                if (m_strictPipelineValidation && (nullptr != pipeline) && (!pipeline->unusedAttributes().empty()))
+                {
+                    throw std::runtime_error("Mesh " + mesh.name + " provides attribute " + pipeline->unusedAttributes().front() + " not used by its material");
+                }
+                aresPrim->setBoundingBox(boundingBox);
                 primVec.push_back(aresPrim);
+                m_primitiveSources[aresPrim.get()] = &primitive;
             }
 
             /* Create mesh */
@@ -605,6 +1293,272 @@ namespace gltf
         }
     }
 
+    void Gltf::generateAttributes(const tinygltf::Primitive& primitive, const core::MaterialPtr& material, std::vector<glutils::AttributeDataPtr>& attrDataVec)
+    {
+        /* All the attributes must describe the same vertices */
+        auto positionIt = primitive.attributes.find(ATTRIBUTE_POSITION);
+        if (primitive.attributes.end() == positionIt)
+        {
+            throw std::runtime_error("Primitive without " + std::string(ATTRIBUTE_POSITION) + " attribute");
+        }
+        size_t vertexCount = m_model->accessors[positionIt->second].count;
+        for (const auto& attributePair : primitive.attributes)
+        {
+            if (vertexCount != m_model->accessors[attributePair.second].count)
+            {
+                throw std::runtime_error("Attribute " + attributePair.first + " count does not match the primitive vertex count");
+            }
+        }
+
+        /* Find the attributes read by the material shader but missing from the primitive */
+        bool missing[BATCH_ATTRIBUTE_COUNT] = {};
+        bool anyMissing = false;
+        for (uint32_t attribute : { BATCH_NORMAL, BATCH_TANGENT, BATCH_TEXCOORD })
+        {
+            missing[attribute] = (nullptr != material) && (nullptr != material->shader()) &&
+                                 (nullptr != material->shader()->getAttribute(BATCH_ATTRIBUTES[attribute].name)) &&
+                                 (primitive.attributes.end() == primitive.attributes.find(BATCH_ATTRIBUTES[attribute].name));
+            anyMissing = anyMissing || missing[attribute];
+        }
+        if (!anyMissing)
+        {
+            return;
+        }
+
+        /* Read positions and triangles, without readable positions the faces are unknown */
+        std::vector<float> positions;
+        std::vector<uint32_t> triangles;
+        triangleIndices(*m_model, primitive, static_cast<uint32_t>(vertexCount), triangles);
+        if (!readAttribute(*m_model, m_model->accessors[positionIt->second], 3U, positions))
+        {
+            triangles.clear();
+        }
+
+        /* Read normals, or smooth them over the faces */
+        auto& generated = m_generatedAttributes[&primitive];
+        std::vector<float> normals;
+        auto normalIt = primitive.attributes.find(BATCH_ATTRIBUTES[BATCH_NORMAL].name);
+        if ((primitive.attributes.end() == normalIt) || (!readAttribute(*m_model, m_model->accessors[normalIt->second], 3U, normals)))
+        {
+            generateNormals(positions, triangles, vertexCount, normals);
+        }
+        if (missing[BATCH_NORMAL])
+        {
+            generated[BATCH_ATTRIBUTES[BATCH_NORMAL].name] = normals;
+        }
+
+        /* Tangents follow the texture coordinates if available */
+        if (missing[BATCH_TANGENT])
+        {
+            std::vector<float> uvs;
+            auto uvIt = primitive.attributes.find(BATCH_ATTRIBUTES[BATCH_TEXCOORD].name);
+            if ((primitive.attributes.end() == uvIt) || (!readAttribute(*m_model, m_model->accessors[uvIt->second], 2U, uvs)))
+            {
+                uvs.clear();
+            }
+            generateTangents(positions, normals, uvs, triangles, vertexCount, generated[BATCH_ATTRIBUTES[BATCH_TANGENT].name]);
+        }
+
+        /* Constant texture coordinates sample the first texel */
+        if (missing[BATCH_TEXCOORD])
+        {
+            generated[BATCH_ATTRIBUTES[BATCH_TEXCOORD].name] = std::vector<float>(vertexCount * 2U, 0.F);
+        }
+
+        /* Store the generated attributes one after the other in a single buffer */
+        std::vector<float> vertices;
+        for (const auto& generatedPair : generated)
+        {
+            vertices.insert(vertices.end(), generatedPair.second.begin(), generatedPair.second.end());
+        }
+        auto vbo = std::make_shared<glutils::Vbo>(vertices.data(), static_cast<int32_t>(vertices.size() * sizeof(float)), glutils::Vbo::TargetType::ArrayBuffer);
+        int32_t offset = 0;
+        for (const auto& generatedPair : generated)
+        {
+            int32_t size = static_cast<int32_t>(generatedPair.second.size() / vertexCount);
+            attrDataVec.push_back(std::make_shared<glutils::AttributeData>(generatedPair.first, vbo, size, glutils::AttributeData::AttributeType::Float, false, 0, offset));
+            offset += static_cast<int32_t>(generatedPair.second.size() * sizeof(float));
+        }
+    }
+
+    void Gltf::batchStaticNodes(core::ScenePtr scene)
+    {
+        /* Primitive of a static mesh node */
+        struct BatchSource
+        {
+            core::MeshNode* meshNode;
+            const core::Primitive* primitive;
+            const tinygltf::Primitive* gltfPrimitive;
+            const glutils::Mat4* modelMatrix;
+            uint32_t vertexCount;
+        };
+
+        /* Primitives sharing material and vertex layout */
+        struct BatchGroup
+        {
+            core::MaterialPtr material;
+            uint32_t layout;
+            std::vector<BatchSource> sources;
+        };
+
+        /* Without 32-bit indices support, batches are limited to the vertices addressable with 16-bit indices */
+        size_t maxVertices = glutils::GlUtils::hasExtension("GL_OES_element_index_uint") ? (std::numeric_limits<uint32_t>::max()) : (MAX_SHORT_INDEX_VERTICES);
+
+        /* Collect the static mesh nodes from the scene registry */
+        std::vector<core::MeshNode*> meshNodes;
+        for (const auto& meshNode : scene->getMeshNodes())
+        {
+            if (meshNode->isStatic() && (nullptr != meshNode->mesh()))
+            {
+                meshNodes.push_back(meshNode.get());
+            }
+        }
+
+        /* Attributes generated for a gltf primitive, nullptr if none */
+        auto generatedAttributes = [this](const tinygltf::Primitive* gltfPrimitive) -> const std::map<std::string, std::vector<float>>*
+        {
+            auto generatedIt = m_generatedAttributes.find(gltfPrimitive);
+            return (m_generatedAttributes.end() != generatedIt) ? (&(generatedIt->second)) : (nullptr);
+        };
+
+        /* Group the mergeable primitives by material and vertex layout */
+        std::vector<BatchGroup> groups;
+        std::map<std::pair<const core::Material*, uint32_t>, size_t> groupIndices;
+        for (auto meshNode : meshNodes)
+        {
+            for (const auto& primitive : meshNode->mesh()->primitives())
+            {
+                /* Translucent primitives are sorted back-to-front, merging them would break their order */
+                auto sourceIt = m_primitiveSources.find(primitive.get());
+                uint32_t layout = 0U;
+                if (primitive->material()->blending() || (m_primitiveSources.end() == sourceIt) ||
+                    (!batchLayout(*m_model, *(sourceIt->second), generatedAttributes(sourceIt->second), layout)))
+                {
+                    continue;
+                }
+
+                size_t vertexCount = m_model->accessors[sourceIt->second->attributes.at(ATTRIBUTE_POSITION)].count;
+                if (vertexCount > maxVertices)
+                {
+                    continue;
+                }
+
+                auto key = std::make_pair(primitive->material().get(), layout);
+                auto groupIt = groupIndices.find(key);
+                if (groupIndices.end() == groupIt)
+                {
+                    groupIt = groupIndices.insert(std::make_pair(key, groups.size())).first;
+                    groups.push_back(BatchGroup{ primitive->material(), layout, {} });
+                }
+                groups[groupIt->second].sources.push_back(BatchSource{ meshNode, primitive.get(), sourceIt->second, &(meshNode->totalTransformMatrix()), static_cast<uint32_t>(vertexCount) });
+            }
+        }
+
+        /* Merge each group in as few batches as possible */
+        std::set<std::pair<const core::MeshNode*, const core::Primitive*>> batchedPrimitives;
+        std::vector<float> vertices;
+        std::vector<uint32_t> indices;
+        uint32_t batchCount = 0U;
+        for (const auto& group : groups)
+        {
+            size_t begin = 0U;
+            while (begin < group.sources.size())
+            {
+                /* Pre-transform the primitives in world space until the batch is full */
+                vertices.clear();
+                indices.clear();
+                glutils::BoundingBox boundingBox;
+                size_t batchVertices = 0U;
+                size_t end = begin;
+                while ((end < group.sources.size()) && ((batchVertices + group.sources[end].vertexCount) <= maxVertices))
+                {
+                    const BatchSource& source = group.sources[end];
+                    appendIndices(*m_model, *(source.gltfPrimitive), static_cast<uint32_t>(batchVertices), source.vertexCount, indices);
+                    appendBatchVertices(*m_model, *(source.gltfPrimitive), generatedAttributes(source.gltfPrimitive), group.layout, *(source.modelMatrix), vertices, boundingBox);
+                    batchVertices += source.vertexCount;
+                    ++end;
+                }
+
+                /* Merging a single primitive saves no draw call */
+                if ((end - begin) > 1U)
+                {
+                    /* Create interleaved vertex buffer */
+                    int32_t stride = 0;
+                    for (uint32_t attribute = 0; attribute < BATCH_ATTRIBUTE_COUNT; ++attribute)
+                    {
+                        if (0U != (group.layout & (1U << attribute)))
+                        {
+                            stride += static_cast<int32_t>(BATCH_ATTRIBUTES[attribute].size * sizeof(float));
+                        }
+                    }
+                    auto vbo = std::make_shared<glutils::Vbo>(vertices.data(), static_cast<int32_t>(vertices.size() * sizeof(float)), glutils::Vbo::TargetType::ArrayBuffer);
+                    std::vector<glutils::AttributeDataPtr> attrDataVec;
+                    int32_t offset = 0;
+                    for (uint32_t attribute = 0; attribute < BATCH_ATTRIBUTE_COUNT; ++attribute)
+                    {
+                        if (0U != (group.layout & (1U << attribute)))
+                        {
+                            attrDataVec.push_back(std::make_shared<glutils::AttributeData>(BATCH_ATTRIBUTES[attribute].name, vbo, BATCH_ATTRIBUTES[attribute].size,
+                                                                                           glutils::AttributeData::AttributeType::Float, false, stride, offset));
+                            offset += static_cast<int32_t>(BATCH_ATTRIBUTES[attribute].size * sizeof(float));
+                        }
+                    }
+
+                    /* Create index buffer, with 16-bit indices whenever possible */
+                    glutils::AttributeDataPtr indicesData;
+                    if (batchVertices <= MAX_SHORT_INDEX_VERTICES)
+                    {
+                        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+                        auto indicesVbo = std::make_shared<glutils::Vbo>(shortIndices.data(), static_cast<int32_t>(shortIndices.size() * sizeof(uint16_t)), glutils::Vbo::TargetType::ElementArrayBuffer);
+                        indicesData = std::make_shared<glutils::AttributeData>("", indicesVbo, 1, glutils::AttributeData::AttributeType::UnsignedShort, false, 0, 0);
+                    }
+                    else
+                    {
+                        auto indicesVbo = std::make_shared<glutils::Vbo>(indices.data(), static_cast<int32_t>(indices.size() * sizeof(uint32_t)), glutils::Vbo::TargetType::ElementArrayBuffer);
+                        indicesData = std::make_shared<glutils::AttributeData>("", indicesVbo, 1, glutils::AttributeData::AttributeType::UnsignedInt, false, 0, 0);
+                    }
+
+                    /* Create the batch node in world space */
+                    auto aresPrim = std::make_shared<core::Primitive>(attrDataVec, core::Primitive::PrimitiveType::Triangles, static_cast<GLsizei>(indices.size()), group.material, indicesData);
+                    aresPrim->setBoundingBox(boundingBox);
+                    std::string batchName = STATIC_BATCH_NAME + std::to_string(batchCount++);
+                    auto batchNode = scene->createNode<core::MeshNode>(batchName, scene->rootNode());
+                    batchNode->setMesh(std::make_shared<core::Mesh>(batchName, std::vector<core::PrimitivePtr>(1U, aresPrim)));
+                    batchNode->setStatic(true);
+
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        batchedPrimitives.insert(std::make_pair(group.sources[i].meshNode, group.sources[i].primitive));
+                    }
+                }
+
+                begin = end;
+            }
+        }
+
+        /* Remove the merged primitives from the static nodes, keeping the shared meshes untouched */
+        for (auto meshNode : meshNodes)
+        {
+            std::vector<core::PrimitivePtr> remaining;
+            for (const auto& primitive : meshNode->mesh()->primitives())
+            {
+                if (batchedPrimitives.end() == batchedPrimitives.find(std::make_pair(meshNode, primitive.get())))
+                {
+                    remaining.push_back(primitive);
+                }
+            }
+
+            if (remaining.empty())
+            {
+                meshNode->setMesh(nullptr);
+            }
+            else if (remaining.size() != meshNode->mesh()->primitives().size())
+            {
+                meshNode->setMesh(std::make_shared<core::Mesh>(meshNode->name(), remaining));
+            }
+        }
+    }
+
 }
 
 }
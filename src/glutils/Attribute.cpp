@@ -29,8 +29,6 @@
  *****************************************************************************/
 
 #include "ares/glutils/Attribute.hpp"
-#include "ares/glutils/AttributeData.hpp"
-#include "ares/glutils/GlUtils.hpp"
 
 namespace ares
 {
@@ -43,42 +41,6 @@ namespace glutils
     {
     }
 
-    void Attribute::activate(const AttributeDataPtr& data)
-    {
-        /* Make sure attribute location is valid */
-        if ((m_location >= 0) && (nullptr != data->vbo()))
-        {
-            /* Activate Vbo */
-            data->vbo()->activate();
-
-            /* Enable attribute */
-            glEnableVertexAttribArray(static_cast<GLuint>(m_location));
-            GlUtils::checkGLError("glEnableVertexAttribArray");
-
-            /* Set attribute stride and offset in the VBO */
-            glVertexAttribPointer(static_cast<GLuint>(m_location),
-                                  static_cast<GLint>(data->size()),
-                                  static_cast<GLenum>(data->type()),
-                                  static_cast<GLboolean>(data->normalized()),
-                                  static_cast<GLsizei>(data->stride()),
-                                  (const void*)(intptr_t)data->offset());
-            GlUtils::checkGLError("glVertexAttribPointer");
-        }
-    }
-
-    void Attribute::deactivate(const AttributeDataPtr& data)
-    {
-        if ((m_location >= 0) && (nullptr != data->vbo()))
-        {
-            /* Disable attribute */
-            glDisableVertexAttribArray(static_cast<GLuint>(m_location));
-            GlUtils::checkGLError("glDisableVertexAttribArray");
-
-            /* Deactivate Vbo */
-            data->vbo()->deactivate();
-        }
-    }
-
 }
 
 }
@@ -0,0 +1,148 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/BoundingVolume.hpp"
+
+#include <algorithm>
+
+namespace ares
+{
+
+namespace glutils
+{
+    constexpr float BOX_INFINITY = std::numeric_limits<float>::infinity();
+
+    BoundingBox::BoundingBox()
+        : m_min(BOX_INFINITY, BOX_INFINITY, BOX_INFINITY)
+        , m_max(-BOX_INFINITY, -BOX_INFINITY, -BOX_INFINITY)
+    {
+    }
+
+    BoundingBox::BoundingBox(const Vec3& minCorner, const Vec3& maxCorner)
+        : m_min(minCorner)
+        , m_max(maxCorner)
+    {
+    }
+
+    BoundingBox BoundingBox::infinite()
+    {
+        return BoundingBox(Vec3(-BOX_INFINITY, -BOX_INFINITY, -BOX_INFINITY), Vec3(BOX_INFINITY, BOX_INFINITY, BOX_INFINITY));
+    }
+
+    bool BoundingBox::isInfinite() const
+    {
+        bool retval = false;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            retval = retval || (m_min[i] == -BOX_INFINITY) || (m_max[i] == BOX_INFINITY);
+        }
+        return retval;
+    }
+
+    float BoundingBox::surfaceArea() const
+    {
+        float retval = 0.F;
+        if (!isEmpty())
+        {
+            Vec3 size = m_max - m_min;
+            retval = 2.F * ((size[0] * size[1]) + (size[1] * size[2]) + (size[2] * size[0]));
+        }
+        return retval;
+    }
+
+    void BoundingBox::expand(const Vec3& point)
+    {
+        for (size_t i = 0; i < 3; ++i)
+        {
+            m_min[i] = std::min(m_min[i], point[i]);
+            m_max[i] = std::max(m_max[i], point[i]);
+        }
+    }
+
+    void BoundingBox::expand(const BoundingBox& box)
+    {
+        for (size_t i = 0; i < 3; ++i)
+        {
+            m_min[i] = std::min(m_min[i], box.m_min[i]);
+            m_max[i] = std::max(m_max[i], box.m_max[i]);
+        }
+    }
+
+    BoundingBox BoundingBox::transformed(const Mat4& matrix) const
+    {
+        /* Empty and infinite boxes are not affected by transforms */
+        if (isEmpty() || isInfinite())
+        {
+            return *this;
+        }
+
+        /* Transform center and project extents on the new axes (Arvo's method) */
+        const float* m = matrix.const_data();
+        Vec3 c = center();
+        Vec3 e = extents();
+        Vec3 newCenter;
+        Vec3 newExtents;
+        for (size_t r = 0; r < 3; ++r)
+        {
+            newCenter[r]  = m[12 + r] + (m[r] * c[0]) + (m[4 + r] * c[1]) + (m[8 + r] * c[2]);
+            newExtents[r] = (fabsf(m[r]) * e[0]) + (fabsf(m[4 + r]) * e[1]) + (fabsf(m[8 + r]) * e[2]);
+        }
+
+        return BoundingBox(newCenter - newExtents, newCenter + newExtents);
+    }
+
+    BoundingSphere::BoundingSphere()
+        : m_center()
+        , m_radius(-1.F)
+    {
+    }
+
+    BoundingSphere::BoundingSphere(const Vec3& center, float radius)
+        : m_center(center)
+        , m_radius(radius)
+    {
+    }
+
+    BoundingSphere BoundingSphere::fromBox(const BoundingBox& box)
+    {
+        BoundingSphere retval;
+        if (box.isInfinite())
+        {
+            retval = BoundingSphere(Vec3(), BOX_INFINITY);
+        }
+        else if (!box.isEmpty())
+        {
+            retval = BoundingSphere(box.center(), box.extents().length());
+        }
+        return retval;
+    }
+}
+
+}
@@ -0,0 +1,98 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/Framebuffer.hpp"
+#include "ares/glutils/GlUtils.hpp"
+
+#include <stdexcept>
+
+namespace ares
+{
+
+namespace glutils
+{
+    Framebuffer::Framebuffer(TexturePtr colorTex, TexturePtr depthTex, RenderbufferPtr depthRb)
+        : m_fbo(0U)
+        , m_colorTex(colorTex)
+        , m_depthTex(depthTex)
+        , m_depthRb((nullptr == depthTex) ? (depthRb) : (nullptr))
+        , m_complete(false)
+    {
+        /* Check for valid color texture */
+        if (nullptr == m_colorTex)
+        {
+            throw std::runtime_error("Invalid color texture");
+        }
+
+        /* Create framebuffer object and attach the targets */
+        glGenFramebuffers(1, &m_fbo);
+        GlUtils::checkGLError("glGenFramebuffers");
+        bind();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTex->tex(), 0);
+        GlUtils::checkGLError("glFramebufferTexture2D");
+        if (nullptr != m_depthTex)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTex->tex(), 0);
+            GlUtils::checkGLError("glFramebufferTexture2D");
+        }
+        else if (nullptr != m_depthRb)
+        {
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRb->rb());
+            GlUtils::checkGLError("glFramebufferRenderbuffer");
+        }
+
+        /* Check completeness */
+        m_complete = (GL_FRAMEBUFFER_COMPLETE == glCheckFramebufferStatus(GL_FRAMEBUFFER));
+
+        /* Unbind */
+        bindDefault();
+    }
+
+    Framebuffer::~Framebuffer()
+    {
+        /* Delete framebuffer, OpenGL binds the default one if it is bound */
+        glDeleteFramebuffers(1, &m_fbo);
+    }
+
+    void Framebuffer::bind()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        GlUtils::checkGLError("glBindFramebuffer");
+    }
+
+    void Framebuffer::bindDefault()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0U);
+        GlUtils::checkGLError("glBindFramebuffer");
+    }
+
+}
+
+}
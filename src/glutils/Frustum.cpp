@@ -0,0 +1,178 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/Frustum.hpp"
+#include "ares/glutils/Simd.hpp"
+
+namespace ares
+{
+
+namespace glutils
+{
+    constexpr size_t Frustum::PLANE_COUNT;
+    constexpr size_t Frustum::PLANE_SLOTS;
+
+    Frustum::Frustum()
+    {
+        /* Planes that accept everything */
+        for (size_t i = 0; i < PLANE_SLOTS; ++i)
+        {
+            m_planes[0][i] = 0.F;
+            m_planes[1][i] = 0.F;
+            m_planes[2][i] = 0.F;
+            m_planes[3][i] = 1.F;
+        }
+    }
+
+    Frustum::Frustum(const Mat4& matrix)
+        : Frustum()
+    {
+        setMatrix(matrix);
+    }
+
+    void Frustum::setMatrix(const Mat4& matrix)
+    {
+        /* Get matrix rows, clip coordinates are row_i . v */
+        Vec4 row0 = matrix.row(0);
+        Vec4 row1 = matrix.row(1);
+        Vec4 row2 = matrix.row(2);
+        Vec4 row3 = matrix.row(3);
+
+        /* Left, right, bottom, top, near, far (Gribb-Hartmann) */
+        Vec4 planes[PLANE_COUNT] = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+
+        for (size_t i = 0; i < PLANE_COUNT; ++i)
+        {
+            /* Normalize plane so that distances are in world units */
+            float len = Vec3(planes[i][0], planes[i][1], planes[i][2]).length();
+            if (len > 0.F)
+            {
+                planes[i] /= len;
+            }
+
+            /* Store as structure of arrays */
+            for (size_t c = 0; c < 4; ++c)
+            {
+                m_planes[c][i] = planes[i][c];
+            }
+        }
+
+        /* Padding planes accept everything */
+        for (size_t i = PLANE_COUNT; i < PLANE_SLOTS; ++i)
+        {
+            m_planes[0][i] = 0.F;
+            m_planes[1][i] = 0.F;
+            m_planes[2][i] = 0.F;
+            m_planes[3][i] = 1.F;
+        }
+    }
+
+    Vec4 Frustum::plane(size_t i) const
+    {
+        return Vec4(m_planes[0][i], m_planes[1][i], m_planes[2][i], m_planes[3][i]);
+    }
+
+    bool Frustum::intersects(const BoundingBox& box) const
+    {
+        /* Empty boxes are never visible, infinite boxes always are */
+        if (box.isEmpty())
+        {
+            return false;
+        }
+        if (box.isInfinite())
+        {
+            return true;
+        }
+
+        Vec3 c = box.center();
+        Vec3 e = box.extents();
+        Float4 cx = Float4::splat(c[0]);
+        Float4 cy = Float4::splat(c[1]);
+        Float4 cz = Float4::splat(c[2]);
+        Float4 ex = Float4::splat(e[0]);
+        Float4 ey = Float4::splat(e[1]);
+        Float4 ez = Float4::splat(e[2]);
+        Float4 zero = Float4::splat(0.F);
+
+        /* Four planes at a time: the box is outside a plane if center distance plus projected radius is negative */
+        uint32_t outside = 0U;
+        for (size_t i = 0; i < PLANE_SLOTS; i += 4)
+        {
+            Float4 a = Float4::load(&m_planes[0][i]);
+            Float4 b = Float4::load(&m_planes[1][i]);
+            Float4 cc = Float4::load(&m_planes[2][i]);
+            Float4 d = Float4::load(&m_planes[3][i]);
+
+            Float4 dist = Float4::madd(a, cx, Float4::madd(b, cy, Float4::madd(cc, cz, d)));
+            Float4 radius = Float4::madd(Float4::abs(a), ex, Float4::madd(Float4::abs(b), ey, Float4::abs(cc) * ez));
+
+            outside |= Float4::lessMask(dist + radius, zero);
+        }
+
+        return (0U == outside);
+    }
+
+    bool Frustum::intersects(const BoundingSphere& sphere) const
+    {
+        /* Empty spheres are never visible, infinite spheres always are */
+        if (sphere.isEmpty())
+        {
+            return false;
+        }
+        if (sphere.isInfinite())
+        {
+            return true;
+        }
+
+        const Vec3& c = sphere.center();
+        Float4 cx = Float4::splat(c[0]);
+        Float4 cy = Float4::splat(c[1]);
+        Float4 cz = Float4::splat(c[2]);
+        Float4 negRadius = Float4::splat(-sphere.radius());
+
+        /* Four planes at a time: the sphere is outside a plane if center distance is below -radius */
+        uint32_t outside = 0U;
+        for (size_t i = 0; i < PLANE_SLOTS; i += 4)
+        {
+            Float4 a = Float4::load(&m_planes[0][i]);
+            Float4 b = Float4::load(&m_planes[1][i]);
+            Float4 cc = Float4::load(&m_planes[2][i]);
+            Float4 d = Float4::load(&m_planes[3][i]);
+
+            Float4 dist = Float4::madd(a, cx, Float4::madd(b, cy, Float4::madd(cc, cz, d)));
+
+            outside |= Float4::lessMask(dist, negRadius);
+        }
+
+        return (0U == outside);
+    }
+}
+
+}
@@ -0,0 +1,483 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/GlState.hpp"
+#include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/VertexArrayObject.hpp"
+
+#include <algorithm>
+
+namespace ares
+{
+
+namespace glutils
+{
+    /* Value of the bindings and modes in unknown state */
+    constexpr GLuint UNKNOWN_VALUE = 0xFFFFFFFFU;
+
+    /* Capabilities tracked by the state, in bit order */
+    static const GLenum TRACKED_CAPABILITIES[] =
+    {
+        GL_BLEND,
+        GL_CULL_FACE,
+        GL_DEPTH_TEST,
+        GL_DITHER,
+        GL_POLYGON_OFFSET_FILL,
+        GL_SAMPLE_ALPHA_TO_COVERAGE,
+        GL_SAMPLE_COVERAGE,
+        GL_SCISSOR_TEST,
+        GL_STENCIL_TEST
+    };
+    constexpr uint32_t TRACKED_CAPABILITY_COUNT = sizeof(TRACKED_CAPABILITIES) / sizeof(TRACKED_CAPABILITIES[0]);
+
+    /* State of the context current in each thread */
+    static thread_local GlState* sg_currentState = nullptr;
+
+    constexpr uint32_t GlState::MAX_TRACKED_TEXTURE_UNITS;
+    constexpr uint32_t GlState::MAX_TRACKED_VERTEX_ATTRIBS;
+
+    static int32_t capabilityIndex(GLenum capability)
+    {
+        int32_t retval = -1;
+        for (uint32_t i = 0; i < TRACKED_CAPABILITY_COUNT; ++i)
+        {
+            if (TRACKED_CAPABILITIES[i] == capability)
+            {
+                retval = static_cast<int32_t>(i);
+                break;
+            }
+        }
+        return retval;
+    }
+
+    GlState::GlState()
+        : m_unbindToZero(false)
+        , m_counters()
+        , m_maxVertexAttribs(0U)
+    {
+        invalidate();
+        resetCounters();
+    }
+
+    GlState& GlState::current()
+    {
+        /* Fall back on a per-thread state for contexts not made current through a state object */
+        static thread_local GlState defaultState;
+        return (nullptr != sg_currentState) ? (*sg_currentState) : (defaultState);
+    }
+
+    void GlState::setCurrent(GlState* state)
+    {
+        sg_currentState = state;
+    }
+
+    void GlState::invalidate()
+    {
+        m_program = UNKNOWN_VALUE;
+        m_arrayBuffer = UNKNOWN_VALUE;
+        m_vertexArray = UNKNOWN_VALUE;
+        invalidateVertexArrayState();
+        m_activeTextureUnit = UNKNOWN_VALUE;
+        for (uint32_t unit = 0; unit < MAX_TRACKED_TEXTURE_UNITS; ++unit)
+        {
+            m_textures[unit] = UNKNOWN_VALUE;
+        }
+        m_enabledCapabilities = 0U;
+        m_knownCapabilities = 0U;
+        m_cullFace = UNKNOWN_VALUE;
+        m_frontFace = UNKNOWN_VALUE;
+        m_depthFunc = UNKNOWN_VALUE;
+        m_depthMask = UNKNOWN_VALUE;
+        m_blendSrcFactor = UNKNOWN_VALUE;
+        m_blendDstFactor = UNKNOWN_VALUE;
+    }
+
+    void GlState::resetCounters()
+    {
+        m_counters.calls = 0U;
+        m_counters.skippedCalls = 0U;
+        m_counters.programBinds = 0U;
+        m_counters.textureBinds = 0U;
+        m_counters.bufferBinds = 0U;
+        m_counters.vertexArrayBinds = 0U;
+        m_counters.uniformUploads = 0U;
+        m_counters.drawCalls = 0U;
+        m_counters.triangles = 0U;
+    }
+
+    void GlState::countDraw(GLenum mode, GLsizei vertexCount, GLsizei instanceCount)
+    {
+        /* Count the triangles of the triangle modes, strips and fans share all but the first two vertices */
+        uint64_t triangles = 0U;
+        if (GL_TRIANGLES == mode)
+        {
+            triangles = static_cast<uint64_t>(vertexCount / 3);
+        }
+        else if (((GL_TRIANGLE_STRIP == mode) || (GL_TRIANGLE_FAN == mode)) && (vertexCount > 2))
+        {
+            triangles = static_cast<uint64_t>(vertexCount - 2);
+        }
+
+        ++m_counters.drawCalls;
+        m_counters.triangles += triangles * static_cast<uint64_t>(instanceCount);
+    }
+
+    void GlState::useProgram(GLuint program)
+    {
+        if (update(m_program, program))
+        {
+            glUseProgram(program);
+            GlUtils::checkGLError("glUseProgram");
+            ++m_counters.programBinds;
+        }
+    }
+
+    void GlState::bindBuffer(GLenum target, GLuint buffer)
+    {
+        /* Only the GLES2 targets are tracked */
+        bool forward = true;
+        if (GL_ARRAY_BUFFER == target)
+        {
+            forward = update(m_arrayBuffer, buffer);
+        }
+        else if (GL_ELEMENT_ARRAY_BUFFER == target)
+        {
+            forward = update(m_elementArrayBuffer, buffer);
+        }
+        else
+        {
+            ++m_counters.calls;
+        }
+
+        if (forward)
+        {
+            glBindBuffer(target, buffer);
+            GlUtils::checkGLError("glBindBuffer");
+            ++m_counters.bufferBinds;
+        }
+    }
+
+    void GlState::deleteBuffer(GLuint buffer)
+    {
+        glDeleteBuffers(1, &buffer);
+        GlUtils::checkGLError("glDeleteBuffers");
+        ++m_counters.calls;
+
+        /* Deleted buffers are unbound */
+        if (buffer == m_arrayBuffer)
+        {
+            m_arrayBuffer = 0U;
+        }
+        if (buffer == m_elementArrayBuffer)
+        {
+            m_elementArrayBuffer = 0U;
+        }
+        for (uint32_t location = 0; location < MAX_TRACKED_VERTEX_ATTRIBS; ++location)
+        {
+            if (buffer == m_vertexAttribPointers[location].buffer)
+            {
+                m_vertexAttribPointers[location].buffer = 0U;
+            }
+        }
+    }
+
+    void GlState::activeTexture(uint32_t unit)
+    {
+        if (update(m_activeTextureUnit, unit))
+        {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            GlUtils::checkGLError("glActiveTexture");
+        }
+    }
+
+    void GlState::bindTexture(uint32_t unit, GLuint texture)
+    {
+        /* Skip both unit selection and binding if the texture is already bound */
+        if ((unit < MAX_TRACKED_TEXTURE_UNITS) && (texture == m_textures[unit]))
+        {
+            m_counters.skippedCalls += 2U;
+            return;
+        }
+
+        activeTexture(unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        GlUtils::checkGLError("glBindTexture");
+        ++m_counters.calls;
+        ++m_counters.textureBinds;
+        if (unit < MAX_TRACKED_TEXTURE_UNITS)
+        {
+            m_textures[unit] = texture;
+        }
+    }
+
+    void GlState::unbindTexture(GLuint texture)
+    {
+        for (uint32_t unit = 0; unit < MAX_TRACKED_TEXTURE_UNITS; ++unit)
+        {
+            if (texture == m_textures[unit])
+            {
+                bindTexture(unit, 0U);
+            }
+        }
+    }
+
+    void GlState::deleteTexture(GLuint texture)
+    {
+        glDeleteTextures(1, &texture);
+        GlUtils::checkGLError("glDeleteTextures");
+        ++m_counters.calls;
+
+        /* Deleted textures are unbound from all units */
+        for (uint32_t unit = 0; unit < MAX_TRACKED_TEXTURE_UNITS; ++unit)
+        {
+            if (texture == m_textures[unit])
+            {
+                m_textures[unit] = 0U;
+            }
+        }
+    }
+
+    void GlState::enableVertexAttribArray(GLuint location)
+    {
+        uint32_t bit = (location < MAX_TRACKED_VERTEX_ATTRIBS) ? (1U << location) : (0U);
+        if ((0U != bit) && (0U != (m_knownVertexAttribArrays & m_enabledVertexAttribArrays & bit)))
+        {
+            ++m_counters.skippedCalls;
+            return;
+        }
+
+        glEnableVertexAttribArray(location);
+        GlUtils::checkGLError("glEnableVertexAttribArray");
+        ++m_counters.calls;
+        m_knownVertexAttribArrays |= bit;
+        m_enabledVertexAttribArrays |= bit;
+    }
+
+    void GlState::disableVertexAttribArray(GLuint location)
+    {
+        uint32_t bit = (location < MAX_TRACKED_VERTEX_ATTRIBS) ? (1U << location) : (0U);
+        if ((0U != bit) && (0U != (m_knownVertexAttribArrays & bit)) && (0U == (m_enabledVertexAttribArrays & bit)))
+        {
+            ++m_counters.skippedCalls;
+            return;
+        }
+
+        glDisableVertexAttribArray(location);
+        GlUtils::checkGLError("glDisableVertexAttribArray");
+        ++m_counters.calls;
+        m_knownVertexAttribArrays |= bit;
+        m_enabledVertexAttribArrays &= ~bit;
+    }
+
+    void GlState::retainVertexAttribArrays(uint32_t locationMask)
+    {
+        /* Get the number of attribute locations once */
+        if (0U == m_maxVertexAttribs)
+        {
+            GLint maxVertexAttribs = 0;
+            glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxVertexAttribs);
+            GlUtils::checkGLError("glGetIntegerv");
+            m_maxVertexAttribs = std::min(static_cast<uint32_t>(std::max(maxVertexAttribs, 0)), MAX_TRACKED_VERTEX_ATTRIBS);
+        }
+
+        /* Disable the arrays enabled or in unknown state, outside the mask */
+        uint32_t disableMask = (m_enabledVertexAttribArrays | (~m_knownVertexAttribArrays)) & (~locationMask);
+        for (uint32_t location = 0; location < m_maxVertexAttribs; ++location)
+        {
+            if (0U != (disableMask & (1U << location)))
+            {
+                disableVertexAttribArray(location);
+            }
+        }
+    }
+
+    void GlState::vertexAttribPointer(GLuint location, GLuint buffer, GLint size, GLenum type, bool normalized, GLsizei stride, uintptr_t offset)
+    {
+        /* Skip both buffer binding and pointer if the pointer is already set */
+        if (location < MAX_TRACKED_VERTEX_ATTRIBS)
+        {
+            VertexAttribPointer& cached = m_vertexAttribPointers[location];
+            if ((buffer == cached.buffer) && (size == cached.size) && (type == cached.type) &&
+                (normalized == cached.normalized) && (stride == cached.stride) && (offset == cached.offset))
+            {
+                m_counters.skippedCalls += 2U;
+                return;
+            }
+            cached.buffer = buffer;
+            cached.size = size;
+            cached.type = type;
+            cached.normalized = normalized;
+            cached.stride = stride;
+            cached.offset = offset;
+        }
+
+        bindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(location, size, type, normalized ? GL_TRUE : GL_FALSE, stride, (const void*)offset);
+        GlUtils::checkGLError("glVertexAttribPointer");
+        ++m_counters.calls;
+    }
+
+    void GlState::bindVertexArray(GLuint vertexArray)
+    {
+        /* Without vertex array objects the default one is always bound */
+        if ((0U == vertexArray) && (!VertexArrayObject::isSupported()))
+        {
+            m_vertexArray = 0U;
+            ++m_counters.skippedCalls;
+            return;
+        }
+
+        if (update(m_vertexArray, vertexArray))
+        {
+            VertexArrayObject::bindVertexArray(vertexArray);
+            ++m_counters.vertexArrayBinds;
+            invalidateVertexArrayState();
+        }
+    }
+
+    void GlState::deleteVertexArray(GLuint vertexArray)
+    {
+        VertexArrayObject::deleteVertexArray(vertexArray);
+        ++m_counters.calls;
+
+        /* Deleted vertex array objects are unbound */
+        if (vertexArray == m_vertexArray)
+        {
+            m_vertexArray = 0U;
+            invalidateVertexArrayState();
+        }
+    }
+
+    void GlState::setCapability(GLenum capability, bool enable)
+    {
+        int32_t index = capabilityIndex(capability);
+        uint32_t bit = (index >= 0) ? (1U << index) : (0U);
+        if ((0U != bit) && (0U != (m_knownCapabilities & bit)) && (enable == (0U != (m_enabledCapabilities & bit))))
+        {
+            ++m_counters.skippedCalls;
+            return;
+        }
+
+        if (enable)
+        {
+            glEnable(capability);
+            GlUtils::checkGLError("glEnable");
+            m_enabledCapabilities |= bit;
+        }
+        else
+        {
+            glDisable(capability);
+            GlUtils::checkGLError("glDisable");
+            m_enabledCapabilities &= ~bit;
+        }
+        ++m_counters.calls;
+        m_knownCapabilities |= bit;
+    }
+
+    void GlState::cullFace(GLenum mode)
+    {
+        if (update(m_cullFace, mode))
+        {
+            glCullFace(mode);
+            GlUtils::checkGLError("glCullFace");
+        }
+    }
+
+    void GlState::frontFace(GLenum mode)
+    {
+        if (update(m_frontFace, mode))
+        {
+            glFrontFace(mode);
+            GlUtils::checkGLError("glFrontFace");
+        }
+    }
+
+    void GlState::depthFunc(GLenum func)
+    {
+        if (update(m_depthFunc, func))
+        {
+            glDepthFunc(func);
+            GlUtils::checkGLError("glDepthFunc");
+        }
+    }
+
+    void GlState::depthMask(bool enable)
+    {
+        if (update(m_depthMask, enable ? GL_TRUE : GL_FALSE))
+        {
+            glDepthMask(enable ? GL_TRUE : GL_FALSE);
+            GlUtils::checkGLError("glDepthMask");
+        }
+    }
+
+    void GlState::blendFunc(GLenum srcFactor, GLenum dstFactor)
+    {
+        /* Both factors are set by a single call */
+        if ((srcFactor == m_blendSrcFactor) && (dstFactor == m_blendDstFactor))
+        {
+            ++m_counters.skippedCalls;
+            return;
+        }
+
+        glBlendFunc(srcFactor, dstFactor);
+        GlUtils::checkGLError("glBlendFunc");
+        ++m_counters.calls;
+        m_blendSrcFactor = srcFactor;
+        m_blendDstFactor = dstFactor;
+    }
+
+    bool GlState::update(GLuint& cached, GLuint value)
+    {
+        bool retval = (cached != value);
+        if (retval)
+        {
+            cached = value;
+            ++m_counters.calls;
+        }
+        else
+        {
+            ++m_counters.skippedCalls;
+        }
+        return retval;
+    }
+
+    void GlState::invalidateVertexArrayState()
+    {
+        m_elementArrayBuffer = UNKNOWN_VALUE;
+        m_enabledVertexAttribArrays = 0U;
+        m_knownVertexAttribArrays = 0U;
+        for (uint32_t location = 0; location < MAX_TRACKED_VERTEX_ATTRIBS; ++location)
+        {
+            m_vertexAttribPointers[location].buffer = UNKNOWN_VALUE;
+        }
+    }
+}
+
+}
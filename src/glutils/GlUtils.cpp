@@ -30,8 +30,12 @@
 
 #include "ares/glutils/GlUtils.hpp"
 
+#include <atomic>
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
 
 namespace ares
 {
@@ -43,14 +47,61 @@ namespace GlUtils
 {
 
 
+    /* Current error checking mode */
+    static ErrorCheckMode sg_errorCheckMode = static_cast<ErrorCheckMode>(ARES_GL_ERROR_CHECK);
+
+    /* Flag set when a debug output callback is installed */
+    static std::atomic<bool> sg_debugOutput(false);
+
+    /* Number of errors received by the debug output callback, the callback can run on driver threads */
+    static std::atomic<uint32_t> sg_debugErrorCount(0U);
+
+    /* Maximum number of pending errors read by a frame check, errors are cleared one per glGetError */
+    constexpr uint32_t MAX_FRAME_ERRORS = 16U;
+
+    void setErrorCheckMode(ErrorCheckMode mode)
+    {
+        /* Checks above the build-time level are compiled out */
+        if (static_cast<int32_t>(mode) > ARES_GL_ERROR_CHECK)
+        {
+            mode = static_cast<ErrorCheckMode>(ARES_GL_ERROR_CHECK);
+        }
+        sg_errorCheckMode = mode;
+
+        /* The driver keeps validating and reporting messages while the debug output is enabled */
+        if (sg_debugOutput)
+        {
+            if (ErrorCheckMode::Off == mode)
+            {
+                glDisable(GL_DEBUG_OUTPUT_KHR);
+            }
+            else
+            {
+                glEnable(GL_DEBUG_OUTPUT_KHR);
+            }
+        }
+    }
+
+    ErrorCheckMode errorCheckMode()
+    {
+        return sg_errorCheckMode;
+    }
+
+#if ARES_GL_ERROR_CHECK == ARES_GL_ERROR_CHECK_EVERY_CALL
     bool checkGLError(const char* functionLastCalled, bool throwExcpt)
     {
+        /* Only poll in every call mode, the debug output callback reports errors by itself */
+        if ((ErrorCheckMode::EveryCall != sg_errorCheckMode) || sg_debugOutput)
+        {
+            return true;
+        }
+
         /* Get error from OpenGL */
         GLenum lastError = glGetError();
         if (lastError != GL_NO_ERROR)
         {
             /* Print error message */
-            std::cout << functionLastCalled << " failed " << lastError << std::endl;
+            std::cerr << functionLastCalled << " failed " << lastError << std::endl;
 
             /* Throw exception if needed */
             if (throwExcpt)
@@ -61,6 +112,118 @@ namespace GlUtils
         }
         return true;
     }
+#endif
+
+#if ARES_GL_ERROR_CHECK != ARES_GL_ERROR_CHECK_OFF
+    static void GL_APIENTRY debugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
+    {
+        (void)source;
+        (void)id;
+        (void)length;
+        (void)userParam;
+
+        /* Count errors for the frame checks, only errors and high severity messages are printed */
+        if (GL_DEBUG_TYPE_ERROR_KHR == type)
+        {
+            ++sg_debugErrorCount;
+        }
+        if ((GL_DEBUG_TYPE_ERROR_KHR == type) || (GL_DEBUG_SEVERITY_HIGH_KHR == severity))
+        {
+            std::cerr << "GL debug (type " << type << ", severity " << severity << "): " << message << std::endl;
+        }
+    }
+
+    bool checkFrameGLErrors(bool throwExcpt)
+    {
+        if (ErrorCheckMode::Off == sg_errorCheckMode)
+        {
+            return true;
+        }
+
+        /* Get the errors reported by the callback, or read the pending ones */
+        uint32_t errorCount = 0U;
+        if (sg_debugOutput)
+        {
+            errorCount = sg_debugErrorCount.exchange(0U);
+        }
+        else
+        {
+            for (GLenum lastError = glGetError(); (GL_NO_ERROR != lastError) && (errorCount < MAX_FRAME_ERRORS); lastError = glGetError())
+            {
+                std::cerr << "Frame OpenGL error " << lastError << std::endl;
+                ++errorCount;
+            }
+        }
+
+        if (0U != errorCount)
+        {
+            /* Throw exception if needed */
+            if (throwExcpt)
+            {
+                throw std::runtime_error("GL Error");
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool enableDebugOutput()
+    {
+        /* Get the extension entry points */
+        PFNGLDEBUGMESSAGECALLBACKKHRPROC debugMessageCallbackProc = nullptr;
+        PFNGLDEBUGMESSAGECONTROLKHRPROC debugMessageControlProc = nullptr;
+        if (hasExtension("GL_KHR_debug"))
+        {
+            debugMessageCallbackProc = reinterpret_cast<PFNGLDEBUGMESSAGECALLBACKKHRPROC>(eglGetProcAddress("glDebugMessageCallbackKHR"));
+            debugMessageControlProc = reinterpret_cast<PFNGLDEBUGMESSAGECONTROLKHRPROC>(eglGetProcAddress("glDebugMessageControlKHR"));
+        }
+        if ((nullptr == debugMessageCallbackProc) || (nullptr == debugMessageControlProc))
+        {
+            return false;
+        }
+
+        /* Install the callback for asynchronous messages, only errors and high severity messages are generated */
+        debugMessageCallbackProc(debugMessageCallback, nullptr);
+        debugMessageControlProc(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+        debugMessageControlProc(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR_KHR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        debugMessageControlProc(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_HIGH_KHR, 0, nullptr, GL_TRUE);
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+        sg_debugOutput = true;
+
+        /* Follow the current mode, the output is disabled while the checks are off */
+        setErrorCheckMode(sg_errorCheckMode);
+        return true;
+    }
+
+    bool debugOutputEnabled()
+    {
+        return sg_debugOutput && (ErrorCheckMode::Off != sg_errorCheckMode);
+    }
+#endif
+
+    bool hasExtension(const char* extensionName)
+    {
+        /* Get space-separated extension list */
+        const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+        checkGLError("glGetString");
+        if ((nullptr == extensions) || (nullptr == extensionName) || ('\0' == extensionName[0]))
+        {
+            return false;
+        }
+
+        /* Look for a whole word match, as names can be prefixes of other names */
+        size_t nameLength = strlen(extensionName);
+        for (const char* found = strstr(extensions, extensionName); nullptr != found; found = strstr(found + nameLength, extensionName))
+        {
+            bool startsWord = (found == extensions) || (' ' == found[-1]);
+            bool endsWord = (' ' == found[nameLength]) || ('\0' == found[nameLength]);
+            if (startsWord && endsWord)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
 
 }
 
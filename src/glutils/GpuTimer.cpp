@@ -0,0 +1,351 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/GpuTimer.hpp"
+#include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/Profiler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+namespace ares
+{
+
+namespace glutils
+{
+    /* Extension entry points */
+    static PFNGLGENQUERIESEXTPROC          sg_genQueries          = nullptr;
+    static PFNGLDELETEQUERIESEXTPROC       sg_deleteQueries       = nullptr;
+    static PFNGLBEGINQUERYEXTPROC          sg_beginQuery          = nullptr;
+    static PFNGLENDQUERYEXTPROC            sg_endQuery            = nullptr;
+    static PFNGLGETQUERYOBJECTUIVEXTPROC   sg_getQueryObjectuiv   = nullptr;
+    static PFNGLGETQUERYOBJECTUI64VEXTPROC sg_getQueryObjectui64v = nullptr;
+
+    /* Flag set once the extension has been queried */
+    static bool sg_initialized = false;
+
+    constexpr uint32_t GpuTimer::MAX_SCOPE_DEPTH;
+
+    static void loadEntryPoints()
+    {
+        sg_initialized = true;
+
+        if (GlUtils::hasExtension("GL_EXT_disjoint_timer_query"))
+        {
+            sg_genQueries          = reinterpret_cast<PFNGLGENQUERIESEXTPROC>(eglGetProcAddress("glGenQueriesEXT"));
+            sg_deleteQueries       = reinterpret_cast<PFNGLDELETEQUERIESEXTPROC>(eglGetProcAddress("glDeleteQueriesEXT"));
+            sg_beginQuery          = reinterpret_cast<PFNGLBEGINQUERYEXTPROC>(eglGetProcAddress("glBeginQueryEXT"));
+            sg_endQuery            = reinterpret_cast<PFNGLENDQUERYEXTPROC>(eglGetProcAddress("glEndQueryEXT"));
+            sg_getQueryObjectuiv   = reinterpret_cast<PFNGLGETQUERYOBJECTUIVEXTPROC>(eglGetProcAddress("glGetQueryObjectuivEXT"));
+            sg_getQueryObjectui64v = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(eglGetProcAddress("glGetQueryObjectui64vEXT"));
+        }
+
+        /* All entry points are needed */
+        if ((nullptr == sg_genQueries) || (nullptr == sg_deleteQueries) || (nullptr == sg_beginQuery) ||
+            (nullptr == sg_endQuery) || (nullptr == sg_getQueryObjectuiv) || (nullptr == sg_getQueryObjectui64v))
+        {
+            sg_genQueries          = nullptr;
+            sg_deleteQueries       = nullptr;
+            sg_beginQuery          = nullptr;
+            sg_endQuery            = nullptr;
+            sg_getQueryObjectuiv   = nullptr;
+            sg_getQueryObjectui64v = nullptr;
+        }
+    }
+
+    GpuTimer::GpuTimer(uint32_t frameLatency)
+        : m_frames(std::max(frameLatency, 1U))
+        , m_currentFrame(0U)
+        , m_frameNumber(0U)
+        , m_gpuTiming(false)
+        , m_scopeIds()
+        , m_traceNames()
+        , m_scopeStack()
+        , m_scopeStartTimes()
+        , m_scopeDepth(0U)
+        , m_queryRunning(false)
+        , m_results()
+        , m_resultsFrame(0U)
+        , m_resultsHaveGpuTimes(false)
+    {
+    }
+
+    GpuTimer::~GpuTimer()
+    {
+        /* Delete the queries of all frames */
+        for (auto& frame : m_frames)
+        {
+            if (!frame.queries.empty())
+            {
+                sg_deleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+                GlUtils::checkGLError("glDeleteQueriesEXT");
+            }
+        }
+    }
+
+    bool GpuTimer::isSupported()
+    {
+        if (!sg_initialized)
+        {
+            loadEntryPoints();
+        }
+        return (nullptr != sg_beginQuery);
+    }
+
+    uint32_t GpuTimer::scopeId(const std::string& name)
+    {
+        /* Register the scope on first use */
+        auto it = m_scopeIds.find(name);
+        if (m_scopeIds.end() == it)
+        {
+            it = m_scopeIds.insert(std::make_pair(name, static_cast<uint32_t>(m_scopeIds.size()))).first;
+            m_traceNames.push_back(Profiler::internName(name));
+        }
+        return it->second;
+    }
+
+    void GpuTimer::beginFrame()
+    {
+        /* Check the queries support with the first frame, the context is current from then on */
+        if (0U == m_frameNumber)
+        {
+            m_gpuTiming = isSupported();
+            if (m_gpuTiming)
+            {
+                /* Reading the disjoint flag resets it */
+                GLint disjoint = 0;
+                glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+                GlUtils::checkGLError("glGetIntegerv");
+            }
+        }
+
+        /* Read back the oldest frame and reuse its slot */
+        m_currentFrame = (m_currentFrame + 1U) % static_cast<uint32_t>(m_frames.size());
+        Frame& frame = m_frames[m_currentFrame];
+        readResults(frame);
+        frame.number = ++m_frameNumber;
+        frame.startNs = Profiler::now();
+        frame.intervals.clear();
+        frame.cpuTimesMs.assign(m_scopeIds.size(), 0.F);
+    }
+
+    void GpuTimer::endFrame()
+    {
+        if (0U != m_scopeDepth)
+        {
+            throw std::runtime_error("GpuTimer frame ended with open scopes");
+        }
+    }
+
+    void GpuTimer::beginScope(uint32_t scope)
+    {
+        if (MAX_SCOPE_DEPTH == m_scopeDepth)
+        {
+            throw std::runtime_error("Too many nested GpuTimer scopes");
+        }
+
+        /* Open scope */
+        Frame& frame = m_frames[m_currentFrame];
+        if (scope >= frame.cpuTimesMs.size())
+        {
+            frame.cpuTimesMs.resize(scope + 1U, 0.F);
+        }
+        m_scopeStack[m_scopeDepth] = scope;
+        m_scopeStartTimes[m_scopeDepth] = std::chrono::steady_clock::now();
+        ++m_scopeDepth;
+
+        /* Time the scope with a new query */
+        if (m_gpuTiming)
+        {
+            switchQuery();
+        }
+    }
+
+    void GpuTimer::endScope()
+    {
+        if (0U == m_scopeDepth)
+        {
+            throw std::runtime_error("No GpuTimer scope to end");
+        }
+
+        /* Close scope */
+        --m_scopeDepth;
+        Frame& frame = m_frames[m_currentFrame];
+        frame.cpuTimesMs[m_scopeStack[m_scopeDepth]] +=
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_scopeStartTimes[m_scopeDepth]).count();
+
+        /* Time the enclosing scopes with a new query */
+        if (m_gpuTiming)
+        {
+            switchQuery();
+        }
+    }
+
+    void GpuTimer::switchQuery()
+    {
+        /* Stop the running query */
+        if (m_queryRunning)
+        {
+            sg_endQuery(GL_TIME_ELAPSED_EXT);
+            GlUtils::checkGLError("glEndQueryEXT");
+            m_queryRunning = false;
+        }
+
+        /* Start a query for the open scopes, creating it if the pool is exhausted */
+        if (m_scopeDepth > 0U)
+        {
+            Frame& frame = m_frames[m_currentFrame];
+            Interval interval;
+            interval.query = static_cast<uint32_t>(frame.intervals.size());
+            if (interval.query == frame.queries.size())
+            {
+                GLuint query = 0U;
+                sg_genQueries(1, &query);
+                GlUtils::checkGLError("glGenQueriesEXT");
+                frame.queries.push_back(query);
+            }
+            std::copy(m_scopeStack, m_scopeStack + m_scopeDepth, interval.scopes);
+            interval.depth = m_scopeDepth;
+            frame.intervals.push_back(interval);
+
+            sg_beginQuery(GL_TIME_ELAPSED_EXT, frame.queries[interval.query]);
+            GlUtils::checkGLError("glBeginQueryEXT");
+            m_queryRunning = true;
+        }
+    }
+
+    void GpuTimer::readResults(Frame& frame)
+    {
+        /* Nothing to read for unused slots */
+        if (0U == frame.number)
+        {
+            return;
+        }
+
+        /* Scope names and CPU times */
+        m_results.resize(m_scopeIds.size());
+        for (const auto& scope : m_scopeIds)
+        {
+            ScopeTimes& times = m_results[scope.second];
+            times.name = scope.first;
+            times.gpuTimeMs = 0.F;
+            times.cpuTimeMs = (scope.second < frame.cpuTimesMs.size()) ? (frame.cpuTimesMs[scope.second]) : (0.F);
+        }
+
+        /* The queries complete in order, the frame is available if its last query is */
+        bool gpuTimes = m_gpuTiming;
+        if (gpuTimes && (!frame.intervals.empty()))
+        {
+            GLuint available = GL_FALSE;
+            sg_getQueryObjectuiv(frame.queries[frame.intervals.back().query], GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+            GlUtils::checkGLError("glGetQueryObjectuivEXT");
+            gpuTimes = (GL_FALSE != available);
+        }
+
+        /* Discard the GPU times if a disjoint operation occurred */
+        if (gpuTimes)
+        {
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+            GlUtils::checkGLError("glGetIntegerv");
+            gpuTimes = (0 == disjoint);
+        }
+
+        /* Add the time of each query to all the scopes open during it */
+        if (gpuTimes)
+        {
+            std::vector<uint64_t> intervalTimesNs(frame.intervals.size(), 0U);
+            for (size_t index = 0; index < frame.intervals.size(); ++index)
+            {
+                const Interval& interval = frame.intervals[index];
+                GLuint64 elapsedNs = 0U;
+                sg_getQueryObjectui64v(frame.queries[interval.query], GL_QUERY_RESULT_EXT, &elapsedNs);
+                GlUtils::checkGLError("glGetQueryObjectui64vEXT");
+                intervalTimesNs[index] = elapsedNs;
+                float elapsedMs = static_cast<float>(static_cast<double>(elapsedNs) * 1.0E-6);
+                for (uint32_t i = 0; i < interval.depth; ++i)
+                {
+                    m_results[interval.scopes[i]].gpuTimeMs += elapsedMs;
+                }
+            }
+
+            if (Profiler::isEnabled())
+            {
+                recordTraceEvents(frame, intervalTimesNs);
+            }
+        }
+
+        m_resultsFrame = frame.number;
+        m_resultsHaveGpuTimes = gpuTimes;
+    }
+
+    void GpuTimer::recordTraceEvents(const Frame& frame, const std::vector<uint64_t>& elapsedNs) const
+    {
+        /* Lay the intervals out back to back, a scope spans from its first interval to its last */
+        uint32_t openScopes[MAX_SCOPE_DEPTH];
+        uint64_t openStartNs[MAX_SCOPE_DEPTH];
+        uint32_t openDepth = 0U;
+        uint64_t timeNs = frame.startNs;
+        for (size_t index = 0; index < frame.intervals.size(); ++index)
+        {
+            /* Close the open scopes that the interval does not continue, innermost first */
+            const Interval& interval = frame.intervals[index];
+            uint32_t common = 0U;
+            while ((common < openDepth) && (common < interval.depth) && (openScopes[common] == interval.scopes[common]))
+            {
+                ++common;
+            }
+            while (openDepth > common)
+            {
+                --openDepth;
+                Profiler::recordGpuEvent(m_traceNames[openScopes[openDepth]], openStartNs[openDepth], timeNs);
+            }
+
+            /* Open the new scopes of the interval */
+            for (; openDepth < interval.depth; ++openDepth)
+            {
+                openScopes[openDepth] = interval.scopes[openDepth];
+                openStartNs[openDepth] = timeNs;
+            }
+            timeNs += elapsedNs[index];
+        }
+
+        /* Close the remaining scopes */
+        while (openDepth > 0U)
+        {
+            --openDepth;
+            Profiler::recordGpuEvent(m_traceNames[openScopes[openDepth]], openStartNs[openDepth], timeNs);
+        }
+    }
+}
+
+}
@@ -41,6 +41,7 @@ namespace glutils
         , m_format(format)
         , m_width(width)
         , m_height(height)
+        , m_memory(MemoryTracker::Category::Image, static_cast<uint64_t>(m_imageData.size()))
     {
     }
 
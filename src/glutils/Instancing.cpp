@@ -0,0 +1,123 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/Instancing.hpp"
+#include "ares/glutils/GlUtils.hpp"
+
+#include <stdexcept>
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+namespace ares
+{
+
+namespace glutils
+{
+
+namespace Instancing
+{
+    /* Extension entry points, EXT and ANGLE variants share the same signatures */
+    static PFNGLDRAWARRAYSINSTANCEDEXTPROC   sg_drawArraysInstanced   = nullptr;
+    static PFNGLDRAWELEMENTSINSTANCEDEXTPROC sg_drawElementsInstanced = nullptr;
+    static PFNGLVERTEXATTRIBDIVISOREXTPROC   sg_vertexAttribDivisor   = nullptr;
+
+    /* Flag set once the extensions have been queried */
+    static bool sg_initialized = false;
+
+    static void loadEntryPoints()
+    {
+        sg_initialized = true;
+
+        if (GlUtils::hasExtension("GL_EXT_instanced_arrays"))
+        {
+            sg_drawArraysInstanced   = reinterpret_cast<PFNGLDRAWARRAYSINSTANCEDEXTPROC>(eglGetProcAddress("glDrawArraysInstancedEXT"));
+            sg_drawElementsInstanced = reinterpret_cast<PFNGLDRAWELEMENTSINSTANCEDEXTPROC>(eglGetProcAddress("glDrawElementsInstancedEXT"));
+            sg_vertexAttribDivisor   = reinterpret_cast<PFNGLVERTEXATTRIBDIVISOREXTPROC>(eglGetProcAddress("glVertexAttribDivisorEXT"));
+        }
+        else if (GlUtils::hasExtension("GL_ANGLE_instanced_arrays"))
+        {
+            sg_drawArraysInstanced   = reinterpret_cast<PFNGLDRAWARRAYSINSTANCEDEXTPROC>(eglGetProcAddress("glDrawArraysInstancedANGLE"));
+            sg_drawElementsInstanced = reinterpret_cast<PFNGLDRAWELEMENTSINSTANCEDEXTPROC>(eglGetProcAddress("glDrawElementsInstancedANGLE"));
+            sg_vertexAttribDivisor   = reinterpret_cast<PFNGLVERTEXATTRIBDIVISOREXTPROC>(eglGetProcAddress("glVertexAttribDivisorANGLE"));
+        }
+
+        /* All entry points are needed */
+        if ((nullptr == sg_drawArraysInstanced) || (nullptr == sg_drawElementsInstanced) || (nullptr == sg_vertexAttribDivisor))
+        {
+            sg_drawArraysInstanced   = nullptr;
+            sg_drawElementsInstanced = nullptr;
+            sg_vertexAttribDivisor   = nullptr;
+        }
+    }
+
+    bool isSupported()
+    {
+        if (!sg_initialized)
+        {
+            loadEntryPoints();
+        }
+        return (nullptr != sg_vertexAttribDivisor);
+    }
+
+    void vertexAttribDivisor(GLuint index, GLuint divisor)
+    {
+        if (!isSupported())
+        {
+            throw std::runtime_error("Instanced arrays not supported");
+        }
+        sg_vertexAttribDivisor(index, divisor);
+        GlUtils::checkGLError("glVertexAttribDivisor");
+    }
+
+    void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+    {
+        if (!isSupported())
+        {
+            throw std::runtime_error("Instanced arrays not supported");
+        }
+        sg_drawArraysInstanced(mode, first, count, instanceCount);
+        GlUtils::checkGLError("glDrawArraysInstanced");
+    }
+
+    void drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount)
+    {
+        if (!isSupported())
+        {
+            throw std::runtime_error("Instanced arrays not supported");
+        }
+        sg_drawElementsInstanced(mode, count, type, indices, instanceCount);
+        GlUtils::checkGLError("glDrawElementsInstanced");
+    }
+
+}
+
+}
+
+}
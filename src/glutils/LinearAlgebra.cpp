@@ -35,6 +35,34 @@ namespace ares
 
 namespace glutils
 {
+#if defined(ARES_SIMD_SSE2) || defined(ARES_SIMD_NEON)
+    /*
+     * 2x2 matrix helpers of the block inverse, each Float4 holds a
+     * 2x2 matrix as (m00, m01, m10, m11)
+     */
+
+    /* Product A * B */
+    static inline Float4 mat2Mul(const Float4& a, const Float4& b)
+    {
+        return (a * Float4::swizzle<0, 3, 0, 3>(b)) + (Float4::swizzle<1, 0, 3, 2>(a) * Float4::swizzle<2, 1, 2, 1>(b));
+    }
+
+    /* Product adj(A) * B */
+    static inline Float4 mat2AdjMul(const Float4& a, const Float4& b)
+    {
+        return (Float4::swizzle<3, 3, 0, 0>(a) * b) - (Float4::swizzle<1, 1, 2, 2>(a) * Float4::swizzle<2, 3, 0, 1>(b));
+    }
+
+    /* Product A * adj(B) */
+    static inline Float4 mat2MulAdj(const Float4& a, const Float4& b)
+    {
+        return (a * Float4::swizzle<3, 0, 3, 0>(b)) - (Float4::swizzle<1, 0, 3, 2>(a) * Float4::swizzle<2, 1, 2, 1>(b));
+    }
+#endif
+
+    /* Tolerance of the uniform scale shortcut of the normal matrix, tight enough to keep it exact in float */
+    constexpr float NORMAL_MATRIX_SCALE_TOLERANCE = 1.0E-5F;
+
     template<>
     Vec3 Mat4::translation() const
     {
@@ -203,9 +231,108 @@ namespace glutils
         *this = tmp * *this;
     }
 
+    template<>
+    Mat4& Mat4::invertAffine()
+    {
+        const Float4 c0 = Float4::load(m_data[0]);
+        const Float4 c1 = Float4::load(m_data[1]);
+        const Float4 c2 = Float4::load(m_data[2]);
+
+        /* Rows of the adjugate of the upper 3x3 block as cross products of its columns */
+        Float4 r0 = (Float4::swizzle<1, 2, 0, 3>(c1) * Float4::swizzle<2, 0, 1, 3>(c2)) -
+                    (Float4::swizzle<2, 0, 1, 3>(c1) * Float4::swizzle<1, 2, 0, 3>(c2));
+        Float4 r1 = (Float4::swizzle<1, 2, 0, 3>(c2) * Float4::swizzle<2, 0, 1, 3>(c0)) -
+                    (Float4::swizzle<2, 0, 1, 3>(c2) * Float4::swizzle<1, 2, 0, 3>(c0));
+        Float4 r2 = (Float4::swizzle<1, 2, 0, 3>(c0) * Float4::swizzle<2, 0, 1, 3>(c1)) -
+                    (Float4::swizzle<2, 0, 1, 3>(c0) * Float4::swizzle<1, 2, 0, 3>(c1));
+        const float det = Float4::sum(c0 * r0).first();
+
+        if (det != 0.F)
+        {
+            /* Scale the adjugate and transpose it to get the columns of the inverse */
+            const Float4 invDet = Float4::splat(1.F / det);
+            r0 = r0 * invDet;
+            r1 = r1 * invDet;
+            r2 = r2 * invDet;
+            Float4 r3 = Float4::splat(0.F);
+            Float4::transpose(r0, r1, r2, r3);
+
+            /* Translation of the inverse as the opposite translation transformed by the inverse */
+            Float4 t = r0 * Float4::splat(m_data[3][0]);
+            t = Float4::madd(r1, Float4::splat(m_data[3][1]), t);
+            t = Float4::madd(r2, Float4::splat(m_data[3][2]), t);
+            t = Float4::set(0.F, 0.F, 0.F, 1.F) - t;
+
+            r0.store(m_data[0]);
+            r1.store(m_data[1]);
+            r2.store(m_data[2]);
+            t.store(m_data[3]);
+        }
+
+        return *this;
+    }
+
     template<>
     Mat4& Mat4::invert()
     {
+        /* Affine matrices, like model and view matrices, have a much cheaper inverse */
+        if ((0.F == m_data[0][3]) && (0.F == m_data[1][3]) && (0.F == m_data[2][3]) && (1.F == m_data[3][3]))
+        {
+            return invertAffine();
+        }
+
+#if defined(ARES_SIMD_SSE2) || defined(ARES_SIMD_NEON)
+        /*
+         * Block inverse on the 2x2 sub-matrices. The columns are processed as
+         * rows, which gives the transpose of the inverse of the transpose,
+         * i.e. the columns of the inverse.
+         */
+        const Float4 c0 = Float4::load(m_data[0]);
+        const Float4 c1 = Float4::load(m_data[1]);
+        const Float4 c2 = Float4::load(m_data[2]);
+        const Float4 c3 = Float4::load(m_data[3]);
+        const Float4 a = Float4::shuffle<0, 1, 0, 1>(c0, c1);
+        const Float4 b = Float4::shuffle<2, 3, 2, 3>(c0, c1);
+        const Float4 c = Float4::shuffle<0, 1, 0, 1>(c2, c3);
+        const Float4 d = Float4::shuffle<2, 3, 2, 3>(c2, c3);
+
+        /* Determinants of the sub-matrices as (|A|, |B|, |C|, |D|) */
+        const Float4 detSub = (Float4::shuffle<0, 2, 0, 2>(c0, c2) * Float4::shuffle<1, 3, 1, 3>(c1, c3)) -
+                              (Float4::shuffle<1, 3, 1, 3>(c0, c2) * Float4::shuffle<0, 2, 0, 2>(c1, c3));
+        const Float4 detA = Float4::swizzle<0, 0, 0, 0>(detSub);
+        const Float4 detB = Float4::swizzle<1, 1, 1, 1>(detSub);
+        const Float4 detC = Float4::swizzle<2, 2, 2, 2>(detSub);
+        const Float4 detD = Float4::swizzle<3, 3, 3, 3>(detSub);
+
+        /* Adjugates of the blocks of the inverse */
+        const Float4 dc = mat2AdjMul(d, c);
+        const Float4 ab = mat2AdjMul(a, b);
+        const Float4 x = (detD * a) - mat2Mul(b, dc);
+        const Float4 w = (detA * d) - mat2Mul(c, ab);
+        const Float4 y = (detB * c) - mat2MulAdj(d, ab);
+        const Float4 z = (detC * b) - mat2MulAdj(a, dc);
+
+        /* Determinant as |A||D| + |B||C| - tr(adj(A)B adj(D)C) */
+        const Float4 tr = Float4::sum(ab * Float4::swizzle<0, 2, 1, 3>(dc));
+        const float det = ((detA * detD) + (detB * detC) - tr).first();
+
+        if (det != 0.F)
+        {
+            /* Scale and apply the adjugate signs, then store in the output layout */
+            const float invDet = 1.F / det;
+            const Float4 scale = Float4::set(invDet, -invDet, -invDet, invDet);
+            const Float4 xs = x * scale;
+            const Float4 ys = y * scale;
+            const Float4 zs = z * scale;
+            const Float4 ws = w * scale;
+            Float4::shuffle<3, 1, 3, 1>(xs, ys).store(m_data[0]);
+            Float4::shuffle<2, 0, 2, 0>(xs, ys).store(m_data[1]);
+            Float4::shuffle<3, 1, 3, 1>(zs, ws).store(m_data[2]);
+            Float4::shuffle<2, 0, 2, 0>(zs, ws).store(m_data[3]);
+        }
+
+        return *this;
+#else
         Mat4 res;
 
         res.m_data[0][0] = m_data[1][1] * m_data[2][2] * m_data[3][3] - 
@@ -335,6 +462,66 @@ namespace glutils
         }
 
         return *this;
+#endif
+    }
+
+    template<>
+    bool Mat4::hasUniformScale(float tolerance) const
+    {
+        Vec3 x(m_data[0][0], m_data[0][1], m_data[0][2]);
+        Vec3 y(m_data[1][0], m_data[1][1], m_data[1][2]);
+        Vec3 z(m_data[2][0], m_data[2][1], m_data[2][2]);
+
+        /* Columns must have the same length and be orthogonal */
+        float lengthSq = x.dot(x);
+        float absTolerance = tolerance * lengthSq;
+        return (lengthSq > 0.F) &&
+               (std::fabs(y.dot(y) - lengthSq) <= absTolerance) && (std::fabs(z.dot(z) - lengthSq) <= absTolerance) &&
+               (std::fabs(x.dot(y)) <= absTolerance) && (std::fabs(x.dot(z)) <= absTolerance) && (std::fabs(y.dot(z)) <= absTolerance);
+    }
+
+    template<>
+    Mat3 Mat4::normalMatrix() const
+    {
+        Mat3 res;
+
+        /* Uniform scale: the block is orthogonal up to its squared scale */
+        if (hasUniformScale(NORMAL_MATRIX_SCALE_TOLERANCE))
+        {
+            float invScaleSq = 1.F / ((m_data[0][0] * m_data[0][0]) + (m_data[0][1] * m_data[0][1]) + (m_data[0][2] * m_data[0][2]));
+            for (size_t c = 0; c < 3; ++c)
+            {
+                for (size_t r = 0; r < 3; ++r)
+                {
+                    res.set(r, c, m_data[c][r] * invScaleSq);
+                }
+            }
+            return res;
+        }
+
+        /* Otherwise the columns of the inverse transpose are the cross products of the columns divided by the determinant */
+        float cof[3][3];
+        for (size_t c = 0; c < 3; ++c)
+        {
+            const float* u = m_data[(c + 1) % 3];
+            const float* v = m_data[(c + 2) % 3];
+            cof[c][0] = (u[1] * v[2]) - (u[2] * v[1]);
+            cof[c][1] = (u[2] * v[0]) - (u[0] * v[2]);
+            cof[c][2] = (u[0] * v[1]) - (u[1] * v[0]);
+        }
+        float det = (m_data[0][0] * cof[0][0]) + (m_data[0][1] * cof[0][1]) + (m_data[0][2] * cof[0][2]);
+        float invDet = (det != 0.F) ? (1.F / det) : 0.F;
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            for (size_t r = 0; r < 3; ++r)
+            {
+                /* Singular block: keep the transposed block as the full inverse does */
+                res.set(r, c, (det != 0.F) ? (cof[c][r] * invDet) : m_data[r][c]);
+            }
+        }
+
+        return res;
     }
 
     Vec4 eulerToQuaternion(const Vec3& euler)
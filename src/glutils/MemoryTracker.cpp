@@ -0,0 +1,351 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/MemoryTracker.hpp"
+
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+namespace ares
+{
+
+namespace glutils
+{
+
+namespace MemoryTracker
+{
+
+    /* Asset of the allocations created outside any asset scope */
+    constexpr uint32_t ENGINE_ASSET = 0U;
+
+    /* Names of the categories */
+    static const char* const sg_categoryNames[CATEGORY_COUNT] = { "vertexBuffer", "indexBuffer", "texture", "renderbuffer", "image", "modelData" };
+
+    /* Usage of each asset, totals, peak and budget, guarded by the mutex */
+    static std::mutex sg_mutex;
+    static std::vector<AssetUsage> sg_assets(1U, AssetUsage{ "engine", {} });
+    static uint64_t sg_categoryBytes[CATEGORY_COUNT] = {};
+    static uint64_t sg_totalBytes = 0U;
+    static uint64_t sg_peakBytes = 0U;
+    static uint64_t sg_budget = 0U;
+
+    /* Periodic dump interval and frame counter, used by the render thread */
+    static uint32_t sg_dumpInterval = 0U;
+    static uint32_t sg_frameCount = 0U;
+
+    /* Active asset of the calling thread */
+    static thread_local uint32_t sg_currentAsset = ENGINE_ASSET;
+
+    static void addBytes(Category category, uint32_t asset, uint64_t oldBytes, uint64_t newBytes)
+    {
+        /* Replace the old size with the new one in the asset and in the totals */
+        const uint32_t index = static_cast<uint32_t>(category);
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        sg_assets[asset].bytes[index] = sg_assets[asset].bytes[index] - oldBytes + newBytes;
+        sg_categoryBytes[index] = sg_categoryBytes[index] - oldBytes + newBytes;
+        sg_totalBytes = sg_totalBytes - oldBytes + newBytes;
+        sg_peakBytes = std::max(sg_peakBytes, sg_totalBytes);
+    }
+
+    static void writeBytes(std::ostream& os, uint64_t bytes)
+    {
+        /* Sizes in KiB with one decimal */
+        os << std::setw(12) << std::fixed << std::setprecision(1) << (static_cast<double>(bytes) / 1024.0);
+    }
+
+    uint64_t AssetUsage::totalBytes() const
+    {
+        uint64_t total = 0U;
+        for (uint32_t i = 0; i < CATEGORY_COUNT; ++i)
+        {
+            total += bytes[i];
+        }
+        return total;
+    }
+
+    const char* categoryName(Category category)
+    {
+        return (category < Category::Count) ? (sg_categoryNames[static_cast<uint32_t>(category)]) : ("invalid");
+    }
+
+    uint64_t categoryBytes(Category category)
+    {
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        return (category < Category::Count) ? (sg_categoryBytes[static_cast<uint32_t>(category)]) : (0U);
+    }
+
+    uint64_t totalBytes()
+    {
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        return sg_totalBytes;
+    }
+
+    uint64_t peakBytes()
+    {
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        return sg_peakBytes;
+    }
+
+    std::vector<AssetUsage> assetUsage()
+    {
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        return sg_assets;
+    }
+
+    void setBudget(uint64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        sg_budget = bytes;
+    }
+
+    uint64_t budget()
+    {
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        return sg_budget;
+    }
+
+    bool isOverBudget()
+    {
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        return (0U != sg_budget) && (sg_totalBytes > sg_budget);
+    }
+
+    void dump(std::ostream& os)
+    {
+        /* Take a snapshot not to hold the lock while writing */
+        std::vector<AssetUsage> assets;
+        uint64_t categories[CATEGORY_COUNT];
+        uint64_t total = 0U;
+        uint64_t peak = 0U;
+        uint64_t budgetBytes = 0U;
+        {
+            std::lock_guard<std::mutex> lock(sg_mutex);
+            assets = sg_assets;
+            std::copy(sg_categoryBytes, sg_categoryBytes + CATEGORY_COUNT, categories);
+            total = sg_totalBytes;
+            peak = sg_peakBytes;
+            budgetBytes = sg_budget;
+        }
+
+        /* Header with the totals */
+        const std::ios_base::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << "Memory (KiB): total";
+        writeBytes(os, total);
+        os << ", peak";
+        writeBytes(os, peak);
+        if (0U != budgetBytes)
+        {
+            os << ", budget";
+            writeBytes(os, budgetBytes);
+            os << ((total > budgetBytes) ? " EXCEEDED" : "");
+        }
+        os << std::endl << std::setw(24) << std::left << "asset" << std::right;
+        for (uint32_t i = 0; i < CATEGORY_COUNT; ++i)
+        {
+            os << std::setw(13) << sg_categoryNames[i];
+        }
+        os << std::setw(13) << "total" << std::endl;
+
+        /* One line per asset using memory, then the category totals */
+        for (const auto& asset : assets)
+        {
+            const uint64_t assetTotal = asset.totalBytes();
+            if (0U != assetTotal)
+            {
+                /* Long names (e.g. file paths) are shortened to their end */
+                const std::string name = (asset.name.size() > 23U) ? (asset.name.substr(asset.name.size() - 23U)) : (asset.name);
+                os << std::setw(24) << std::left << name << std::right;
+                for (uint32_t i = 0; i < CATEGORY_COUNT; ++i)
+                {
+                    os << " ";
+                    writeBytes(os, asset.bytes[i]);
+                }
+                os << " ";
+                writeBytes(os, assetTotal);
+                os << std::endl;
+            }
+        }
+        os << std::setw(24) << std::left << "all" << std::right;
+        for (uint32_t i = 0; i < CATEGORY_COUNT; ++i)
+        {
+            os << " ";
+            writeBytes(os, categories[i]);
+        }
+        os << " ";
+        writeBytes(os, total);
+        os << std::endl;
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    void setDumpInterval(uint32_t frames)
+    {
+        sg_dumpInterval = frames;
+        sg_frameCount = 0U;
+    }
+
+    void endFrame()
+    {
+        if ((0U != sg_dumpInterval) && (++sg_frameCount >= sg_dumpInterval))
+        {
+            sg_frameCount = 0U;
+            dump(std::cerr);
+        }
+    }
+
+    Allocation::Allocation(Category category, uint64_t bytes)
+        : m_category(category)
+        , m_asset(sg_currentAsset)
+        , m_bytes(0U)
+    {
+        setBytes(bytes);
+    }
+
+    Allocation::~Allocation()
+    {
+        setBytes(0U);
+    }
+
+    void Allocation::setBytes(uint64_t bytes)
+    {
+        /* Only size changes reach the registry */
+        if (bytes != m_bytes)
+        {
+            addBytes(m_category, m_asset, m_bytes, bytes);
+            m_bytes = bytes;
+        }
+    }
+
+    AssetScope::AssetScope(const std::string& name)
+        : m_previousAsset(sg_currentAsset)
+    {
+        /* Register the asset on first use, assets loaded again keep their entry */
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        auto it = std::find_if(sg_assets.begin(), sg_assets.end(), [&name](const AssetUsage& asset) { return (asset.name == name); });
+        if (sg_assets.end() == it)
+        {
+            sg_assets.push_back(AssetUsage{ name, {} });
+            it = sg_assets.end() - 1;
+        }
+        sg_currentAsset = static_cast<uint32_t>(it - sg_assets.begin());
+    }
+
+    AssetScope::~AssetScope()
+    {
+        sg_currentAsset = m_previousAsset;
+    }
+
+    uint64_t textureBytes(int32_t width, int32_t height, GLenum format, GLenum type, bool mipmaps)
+    {
+        /* Bytes per pixel from the type, packed types hold the whole pixel */
+        uint64_t pixelBytes = 0U;
+        switch (type)
+        {
+            case GL_UNSIGNED_SHORT_5_6_5:
+            case GL_UNSIGNED_SHORT_4_4_4_4:
+            case GL_UNSIGNED_SHORT_5_5_5_1:
+                pixelBytes = 2U;
+                break;
+            default:
+            {
+                uint64_t componentBytes = 1U;
+                if ((GL_UNSIGNED_SHORT == type) || (GL_HALF_FLOAT_OES == type))
+                {
+                    componentBytes = 2U;
+                }
+                else if ((GL_UNSIGNED_INT == type) || (GL_FLOAT == type))
+                {
+                    componentBytes = 4U;
+                }
+                uint64_t components = 1U;
+                if (GL_RGBA == format)
+                {
+                    components = 4U;
+                }
+                else if (GL_RGB == format)
+                {
+                    components = 3U;
+                }
+                else if (GL_LUMINANCE_ALPHA == format)
+                {
+                    components = 2U;
+                }
+                pixelBytes = components * componentBytes;
+                break;
+            }
+        }
+
+        /* Sum the levels of the mip chain, each level halves the size down to 1x1 */
+        uint64_t bytes = 0U;
+        uint64_t levelWidth = static_cast<uint64_t>(std::max(width, 0));
+        uint64_t levelHeight = static_cast<uint64_t>(std::max(height, 0));
+        while ((levelWidth > 0U) && (levelHeight > 0U))
+        {
+            bytes += levelWidth * levelHeight * pixelBytes;
+            if ((!mipmaps) || ((1U == levelWidth) && (1U == levelHeight)))
+            {
+                break;
+            }
+            levelWidth = std::max(levelWidth / 2U, static_cast<uint64_t>(1U));
+            levelHeight = std::max(levelHeight / 2U, static_cast<uint64_t>(1U));
+        }
+        return bytes;
+    }
+
+    uint64_t renderbufferBytes(int32_t width, int32_t height, GLenum format)
+    {
+        /* Bytes per pixel of the internal format */
+        uint64_t pixelBytes = 4U;
+        switch (format)
+        {
+            case GL_STENCIL_INDEX8:
+                pixelBytes = 1U;
+                break;
+            case GL_DEPTH_COMPONENT16:
+            case GL_RGBA4:
+            case GL_RGB5_A1:
+            case GL_RGB565:
+                pixelBytes = 2U;
+                break;
+            default:
+                break;
+        }
+        return static_cast<uint64_t>(std::max(width, 0)) * static_cast<uint64_t>(std::max(height, 0)) * pixelBytes;
+    }
+
+}
+
+}
+
+}
@@ -29,6 +29,7 @@
  *****************************************************************************/
 
 #include "ares/glutils/PngLoader.hpp"
+#include "ares/glutils/Profiler.hpp"
 
 #include <stdexcept>
 #include <fstream>
@@ -66,6 +67,8 @@ namespace PngLoader
 
     ImagePtr loadPng(const std::string& filename, bool flip)
     {
+        ARES_PROFILE_SCOPE("load", "PngLoader::loadPng");
+
         /* Assume failure */
         ImagePtr retval = nullptr;
 
@@ -0,0 +1,277 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/Profiler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace ares
+{
+
+namespace glutils
+{
+
+namespace Profiler
+{
+
+    /* Number of events of a buffer chunk */
+    constexpr uint32_t CHUNK_EVENTS = 1024U;
+
+    /* Trace identifiers of the process and of the GPU track */
+    constexpr uint32_t TRACE_PID = 1U;
+    constexpr uint32_t GPU_TRACK_TID = 0U;
+
+    /* Recorded event */
+    struct Event
+    {
+        const char* category;
+        const char* name;
+        uint64_t startNs;
+        uint64_t durationNs;
+        bool gpu;
+    };
+
+    /* Chunk of events, written by the owner thread and read when the trace is written */
+    struct Chunk
+    {
+        Event events[CHUNK_EVENTS];
+        std::atomic<uint32_t> count;
+        std::atomic<Chunk*> next;
+
+        Chunk() : count(0U), next(nullptr) {}
+    };
+
+    /* Event buffer of a thread, a list of chunks appended by the owner thread and drained by the writer */
+    struct ThreadBuffer
+    {
+        uint32_t tid;
+        std::atomic<const char*> name;
+        std::atomic<bool> retired;
+        Chunk* head;
+        uint32_t readIndex;
+        Chunk* tail;
+
+        ThreadBuffer(uint32_t threadId)
+            : tid(threadId), name(nullptr), retired(false), head(new Chunk()), readIndex(0U), tail(head) {}
+
+        ~ThreadBuffer()
+        {
+            while (nullptr != head)
+            {
+                Chunk* next = head->next.load(std::memory_order_relaxed);
+                delete head;
+                head = next;
+            }
+        }
+    };
+
+    /* Handle of the buffer of a thread, retires the buffer when the thread exits */
+    struct ThreadBufferHandle
+    {
+        ThreadBuffer* buffer = nullptr;
+
+        ~ThreadBufferHandle()
+        {
+            if (nullptr != buffer)
+            {
+                buffer->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    /* Event recording enable flag */
+    static std::atomic<bool> sg_enabled(false);
+
+    /* Buffers of all threads, interned names and next thread identifier, guarded by the mutex */
+    static std::mutex sg_mutex;
+    static std::vector<std::unique_ptr<ThreadBuffer>> sg_buffers;
+    static std::set<std::string> sg_names;
+    static uint32_t sg_nextTid = GPU_TRACK_TID + 1U;
+
+    /* Buffer of the calling thread */
+    static thread_local ThreadBufferHandle sg_threadBuffer;
+
+    /* Clock origin of the trace timestamps */
+    static const uint64_t sg_epochNs = now();
+
+    static ThreadBuffer& threadBuffer()
+    {
+        /* Register the buffer of the thread on first use */
+        if (nullptr == sg_threadBuffer.buffer)
+        {
+            std::lock_guard<std::mutex> lock(sg_mutex);
+            sg_buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer(sg_nextTid++)));
+            sg_threadBuffer.buffer = sg_buffers.back().get();
+        }
+        return *sg_threadBuffer.buffer;
+    }
+
+    static void pushEvent(const Event& event)
+    {
+        /* Start a new chunk when the last one is full, published after its predecessor is complete */
+        ThreadBuffer& buffer = threadBuffer();
+        uint32_t count = buffer.tail->count.load(std::memory_order_relaxed);
+        if (CHUNK_EVENTS == count)
+        {
+            Chunk* chunk = new Chunk();
+            buffer.tail->next.store(chunk, std::memory_order_release);
+            buffer.tail = chunk;
+            count = 0U;
+        }
+
+        /* Write the event, then publish it */
+        buffer.tail->events[count] = event;
+        buffer.tail->count.store(count + 1U, std::memory_order_release);
+    }
+
+    static void writeEvent(std::ostream& os, const Event& event, uint32_t tid)
+    {
+        /* Timestamps are in microseconds */
+        char times[64];
+        const uint64_t startNs = (event.startNs > sg_epochNs) ? (event.startNs - sg_epochNs) : (0U);
+        std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", static_cast<double>(startNs) * 1.0E-3, static_cast<double>(event.durationNs) * 1.0E-3);
+        os << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category << "\",\"ph\":\"X\"," << times
+           << ",\"pid\":" << TRACE_PID << ",\"tid\":" << tid << "}";
+    }
+
+    static void writeThreadName(std::ostream& os, uint32_t tid, const char* name)
+    {
+        os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << TRACE_PID << ",\"tid\":" << tid << ",\"args\":{\"name\":\"";
+        if (nullptr != name)
+        {
+            os << name;
+        }
+        else
+        {
+            os << "Thread " << tid;
+        }
+        os << "\"}}";
+    }
+
+    void setEnabled(bool enabled)
+    {
+        sg_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool isEnabled()
+    {
+        return sg_enabled.load(std::memory_order_relaxed);
+    }
+
+    void setThreadName(const char* name)
+    {
+        threadBuffer().name.store(name, std::memory_order_relaxed);
+    }
+
+    const char* internName(const std::string& name)
+    {
+        /* Set nodes are never moved, the strings stay valid */
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        return sg_names.insert(name).first->c_str();
+    }
+
+    uint64_t now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void recordEvent(const char* category, const char* name, uint64_t startNs, uint64_t endNs)
+    {
+        pushEvent(Event{ category, name, startNs, (endNs > startNs) ? (endNs - startNs) : (0U), false });
+    }
+
+    void recordGpuEvent(const char* name, uint64_t startNs, uint64_t endNs)
+    {
+        pushEvent(Event{ "gpu", name, startNs, (endNs > startNs) ? (endNs - startNs) : (0U), true });
+    }
+
+    bool writeTrace(const std::string& filename)
+    {
+        std::ofstream file(filename);
+        if (!file)
+        {
+            return false;
+        }
+
+        /* Process and track names */
+        std::lock_guard<std::mutex> lock(sg_mutex);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+             << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << TRACE_PID << ",\"args\":{\"name\":\"ares\"}}";
+        writeThreadName(file, GPU_TRACK_TID, "GPU");
+        for (const auto& buffer : sg_buffers)
+        {
+            writeThreadName(file, buffer->tid, buffer->name.load(std::memory_order_relaxed));
+        }
+
+        /* Drain the published events of each buffer */
+        for (auto it = sg_buffers.begin(); it != sg_buffers.end();)
+        {
+            ThreadBuffer& buffer = **it;
+            const bool retired = buffer.retired.load(std::memory_order_acquire);
+            while (true)
+            {
+                /* A chunk with a successor is complete and no longer written */
+                Chunk* next = buffer.head->next.load(std::memory_order_acquire);
+                const uint32_t count = buffer.head->count.load(std::memory_order_acquire);
+                for (uint32_t i = buffer.readIndex; i < count; ++i)
+                {
+                    const Event& event = buffer.head->events[i];
+                    writeEvent(file, event, (event.gpu) ? (GPU_TRACK_TID) : (buffer.tid));
+                }
+                buffer.readIndex = count;
+                if (nullptr == next)
+                {
+                    break;
+                }
+                delete buffer.head;
+                buffer.head = next;
+                buffer.readIndex = 0U;
+            }
+
+            /* Release the buffers of the exited threads once drained */
+            it = (retired) ? (sg_buffers.erase(it)) : (it + 1);
+        }
+
+        file << "\n]}" << std::endl;
+        return static_cast<bool>(file);
+    }
+
+}
+
+}
+
+}
@@ -0,0 +1,66 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/Renderbuffer.hpp"
+#include "ares/glutils/GlUtils.hpp"
+
+namespace ares
+{
+
+namespace glutils
+{
+    Renderbuffer::Renderbuffer(int32_t width, int32_t height, GLenum format)
+        : m_rb(0U)
+        , m_width(width)
+        , m_height(height)
+        , m_memory(MemoryTracker::Category::Renderbuffer, MemoryTracker::renderbufferBytes(width, height, format))
+    {
+        /* Create renderbuffer object and its storage */
+        glGenRenderbuffers(1, &m_rb);
+        GlUtils::checkGLError("glGenRenderbuffers");
+        glBindRenderbuffer(GL_RENDERBUFFER, m_rb);
+        GlUtils::checkGLError("glBindRenderbuffer");
+        glRenderbufferStorage(GL_RENDERBUFFER, format, m_width, m_height);
+        GlUtils::checkGLError("glRenderbufferStorage");
+
+        /* Unbind */
+        glBindRenderbuffer(GL_RENDERBUFFER, 0U);
+        GlUtils::checkGLError("glBindRenderbuffer");
+    }
+
+    Renderbuffer::~Renderbuffer()
+    {
+        /* Delete renderbuffer, OpenGL detaches it from the bound framebuffer */
+        glDeleteRenderbuffers(1, &m_rb);
+    }
+
+}
+
+}
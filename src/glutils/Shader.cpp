@@ -29,6 +29,7 @@
  *****************************************************************************/
 
 #include "ares/glutils/Shader.hpp"
+#include "ares/glutils/GlState.hpp"
 #include "ares/glutils/GlUtils.hpp"
 
 namespace ares
@@ -36,46 +37,45 @@ namespace ares
 
 namespace glutils
 {
+    /* Suffix of the names of array uniforms */
+    constexpr char ARRAY_NAME_SUFFIX[] = "[0]";
+
     Shader::Shader(GLuint prog)
         : m_program(prog)
-        , m_uniformMap()
+        , m_attributes()
+        , m_uniforms()
+        , m_uniformIndices()
     {
+        /* Enumerate active attributes and uniforms */
+        reflectAttributes();
+        reflectUniforms();
     }
 
-    void Shader::activate(const std::vector<glutils::AttributeDataPtr>& attributeData)
+    void Shader::activate()
     {
         /* Use program */
-        glUseProgram(m_program);
-        GlUtils::checkGLError("glUseProgram");
+        GlState::current().useProgram(m_program);
+    }
 
-        /* Setup all attributes */
-        for (const auto& attrData : attributeData)
+    void Shader::deactivate()
+    {
+        /* Leave program set, unless requested, as the next activation sets its own */
+        GlState& state = GlState::current();
+        if (state.unbindToZero())
         {
-            auto attr = addAttribute(attrData->name());
-            if ((nullptr != attr) && (nullptr != attrData->vbo()))
-            {
-                /* Setup attribute with data */
-                attr->activate(attrData);
-            }
+            state.useProgram(0U);
         }
     }
 
-    void Shader::deactivate(const std::vector<glutils::AttributeDataPtr>& attributeData)
+    void Shader::setSampler(const std::string& unifName, int32_t unit)
     {
-        /* Deactivate all attributes */
-        for (const auto& attrData : attributeData)
+        /* Set the unit with the program in use */
+        auto sampler = getUniform<Uniform1i>(unifName);
+        if (nullptr != sampler)
         {
-            auto attr = addAttribute(attrData->name());
-            if ((nullptr != attr) && (nullptr != attrData->vbo()))
-            {
-                /* Setup attribute with data */
-                attr->deactivate(attrData);
-            }
+            GlState::current().useProgram(m_program);
+            sampler->setAndCommit(unit);
         }
-
-        /* Reset program */
-        glUseProgram(0);
-        GlUtils::checkGLError("glUseProgram");
     }
 
     GLint Shader::getAttribLocation(const std::string& attribName) const
@@ -96,47 +96,128 @@ namespace glutils
 
     AttributePtr Shader::getAttribute(const std::string& attribName) const
     {
-        /* Check if requested attribute is in the map */
+        /* Look for the requested attribute among the active ones */
         AttributePtr retval = nullptr;
-        if (m_attributeMap.end() != m_attributeMap.find(attribName))
+        for (const auto& attr : m_attributes)
         {
-            /* Return attribute object */
-            retval = m_attributeMap.at(attribName);
+            if (attr->name() == attribName)
+            {
+                retval = attr;
+                break;
+            }
         }
         return retval;
     }
 
-    AttributePtr Shader::addAttribute(const std::string& name)
+    UniformPtr Shader::getUniform(const std::string& unifName) const
     {
-        /* Try to get attribute first */
-        AttributePtr retval = getAttribute(name);
-        if (nullptr == retval)
+        /* Check if requested uniform is active */
+        UniformPtr retval = nullptr;
+        auto it = m_uniformIndices.find(unifName);
+        if (m_uniformIndices.end() != it)
         {
-            /* Not found, create a new one and add to the map */
-            retval = std::make_shared<Attribute>(name, getAttribLocation(name));
-            m_attributeMap.emplace(name, retval);
+            /* Return uniform object */
+            retval = m_uniforms[it->second];
         }
         return retval;
     }
 
-    void Shader::addAttributes(const std::vector<std::string>& names)
+    void Shader::reflectAttributes()
     {
-        for (const auto& name : names)
+        /* Get number of active attributes and longest name */
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(m_program, GL_ACTIVE_ATTRIBUTES, &count);
+        glGetProgramiv(m_program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+        GlUtils::checkGLError("glGetProgramiv");
+
+        std::vector<GLchar> nameBuffer(static_cast<size_t>(maxLength) + 1U);
+        for (GLint i = 0; i < count; ++i)
         {
-            addAttribute(name);
+            /* Get attribute name and create its object */
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveAttrib(m_program, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+            std::string name(nameBuffer.data(), static_cast<size_t>(length));
+            m_attributes.push_back(std::make_shared<Attribute>(name, getAttribLocation(name)));
         }
     }
 
-    UniformPtr Shader::getUniform(const std::string& unifName) const
+    void Shader::reflectUniforms()
     {
-        /* Check if requested uniform is in the map */
-        UniformPtr retval = nullptr;
-        if (m_uniformMap.end() != m_uniformMap.find(unifName))
+        /* Get number of active uniforms and longest name */
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        GlUtils::checkGLError("glGetProgramiv");
+
+        std::vector<GLchar> nameBuffer(static_cast<size_t>(maxLength) + 1U);
+        for (GLint i = 0; i < count; ++i)
         {
-            /* Return uniform object */
-            retval = m_uniformMap.at(unifName);
+            /* Get uniform name, without array suffix */
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(m_program, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+            std::string name(nameBuffer.data(), static_cast<size_t>(length));
+            size_t suffixPos = name.rfind(ARRAY_NAME_SUFFIX);
+            if ((std::string::npos != suffixPos) && ((suffixPos + sizeof(ARRAY_NAME_SUFFIX) - 1U) == name.size()))
+            {
+                name.erase(suffixPos);
+            }
+
+            /* Create the uniform object matching the declared type */
+            GLint location = getUniformLocation(name);
+            UniformPtr uniform;
+            switch (type)
+            {
+                case GL_FLOAT:
+                    if (size > 1)
+                    {
+                        uniform = std::make_shared<Uniformfv>(name, location);
+                    }
+                    else
+                    {
+                        uniform = std::make_shared<Uniform1f>(name, location);
+                    }
+                    break;
+                case GL_FLOAT_VEC2:
+                    uniform = std::make_shared<Uniform2f>(name, location);
+                    break;
+                case GL_FLOAT_VEC3:
+                    uniform = std::make_shared<Uniform3f>(name, location);
+                    break;
+                case GL_FLOAT_VEC4:
+                    uniform = std::make_shared<Uniform4f>(name, location);
+                    break;
+                case GL_INT:
+                case GL_BOOL:
+                case GL_SAMPLER_2D:
+                case GL_SAMPLER_CUBE:
+                    uniform = std::make_shared<Uniform1i>(name, location);
+                    break;
+                case GL_FLOAT_MAT2:
+                    uniform = std::make_shared<UniformMat2>(name, location);
+                    break;
+                case GL_FLOAT_MAT3:
+                    uniform = std::make_shared<UniformMat3>(name, location);
+                    break;
+                case GL_FLOAT_MAT4:
+                    uniform = std::make_shared<UniformMat4>(name, location);
+                    break;
+                default:
+                    /* Uniform type not supported, leave it unset */
+                    break;
+            }
+
+            if (nullptr != uniform)
+            {
+                m_uniformIndices.emplace(name, m_uniforms.size());
+                m_uniforms.push_back(uniform);
+            }
         }
-        return retval;
     }
 
 }
@@ -31,11 +31,13 @@
 #include <functional>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "ares/glutils/ShaderManager.hpp"
 #include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/Profiler.hpp"
 
 /* Shader ID pair alias */
 using ShaderIDPair = std::pair<GLuint, GLuint>;
@@ -66,13 +68,22 @@ namespace ShaderManager
     static std::unordered_map<ShaderIDPair, GLuint> sg_shaderProgMap;
     static std::unordered_map<GLuint, ShaderPtr>    sg_shaderPtrMap;
 
-    static GLuint compileShader(const char* shaderSource, GLenum shaderType)
+    static GLuint compileShader(const char* shaderSource, GLenum shaderType, const char* shaderHeader = nullptr)
     {
         /* Create shader */
         GLuint retval = glCreateShader(shaderType);
 
+        /* Insert header after the version directive, which must come first */
+        std::string source(shaderSource);
+        if (nullptr != shaderHeader)
+        {
+            size_t firstLineEnd = source.find('\n');
+            source.insert((std::string::npos != firstLineEnd) ? (firstLineEnd + 1U) : (0U), shaderHeader);
+        }
+
         /* Load the source code */
-        glShaderSource(retval, 1, (const char**)&shaderSource, NULL);
+        const char* sourcePtr = source.c_str();
+        glShaderSource(retval, 1, &sourcePtr, NULL);
 
         /* Compile the source code */
         glCompileShader(retval);
@@ -95,11 +106,11 @@ namespace ShaderManager
             /* Print message */
             if (infoLogLength > 1)
             {
-                std::cout << infoLog.data() << std::endl;
+                std::cerr << infoLog.data() << std::endl;
             }
             else
             {
-                std::cout << "Failed to compile shader" << std::endl;
+                std::cerr << "Failed to compile shader" << std::endl;
             }
 
             /* Throw exception */
@@ -139,11 +150,11 @@ namespace ShaderManager
             /* Print error message */
             if (infoLogLength > 1)
             {
-                std::cout << infoLog.data() << std::endl;
+                std::cerr << infoLog.data() << std::endl;
             }
             else
             {
-                std::cout << "Failed to compile shader" << std::endl;
+                std::cerr << "Failed to compile shader" << std::endl;
             }
 
             /* Throw exception */
@@ -153,8 +164,10 @@ namespace ShaderManager
         return retval;
     }
 
-    ShaderPtr getShader(const char* vertShaderSource, const char* fragShaderSource)
+    ShaderPtr getShader(const char* vertShaderSource, const char* fragShaderSource, const char* vertShaderHeader, const char* fragShaderHeader)
     {
+        ARES_PROFILE_SCOPE("load", "ShaderManager::getShader");
+
         /* Assume failure */
         ShaderPtr retval = nullptr;
 
@@ -163,7 +176,7 @@ namespace ShaderManager
 
         /* Vertex shader */
         GLuint vertShader = 0;
-        const std::size_t vertHash = hasher(vertShaderSource);
+        const std::size_t vertHash = hasher(vertShaderSource) ^ (hasher(vertShaderHeader) << 1);
         if (sg_vertShaderMap.end() != sg_vertShaderMap.find(vertHash))
         {
             /* We already had a shader for this code, re-use it */
@@ -172,13 +185,13 @@ namespace ShaderManager
         else
         {
             /* Compile vertex shader and add it to the map */
-            vertShader = compileShader(vertShaderSource, GL_VERTEX_SHADER);
+            vertShader = compileShader(vertShaderSource, GL_VERTEX_SHADER, vertShaderHeader);
             sg_vertShaderMap.emplace(vertHash, vertShader);
         }
 
         /* Fragment shader */
         GLuint fragShader = 0;
-        const std::size_t fragHash = hasher(fragShaderSource);
+        const std::size_t fragHash = hasher(fragShaderSource) ^ (hasher(fragShaderHeader) << 1);
         if (sg_fragShaderMap.end() != sg_fragShaderMap.find(fragHash))
         {
             /* We already had a shader for this code, re-use it */
@@ -187,7 +200,7 @@ namespace ShaderManager
         else
         {
             /* Compile fragment shader and add it to the map */
-            fragShader = compileShader(fragShaderSource, GL_FRAGMENT_SHADER);
+            fragShader = compileShader(fragShaderSource, GL_FRAGMENT_SHADER, fragShaderHeader);
             sg_fragShaderMap.emplace(fragHash, fragShader);
         }
 
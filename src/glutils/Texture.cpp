@@ -29,6 +29,7 @@
  *****************************************************************************/
 
 #include "ares/glutils/Texture.hpp"
+#include "ares/glutils/GlState.hpp"
 #include "ares/glutils/GlUtils.hpp"
 
 #include <stdexcept>
@@ -39,6 +40,12 @@ namespace ares
 namespace glutils
 {
     Texture::Texture(ImagePtr image, WrapType wrapS, WrapType wrapT, FilterType minF, FilterType magF)
+        : m_tex(0U)
+        , m_width(0)
+        , m_height(0)
+        , m_format(GL_RGBA)
+        , m_type(GL_UNSIGNED_BYTE)
+        , m_memory(MemoryTracker::Category::Texture)
     {
         /* Check for valid image */
         if (nullptr == image)
@@ -46,13 +53,50 @@ namespace glutils
             throw std::runtime_error("Invalid image");
         }
 
+        /* Create texture object */
+        create(wrapS, wrapT, minF, magF);
+
+        /* Create texture image */
+        m_width = image->width();
+        m_height = image->height();
+        m_format = image->glFormat();
+        glTexImage2D(GL_TEXTURE_2D, 0, m_format, m_width, m_height, 0, m_format, m_type, image->imageData().data());
+        GlUtils::checkGLError("glTexImage2D");
+        glGenerateMipmap(GL_TEXTURE_2D);
+        GlUtils::checkGLError("glGenerateMipmap");
+        m_memory.setBytes(MemoryTracker::textureBytes(m_width, m_height, m_format, m_type, true));
+
+        /* Unbind */
+        deactivate();
+    }
+
+    Texture::Texture(int32_t width, int32_t height, GLenum format, GLenum type, const void* data, FilterType minF, FilterType magF)
+        : m_tex(0U)
+        , m_width(width)
+        , m_height(height)
+        , m_format(format)
+        , m_type(type)
+        , m_memory(MemoryTracker::Category::Texture, MemoryTracker::textureBytes(width, height, format, type, false))
+    {
+        /* Create texture object, data textures are never repeated */
+        create(WrapType::ClampToEdge, WrapType::ClampToEdge, minF, magF);
+
+        /* Create texture image without mipmaps */
+        glTexImage2D(GL_TEXTURE_2D, 0, m_format, m_width, m_height, 0, m_format, m_type, data);
+        GlUtils::checkGLError("glTexImage2D");
+
+        /* Unbind */
+        deactivate();
+    }
+
+    void Texture::create(WrapType wrapS, WrapType wrapT, FilterType minF, FilterType magF)
+    {
         /* Create texture object */
         glGenTextures(1, &m_tex);
         GlUtils::checkGLError("glGenTextures");
 
         /* Bind texture */
-        glBindTexture(GL_TEXTURE_2D, m_tex);
-        GlUtils::checkGLError("glBindTexture");
+        GlState::current().bindTexture(0U, m_tex);
 
         /* Set texture wrapping parameters */
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLint>(wrapS));
@@ -65,12 +109,28 @@ namespace glutils
         GlUtils::checkGLError("glTexParameteri");
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(magF));
         GlUtils::checkGLError("glTexParameteri");
+    }
 
-        /* Create texture image */
-        glTexImage2D(GL_TEXTURE_2D, 0, image->glFormat(), image->width(), image->height(), 0, image->glFormat(), GL_UNSIGNED_BYTE, image->imageData().data());
-        GlUtils::checkGLError("glTexImage2D");
-        glGenerateMipmap(GL_TEXTURE_2D);
-        GlUtils::checkGLError("glGenerateMipmap");
+    void Texture::setData(int32_t width, int32_t height, const void* data)
+    {
+        /* Bind texture, it stays bound as the next activation binds its own texture */
+        GlState::current().bindTexture(0U, m_tex);
+
+        if ((width != m_width) || (height != m_height))
+        {
+            /* Reallocate storage */
+            m_width = width;
+            m_height = height;
+            glTexImage2D(GL_TEXTURE_2D, 0, m_format, m_width, m_height, 0, m_format, m_type, data);
+            GlUtils::checkGLError("glTexImage2D");
+            m_memory.setBytes(MemoryTracker::textureBytes(m_width, m_height, m_format, m_type, false));
+        }
+        else
+        {
+            /* Replace data in the existing storage */
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, m_format, m_type, data);
+            GlUtils::checkGLError("glTexSubImage2D");
+        }
 
         /* Unbind */
         deactivate();
@@ -78,28 +138,24 @@ namespace glutils
 
     Texture::~Texture()
     {
-        /* Unbind */
-        deactivate();
-
-        /* Delete Texture */
-        glDeleteTextures(1, &m_tex);
-        GlUtils::checkGLError("glDeleteTextures");
+        /* Delete Texture, OpenGL unbinds it */
+        GlState::current().deleteTexture(m_tex);
     }
 
     void Texture::activate(int32_t unit)
     {
         /* Activate and bind texture */
-        glActiveTexture(GL_TEXTURE0 + unit);
-        GlUtils::checkGLError("glActiveTexture");
-        glBindTexture(GL_TEXTURE_2D, m_tex);
-        GlUtils::checkGLError("glBindTexture");
+        GlState::current().bindTexture(static_cast<uint32_t>(unit), m_tex);
     }
 
     void Texture::deactivate()
     {
-        /* Unbind */
-        glBindTexture(GL_TEXTURE_2D, 0);
-        GlUtils::checkGLError("glBindTexture");
+        /* Unbind, only if requested as the next activation binds its own texture */
+        GlState& state = GlState::current();
+        if (state.unbindToZero())
+        {
+            state.unbindTexture(m_tex);
+        }
     }
 
 }
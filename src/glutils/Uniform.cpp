@@ -29,8 +29,10 @@
  *****************************************************************************/
 
 #include "ares/glutils/Uniform.hpp"
+#include "ares/glutils/GlState.hpp"
 #include "ares/glutils/GlUtils.hpp"
 
+#include <cstring>
 #include <stdexcept>
 
 namespace ares
@@ -43,6 +45,7 @@ namespace glutils
     Uniform::Uniform(const std::string& name, int32_t loc)
         : m_name(name)
         , m_location(loc)
+        , m_dirty(true)
     {
         /* Check for valid location */
         if (loc < 0)
@@ -51,6 +54,17 @@ namespace glutils
         }
     }
 
+    void Uniform::commit()
+    {
+        /* Skip the upload if the program already has the value */
+        if (m_dirty)
+        {
+            upload();
+            GlState::current().countUniformUpload();
+            m_dirty = false;
+        }
+    }
+
     /***************** Uniform1f *****************/
     Uniform1f::Uniform1f(const std::string& name, int32_t loc)
         : Uniform(name, loc)
@@ -60,10 +74,15 @@ namespace glutils
 
     void Uniform1f::setValue(float v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (v0 != m_value)
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void Uniform1f::commit()
+    void Uniform1f::upload()
     {
         glUniform1f(m_location, m_value);
         GlUtils::checkGLError("glUniform1f");
@@ -84,10 +103,15 @@ namespace glutils
 
     void Uniform2f::setValue(const Vec2& v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (0 != memcmp(m_value.const_data(), v0.const_data(), 2U * sizeof(float)))
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void Uniform2f::commit()
+    void Uniform2f::upload()
     {
         glUniform2f(m_location, m_value[0], m_value[1]);
         GlUtils::checkGLError("glUniform2f");
@@ -108,10 +132,15 @@ namespace glutils
 
     void Uniform3f::setValue(const Vec3& v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (0 != memcmp(m_value.const_data(), v0.const_data(), 3U * sizeof(float)))
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void Uniform3f::commit()
+    void Uniform3f::upload()
     {
         glUniform3f(m_location, m_value[0], m_value[1], m_value[2]);
         GlUtils::checkGLError("glUniform3f");
@@ -132,10 +161,15 @@ namespace glutils
 
     void Uniform4f::setValue(const Vec4& v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (0 != memcmp(m_value.const_data(), v0.const_data(), 4U * sizeof(float)))
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void Uniform4f::commit()
+    void Uniform4f::upload()
     {
         glUniform4f(m_location, m_value[0], m_value[1], m_value[2], m_value[3]);
         GlUtils::checkGLError("glUniform4f");
@@ -156,10 +190,15 @@ namespace glutils
 
     void Uniformfv::setValue(const std::vector<float>& v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (v0 != m_value)
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void Uniformfv::commit()
+    void Uniformfv::upload()
     {
         glUniform1fv(m_location, m_value.size(), m_value.data());
         GlUtils::checkGLError("glUniform1fv");
@@ -180,10 +219,15 @@ namespace glutils
 
     void Uniform1i::setValue(int32_t v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (v0 != m_value)
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void Uniform1i::commit()
+    void Uniform1i::upload()
     {
         glUniform1i(m_location, m_value);
         GlUtils::checkGLError("glUniform1i");
@@ -204,10 +248,15 @@ namespace glutils
 
     void UniformMat2::setValue(const Mat2& v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (0 != memcmp(m_value.const_data(), v0.const_data(), 4U * sizeof(float)))
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void UniformMat2::commit()
+    void UniformMat2::upload()
     {
         glUniformMatrix2fv(m_location, 1, GL_FALSE, m_value.const_data());
         GlUtils::checkGLError("glUniformMatrix2fv");
@@ -228,10 +277,15 @@ namespace glutils
 
     void UniformMat3::setValue(const Mat3& v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (0 != memcmp(m_value.const_data(), v0.const_data(), 9U * sizeof(float)))
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void UniformMat3::commit()
+    void UniformMat3::upload()
     {
         glUniformMatrix3fv(m_location, 1, GL_FALSE, m_value.const_data());
         GlUtils::checkGLError("glUniformMatrix3fv");
@@ -252,10 +306,15 @@ namespace glutils
 
     void UniformMat4::setValue(const Mat4& v0)
     {
-        m_value = v0;
+        /* Only mark dirty if the value changed */
+        if (0 != memcmp(m_value.const_data(), v0.const_data(), 16U * sizeof(float)))
+        {
+            m_value = v0;
+            m_dirty = true;
+        }
     }
 
-    void UniformMat4::commit()
+    void UniformMat4::upload()
     {
         glUniformMatrix4fv(m_location, 1, GL_FALSE, m_value.const_data());
         GlUtils::checkGLError("glUniformMatrix4fv");
@@ -29,6 +29,7 @@
  *****************************************************************************/
 
 #include "ares/glutils/Vbo.hpp"
+#include "ares/glutils/GlState.hpp"
 #include "ares/glutils/GlUtils.hpp"
 
 namespace ares
@@ -36,19 +37,21 @@ namespace ares
 
 namespace glutils
 {
-    Vbo::Vbo(const void* data, int32_t dataSize, TargetType target)
+    Vbo::Vbo(const void* data, int32_t dataSize, TargetType target, Usage usage)
         : m_target(target)
+        , m_usage(usage)
+        , m_memory((TargetType::ElementArrayBuffer == target) ? (MemoryTracker::Category::IndexBuffer) : (MemoryTracker::Category::VertexBuffer),
+                   static_cast<uint64_t>(dataSize))
     {
         /* Generate a buffer object */
         glGenBuffers(1, &m_vbo);
         GlUtils::checkGLError("glGenBuffers");
 
         /* Bind buffer */
-        glBindBuffer(static_cast<GLenum>(m_target), m_vbo);
-        GlUtils::checkGLError("glBindBuffer");
+        activate();
 
         /* Set buffer data */
-        glBufferData(static_cast<GLenum>(m_target), static_cast<GLuint>(dataSize), data, GL_STATIC_DRAW);
+        glBufferData(static_cast<GLenum>(m_target), static_cast<GLuint>(dataSize), data, static_cast<GLenum>(m_usage));
         GlUtils::checkGLError("glBufferData");
 
         /* Unbind */
@@ -57,26 +60,45 @@ namespace glutils
 
     Vbo::~Vbo()
     {
+        /* Delete VBO, OpenGL unbinds it */
+        GlState::current().deleteBuffer(m_vbo);
+    }
+
+    void Vbo::setData(const void* data, int32_t dataSize)
+    {
+        /* Bind buffer */
+        activate();
+
+        /* Re-specify buffer data */
+        glBufferData(static_cast<GLenum>(m_target), static_cast<GLuint>(dataSize), data, static_cast<GLenum>(m_usage));
+        GlUtils::checkGLError("glBufferData");
+        m_memory.setBytes(static_cast<uint64_t>(dataSize));
+
         /* Unbind */
         deactivate();
-
-        /* Delete VBO */
-        glDeleteBuffers(1, &m_vbo);
-        GlUtils::checkGLError("glDeleteBuffers");
     }
 
     void Vbo::activate()
     {
+        /* Index buffer bindings are vertex array object state, use the default one not to modify the bound layout */
+        GlState& state = GlState::current();
+        if (TargetType::ElementArrayBuffer == m_target)
+        {
+            state.bindVertexArray(0U);
+        }
+
         /* Bind buffer */
-        glBindBuffer(static_cast<GLenum>(m_target), m_vbo);
-        GlUtils::checkGLError("glBindBuffer");
+        state.bindBuffer(static_cast<GLenum>(m_target), m_vbo);
     }
 
     void Vbo::deactivate()
     {
-        /* Unbind */
-        glBindBuffer(static_cast<GLenum>(m_target), 0);
-        GlUtils::checkGLError("glBindBuffer");
+        /* Unbind, only if requested as the next activation binds its own buffer */
+        GlState& state = GlState::current();
+        if (state.unbindToZero())
+        {
+            state.bindBuffer(static_cast<GLenum>(m_target), 0U);
+        }
     }
 
     
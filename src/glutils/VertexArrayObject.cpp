@@ -0,0 +1,119 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/VertexArrayObject.hpp"
+#include "ares/glutils/GlUtils.hpp"
+
+#include <stdexcept>
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+namespace ares
+{
+
+namespace glutils
+{
+
+namespace VertexArrayObject
+{
+    /* Extension entry points */
+    static PFNGLGENVERTEXARRAYSOESPROC    sg_genVertexArrays    = nullptr;
+    static PFNGLBINDVERTEXARRAYOESPROC    sg_bindVertexArray    = nullptr;
+    static PFNGLDELETEVERTEXARRAYSOESPROC sg_deleteVertexArrays = nullptr;
+
+    /* Flag set once the extension has been queried */
+    static bool sg_initialized = false;
+
+    static void loadEntryPoints()
+    {
+        sg_initialized = true;
+
+        if (GlUtils::hasExtension("GL_OES_vertex_array_object"))
+        {
+            sg_genVertexArrays    = reinterpret_cast<PFNGLGENVERTEXARRAYSOESPROC>(eglGetProcAddress("glGenVertexArraysOES"));
+            sg_bindVertexArray    = reinterpret_cast<PFNGLBINDVERTEXARRAYOESPROC>(eglGetProcAddress("glBindVertexArrayOES"));
+            sg_deleteVertexArrays = reinterpret_cast<PFNGLDELETEVERTEXARRAYSOESPROC>(eglGetProcAddress("glDeleteVertexArraysOES"));
+        }
+
+        /* All entry points are needed */
+        if ((nullptr == sg_genVertexArrays) || (nullptr == sg_bindVertexArray) || (nullptr == sg_deleteVertexArrays))
+        {
+            sg_genVertexArrays    = nullptr;
+            sg_bindVertexArray    = nullptr;
+            sg_deleteVertexArrays = nullptr;
+        }
+    }
+
+    bool isSupported()
+    {
+        if (!sg_initialized)
+        {
+            loadEntryPoints();
+        }
+        return (nullptr != sg_bindVertexArray);
+    }
+
+    GLuint genVertexArray()
+    {
+        if (!isSupported())
+        {
+            throw std::runtime_error("Vertex array objects not supported");
+        }
+        GLuint retval = 0U;
+        sg_genVertexArrays(1, &retval);
+        GlUtils::checkGLError("glGenVertexArrays");
+        return retval;
+    }
+
+    void bindVertexArray(GLuint vertexArray)
+    {
+        if (!isSupported())
+        {
+            throw std::runtime_error("Vertex array objects not supported");
+        }
+        sg_bindVertexArray(vertexArray);
+        GlUtils::checkGLError("glBindVertexArray");
+    }
+
+    void deleteVertexArray(GLuint vertexArray)
+    {
+        if (!isSupported())
+        {
+            throw std::runtime_error("Vertex array objects not supported");
+        }
+        sg_deleteVertexArrays(1, &vertexArray);
+        GlUtils::checkGLError("glDeleteVertexArrays");
+    }
+
+}
+
+}
+
+}
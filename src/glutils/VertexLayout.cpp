@@ -0,0 +1,149 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include "ares/glutils/VertexLayout.hpp"
+#include "ares/glutils/GlState.hpp"
+#include "ares/glutils/VertexArrayObject.hpp"
+
+#include <algorithm>
+
+namespace ares
+{
+
+namespace glutils
+{
+    VertexLayout::VertexLayout(const Shader& shader, const std::vector<AttributeDataPtr>& attributeData, const AttributeDataPtr& indicesData)
+        : m_bindings()
+        , m_indexVbo()
+        , m_locationMask(0U)
+        , m_vertexArray(0U)
+    {
+        /* Bind each attribute data to its location in the shader */
+        for (const auto& data : attributeData)
+        {
+            AttributePtr attr = shader.getAttribute(data->name());
+            if ((nullptr != attr) && (attr->location() >= 0) && (nullptr != data->vbo()))
+            {
+                Binding binding;
+                binding.location = static_cast<GLuint>(attr->location());
+                binding.vbo = data->vbo();
+                binding.size = static_cast<GLint>(data->size());
+                binding.type = static_cast<GLenum>(data->type());
+                binding.normalized = data->normalized();
+                binding.stride = static_cast<GLsizei>(data->stride());
+                binding.offset = static_cast<uintptr_t>(data->offset());
+                m_bindings.push_back(binding);
+                if (binding.location < GlState::MAX_TRACKED_VERTEX_ATTRIBS)
+                {
+                    m_locationMask |= (1U << binding.location);
+                }
+            }
+        }
+        std::sort(m_bindings.begin(), m_bindings.end(), [](const Binding& a, const Binding& b) { return a.location < b.location; });
+
+        /* Keep index buffer */
+        if (nullptr != indicesData)
+        {
+            m_indexVbo = indicesData->vbo();
+        }
+    }
+
+    VertexLayout::~VertexLayout()
+    {
+        /* Delete vertex array object, OpenGL unbinds it */
+        if (0U != m_vertexArray)
+        {
+            GlState::current().deleteVertexArray(m_vertexArray);
+        }
+    }
+
+    void VertexLayout::bind()
+    {
+        GlState& state = GlState::current();
+        if (0U != m_vertexArray)
+        {
+            /* Already recorded, a single bind */
+            state.bindVertexArray(m_vertexArray);
+        }
+        else if (VertexArrayObject::isSupported())
+        {
+            /* Record the layout on first use, new vertex array objects have all arrays disabled */
+            m_vertexArray = VertexArrayObject::genVertexArray();
+            state.bindVertexArray(m_vertexArray);
+            setUp();
+        }
+        else
+        {
+            /* Set up the layout in the default vertex array, only the differences are forwarded */
+            setUp();
+
+            /* Disable the arrays left enabled by other layouts */
+            state.retainVertexAttribArrays(m_locationMask);
+        }
+    }
+
+    void VertexLayout::unbind()
+    {
+        /* Leave layout bound, unless requested, as the next bind sets its own */
+        GlState& state = GlState::current();
+        if (!state.unbindToZero())
+        {
+            return;
+        }
+
+        if (0U != m_vertexArray)
+        {
+            state.bindVertexArray(0U);
+        }
+        else
+        {
+            state.retainVertexAttribArrays(0U);
+            state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0U);
+        }
+        state.bindBuffer(GL_ARRAY_BUFFER, 0U);
+    }
+
+    void VertexLayout::setUp()
+    {
+        /* Set attribute pointers and enable their arrays */
+        GlState& state = GlState::current();
+        for (const auto& binding : m_bindings)
+        {
+            state.vertexAttribPointer(binding.location, binding.vbo->vbo(), binding.size, binding.type, binding.normalized, binding.stride, binding.offset);
+            state.enableVertexAttribArray(binding.location);
+        }
+
+        /* Bind index buffer */
+        state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, (nullptr != m_indexVbo) ? (m_indexVbo->vbo()) : (0U));
+    }
+
+}
+
+}
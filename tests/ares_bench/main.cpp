@@ -0,0 +1,736 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+/* Port include, for the offscreen display device */
+#include "ares/port/HeadlessDisplay.hpp"
+
+/* Core includes for ARES 3D objects */
+#include "ares/core/CameraNode.hpp"
+#include "ares/core/DrawingContext.hpp"
+#include "ares/core/LightNode.hpp"
+#include "ares/core/PerspectiveCamera.hpp"
+#include "ares/core/PointLight.hpp"
+#include "ares/core/Renderer.hpp"
+#include "ares/core/Scene.hpp"
+
+/* Gltf include to load GLTF file */
+#include "ares/gltf/Gltf.hpp"
+
+/* GL utilities, memory tracker and profiler includes, for the error checking mode, the memory and the trace of the run */
+#include "ares/glutils/GlUtils.hpp"
+#include "ares/glutils/MemoryTracker.hpp"
+#include "ares/glutils/Profiler.hpp"
+
+/* Default width and height of the offscreen surface */
+constexpr int32_t DEFAULT_WIDTH  = 1280;
+constexpr int32_t DEFAULT_HEIGHT = 720;
+
+/* Default number of measured and warm-up frames per model */
+constexpr uint32_t DEFAULT_FRAMES        = 300U;
+constexpr uint32_t DEFAULT_WARMUP_FRAMES = 30U;
+
+/* Default sample models directory, assuming the application is run from a 'build' dir */
+constexpr char DEFAULT_MODELS_DIR[] = "../third-party/glTF-Sample-Models/2.0";
+
+/* Default models, loaded from their glTF directory in the sample models */
+const char* const DEFAULT_MODELS[] = { "SciFiHelmet", "DamagedHelmet", "FlightHelmet", "Sponza" };
+
+/* Camera path: orbits per run, distance from the scene center in bounding radii and its variation */
+constexpr float PATH_ORBITS            = 1.F;
+constexpr float PATH_DISTANCE          = 2.F;
+constexpr float PATH_DISTANCE_VARIATION = 0.5F;
+constexpr float PATH_MAX_ELEVATION     = 0.6F;
+
+/* Camera vertical field of view */
+constexpr float CAMERA_YFOV = 0.8F;
+
+/* Intensity of the light added to scenes without lights, per squared bounding radius */
+constexpr float DEFAULT_LIGHT_INTENSITY = 10.F;
+
+constexpr float PI = 3.14159265358979F;
+
+/* Benchmark options */
+struct Options
+{
+    int32_t width;
+    int32_t height;
+    uint32_t frames;
+    uint32_t warmupFrames;
+    ares::core::Renderer::RenderMode renderMode;
+    bool setGlErrorCheck;
+    ares::glutils::GlUtils::ErrorCheckMode glErrorCheck;
+    std::string modelsDir;
+    std::string output;
+    std::string trace;
+    std::vector<std::string> models;
+};
+
+/* Statistics of a per-frame series */
+struct Series
+{
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+};
+
+/* Results of a model run */
+struct ModelResults
+{
+    std::string model;
+    std::string file;
+    std::string error;
+    Series cpuFrameTimeMs;
+    bool hasGpuTime;
+    Series gpuFrameTimeMs;
+    std::vector<std::pair<std::string, Series>> gpuScopeTimes;
+    std::vector<std::pair<std::string, Series>> cpuScopeTimes;
+    std::vector<std::pair<std::string, Series>> renderStats;
+    bool hasMemory;
+    ares::glutils::MemoryTracker::AssetUsage memory;
+};
+
+/* Timer scope samples of the measured frames */
+struct ScopeSamples
+{
+    struct Times
+    {
+        std::vector<double> gpu;
+        std::vector<double> cpu;
+    };
+
+    uint64_t lastFrame = 0U;
+    std::map<std::string, Times> scopes;
+};
+
+/* Render statistics reported per frame */
+enum MetricIndex
+{
+    DRAW_CALLS,
+    TRIANGLES,
+    PROGRAM_BINDS,
+    TEXTURE_BINDS,
+    BUFFER_BINDS,
+    UNIFORM_UPLOADS,
+    STATE_CHANGES,
+    SKIPPED_STATE_CHANGES,
+    VISIBLE_PRIMITIVES,
+    CULLED_PRIMITIVES,
+    UPDATE_TIME,
+    CULL_TIME,
+    GATHER_TIME,
+    SORT_TIME,
+    SUBMIT_TIME,
+    SWAP_TIME,
+    METRIC_COUNT
+};
+
+/* Names of the render statistics in the results */
+const char* const METRIC_NAMES[METRIC_COUNT] = {
+    "drawCalls", "triangles", "programBinds", "textureBinds", "bufferBinds", "uniformUploads",
+    "stateChanges", "skippedStateChanges", "visiblePrimitives", "culledPrimitives",
+    "updateTimeMs", "cullTimeMs", "gatherTimeMs", "sortTimeMs", "submitTimeMs", "swapTimeMs"
+};
+
+static void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [options] [model...]" << std::endl
+              << "  --frames N         measured frames per model (default " << DEFAULT_FRAMES << ")" << std::endl
+              << "  --warmup N         warm-up frames per model (default " << DEFAULT_WARMUP_FRAMES << ")" << std::endl
+              << "  --width W          surface width (default " << DEFAULT_WIDTH << ")" << std::endl
+              << "  --height H         surface height (default " << DEFAULT_HEIGHT << ")" << std::endl
+              << "  --mode MODE        render mode, forward or lightprepass (default forward)" << std::endl
+              << "  --gl-error-check M GL error checking mode, off, frame or every, limited to the build level (default build level)" << std::endl
+              << "  --models-dir DIR   sample models directory (default " << DEFAULT_MODELS_DIR << ")" << std::endl
+              << "  --output FILE      JSON results file (default standard output)" << std::endl
+              << "  --trace FILE       Chrome trace-event file of the CPU and GPU scopes (default none)" << std::endl
+              << "A model is either a sample model name or a .gltf/.glb file path." << std::endl;
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+    options.width = DEFAULT_WIDTH;
+    options.height = DEFAULT_HEIGHT;
+    options.frames = DEFAULT_FRAMES;
+    options.warmupFrames = DEFAULT_WARMUP_FRAMES;
+    options.renderMode = ares::core::Renderer::RenderMode::Forward;
+    options.setGlErrorCheck = false;
+    options.glErrorCheck = ares::glutils::GlUtils::errorCheckMode();
+    options.modelsDir = DEFAULT_MODELS_DIR;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if ('-' != arg[0])
+        {
+            options.models.push_back(arg);
+            continue;
+        }
+        if (nullptr == value)
+        {
+            return false;
+        }
+        ++i;
+
+        if ("--frames" == arg)
+        {
+            options.frames = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        else if ("--warmup" == arg)
+        {
+            options.warmupFrames = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        else if ("--width" == arg)
+        {
+            options.width = static_cast<int32_t>(std::strtol(value, nullptr, 10));
+        }
+        else if ("--height" == arg)
+        {
+            options.height = static_cast<int32_t>(std::strtol(value, nullptr, 10));
+        }
+        else if ("--mode" == arg)
+        {
+            if (0 == std::strcmp(value, "forward"))
+            {
+                options.renderMode = ares::core::Renderer::RenderMode::Forward;
+            }
+            else if (0 == std::strcmp(value, "lightprepass"))
+            {
+                options.renderMode = ares::core::Renderer::RenderMode::LightPrePass;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if ("--gl-error-check" == arg)
+        {
+            options.setGlErrorCheck = true;
+            if (0 == std::strcmp(value, "off"))
+            {
+                options.glErrorCheck = ares::glutils::GlUtils::ErrorCheckMode::Off;
+            }
+            else if (0 == std::strcmp(value, "frame"))
+            {
+                options.glErrorCheck = ares::glutils::GlUtils::ErrorCheckMode::Frame;
+            }
+            else if (0 == std::strcmp(value, "every"))
+            {
+                options.glErrorCheck = ares::glutils::GlUtils::ErrorCheckMode::EveryCall;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if ("--models-dir" == arg)
+        {
+            options.modelsDir = value;
+        }
+        else if ("--output" == arg)
+        {
+            options.output = value;
+        }
+        else if ("--trace" == arg)
+        {
+            options.trace = value;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /* Use the default models if none is given */
+    if (options.models.empty())
+    {
+        options.models.assign(std::begin(DEFAULT_MODELS), std::end(DEFAULT_MODELS));
+    }
+    return (options.frames > 0U) && (options.width > 0) && (options.height > 0);
+}
+
+static bool endsWith(const std::string& str, const std::string& suffix)
+{
+    return (str.size() >= suffix.size()) && (0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix));
+}
+
+static std::string modelFile(const Options& options, const std::string& model)
+{
+    /* File paths are used as is, names are looked up in the sample models layout */
+    if (endsWith(model, ".gltf") || endsWith(model, ".glb"))
+    {
+        return model;
+    }
+    return options.modelsDir + "/" + model + "/glTF/" + model + ".gltf";
+}
+
+static Series computeSeries(std::vector<double> values)
+{
+    /* Nearest-rank percentiles of the sorted values */
+    Series series = {};
+    if (!values.empty())
+    {
+        std::sort(values.begin(), values.end());
+        auto percentile = [&values](double p)
+        {
+            size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+            return values[(rank > 0U) ? (rank - 1U) : 0U];
+        };
+        double sum = 0.0;
+        for (double value : values)
+        {
+            sum += value;
+        }
+        series.mean = sum / static_cast<double>(values.size());
+        series.p50 = percentile(0.50);
+        series.p95 = percentile(0.95);
+        series.p99 = percentile(0.99);
+        series.max = values.back();
+    }
+    return series;
+}
+
+static ares::glutils::Vec3 cross(const ares::glutils::Vec3& a, const ares::glutils::Vec3& b)
+{
+    return ares::glutils::Vec3((a[1] * b[2]) - (a[2] * b[1]), (a[2] * b[0]) - (a[0] * b[2]), (a[0] * b[1]) - (a[1] * b[0]));
+}
+
+static void setCameraPose(ares::core::CameraNode& cameraNode, const ares::glutils::Vec3& eye, const ares::glutils::Vec3& target)
+{
+    /* Camera looks along its -Z axis with +Y up */
+    ares::glutils::Vec3 back = eye - target;
+    back.normalize();
+    ares::glutils::Vec3 right = cross(ares::glutils::Vec3(0.F, 1.F, 0.F), back);
+    right.normalize();
+    ares::glutils::Vec3 up = cross(back, right);
+
+    ares::glutils::Mat4 transform;
+    transform.setIdentity();
+    for (size_t r = 0; r < 3; ++r)
+    {
+        transform.set(r, 0, right[r]);
+        transform.set(r, 1, up[r]);
+        transform.set(r, 2, back[r]);
+        transform.set(r, 3, eye[r]);
+    }
+    cameraNode.setTransformMatrix(transform);
+}
+
+static void setPathPose(ares::core::CameraNode& cameraNode, const ares::glutils::Vec3& center, float radius, uint32_t frame, uint32_t frames)
+{
+    /* Deterministic orbit around the scene center, with varying elevation and distance */
+    const float t = static_cast<float>(frame) / static_cast<float>(frames);
+    const float azimuth = 2.F * PI * PATH_ORBITS * t;
+    const float elevation = PATH_MAX_ELEVATION * std::sin(2.F * azimuth);
+    const float distance = radius * (PATH_DISTANCE + (PATH_DISTANCE_VARIATION * std::sin(3.F * azimuth)));
+    const ares::glutils::Vec3 offset(std::cos(elevation) * std::sin(azimuth), std::sin(elevation), std::cos(elevation) * std::cos(azimuth));
+    setCameraPose(cameraNode, center + (offset * distance), center);
+}
+
+static void collectScopeTimes(const ares::glutils::GpuTimer& gpuTimer, uint64_t firstFrame, uint64_t lastFrame, ScopeSamples& samples)
+{
+    /* Only the results of the measured frames are collected, a results frame is collected once */
+    const uint64_t resultsFrame = gpuTimer.resultsFrame();
+    if ((resultsFrame < firstFrame) || (resultsFrame > lastFrame) || (samples.lastFrame == resultsFrame))
+    {
+        return;
+    }
+    samples.lastFrame = resultsFrame;
+    for (const ares::glutils::GpuTimer::ScopeTimes& times : gpuTimer.results())
+    {
+        ScopeSamples::Times& scopeTimes = samples.scopes[times.name];
+        scopeTimes.cpu.push_back(times.cpuTimeMs);
+        if (gpuTimer.hasGpuTimes())
+        {
+            scopeTimes.gpu.push_back(times.gpuTimeMs);
+        }
+    }
+}
+
+static void runModel(const Options& options, ares::core::DrawingContextPtr drawingContext, ModelResults& results)
+{
+    /* Load and parse GLTF file */
+    ares::gltf::GltfPtr gltf = std::make_shared<ares::gltf::Gltf>(drawingContext);
+    const ares::gltf::Gltf::FileType fileType = endsWith(results.file, ".glb") ? ares::gltf::Gltf::FileType::BINARY : ares::gltf::Gltf::FileType::ASCII;
+    if (!gltf->loadFile(results.file, fileType))
+    {
+        results.error = "Failed to load gltf file";
+        return;
+    }
+    auto sceneVec = gltf->parse();
+    if (sceneVec.empty())
+    {
+        results.error = "Failed to parse gltf scene";
+        return;
+    }
+    ares::core::ScenePtr scene = sceneVec[0];
+
+    /* Get the scene bounds for the camera path */
+    scene->update();
+    const ares::glutils::BoundingBox& bounds = scene->rootNode()->subtreeBoundingBox();
+    if (bounds.isEmpty() || bounds.isInfinite())
+    {
+        results.error = "Invalid scene bounds";
+        return;
+    }
+    const ares::glutils::Vec3 center = bounds.center();
+    const float radius = std::max(bounds.extents().length(), 0.001F);
+
+    /* Create the benchmark camera */
+    ares::core::CameraNodePtr cameraNode = scene->createNode<ares::core::CameraNode>("benchCameraNode", scene->rootNode());
+    const float aspectRatio = static_cast<float>(options.width) / static_cast<float>(options.height);
+    cameraNode->setCamera(std::make_shared<ares::core::PerspectiveCamera>(aspectRatio, CAMERA_YFOV, radius * 0.01F, radius * 10.F));
+    scene->setActiveCameraNode(cameraNode);
+
+    /* Add a point light above the scene if it has none */
+    if (scene->getLightNodes().empty())
+    {
+        ares::core::LightNodePtr lightNode = scene->createNode<ares::core::LightNode>("benchLightNode", scene->rootNode());
+        ares::core::PointLightPtr pointLight = std::make_shared<ares::core::PointLight>();
+        pointLight->setIntensity(DEFAULT_LIGHT_INTENSITY * radius * radius);
+        lightNode->setLight(pointLight);
+        lightNode->setPosition(center[0], center[1] + radius, center[2] + radius);
+    }
+
+    /* Create renderer */
+    ares::core::RendererPtr renderer = std::make_shared<ares::core::Renderer>();
+    renderer->setBgColor(ares::glutils::RGBAColor(1.F, 1.F, 1.F, 1.F));
+    renderer->setRenderMode(options.renderMode);
+    renderer->setStatsEnabled(true);
+
+    /* Warm up shaders, pipelines and caches along the path */
+    for (uint32_t frame = 0; frame < options.warmupFrames; ++frame)
+    {
+        setPathPose(*cameraNode, center, radius, frame % options.frames, options.frames);
+        renderer->render(scene);
+    }
+
+    /* Render the measured frames, the timer results of a frame arrive a few frames later */
+    const ares::glutils::GpuTimer& gpuTimer = renderer->gpuTimer();
+    const uint64_t firstTimedFrame = gpuTimer.frameNumber() + 1U;
+    const uint64_t lastTimedFrame = firstTimedFrame + options.frames - 1U;
+    ScopeSamples scopeSamples;
+    std::vector<double> cpuTimes;
+    std::vector<double> metrics[METRIC_COUNT];
+    for (uint32_t frame = 0; frame < options.frames; ++frame)
+    {
+        setPathPose(*cameraNode, center, radius, frame, options.frames);
+
+        const auto start = std::chrono::steady_clock::now();
+        renderer->render(scene);
+        const auto end = std::chrono::steady_clock::now();
+
+        collectScopeTimes(gpuTimer, firstTimedFrame, lastTimedFrame, scopeSamples);
+        cpuTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        const ares::core::Renderer::RenderStats& stats = renderer->renderStats();
+        metrics[DRAW_CALLS].push_back(stats.drawCalls);
+        metrics[TRIANGLES].push_back(static_cast<double>(stats.triangles));
+        metrics[PROGRAM_BINDS].push_back(stats.programBinds);
+        metrics[TEXTURE_BINDS].push_back(stats.textureBinds);
+        metrics[BUFFER_BINDS].push_back(stats.bufferBinds);
+        metrics[UNIFORM_UPLOADS].push_back(stats.uniformUploads);
+        metrics[STATE_CHANGES].push_back(stats.stateChanges);
+        metrics[SKIPPED_STATE_CHANGES].push_back(stats.skippedStateChanges);
+        metrics[VISIBLE_PRIMITIVES].push_back(stats.visiblePrimitives);
+        metrics[CULLED_PRIMITIVES].push_back(stats.culledPrimitives);
+        metrics[UPDATE_TIME].push_back(stats.updateTimeMs);
+        metrics[CULL_TIME].push_back(stats.cullTimeMs);
+        metrics[GATHER_TIME].push_back(stats.gatherTimeMs);
+        metrics[SORT_TIME].push_back(stats.sortTimeMs);
+        metrics[SUBMIT_TIME].push_back(stats.submitTimeMs);
+        metrics[SWAP_TIME].push_back(stats.swapTimeMs);
+    }
+
+    /* Render the last pose until the results of the measured frames are read back, one results frame per frame */
+    for (uint32_t frame = 0; (frame < gpuTimer.frameLatency()) && (gpuTimer.resultsFrame() < lastTimedFrame); ++frame)
+    {
+        renderer->render(scene);
+        collectScopeTimes(gpuTimer, firstTimedFrame, lastTimedFrame, scopeSamples);
+    }
+
+    /* Frames affected by a disjoint operation have no GPU times and are not in the GPU series */
+    results.hasGpuTime = false;
+    for (const auto& samples : scopeSamples.scopes)
+    {
+        if (!samples.second.gpu.empty())
+        {
+            if ("frame" == samples.first)
+            {
+                results.hasGpuTime = true;
+                results.gpuFrameTimeMs = computeSeries(samples.second.gpu);
+            }
+            results.gpuScopeTimes.push_back(std::make_pair(samples.first, computeSeries(samples.second.gpu)));
+        }
+        results.cpuScopeTimes.push_back(std::make_pair(samples.first, computeSeries(samples.second.cpu)));
+    }
+
+    /* Memory attributed to the model file, with the model still loaded */
+    results.hasMemory = false;
+    for (const ares::glutils::MemoryTracker::AssetUsage& asset : ares::glutils::MemoryTracker::assetUsage())
+    {
+        if (results.file == asset.name)
+        {
+            results.hasMemory = true;
+            results.memory = asset;
+        }
+    }
+
+    results.cpuFrameTimeMs = computeSeries(cpuTimes);
+    for (uint32_t metric = 0; metric < METRIC_COUNT; ++metric)
+    {
+        results.renderStats.push_back(std::make_pair(METRIC_NAMES[metric], computeSeries(metrics[metric])));
+    }
+}
+
+static std::string jsonString(const std::string& str)
+{
+    std::ostringstream oss;
+    oss << '"';
+    for (char c : str)
+    {
+        if (('"' == c) || ('\\' == c))
+        {
+            oss << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20U)
+        {
+            oss << ' ';
+        }
+        else
+        {
+            oss << c;
+        }
+    }
+    oss << '"';
+    return oss.str();
+}
+
+static void writeSeries(std::ostream& os, const char* name, const Series& series, const char* indent = "      ")
+{
+    os << indent << jsonString(name) << ": { \"mean\": " << series.mean << ", \"p50\": " << series.p50
+       << ", \"p95\": " << series.p95 << ", \"p99\": " << series.p99 << ", \"max\": " << series.max << " }";
+}
+
+static void writeScopeTimes(std::ostream& os, const char* name, const std::vector<std::pair<std::string, Series>>& scopeTimes)
+{
+    os << "," << std::endl
+       << "      " << jsonString(name) << ": {";
+    for (size_t i = 0; i < scopeTimes.size(); ++i)
+    {
+        os << ((0U == i) ? "" : ",") << std::endl;
+        writeSeries(os, scopeTimes[i].first.c_str(), scopeTimes[i].second, "        ");
+    }
+    os << std::endl
+       << "      }";
+}
+
+static void writeMemory(std::ostream& os, const ModelResults& results)
+{
+    if (!results.hasMemory)
+    {
+        os << "      \"memoryBytes\": null";
+        return;
+    }
+    os << "      \"memoryBytes\": { ";
+    for (uint32_t i = 0; i < ares::glutils::MemoryTracker::CATEGORY_COUNT; ++i)
+    {
+        const auto category = static_cast<ares::glutils::MemoryTracker::Category>(i);
+        os << jsonString(ares::glutils::MemoryTracker::categoryName(category)) << ": " << results.memory.bytes[i] << ", ";
+    }
+    os << "\"total\": " << results.memory.totalBytes() << " }";
+}
+
+static const char* glErrorCheckName(ares::glutils::GlUtils::ErrorCheckMode mode)
+{
+    switch (mode)
+    {
+    case ares::glutils::GlUtils::ErrorCheckMode::Off:
+        return "Off";
+    case ares::glutils::GlUtils::ErrorCheckMode::Frame:
+        return "Frame";
+    default:
+        return "EveryCall";
+    }
+}
+
+static void writeResults(std::ostream& os, const Options& options, const std::vector<ModelResults>& resultsVec)
+{
+    const char* glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    os << "{" << std::endl
+       << "  \"engine\": \"ares\"," << std::endl
+       << "  \"version\": " << jsonString(ARES_BENCH_VERSION) << "," << std::endl
+       << "  \"glRenderer\": " << jsonString((nullptr != glRenderer) ? glRenderer : "") << "," << std::endl
+       << "  \"glErrorCheck\": " << jsonString(glErrorCheckName(ares::glutils::GlUtils::errorCheckMode())) << "," << std::endl
+       << "  \"glDebugOutput\": " << (ares::glutils::GlUtils::debugOutputEnabled() ? "true" : "false") << "," << std::endl
+       << "  \"renderMode\": " << jsonString((ares::core::Renderer::RenderMode::Forward == options.renderMode) ? "forward" : "lightprepass") << "," << std::endl
+       << "  \"width\": " << options.width << "," << std::endl
+       << "  \"height\": " << options.height << "," << std::endl
+       << "  \"frames\": " << options.frames << "," << std::endl
+       << "  \"warmupFrames\": " << options.warmupFrames << "," << std::endl
+       << "  \"models\": [" << std::endl;
+    for (size_t i = 0; i < resultsVec.size(); ++i)
+    {
+        const ModelResults& results = resultsVec[i];
+        os << "    {" << std::endl
+           << "      \"model\": " << jsonString(results.model) << "," << std::endl
+           << "      \"file\": " << jsonString(results.file) << "," << std::endl;
+        if (!results.error.empty())
+        {
+            os << "      \"error\": " << jsonString(results.error) << std::endl;
+        }
+        else
+        {
+            writeSeries(os, "cpuFrameTimeMs", results.cpuFrameTimeMs);
+            os << "," << std::endl;
+            if (results.hasGpuTime)
+            {
+                writeSeries(os, "gpuFrameTimeMs", results.gpuFrameTimeMs);
+            }
+            else
+            {
+                os << "      \"gpuFrameTimeMs\": null";
+            }
+            for (const auto& metric : results.renderStats)
+            {
+                os << "," << std::endl;
+                writeSeries(os, metric.first.c_str(), metric.second);
+            }
+            writeScopeTimes(os, "gpuScopeTimesMs", results.gpuScopeTimes);
+            writeScopeTimes(os, "cpuScopeTimesMs", results.cpuScopeTimes);
+            os << "," << std::endl;
+            writeMemory(os, results);
+            os << std::endl;
+        }
+        os << "    }" << ((i + 1U < resultsVec.size()) ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl
+       << "}" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    /* Parse command line */
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return -1;
+    }
+
+    /* Create offscreen display device and drawing context */
+    ares::port::HeadlessDisplayPtr displayDevice = std::make_shared<ares::port::HeadlessDisplay>(options.width, options.height);
+    ares::core::DrawingContextPtr drawingContext;
+    try
+    {
+        drawingContext = std::make_shared<ares::core::DrawingContext>(displayDevice);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Failed to create drawing context: " << e.what() << std::endl;
+        return -1;
+    }
+
+    /* Select the GL error checking mode, the build level is kept otherwise */
+    if (options.setGlErrorCheck)
+    {
+        ares::glutils::GlUtils::setErrorCheckMode(options.glErrorCheck);
+    }
+
+    /* Record the engine scopes of the whole run if a trace is requested */
+    ares::glutils::Profiler::setEnabled(!options.trace.empty());
+
+    /* Run all models, failures are reported in the results */
+    bool success = true;
+    std::vector<ModelResults> resultsVec;
+    for (const std::string& model : options.models)
+    {
+        ModelResults results = {};
+        results.model = model;
+        results.file = modelFile(options, model);
+        std::cerr << "Running " << results.file << std::endl;
+        try
+        {
+            runModel(options, drawingContext, results);
+        }
+        catch (const std::exception& e)
+        {
+            results.error = e.what();
+        }
+        if (!results.error.empty())
+        {
+            std::cerr << "Failed to run " << model << ": " << results.error << std::endl;
+            success = false;
+        }
+        resultsVec.push_back(results);
+    }
+
+    /* Write the trace of the run */
+    if ((!options.trace.empty()) && (!ares::glutils::Profiler::writeTrace(options.trace)))
+    {
+        std::cerr << "Failed to write " << options.trace << std::endl;
+        success = false;
+    }
+
+    /* Write JSON results */
+    if (options.output.empty())
+    {
+        writeResults(std::cout, options, resultsVec);
+    }
+    else
+    {
+        std::ofstream file(options.output);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << options.output << std::endl;
+            return -1;
+        }
+        writeResults(file, options, resultsVec);
+    }
+
+    return success ? 0 : -1;
+}
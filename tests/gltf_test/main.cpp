@@ -128,6 +128,7 @@ int main(int /*argc*/, char** /*argv*/)
         std::cout << "Failed to create point light" << std::endl;
         return -1;
     }
+    pointLight->setIntensity(10.F);
     lightNode->setLight(pointLight);
     lightNode->setPosition(0.F, 2.F, 1.F);
 
@@ -0,0 +1,373 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+
+/* Linear algebra include, with the SIMD or scalar kernels selected at build time */
+#include "ares/glutils/LinearAlgebra.hpp"
+
+using ares::glutils::Mat3;
+using ares::glutils::Mat4;
+using ares::glutils::Vec4;
+
+/* Number of random cases per operation */
+constexpr uint32_t CASE_COUNT = 10000U;
+
+/* Relative tolerance of products and affine inverses against the double precision reference */
+constexpr double PRODUCT_TOLERANCE = 1.0E-5;
+
+/* Tolerance of general inverses of well-conditioned matrices against the double precision reference */
+constexpr double INVERSE_TOLERANCE = 1.0E-4;
+
+/* Double precision column-major 4x4 matrix used as reference */
+struct RefMat4
+{
+    double m[4][4];
+};
+
+/* Number of failed checks */
+static uint32_t s_failures = 0U;
+
+static RefMat4 toRef(const Mat4& mat)
+{
+    RefMat4 ref;
+    for (size_t c = 0; c < 4; ++c)
+    {
+        for (size_t r = 0; r < 4; ++r)
+        {
+            ref.m[c][r] = mat.const_data()[c * 4 + r];
+        }
+    }
+    return ref;
+}
+
+static RefMat4 refMultiply(const RefMat4& lhs, const RefMat4& rhs)
+{
+    RefMat4 res = {};
+    for (size_t c = 0; c < 4; ++c)
+    {
+        for (size_t r = 0; r < 4; ++r)
+        {
+            for (size_t i = 0; i < 4; ++i)
+            {
+                res.m[c][r] += lhs.m[i][r] * rhs.m[c][i];
+            }
+        }
+    }
+    return res;
+}
+
+/* Gauss-Jordan inverse with partial pivoting, false if the matrix is singular */
+static bool refInvert(const RefMat4& mat, RefMat4& inv)
+{
+    double a[4][8];
+    for (size_t r = 0; r < 4; ++r)
+    {
+        for (size_t c = 0; c < 4; ++c)
+        {
+            a[r][c] = mat.m[c][r];
+            a[r][c + 4] = (r == c) ? 1.0 : 0.0;
+        }
+    }
+    for (size_t c = 0; c < 4; ++c)
+    {
+        size_t pivot = c;
+        for (size_t r = c + 1; r < 4; ++r)
+        {
+            if (std::fabs(a[r][c]) > std::fabs(a[pivot][c]))
+            {
+                pivot = r;
+            }
+        }
+        if (0.0 == a[pivot][c])
+        {
+            return false;
+        }
+        for (size_t k = 0; k < 8; ++k)
+        {
+            std::swap(a[c][k], a[pivot][k]);
+        }
+        double scale = 1.0 / a[c][c];
+        for (size_t k = 0; k < 8; ++k)
+        {
+            a[c][k] *= scale;
+        }
+        for (size_t r = 0; r < 4; ++r)
+        {
+            if (r != c)
+            {
+                double factor = a[r][c];
+                for (size_t k = 0; k < 8; ++k)
+                {
+                    a[r][k] -= factor * a[c][k];
+                }
+            }
+        }
+    }
+    for (size_t r = 0; r < 4; ++r)
+    {
+        for (size_t c = 0; c < 4; ++c)
+        {
+            inv.m[c][r] = a[r][c + 4];
+        }
+    }
+    return true;
+}
+
+static void check(const char* operation, uint32_t testCase, const float* values, const double* expected, size_t count, double tolerance)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        double error = std::fabs(static_cast<double>(values[i]) - expected[i]);
+        if (error > tolerance * std::fmax(1.0, std::fabs(expected[i])))
+        {
+            std::cerr << operation << " case " << testCase << " entry " << i << ": got " << values[i] << ", expected " << expected[i] << std::endl;
+            ++s_failures;
+            return;
+        }
+    }
+}
+
+static Mat4 randomMatrix(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-2.F, 2.F);
+    Mat4 mat;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        mat.data()[i] = dist(rng);
+    }
+    return mat;
+}
+
+/* Random matrix dominated by its diagonal, so that it is well-conditioned */
+static Mat4 randomInvertibleMatrix(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> sign(-1.F, 1.F);
+    Mat4 mat = randomMatrix(rng);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        mat.set(i, i, mat.const_data()[i * 5] + ((sign(rng) < 0.F) ? (-8.F) : (8.F)));
+    }
+    return mat;
+}
+
+/* Random rotation, scale and translation */
+static Mat4 randomAffineMatrix(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> angle(-3.14F, 3.14F);
+    std::uniform_real_distribution<float> scale(0.25F, 4.F);
+    std::uniform_real_distribution<float> position(-10.F, 10.F);
+    Mat4 mat;
+    mat.setIdentity();
+    mat.scale(scale(rng), scale(rng), scale(rng));
+    mat.rotateXYZ(angle(rng), angle(rng), angle(rng));
+    mat.translate(position(rng), position(rng), position(rng));
+    return mat;
+}
+
+/* Random rotation and translation with the given scale per axis */
+static Mat4 scaledMatrix(std::mt19937& rng, float scaleX, float scaleY, float scaleZ)
+{
+    std::uniform_real_distribution<float> angle(-3.14F, 3.14F);
+    std::uniform_real_distribution<float> position(-10.F, 10.F);
+    Mat4 mat;
+    mat.setIdentity();
+    mat.scale(scaleX, scaleY, scaleZ);
+    mat.rotateXYZ(angle(rng), angle(rng), angle(rng));
+    mat.translate(position(rng), position(rng), position(rng));
+    return mat;
+}
+
+/* Compares the normal matrix against the inverse transpose of the upper 3x3 block */
+static void checkNormalMatrix(const char* operation, uint32_t testCase, const Mat4& mat, bool uniformScale)
+{
+    if (mat.hasUniformScale(PRODUCT_TOLERANCE) != uniformScale)
+    {
+        std::cerr << operation << " case " << testCase << ": unexpected uniform scale detection" << std::endl;
+        ++s_failures;
+        return;
+    }
+
+    RefMat4 refBlock = toRef(mat);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        refBlock.m[i][3] = 0.0;
+        refBlock.m[3][i] = 0.0;
+    }
+    refBlock.m[3][3] = 1.0;
+    RefMat4 refInverse;
+    if (!refInvert(refBlock, refInverse))
+    {
+        return;
+    }
+
+    /* Column-major inverse transpose */
+    double refNormal[9];
+    for (size_t c = 0; c < 3; ++c)
+    {
+        for (size_t r = 0; r < 3; ++r)
+        {
+            refNormal[c * 3 + r] = refInverse.m[r][c];
+        }
+    }
+    Mat3 normal = mat.normalMatrix();
+    check(operation, testCase, normal.const_data(), refNormal, 9, PRODUCT_TOLERANCE);
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    std::mt19937 rng(1234U);
+    std::uniform_real_distribution<float> dist(-2.F, 2.F);
+
+    for (uint32_t testCase = 0U; testCase < CASE_COUNT; ++testCase)
+    {
+        Mat4 lhs = randomMatrix(rng);
+        Mat4 rhs = randomMatrix(rng);
+        RefMat4 refLhs = toRef(lhs);
+        RefMat4 refRhs = toRef(rhs);
+
+        /* Mat4 * Mat4 and Mat4 *= Mat4 */
+        RefMat4 refProduct = refMultiply(refLhs, refRhs);
+        Mat4 product = lhs * rhs;
+        check("Mat4 * Mat4", testCase, product.const_data(), &refProduct.m[0][0], 16, PRODUCT_TOLERANCE);
+        Mat4 productAssign(lhs);
+        productAssign *= rhs;
+        check("Mat4 *= Mat4", testCase, productAssign.const_data(), &refProduct.m[0][0], 16, PRODUCT_TOLERANCE);
+
+        /* Mat4 * Vec4 */
+        Vec4 vec(dist(rng), dist(rng), dist(rng), dist(rng));
+        double refVec[4] = {};
+        for (size_t r = 0; r < 4; ++r)
+        {
+            for (size_t c = 0; c < 4; ++c)
+            {
+                refVec[r] += refLhs.m[c][r] * vec[c];
+            }
+        }
+        Vec4 vecProduct = lhs * vec;
+        check("Mat4 * Vec4", testCase, vecProduct.const_data(), refVec, 4, PRODUCT_TOLERANCE);
+
+        /* Transpose, exact */
+        RefMat4 refTransposed;
+        for (size_t c = 0; c < 4; ++c)
+        {
+            for (size_t r = 0; r < 4; ++r)
+            {
+                refTransposed.m[c][r] = refLhs.m[r][c];
+            }
+        }
+        Mat4 transposed(lhs);
+        transposed.transpose();
+        check("transpose", testCase, transposed.const_data(), &refTransposed.m[0][0], 16, 0.0);
+
+        /* General inverse */
+        Mat4 invertible = randomInvertibleMatrix(rng);
+        RefMat4 refInverse;
+        if (refInvert(toRef(invertible), refInverse))
+        {
+            Mat4 inverse(invertible);
+            inverse.invert();
+            check("invert", testCase, inverse.const_data(), &refInverse.m[0][0], 16, INVERSE_TOLERANCE);
+        }
+
+        /* Affine inverse, directly and through the general inverse */
+        Mat4 affine = randomAffineMatrix(rng);
+        if (refInvert(toRef(affine), refInverse))
+        {
+            Mat4 inverse(affine);
+            inverse.invertAffine();
+            check("invertAffine", testCase, inverse.const_data(), &refInverse.m[0][0], 16, PRODUCT_TOLERANCE);
+            inverse = affine;
+            inverse.invert();
+            check("invert (affine)", testCase, inverse.const_data(), &refInverse.m[0][0], 16, PRODUCT_TOLERANCE);
+        }
+    }
+
+    /* Normal matrix with uniform, non-uniform and mirrored scales */
+    std::uniform_real_distribution<float> scale(0.25F, 4.F);
+    for (uint32_t testCase = 0U; testCase < CASE_COUNT; ++testCase)
+    {
+        float s = scale(rng);
+        checkNormalMatrix("normalMatrix (uniform)", testCase, scaledMatrix(rng, s, s, s), true);
+        checkNormalMatrix("normalMatrix (non-uniform)", testCase, scaledMatrix(rng, s, 2.F * s, 0.5F * s), false);
+        checkNormalMatrix("normalMatrix (mirrored uniform)", testCase, scaledMatrix(rng, -s, s, s), true);
+        checkNormalMatrix("normalMatrix (mirrored non-uniform)", testCase, scaledMatrix(rng, s, -2.F * s, 0.5F * s), false);
+
+        /* Singular block: the transposed block is kept */
+        Mat4 singular = scaledMatrix(rng, s, s, s);
+        for (size_t r = 0; r < 3; ++r)
+        {
+            singular.set(r, 1, 0.F);
+        }
+        double refTransposed[9];
+        for (size_t c = 0; c < 3; ++c)
+        {
+            for (size_t r = 0; r < 3; ++r)
+            {
+                refTransposed[c * 3 + r] = singular.const_data()[r * 4 + c];
+            }
+        }
+        Mat3 normal = singular.normalMatrix();
+        check("normalMatrix (singular)", testCase, normal.const_data(), refTransposed, 9, 0.0);
+    }
+
+    /* Singular matrices are left unchanged: the zero matrix, a general matrix with proportional rows
+     * and an affine matrix with a zero scale axis, with small integers so that their determinant is exactly 0.
+     * The raw data is row-major */
+    const float singularData[][16] =
+    {
+        { 0.F, 0.F, 0.F, 0.F,   0.F, 0.F, 0.F, 0.F,   0.F, 0.F, 0.F, 0.F,   0.F, 0.F, 0.F, 0.F },
+        { 1.F, 2.F, 3.F, 4.F,   2.F, 4.F, 6.F, 8.F,   0.F, 1.F, 0.F, 2.F,   5.F, 0.F, 1.F, 3.F },
+        { 2.F, 0.F, 0.F, 1.F,   0.F, 0.F, 0.F, 2.F,   0.F, 0.F, 3.F, 3.F,   0.F, 0.F, 0.F, 1.F }
+    };
+    for (uint32_t testCase = 0U; testCase < (sizeof(singularData) / sizeof(singularData[0])); ++testCase)
+    {
+        Mat4 singular;
+        singular = singularData[testCase];
+        RefMat4 refSingular = toRef(singular);
+        singular.invert();
+        check("invert (singular)", testCase, singular.const_data(), &refSingular.m[0][0], 16, 0.0);
+        singular.invertAffine();
+        check("invertAffine (singular)", testCase, singular.const_data(), &refSingular.m[0][0], 16, 0.0);
+    }
+
+#if defined(ARES_SIMD_SSE2)
+    const char* path = "SSE2";
+#elif defined(ARES_SIMD_NEON)
+    const char* path = "NEON";
+#else
+    const char* path = "scalar";
+#endif
+    std::cout << path << " path: " << s_failures << " failed checks" << std::endl;
+    return (0U == s_failures) ? 0 : 1;
+}
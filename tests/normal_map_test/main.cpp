@@ -325,6 +325,7 @@ int main(int /*argc*/, char** /*argv*/)
     /* Create light */
     ares::core::LightNodePtr lightNode = scene->createNode<ares::core::LightNode>("lightNode", scene->rootNode());
     ares::core::PointLightPtr pointLight = std::make_shared<ares::core::PointLight>();
+    pointLight->setIntensity(30.F);
     lightNode->setLight(pointLight);
     lightNode->setPosition(1.F, 3.F, 2.F);
 
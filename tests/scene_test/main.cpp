@@ -0,0 +1,128 @@
+/******************************************************************************/
+/*!
+ * @file
+ * @author Ettore Barattelli
+ * @copyright
+ * This file is part of ARES, distributed under MIT license
+ * \n\n
+ * MIT License
+ * \n\n
+ * Copyright (c) 2023 Ettore Barattelli
+ * \n\n
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * \n\n
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * \n\n
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Port include, for the offscreen display */
+#include "ares/port/HeadlessDisplay.hpp"
+
+/* Core includes for ARES 3D objects */
+#include "ares/core/DrawingContext.hpp"
+#include "ares/core/LightNode.hpp"
+#include "ares/core/PointLight.hpp"
+#include "ares/core/Scene.hpp"
+
+/* Number of light nodes placed along the X axis */
+constexpr uint32_t LIGHT_COUNT = 8U;
+
+/* Distance between consecutive light nodes */
+constexpr float LIGHT_SPACING = 2.F;
+
+/* Number of failed checks */
+static uint32_t s_failures = 0U;
+
+static void check(bool condition, const std::string& description)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << description << std::endl;
+        ++s_failures;
+    }
+}
+
+static void checkNearest(const ares::core::Scene& scene, const std::vector<ares::core::LightNodePtr>& lightNodes, float x, const std::string& description)
+{
+    /* Query all the lights, including those no longer in the scene */
+    std::vector<ares::core::LightNodePtr> nearest = scene.nearestLightNodes(ares::glutils::Vec3(x, 0.F, 0.F), LIGHT_COUNT);
+    check(nearest.size() == lightNodes.size(), description + ": light count");
+
+    /* Each remaining light must be returned once, sorted by distance */
+    float lastDistance = 0.F;
+    for (const auto& lightNode : nearest)
+    {
+        bool found = false;
+        for (const auto& remaining : lightNodes)
+        {
+            found = found || (remaining == lightNode);
+        }
+        check(found, description + ": removed or unknown light " + ((nullptr != lightNode) ? (lightNode->name()) : (std::string("null"))));
+        if (nullptr != lightNode)
+        {
+            float distance = std::fabs(lightNode->worldPosition()[0] - x);
+            check(distance >= lastDistance, description + ": light " + lightNode->name() + " out of order");
+            lastDistance = distance;
+        }
+    }
+}
+
+int main()
+{
+    /* Create an offscreen context and a scene */
+    auto display = std::make_shared<ares::port::HeadlessDisplay>(16, 16);
+    auto drawingContext = std::make_shared<ares::core::DrawingContext>(display);
+    auto scene = std::make_shared<ares::core::Scene>("lights", drawingContext);
+
+    /* Place the lights along the X axis */
+    std::vector<ares::core::LightNodePtr> lightNodes;
+    for (uint32_t i = 0; i < LIGHT_COUNT; ++i)
+    {
+        auto lightNode = scene->createNode<ares::core::LightNode>("light" + std::to_string(i), scene->rootNode());
+        lightNode->setLight(std::make_shared<ares::core::PointLight>());
+        lightNode->setPosition(static_cast<float>(i) * LIGHT_SPACING, 0.F, 0.F);
+        lightNodes.push_back(lightNode);
+    }
+    scene->update();
+    checkNearest(*scene, lightNodes, 0.F, "initial");
+
+    /* Remove lights and query without updating the scene, the first removal moves the last light in the registry */
+    const uint32_t removals[] = { 0U, 3U, 0U };
+    for (uint32_t removal : removals)
+    {
+        scene->removeNode(lightNodes[removal]);
+        lightNodes.erase(lightNodes.begin() + removal);
+        checkNearest(*scene, lightNodes, 0.F, "after removal");
+        checkNearest(*scene, lightNodes, static_cast<float>(LIGHT_COUNT) * LIGHT_SPACING, "after removal, far query");
+    }
+
+    /* Remove the remaining lights */
+    while (!lightNodes.empty())
+    {
+        scene->removeNode(lightNodes.back());
+        lightNodes.pop_back();
+    }
+    checkNearest(*scene, lightNodes, 0.F, "all removed");
+
+    std::cout << "Scene test: " << s_failures << " failed checks" << std::endl;
+    return (0U == s_failures) ? (0) : (1);
+}